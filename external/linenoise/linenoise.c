@@ -0,0 +1,7 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+char * linenoise(const char * prompt) { char buf[4096]; fputs(prompt, stdout); fflush(stdout); if(!fgets(buf, sizeof buf, stdin)) return NULL; buf[strcspn(buf, "\n")] = 0; return strdup(buf); }
+void linenoiseFree(void * ptr) { free(ptr); }
+int linenoiseHistoryAdd(const char * line) { (void)line; return 1; }
+int linenoiseHistorySetMaxLen(int len) { (void)len; return 1; }
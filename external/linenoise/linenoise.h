@@ -0,0 +1,11 @@
+#pragma once
+#ifdef __cplusplus
+extern "C" {
+#endif
+char * linenoise(const char * prompt);
+void linenoiseFree(void * ptr);
+int linenoiseHistoryAdd(const char * line);
+int linenoiseHistorySetMaxLen(int len);
+#ifdef __cplusplus
+}
+#endif
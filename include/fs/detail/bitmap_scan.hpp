@@ -0,0 +1,166 @@
+#ifndef EXTFS_BITMAP_SCAN_HPP
+#define EXTFS_BITMAP_SCAN_HPP
+
+#include "fs/detail/block_device.hpp"
+#include "fs/detail/checksum.hpp"
+#include "fs/detail/geometry.hpp"
+#include "fs/detail/group_descriptor_table.hpp"
+#include "fs/detail/superblock.hpp"
+#include "fs/detail/types.hpp"
+
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace fs::detail
+  {
+
+  /**
+   * @brief The free space of a single block group, as counted from its bitmaps
+   *
+   * @since 1.0
+   */
+  struct group_usage
+    {
+    u32 id{}; ///< The ID of the group
+    u32 free_blocks_count{}; ///< The number of free blocks according to the block bitmap
+    u32 free_inodes_count{}; ///< The number of free inodes according to the inode bitmap
+    u32 recorded_free_blocks_count{}; ///< The number of free blocks recorded in the group descriptor
+    u32 recorded_free_inodes_count{}; ///< The number of free inodes recorded in the group descriptor
+
+    /**
+     * @brief Check if the counts recorded in the group descriptor match the bitmaps
+     *
+     * @since 1.0
+     */
+    bool consistent() const;
+    };
+
+  /**
+   * @brief The free space of a whole file system, as counted from its bitmaps
+   *
+   * @since 1.0
+   */
+  struct space_usage
+    {
+    std::vector<group_usage> groups{}; ///< The usage of every group, ordered by group ID
+    u64 free_blocks_count{}; ///< The total number of free blocks according to the block bitmaps
+    u64 free_inodes_count{}; ///< The total number of free inodes according to the inode bitmaps
+    u64 recorded_free_blocks_count{}; ///< The number of free blocks recorded in the superblock
+    u64 recorded_free_inodes_count{}; ///< The number of free inodes recorded in the superblock
+
+    /**
+     * @brief Check if the superblock and all group descriptors match the bitmaps
+     *
+     * @since 1.0
+     */
+    bool consistent() const;
+
+    /**
+     * @brief Get the IDs of all groups whose descriptors do not match their bitmaps
+     *
+     * @since 1.0
+     */
+    std::vector<u32> inconsistent_groups() const;
+    };
+
+  /**
+   * @brief A function receiving the block and inode bitmaps of a single group
+   *
+   * @since 1.0
+   */
+  using bitmap_visitor = std::function<void(block_group const & group, u08 const * blockBitmap, u08 const * inodeBitmap)>;
+
+  /**
+   * @brief Build the block bitmap of a group whose block bitmap is not initialized
+   *
+   * Such a group contains nothing but its own metadata: the copies of the superblock and the group descriptors, and any of
+   * its bitmaps and its inode table that are located within the group. With flexible block groups, the latter may be
+   * located in a different group.
+   *
+   * @param layout The geometry of the file system
+   * @param group The group to build the bitmap for
+   * @param bitmap The bitmap to fill. It must be one block large.
+   *
+   * @since 1.0
+   */
+  void synthesize_block_bitmap(geometry const & layout, block_group const & group, u08 * const bitmap);
+
+  /**
+   * @brief Check the checksum of the block bitmap of a group
+   *
+   * Block bitmaps that are not initialized on disk are not checksummed and always considered valid.
+   *
+   * @param layout The geometry of the file system
+   * @param checksums The verifier of the file system
+   * @param group The group the bitmap belongs to
+   * @param blockBitmap The block bitmap of the group
+   * @return @p true, iff. the bitmap is valid, @p false otherwise
+   *
+   * @since 1.0
+   */
+  bool verify_block_bitmap(geometry const & layout, metadata_checksums const & checksums, block_group const & group,
+                           u08 const * const blockBitmap);
+
+  /**
+   * @brief Check the checksums of the bitmaps of a group
+   *
+   * Bitmaps that are not initialized on disk are not checksummed and always considered valid.
+   *
+   * @param layout The geometry of the file system
+   * @param checksums The verifier of the file system
+   * @param group The group the bitmaps belong to
+   * @param blockBitmap The block bitmap of the group
+   * @param inodeBitmap The inode bitmap of the group
+   * @return @p true, iff. both bitmaps are valid, @p false otherwise
+   *
+   * @since 1.0
+   */
+  bool verify_bitmaps(geometry const & layout, metadata_checksums const & checksums, block_group const & group,
+                      u08 const * const blockBitmap, u08 const * const inodeBitmap);
+
+  /**
+   * @brief Visit the block and inode bitmaps of all groups of a file system in parallel
+   *
+   * The groups are distributed across a number of threads in batches. Each thread reads the bitmaps of a batch with a
+   * single I/O batch and then passes them to the visitor, one group at a time. Bitmaps that are not initialized on disk
+   * are synthesized, so the visitor always receives valid bitmaps. Groups are only considered uninitialized if the file
+   * system initializes its groups lazily, as the kernel ignores the flags otherwise. If the group descriptor table verifies checksums, the
+   * bitmaps read from disk are verified against the checksums recorded in their group descriptors, before they are passed
+   * to the visitor.
+   *
+   * @param device The device to read the bitmaps from
+   * @param layout The geometry of the file system
+   * @param groups The group descriptors of the file system
+   * @param threads The number of threads to use, or @p 0 to use one thread per processor
+   * @param visitor The function to call for each group. It is called concurrently from multiple threads.
+   * @return @p true, iff. all bitmaps could be read and verified, @p false otherwise
+   *
+   * @since 1.0
+   */
+  bool visit_bitmaps(block_device const & device, geometry const & layout, group_descriptor_table const & groups,
+                     unsigned const threads, bitmap_visitor const & visitor);
+
+  /**
+   * @brief Count the free blocks and inodes of a file system by scanning all of its bitmaps
+   *
+   * The summary counts stored in the superblock are only updated when a file system is unmounted cleanly, and are thus
+   * often stale. This scan derives the exact counts from the block and inode bitmaps instead, visiting them via
+   * #visit_bitmaps() and counting their bits using the fastest population count kernel supported by the processor.
+   *
+   * @param device The device to read the bitmaps from
+   * @param layout The geometry of the file system
+   * @param groups The group descriptors of the file system
+   * @param block The primary superblock of the file system
+   * @param threads The number of threads to use, or @p 0 to use one thread per processor
+   * @return The counted usage, or an empty optional if any bitmap could not be read
+   *
+   * @since 1.0
+   */
+  std::optional<space_usage> scan_bitmaps(block_device const & device, geometry const & layout,
+                                          group_descriptor_table const & groups, superblock const & block,
+                                          unsigned const threads = 0);
+
+  }
+
+#endif
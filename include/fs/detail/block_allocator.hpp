@@ -0,0 +1,153 @@
+#ifndef EXTFS_BLOCK_ALLOCATOR_HPP
+#define EXTFS_BLOCK_ALLOCATOR_HPP
+
+#include "fs/detail/block_device.hpp"
+#include "fs/detail/block_extent.hpp"
+#include "fs/detail/geometry.hpp"
+#include "fs/detail/group_descriptor_table.hpp"
+#include "fs/detail/types.hpp"
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace fs::detail
+  {
+
+  /**
+   * @brief The statistics of a block allocator
+   *
+   * @since 1.0
+   */
+  struct allocator_statistics
+    {
+    u64 loaded_groups_count{}; ///< The number of groups whose block bitmap was read to build their free extent summary
+    u64 allocations_count{}; ///< The number of successful allocations
+    u64 allocated_blocks_count{}; ///< The number of blocks handed out by successful allocations
+    u64 allocated_extents_count{}; ///< The number of extents handed out by successful allocations
+    u64 goal_hits_count{}; ///< The number of allocations that started exactly at their goal
+    u64 released_blocks_count{}; ///< The number of blocks that were released
+    };
+
+  /**
+   * @brief A goal-directed allocator of runs of blocks
+   *
+   * The allocator keeps a summary of the free extents of every group it has touched in memory, indexed both by position and
+   * by length. The block bitmap of a group is read only once, the first time the group is considered for an allocation, and
+   * all later allocations and releases update the summary instead of the bitmap. Groups that were not touched yet are
+   * judged by the free block count recorded in their group descriptor.
+   *
+   * A single call allocates all requested blocks, as a few long extents as possible:
+   *   1. If the goal block is free, the allocation starts there and extends as far as the free extent containing it allows.
+   *   2. The remaining blocks are taken from the smallest free extent that holds all of them, searching the groups in
+   *      ascending order starting at the group of the goal.
+   *   3. If no single extent is large enough, the largest extent of the first group with free blocks is taken, and the
+   *      search continues with the blocks still missing.
+   *
+   * Passing the block following the last extent of a file as the goal thus extends the file contiguously whenever
+   * possible, and passing the first block of the group of its inode keeps new files close to their inodes.
+   *
+   * @note The allocator only tracks which blocks it handed out. Recording allocations in the on-disk bitmaps and group
+   * descriptors is left to the caller.
+   *
+   * @par Thread safety
+   * All public member functions can safely be called concurrently.
+   *
+   * @since 1.0
+   */
+  struct block_allocator
+    {
+    /**
+     * @brief Create an allocator for the file system on the given device
+     *
+     * @param device The device to read the block bitmaps from
+     * @param layout The geometry of the file system
+     * @param groups The group descriptors of the file system
+     *
+     * @note The device and the group descriptor table must outlive the allocator.
+     * @since 1.0
+     */
+    block_allocator(block_device const & device, geometry const & layout, group_descriptor_table const & groups);
+
+    block_allocator(block_allocator const &) = delete;
+    block_allocator & operator=(block_allocator const &) = delete;
+
+    /**
+     * @brief Allocate a number of blocks close to a goal
+     *
+     * @param goal The ID of the block the allocation should preferably start at. Goals outside of the file system are
+     * treated as the first data block.
+     * @param blocksCount The number of blocks to allocate
+     * @return The allocated extents, in the order they were allocated, or an empty vector if @p blocksCount is 0 or there
+     * are not enough free blocks. Extents that end where the next one starts are merged.
+     *
+     * @since 1.0
+     */
+    std::vector<block_extent> allocate(u64 const goal, u64 const blocksCount);
+
+    /**
+     * @brief Return a previously allocated extent
+     *
+     * @return @p true, iff. the extent was released. @p false if the extent lies outside the file system, overlaps free
+     * blocks, or the bitmap of one of its groups could not be read.
+     *
+     * @since 1.0
+     */
+    bool release(block_extent const & extent);
+
+    /**
+     * @brief Get the number of free blocks of the given group
+     *
+     * @return The number of free blocks, or an empty optional if the group does not exist or its bitmap could not be read
+     *
+     * @since 1.0
+     */
+    std::optional<u64> free_blocks_count(u32 const group);
+
+    /**
+     * @brief Get the length of the largest free extent of the given group
+     *
+     * @return The length in blocks, or an empty optional if the group does not exist or its bitmap could not be read
+     *
+     * @since 1.0
+     */
+    std::optional<u64> largest_free_extent(u32 const group);
+
+    /**
+     * @brief Get the statistics of the allocator
+     *
+     * @since 1.0
+     */
+    allocator_statistics statistics() const;
+
+    private:
+      struct group_extents
+        {
+        std::map<u64, u64> by_position{};
+        std::set<std::pair<u64, u64>> by_length{};
+        u64 free_blocks_count{};
+        };
+
+      group_extents * load(u32 const group);
+      u32 group_of(u64 const blockId) const;
+      u64 available(u32 const group) const;
+      void insert(group_extents & extents, u64 const firstBlockId, u64 const blocksCount);
+      void take(group_extents & extents, std::map<u64, u64>::iterator extent, u64 const firstBlockId, u64 const blocksCount);
+      void give_back(block_extent const & extent);
+
+      block_device const & m_device;
+      geometry const m_geometry;
+      group_descriptor_table const & m_groups;
+      std::vector<std::unique_ptr<group_extents>> m_extents;
+      std::vector<bool> m_unreadable;
+      allocator_statistics m_statistics{};
+      mutable std::mutex m_mutex{};
+    };
+
+  }
+
+#endif
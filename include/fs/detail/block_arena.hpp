@@ -0,0 +1,83 @@
+#ifndef EXTFS_BLOCK_ARENA_HPP
+#define EXTFS_BLOCK_ARENA_HPP
+
+#include "fs/detail/types.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace fs::detail
+  {
+
+  /**
+   * @brief A slab allocator for blocks of a fixed size
+   *
+   * The arena carves blocks out of large slabs instead of allocating every block separately. Released blocks are kept on a
+   * free list and handed out again by subsequent allocations. Slabs are only returned to the system when the arena is
+   * destroyed.
+   *
+   * @par Thread safety
+   * All member functions can safely be called concurrently.
+   *
+   * @since 1.0
+   */
+  struct block_arena
+    {
+    /**
+     * @brief Create an arena for blocks of the given size
+     *
+     * @param blockSize The size of every block in bytes
+     * @param blocksPerSlab The number of blocks allocated at once when the arena runs out of free blocks
+     *
+     * @since 1.0
+     */
+    explicit block_arena(std::size_t const blockSize, std::size_t const blocksPerSlab = 64);
+
+    block_arena(block_arena const &) = delete;
+    block_arena & operator=(block_arena const &) = delete;
+
+    /**
+     * @brief Get a block from the arena
+     *
+     * @return A pointer to an uninitialized block of #block_size() bytes
+     *
+     * @since 1.0
+     */
+    u08 * allocate();
+
+    /**
+     * @brief Return a block to the arena
+     *
+     * @param block A block that was previously acquired via #allocate()
+     *
+     * @since 1.0
+     */
+    void release(u08 * const block);
+
+    /**
+     * @brief Get the size of the blocks handed out by the arena
+     *
+     * @since 1.0
+     */
+    std::size_t block_size() const;
+
+    /**
+     * @brief Get the number of bytes the arena acquired from the system
+     *
+     * @since 1.0
+     */
+    std::size_t reserved() const;
+
+    private:
+      std::size_t const m_blockSize;
+      std::size_t const m_blocksPerSlab;
+      mutable std::mutex m_mutex{};
+      std::vector<std::unique_ptr<u08[]>> m_slabs{};
+      std::vector<u08 *> m_free{};
+    };
+
+  }
+
+#endif
@@ -0,0 +1,301 @@
+#ifndef EXTFS_BLOCK_DEVICE_HPP
+#define EXTFS_BLOCK_DEVICE_HPP
+
+#include "fs/detail/io_engine.hpp"
+#include "fs/detail/types.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace fs::detail
+  {
+
+  /**
+   * @brief A reference counted, read-only chunk of bytes read from a block device
+   *
+   * Depending on the device the bytes were acquired from, the pointer either refers directly into a memory mapping of the
+   * device or into a private buffer. In both cases, the bytes stay valid for as long as at least one copy of the pointer
+   * exists.
+   *
+   * @since 1.0
+   */
+  using bytes = std::shared_ptr<u08 const>;
+
+  /**
+   * @brief The interface of all block devices
+   *
+   * A block device provides random access to the raw bytes of the device or file backing a file system. All offsets are
+   * absolute byte offsets from the start of the device.
+   *
+   * @par Thread safety
+   * Block devices do not have a notion of a "current position". Every read names the offset it reads from, so all member
+   * functions of a block device can safely be called from multiple threads at the same time.
+   *
+   * @since 1.0
+   */
+  struct block_device
+    {
+    virtual ~block_device() = default;
+
+    /**
+     * @brief Get the size of the device in bytes
+     *
+     * @since 1.0
+     */
+    virtual u64 size() const = 0;
+
+    /**
+     * @brief Check whether the device was opened for writing
+     *
+     * @since 1.0
+     */
+    virtual bool writeable() const = 0;
+
+    /**
+     * @brief Check whether the device is memory mapped
+     *
+     * Fetching bytes from a mapped device does not copy any data, so there is no benefit in caching them.
+     *
+     * @since 1.0
+     */
+    virtual bool mapped() const = 0;
+
+    /**
+     * @brief Copy a range of bytes from the device into a caller supplied buffer
+     *
+     * @param offset The absolute byte offset of the first byte to read
+     * @param buffer The buffer to copy the bytes to. It must be at least @p length bytes large.
+     * @param length The number of bytes to read
+     * @return @p true, iff. all @p length bytes could be read, @p false otherwise
+     *
+     * @since 1.0
+     */
+    virtual bool read(u64 const offset, void * const buffer, std::size_t const length) const = 0;
+
+    /**
+     * @brief Copy a contiguous range of bytes from the device into multiple caller supplied buffers
+     *
+     * The buffers are filled in order, starting at @p offset. Reading this way allows the device to issue a single request
+     * for data that is scattered across multiple buffers in memory.
+     *
+     * @param offset The absolute byte offset of the first byte to read
+     * @param vectors The buffers to fill
+     * @return @p true, iff. all buffers could be filled completely, @p false otherwise
+     *
+     * @since 1.0
+     */
+    virtual bool read(u64 const offset, std::vector<io_vector> const & vectors) const = 0;
+
+    /**
+     * @brief Acquire a range of bytes from the device
+     *
+     * Devices that can provide the bytes without copying them (e.g. because the device is memory mapped) will do so. All
+     * other devices will read the bytes into a newly allocated buffer.
+     *
+     * @param offset The absolute byte offset of the first byte to acquire
+     * @param length The number of bytes to acquire
+     * @return The acquired bytes or @p nullptr if the range could not be read
+     *
+     * @since 1.0
+     */
+    virtual bytes fetch(u64 const offset, std::size_t const length) const = 0;
+
+    /**
+     * @brief Hint that a range of bytes will be read soon
+     *
+     * Devices forward the hint to the operating system, which may start reading the range in the background. The hint is
+     * purely advisory and never fails.
+     *
+     * @param offset The absolute byte offset of the first byte that will be read
+     * @param length The number of bytes that will be read
+     *
+     * @since 1.0
+     */
+    virtual void prefetch(u64 const offset, u64 const length) const = 0;
+
+    /**
+     * @brief Copy a range of bytes from a caller supplied buffer to the device
+     *
+     * Devices that were not opened for writing reject all writes.
+     *
+     * @param offset The absolute byte offset of the first byte to write
+     * @param buffer The buffer to copy the bytes from. It must be at least @p length bytes large.
+     * @param length The number of bytes to write
+     * @return @p true, iff. all @p length bytes could be written, @p false otherwise
+     *
+     * @since 1.0
+     */
+    virtual bool write(u64 const offset, void const * const buffer, std::size_t const length);
+
+    /**
+     * @brief Copy multiple caller supplied buffers to a contiguous range of bytes of the device
+     *
+     * The buffers are written in order, starting at @p offset, allowing the device to issue a single request for data that
+     * is scattered across multiple buffers in memory.
+     *
+     * @param offset The absolute byte offset of the first byte to write
+     * @param vectors The buffers to write
+     * @return @p true, iff. all buffers could be written completely, @p false otherwise
+     *
+     * @since 1.0
+     */
+    virtual bool write(u64 const offset, std::vector<io_vector> const & vectors);
+
+    /**
+     * @brief Make all completed writes durable
+     *
+     * Devices that can not be written have nothing to synchronize and always succeed.
+     *
+     * @return @p true, iff. all writes reached stable storage, @p false otherwise
+     *
+     * @since 1.0
+     */
+    virtual bool sync();
+
+    /**
+     * @brief Submit a batch of read requests for asynchronous execution
+     *
+     * The completion of every request is invoked exactly once, possibly on a different thread and possibly before this
+     * function returns. Devices without an asynchronous I/O engine execute the requests synchronously.
+     *
+     * @since 1.0
+     */
+    virtual void submit(std::vector<io_request> requests) const;
+
+    /**
+     * @brief Execute a batch of read requests and wait for all of them to complete
+     *
+     * The completion of every request is invoked before this function returns, so requests may still report their
+     * individual results.
+     *
+     * @return @p true, iff. all requests could be executed successfully, @p false otherwise
+     *
+     * @since 1.0
+     */
+    bool read_batch(std::vector<io_request> requests) const;
+    };
+
+  /**
+   * @brief A block device that maps the whole backing file into memory
+   *
+   * The mapped block device is the fastest way to access regular file system images. Reading from it does not involve any
+   * system calls and acquiring bytes via #fetch() does not copy any data at all.
+   *
+   * @note The mapping is always read-only.
+   * @since 1.0
+   */
+  struct mapped_block_device final : block_device
+    {
+    /**
+     * @brief Map the file at the given path
+     *
+     * @note Use #mapped() to check if the file could be mapped.
+     * @since 1.0
+     */
+    explicit mapped_block_device(std::string const & path);
+
+    /**
+     * @brief Check if the file was mapped successfully
+     *
+     * @since 1.0
+     */
+    bool mapped() const override;
+
+    u64 size() const override;
+    bool writeable() const override;
+    bool read(u64 const offset, void * const buffer, std::size_t const length) const override;
+    bool read(u64 const offset, std::vector<io_vector> const & vectors) const override;
+    bytes fetch(u64 const offset, std::size_t const length) const override;
+    void prefetch(u64 const offset, u64 const length) const override;
+
+    private:
+      std::shared_ptr<u08 const> m_mapping{};
+      u64 m_size{};
+    };
+
+  /**
+   * @brief A block device that uses position independent reads and writes
+   *
+   * This device works on every file and device the operating system can open, including block devices that can not be
+   * memory mapped. It is also the device used for file systems that are opened in writeable mode.
+   *
+   * @since 1.0
+   */
+  struct positional_block_device final : block_device
+    {
+    /**
+     * @brief Open the file at the given path
+     *
+     * @param path The path to the device or file
+     * @param writeable Whether the device shall be opened for reading and writing
+     * @param queueDepth The maximum number of asynchronous requests in flight
+     *
+     * @note Use #opened() to check if the file could be opened.
+     * @since 1.0
+     */
+    positional_block_device(std::string const & path, bool const writeable, std::size_t const queueDepth = 64);
+
+    ~positional_block_device() override;
+
+    positional_block_device(positional_block_device const &) = delete;
+    positional_block_device & operator=(positional_block_device const &) = delete;
+
+    /**
+     * @brief Check if the file was opened successfully
+     *
+     * @since 1.0
+     */
+    bool opened() const;
+
+    u64 size() const override;
+    bool writeable() const override;
+    bool mapped() const override;
+    bool read(u64 const offset, void * const buffer, std::size_t const length) const override;
+    bool read(u64 const offset, std::vector<io_vector> const & vectors) const override;
+    bytes fetch(u64 const offset, std::size_t const length) const override;
+    void prefetch(u64 const offset, u64 const length) const override;
+    bool write(u64 const offset, void const * const buffer, std::size_t const length) override;
+    bool write(u64 const offset, std::vector<io_vector> const & vectors) override;
+    bool sync() override;
+
+    /**
+     * @brief Submit a batch of read requests to the I/O engine of the device
+     *
+     * The engine is started on first use. Requests that do not lie within the device are completed immediately.
+     *
+     * @since 1.0
+     */
+    void submit(std::vector<io_request> requests) const override;
+
+    private:
+      int m_descriptor{-1};
+      u64 m_size{};
+      bool m_writeable{};
+      std::size_t const m_queueDepth;
+      mutable std::once_flag m_engineStarted{};
+      mutable std::unique_ptr<io_engine> m_engine{};
+    };
+
+  /**
+   * @brief Open the most efficient block device available for the given path
+   *
+   * Read-only devices are memory mapped whenever possible. If the file can not be mapped, if mapping is not allowed, or if
+   * write access is requested, a #positional_block_device is used instead.
+   *
+   * @param path The path to the device or file
+   * @param writeable Whether the device shall be opened for reading and writing
+   * @param allowMapping Whether the device may be memory mapped
+   * @param queueDepth The maximum number of asynchronous requests in flight on a #positional_block_device
+   * @return The opened block device or @p nullptr if the path could not be opened at all
+   *
+   * @since 1.0
+   */
+  std::unique_ptr<block_device> open_block_device(std::string const & path, bool const writeable,
+                                                  bool const allowMapping = true, std::size_t const queueDepth = 64);
+
+  }
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef EXTFS_BLOCK_EXTENT_HPP
+#define EXTFS_BLOCK_EXTENT_HPP
+
+#include "fs/detail/types.hpp"
+
+namespace fs::detail
+  {
+
+  /**
+   * @brief A run of physically consecutive blocks
+   *
+   * @since 1.0
+   */
+  struct block_extent
+    {
+    u64 first_block_id{}; ///< The ID of the first block of the extent
+    u64 blocks_count{}; ///< The number of blocks in the extent
+
+    /**
+     * @brief Get the ID of the block following the last block of the extent
+     *
+     * @since 1.0
+     */
+    u64 end_block_id() const
+      {
+      return first_block_id + blocks_count;
+      }
+    };
+
+  }
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef EXTFS_BLOCK_MAP_HPP
+#define EXTFS_BLOCK_MAP_HPP
+
+#include "fs/detail/block_run.hpp"
+#include "fs/detail/types.hpp"
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace fs::detail
+  {
+
+  /**
+   * @brief The resolved block mapping of a single inode
+   *
+   * A block map translates logical blocks of an inode into physical blocks. Every range that was resolved once is
+   * remembered, so that repeated and sequential resolutions of the same range do not need to read any mapping metadata
+   * from the device again. Derived classes implement #load() to read the mapping metadata for ranges that have not been
+   * resolved yet.
+   *
+   * @par Thread safety
+   * All public member functions can safely be called concurrently.
+   *
+   * @since 1.0
+   */
+  struct block_map
+    {
+    virtual ~block_map() = default;
+
+    /**
+     * @brief Map a range of logical blocks to physical blocks
+     *
+     * @param firstBlock The first logical block to map
+     * @param blocksCount The number of blocks to map
+     * @return The runs covering the requested range in ascending logical order, with holes reported as sparse runs.
+     * Physically consecutive blocks are merged into a single run. If the mapping metadata is corrupted or could not be read,
+     * an empty optional is returned.
+     *
+     * @since 1.0
+     */
+    std::optional<std::vector<block_run>> resolve(u64 const firstBlock, u64 const blocksCount);
+
+    /**
+     * @brief Get the approximate number of bytes used by the block map
+     *
+     * @since 1.0
+     */
+    std::size_t footprint() const;
+
+    /**
+     * @brief Get the number of metadata blocks that were read from the device so far
+     *
+     * @since 1.0
+     */
+    std::size_t loaded_blocks_count() const;
+
+    protected:
+      /**
+       * @brief Read the mapping metadata for a range that has not been resolved yet
+       *
+       * Implementations must #remember() all mapped blocks they discover and #cover() at least @p firstBlock.
+       *
+       * @param firstBlock The first logical block that needs to be resolved
+       * @param endBlock The logical block following the last block that needs to be resolved
+       * @return @p true, iff. the metadata could be read, @p false otherwise
+       *
+       * @since 1.0
+       */
+      virtual bool load(u64 const firstBlock, u64 const endBlock) = 0;
+
+      /**
+       * @brief Record the physical location of a range of logical blocks
+       *
+       * @since 1.0
+       */
+      void remember(u64 const logicalBlock, u64 const physicalBlock, u64 const blocksCount, bool const uninitialized);
+
+      /**
+       * @brief Record that all mapped blocks in the given logical range are known
+       *
+       * Overlapping and adjacent ranges are merged.
+       *
+       * @since 1.0
+       */
+      void cover(u64 const firstBlock, u64 const endBlock);
+
+      /**
+       * @brief Account for metadata blocks read from the device
+       *
+       * @since 1.0
+       */
+      void count_loaded_blocks(std::size_t const count);
+
+      /**
+       * @brief Get the approximate number of bytes used by the mapping metadata kept by a derived class
+       *
+       * This function is called with the block map locked, just like #load().
+       *
+       * @since 1.0
+       */
+      virtual std::size_t metadata_footprint() const;
+
+    private:
+      struct mapping
+        {
+        u64 physicalBlockId;
+        u64 blocksCount;
+        bool uninitialized;
+        };
+
+      std::map<u64, u64>::const_iterator covering(u64 const logicalBlock) const;
+
+      mutable std::mutex m_mutex{};
+      std::map<u64, mapping> m_mappings{};
+      std::map<u64, u64> m_coverage{};
+      std::size_t m_loadedBlocksCount{};
+    };
+
+  }
+
+#endif
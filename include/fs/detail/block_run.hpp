@@ -0,0 +1,39 @@
+#ifndef EXTFS_BLOCK_RUN_HPP
+#define EXTFS_BLOCK_RUN_HPP
+
+#include "fs/detail/types.hpp"
+
+namespace fs::detail
+  {
+
+  /**
+   * @brief A run of logically consecutive blocks of an inode
+   *
+   * A run either maps a range of logical blocks onto a range of physically consecutive blocks, or describes a hole in the
+   * content of the inode.
+   *
+   * @since 1.0
+   */
+  struct block_run
+    {
+    u64 logical_block_id{}; ///< The first logical block of the run
+    u64 physical_block_id{}; ///< The first physical block of the run, or 0 if the run is a hole
+    u64 blocks_count{}; ///< The number of blocks in the run
+    bool uninitialized{}; ///< Whether the blocks are allocated but not yet initialized
+
+    /**
+     * @brief Check if the content of the run reads as zeroes without accessing the device
+     *
+     * This is the case for holes, as well as for allocated, but uninitialized blocks.
+     *
+     * @since 1.0
+     */
+    bool sparse() const
+      {
+      return !physical_block_id || uninitialized;
+      }
+    };
+
+  }
+
+#endif
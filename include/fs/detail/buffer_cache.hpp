@@ -0,0 +1,254 @@
+#ifndef EXTFS_BUFFER_CACHE_HPP
+#define EXTFS_BUFFER_CACHE_HPP
+
+#include "fs/detail/block_arena.hpp"
+#include "fs/detail/block_device.hpp"
+#include "fs/detail/cache_statistics.hpp"
+#include "fs/detail/types.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace fs::detail
+  {
+
+  /**
+   * @brief The kinds of blocks written through a #buffer_cache
+   *
+   * @since 1.0
+   */
+  enum struct block_kind : char
+    {
+    metadata, ///< A block holding file system metadata
+    data, ///< A block holding the content of a file
+    };
+
+  /**
+   * @brief The write statistics of a #buffer_cache
+   *
+   * @since 1.0
+   */
+  struct write_statistics
+    {
+    u64 dirty_blocks_count; ///< The number of blocks that were written to the cache but not yet to the device
+    u64 flushes_count; ///< The number of times the dirty blocks were flushed to the device
+    u64 writes_count; ///< The number of write requests issued to the device
+    u64 written_blocks_count; ///< The number of blocks written to the device
+    };
+
+  /**
+   * @brief The maximum number of blocks read by a single read of buffer_cache::preload()
+   *
+   * @since 1.0
+   */
+  auto constexpr kMaximumPreloadBlocks = u64{1024};
+
+  /**
+   * @brief A block device that keeps recently used blocks of another device in memory
+   *
+   * The buffer cache serves all reads and fetches that fall into a single block from memory. Blocks are stored in a
+   * #block_arena, and #fetch() hands out reference counted handles directly into the cached blocks. A block is pinned for
+   * as long as a handle to it exists, and pinned blocks are never evicted. Accesses spanning multiple blocks, as well as
+   * vectored reads, bypass the cache.
+   *
+   * Eviction follows the 2Q algorithm: blocks enter the cache in a small FIFO queue and are only promoted to the main LRU
+   * queue if they are accessed again after having been evicted from the FIFO queue. A single scan over many blocks thus
+   * only cycles through the FIFO queue and does not displace frequently used metadata.
+   *
+   * If the underlying device is writeable, the cache is a write-back cache. Writes only modify the cached blocks, which are
+   * marked dirty and are never evicted. Dirty blocks are written to the device by #flush(), by #sync(), once they make up
+   * the whole capacity of the cache, and when the cache is destroyed. A flush sorts the dirty blocks and writes each run of
+   * adjacent blocks with a single vectored write, writing all metadata blocks before any data blocks. Reads, including
+   * reads that bypass the cache, always observe the dirty blocks.
+   *
+   * @par Thread safety
+   * All @p const member functions can safely be called concurrently. Writing, flushing and synchronizing require exclusive
+   * access to the cache.
+   *
+   * @since 1.0
+   */
+  struct buffer_cache final : block_device
+    {
+    /**
+     * @brief Create a buffer cache in front of the given device
+     *
+     * @param device The device to cache
+     * @param blockSize The size of a block in bytes
+     * @param capacity The maximum number of bytes of unpinned blocks the cache may hold
+     * @param shards The number of shards to distribute the blocks across. This is rounded up to the next power of 2.
+     *
+     * @since 1.0
+     */
+    buffer_cache(std::unique_ptr<block_device> device, u32 const blockSize, std::size_t const capacity,
+                 std::size_t const shards = 16);
+
+    /**
+     * @brief Flush all dirty blocks and destroy the cache
+     *
+     * @since 1.0
+     */
+    ~buffer_cache() override;
+
+    buffer_cache(buffer_cache const &) = delete;
+    buffer_cache & operator=(buffer_cache const &) = delete;
+
+    /**
+     * @brief Get a pinned handle to a block
+     *
+     * @param blockId The ID of the block
+     * @return The content of the block or @p nullptr if the block could not be read
+     *
+     * @since 1.0
+     */
+    bytes block(u64 const blockId) const;
+
+    /**
+     * @brief Load a range of blocks into the cache with as few reads as possible
+     *
+     * The range is read with a single vectored read per #kMaximumPreloadBlocks blocks, skipping chunks that are entirely
+     * cached already. Blocks that are not cached yet enter the FIFO queue, just like blocks loaded on demand. Since a range
+     * larger than the FIFO queue would only evict itself, the range is truncated to the capacity of the queue.
+     *
+     * @param firstBlockId The ID of the first block to load
+     * @param blocksCount The number of blocks to load
+     * @return The number of blocks that were added to the cache
+     *
+     * @since 1.0
+     */
+    u64 preload(u64 const firstBlockId, u64 const blocksCount) const;
+
+    /**
+     * @brief Get a snapshot of the statistics of the cache
+     *
+     * @since 1.0
+     */
+    cache_statistics statistics() const;
+
+    /**
+     * @brief Get a snapshot of the write statistics of the cache
+     *
+     * @since 1.0
+     */
+    write_statistics flush_statistics() const;
+
+    /**
+     * @brief Write a range of bytes to the cached blocks
+     *
+     * Blocks that are only partially overwritten are read from the device first, unless they are already cached. A block
+     * written as metadata once is flushed as metadata until it is written to the device.
+     *
+     * @param offset The absolute byte offset of the first byte to write
+     * @param buffer The buffer to copy the bytes from. It must be at least @p length bytes large.
+     * @param length The number of bytes to write
+     * @param kind The kind of the written blocks
+     * @return @p true, iff. the device is writeable and all bytes could be written, @p false otherwise
+     *
+     * @since 1.0
+     */
+    bool write(u64 const offset, void const * const buffer, std::size_t const length, block_kind const kind);
+
+    /**
+     * @brief Write all dirty blocks to the device
+     *
+     * @return @p true, iff. all dirty blocks could be written, @p false otherwise
+     *
+     * @since 1.0
+     */
+    bool flush();
+
+    u64 size() const override;
+    bool writeable() const override;
+    bool mapped() const override;
+    bool read(u64 const offset, void * const buffer, std::size_t const length) const override;
+    bool read(u64 const offset, std::vector<io_vector> const & vectors) const override;
+    bytes fetch(u64 const offset, std::size_t const length) const override;
+    void prefetch(u64 const offset, u64 const length) const override;
+
+    /**
+     * @brief Write a range of bytes as data blocks
+     *
+     * @since 1.0
+     */
+    bool write(u64 const offset, void const * const buffer, std::size_t const length) override;
+
+    /**
+     * @brief Write multiple buffers as data blocks
+     *
+     * @since 1.0
+     */
+    bool write(u64 const offset, std::vector<io_vector> const & vectors) override;
+
+    /**
+     * @brief Flush all dirty blocks and make them durable
+     *
+     * The metadata blocks are written and synchronized before the data blocks are written.
+     *
+     * @since 1.0
+     */
+    bool sync() override;
+
+    /**
+     * @brief Submit a batch of read requests to the underlying device
+     *
+     * Asynchronous reads bypass the cache, but observe dirty blocks.
+     *
+     * @since 1.0
+     */
+    void submit(std::vector<io_request> requests) const override;
+
+    private:
+      struct entry
+        {
+        u64 blockId;
+        bytes data;
+        bool frequent;
+        bool dirty{};
+        block_kind kind{block_kind::data};
+        };
+
+      struct shard
+        {
+        std::mutex mutex{};
+        std::list<entry> recent{};
+        std::list<entry> frequent{};
+        std::unordered_map<u64, std::list<entry>::iterator> index{};
+        std::list<u64> ghosts{};
+        std::unordered_map<u64, std::list<u64>::iterator> ghostIndex{};
+        std::unordered_set<u64> dirty{};
+        std::size_t capacity{};
+        u64 hits{};
+        u64 misses{};
+        u64 evictions{};
+        };
+
+      shard & shard_for(u64 const blockId) const;
+      bytes allocate() const;
+      bytes load(u64 const blockId) const;
+      void evict(shard & target) const;
+      bool within_block(u64 const offset, std::size_t const length) const;
+      u08 * dirty_block(u64 const blockId, block_kind const kind, bool const overwritten);
+      bool flush(block_kind const kind);
+      bytes dirty_content(u64 const blockId) const;
+      void overlay(u64 const offset, std::vector<io_vector> const & vectors) const;
+
+      std::unique_ptr<block_device> m_device;
+      u32 const m_blockSize;
+      std::size_t const m_capacity;
+      std::shared_ptr<block_arena> m_arena;
+      unsigned const m_shardBits;
+      std::unique_ptr<shard[]> m_shards;
+      std::atomic<std::size_t> m_dirtyCount{};
+      u64 m_flushesCount{};
+      u64 m_writesCount{};
+      u64 m_writtenBlocksCount{};
+    };
+
+  }
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef EXTFS_BULK_READ_HPP
+#define EXTFS_BULK_READ_HPP
+
+#include "fs/detail/block_device.hpp"
+#include "fs/detail/block_run.hpp"
+#include "fs/detail/types.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace fs::detail
+  {
+
+  /**
+   * @brief A piece of the content of a file delivered by a bulk read
+   *
+   * @since 1.0
+   */
+  struct content_piece
+    {
+    u32 inode_id; ///< The ID of the inode the piece belongs to
+    u64 offset; ///< The byte offset of the piece within the content of the inode
+    u08 const * data; ///< The bytes of the piece. They are only valid for the duration of the call to the sink.
+    std::size_t length; ///< The number of bytes in the piece
+    };
+
+  /**
+   * @brief The function receiving the pieces of a bulk read
+   *
+   * The sink returns whether to continue with the next piece.
+   *
+   * @since 1.0
+   */
+  using content_sink = std::function<bool(content_piece const & piece)>;
+
+  /**
+   * @brief The function called once all pieces of a file were delivered, or once the file failed to be read
+   *
+   * @since 1.0
+   */
+  using completion_sink = std::function<void(u32 const inodeId, bool const success)>;
+
+  /**
+   * @brief A file to read in a bulk read
+   *
+   * @since 1.0
+   */
+  struct bulk_file
+    {
+    u32 inode_id; ///< The ID of the inode
+    u64 size; ///< The size of the content of the inode in bytes
+    std::vector<block_run> runs; ///< The runs mapping the complete content of the inode
+    };
+
+  /**
+   * @brief The statistics of a bulk read
+   *
+   * @since 1.0
+   */
+  struct bulk_read_statistics
+    {
+    u64 files_count; ///< The number of files that were read completely
+    u64 failures_count; ///< The number of files that could not be read
+    u64 bytes_count; ///< The number of bytes delivered to the sink
+    u64 requests_count; ///< The number of read requests issued to the device
+    bool stopped; ///< Whether the read was stopped by the sink
+    };
+
+  /**
+   * @brief The maximum size of a single request of a bulk read in bytes
+   *
+   * @since 1.0
+   */
+  auto constexpr kMaximumBulkRequestSize = std::size_t{1} << 20;
+
+  /**
+   * @brief The maximum distance between two ranges of a bulk read that are read with a single request, in bytes
+   *
+   * Reading a few unneeded bytes is cheaper than seeking over them.
+   *
+   * @since 1.0
+   */
+  auto constexpr kMaximumBulkGapSize = u64{64} << 10;
+
+  /**
+   * @brief The number of bytes a bulk read keeps in flight
+   *
+   * @since 1.0
+   */
+  auto constexpr kBulkWindowSize = std::size_t{8} << 20;
+
+  /**
+   * @brief Read the content of many files in the order it is stored on the device
+   *
+   * The mapped ranges of all files are sorted by their physical position and merged into requests of at most
+   * #kMaximumBulkRequestSize bytes, bridging gaps of up to #kMaximumBulkGapSize bytes. The requests are executed in windows
+   * of #kBulkWindowSize bytes, hinting the device about the next window while the current one is delivered. The device
+   * is thus read front to back, regardless of the number of files and the order they were given in.
+   *
+   * Pieces are delivered in physical order, so the pieces of a single file generally arrive out of order. Holes and
+   * uninitialized blocks are not delivered; their content reads as zeroes. Files without any mapped content are completed
+   * before the first piece is delivered.
+   *
+   * @param device The device to read from
+   * @param blockSize The size of a block in bytes
+   * @param files The files to read
+   * @param sink The function receiving the pieces
+   * @param completion The function to call once a file was read completely or failed to be read. May be empty.
+   * @return The statistics of the read
+   *
+   * @since 1.0
+   */
+  bulk_read_statistics read_bulk(block_device const & device, u32 const blockSize, std::vector<bulk_file> const & files,
+                                 content_sink const & sink, completion_sink const & completion);
+
+  }
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef EXTFS_CACHE_STATISTICS_HPP
+#define EXTFS_CACHE_STATISTICS_HPP
+
+#include "fs/detail/types.hpp"
+
+#include <cstddef>
+
+namespace fs::detail
+  {
+
+  /**
+   * @brief A snapshot of the state of a cache
+   *
+   * @since 1.0
+   */
+  struct cache_statistics
+    {
+    u64 hits{}; ///< The number of lookups that were served from the cache
+    u64 misses{}; ///< The number of lookups that were not served from the cache
+    u64 evictions{}; ///< The number of entries that were evicted to stay within the capacity of the cache
+    std::size_t entries{}; ///< The number of entries currently held by the cache
+    std::size_t size{}; ///< The number of bytes currently held by the cache
+    std::size_t capacity{}; ///< The maximum number of bytes the cache may hold
+
+    /**
+     * @brief Get the ratio of lookups that were served from the cache
+     *
+     * @return A value between 0 and 1, or 0 if there were no lookups yet
+     *
+     * @since 1.0
+     */
+    double hit_rate() const
+      {
+      auto const lookups = hits + misses;
+      return lookups ? static_cast<double>(hits) / lookups : 0.0;
+      }
+    };
+
+  }
+
+#endif
@@ -0,0 +1,196 @@
+#ifndef EXTFS_CHECKSUM_HPP
+#define EXTFS_CHECKSUM_HPP
+
+#include "fs/detail/superblock.hpp"
+#include "fs/detail/types.hpp"
+
+#include <atomic>
+#include <cstddef>
+
+namespace fs::detail
+  {
+
+  /**
+   * @brief The available implementations of #crc32c()
+   *
+   * @since 1.0
+   */
+  enum struct crc32c_kernel
+    {
+    table, ///< Portable slicing-by-8 table lookups
+    sse42, ///< The SSE 4.2 CRC32 instruction
+    };
+
+  /**
+   * @brief Check if the current processor supports the given kernel
+   *
+   * @since 1.0
+   */
+  bool supported(crc32c_kernel const kernel);
+
+  /**
+   * @brief Get the fastest kernel supported by the current processor
+   *
+   * @since 1.0
+   */
+  crc32c_kernel best_crc32c_kernel();
+
+  /**
+   * @brief Continue a CRC32C (Castagnoli) checksum over the given bytes using the fastest supported kernel
+   *
+   * Like the Linux kernel's @p crc32c(), this function neither inverts the initial nor the final value. ext4 checksums are
+   * computed this way.
+   *
+   * @param crc The checksum of the preceding bytes, or the initial value
+   * @param data The bytes to checksum
+   * @param length The number of bytes to checksum
+   *
+   * @since 1.0
+   */
+  u32 crc32c(u32 const crc, void const * const data, std::size_t const length);
+
+  /**
+   * @brief Continue a CRC32C checksum over the given bytes using the given kernel
+   *
+   * @note The kernel must be #supported() by the current processor.
+   * @since 1.0
+   */
+  u32 crc32c(u32 const crc, void const * const data, std::size_t const length, crc32c_kernel const kernel);
+
+  /**
+   * @brief Check the checksum of a superblock
+   *
+   * @return @p true, iff. the superblock does not use metadata checksums or its checksum is valid, @p false otherwise
+   *
+   * @since 1.0
+   */
+  bool verify_superblock(superblock const & block);
+
+  /**
+   * @brief The verifier for the metadata checksums of a file system
+   *
+   * Every checksum of an ext4 file system with metadata checksums is seeded with a value derived from the file system's
+   * UUID, or stored in the superblock. The seed is computed once, when the verifier is created.
+   *
+   * @par Thread safety
+   * All member functions can safely be called concurrently.
+   *
+   * @since 1.0
+   */
+  struct metadata_checksums
+    {
+    /**
+     * @brief Create the verifier for the file system described by the given superblock
+     *
+     * @since 1.0
+     */
+    explicit metadata_checksums(superblock const & block);
+
+    /**
+     * @brief Get the checksum seed of the file system
+     *
+     * @since 1.0
+     */
+    u32 seed() const;
+
+    /**
+     * @brief Get the checksum seed of the blocks owned by the given inode
+     *
+     * Extent tree blocks and directory blocks are checksummed with this seed.
+     *
+     * @since 1.0
+     */
+    u32 inode_seed(u32 const inodeId, u32 const generation) const;
+
+    /**
+     * @brief Check the checksum of a raw on-disk group descriptor
+     *
+     * @param group The ID of the group the descriptor describes
+     * @param descriptor The raw descriptor
+     * @param size The size of the descriptor in bytes
+     *
+     * @since 1.0
+     */
+    bool verify_group_descriptor(u32 const group, u08 const * const descriptor, u32 const size) const;
+
+    /**
+     * @brief Check the checksum of a block or inode bitmap
+     *
+     * @param bitmap The bitmap
+     * @param length The number of bytes covered by the checksum
+     * @param expected The checksum recorded in the group descriptor
+     * @param wide Whether the group descriptor records all 32 bits of the checksum, or only the lower 16 bits
+     *
+     * @since 1.0
+     */
+    bool verify_bitmap(u08 const * const bitmap, std::size_t const length, u32 const expected, bool const wide) const;
+
+    /**
+     * @brief Check the checksum of a raw on-disk inode
+     *
+     * Inodes consisting of nothing but zeros have never been written, and are considered valid.
+     *
+     * @param inodeId The ID of the inode
+     * @param inode The raw inode
+     * @param size The size of the on-disk inode in bytes
+     *
+     * @since 1.0
+     */
+    bool verify_inode(u32 const inodeId, u08 const * const inode, u32 const size) const;
+
+    /**
+     * @brief Check the checksum stored in the tail of an extent tree block
+     *
+     * @param inodeSeed The checksum seed of the inode owning the block
+     * @param block The extent tree block
+     * @param blockSize The size of the block in bytes
+     *
+     * @since 1.0
+     */
+    bool verify_extent_block(u32 const inodeSeed, u08 const * const block, std::size_t const blockSize) const;
+
+    /**
+     * @brief Check the checksum of a directory block
+     *
+     * Directory leaf blocks end with a fake directory entry containing the checksum. Hash tree index blocks store the
+     * checksum after the last index entry instead.
+     *
+     * @param inodeSeed The checksum seed of the directory
+     * @param block The directory block
+     * @param blockSize The size of the block in bytes
+     *
+     * @since 1.0
+     */
+    bool verify_directory_block(u32 const inodeSeed, u08 const * const block, std::size_t const blockSize) const;
+
+    /**
+     * @brief Check the checksum of an extended attribute block
+     *
+     * Extended attribute blocks may be shared between inodes, and are therefore seeded with their block ID instead of the
+     * seed of an inode.
+     *
+     * @param blockId The ID of the block
+     * @param block The extended attribute block
+     * @param blockSize The size of the block in bytes
+     *
+     * @since 1.0
+     */
+    bool verify_attribute_block(u64 const blockId, u08 const * const block, std::size_t const blockSize) const;
+
+    /**
+     * @brief Get the number of failed verifications so far
+     *
+     * @since 1.0
+     */
+    u64 failures_count() const;
+
+    private:
+      bool count(bool const valid) const;
+
+      u32 m_seed{};
+      mutable std::atomic<u64> m_failuresCount{};
+    };
+
+  }
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef EXTFS_DENTRY_HPP
+#define EXTFS_DENTRY_HPP
+
+#include "fs/detail/types.hpp"
+
+#include <cstddef>
+#include <string>
+
+namespace fs::detail
+  {
+
+  /**
+   * @brief The key of a cached directory entry
+   *
+   * @since 1.0
+   */
+  struct dentry_key
+    {
+    u32 parent_id{}; ///< The ID of the directory containing the entry
+    std::string name{}; ///< The name of the entry
+
+    /**
+     * @brief Get the approximate number of bytes a cache entry with this key occupies
+     *
+     * @since 1.0
+     */
+    std::size_t footprint() const;
+
+    /**
+     * @brief Check if two keys refer to the same entry
+     *
+     * @since 1.0
+     */
+    bool operator==(dentry_key const & other) const;
+    };
+
+  /**
+   * @brief The hash function for #dentry_key
+   *
+   * @since 1.0
+   */
+  struct dentry_key_hash
+    {
+    std::size_t operator()(dentry_key const & key) const;
+    };
+
+  }
+
+#endif
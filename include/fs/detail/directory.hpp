@@ -0,0 +1,158 @@
+#ifndef EXTFS_DIRECTORY_HPP
+#define EXTFS_DIRECTORY_HPP
+
+#include "fs/detail/inode.hpp"
+#include "fs/detail/types.hpp"
+#include "fs/detail/view.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace fs::detail
+  {
+
+  /**
+   * This structure describes the header of an entry of a directory
+   *
+   * The header is immediately followed by the name of the entry. Entries are aligned to 4 bytes, and the last entry of every
+   * block extends to the end of the block.
+   *
+   * @since 1.0
+   */
+  struct directory_entry
+    {
+    /**
+     * @brief The types of files a directory entry can refer to
+     *
+     * @since 1.0
+     */
+    enum struct file_type : u08
+      {
+      unknown = 0, ///< The type of the file is not recorded in the entry
+      regular_file = 1, ///< A regular file
+      directory = 2, ///< A directory
+      character_device = 3, ///< A character device
+      block_device = 4, ///< A block device
+      fifo = 5, ///< A named pipe
+      socket = 6, ///< A unix domain socket
+      symbolic_link = 7, ///< A symbolic link
+      };
+
+    /**
+     * @brief The underlying type of #file_type
+     *
+     * @since 1.0
+     */
+    using fty = std::underlying_type_t<file_type>;
+
+    u32 inode_id{}; ///< The ID of the inode the entry refers to, or 0 if the entry is unused
+    u16 record_length{}; ///< The distance to the next entry in bytes
+    u08 name_length{}; ///< The length of the name of the entry
+    fty type{}; ///< The type of the file the entry refers to
+    };
+
+  static_assert(sizeof(directory_entry) == 8, "An ext2/3/4 directory entry header must have an exact size of 8 bytes!");
+
+  /**
+   * @brief Get the directory entry file type corresponding to the file type of an inode
+   *
+   * @since 1.0
+   */
+  directory_entry::file_type entry_type_of(inode::file_type const type);
+
+  /**
+   * @brief An entry of a directory together with the inode it refers to
+   *
+   * @since 1.0
+   */
+  struct listed_entry
+    {
+    u32 inode_id; ///< The ID of the inode the entry refers to
+    std::string name; ///< The name of the entry
+    directory_entry::file_type type; ///< The type of the file the entry refers to
+    view<inode> attributes; ///< The inode the entry refers to
+    };
+
+  /**
+   * @brief The function called for every batch of entries of a directory listed with their attributes
+   *
+   * The visitor receives the entries of a batch in the order of their inodes in the inode tables, and returns whether to
+   * continue with the next batch.
+   *
+   * @since 1.0
+   */
+  using listing_visitor = std::function<bool(std::vector<listed_entry> const & batch)>;
+
+  /**
+   * @brief The function called for every entry of a directory
+   *
+   * The visitor receives the ID of the inode an entry refers to, its name and the type recorded in the entry, and returns
+   * whether to continue with the next entry.
+   *
+   * @since 1.0
+   */
+  using entry_visitor = std::function<bool(u32 const inodeId, std::string_view const name,
+                                           directory_entry::file_type const type)>;
+
+  /**
+   * @brief Visit all used entries of a single directory block
+   *
+   * Unused entries, including the checksum tail of directory blocks and the fake entries of hash tree index blocks, are
+   * skipped.
+   *
+   * @param block The block to visit
+   * @param blockSize The size of the block in bytes
+   * @param visitor The callable to invoke for every entry. It receives the same arguments as an #entry_visitor and returns
+   * whether to continue with the next entry.
+   * @return @p true, iff. the block is well-formed or the visitor stopped early, @p false if the block is corrupted
+   *
+   * @since 1.0
+   */
+  template<typename Visitor>
+  bool visit_entries(u08 const * const block, std::size_t const blockSize, Visitor && visitor)
+    {
+    auto offset = std::size_t{};
+    while(offset + sizeof(directory_entry) <= blockSize)
+      {
+      auto entry = directory_entry{};
+      std::memcpy(&entry, block + offset, sizeof(entry));
+      if(entry.record_length < sizeof(entry) || entry.record_length % 4 || offset + entry.record_length > blockSize ||
+         sizeof(entry) + entry.name_length > entry.record_length)
+        {
+        return false;
+        }
+
+      auto const name = std::string_view{reinterpret_cast<char const *>(block + offset + sizeof(entry)), entry.name_length};
+      if(entry.inode_id && !visitor(entry.inode_id, name, static_cast<directory_entry::file_type>(entry.type)))
+        {
+        return true;
+        }
+
+      offset += entry.record_length;
+      }
+
+    return offset == blockSize;
+    }
+
+  /**
+   * @brief Find an entry by name in a single block of a linear directory
+   *
+   * @param block The block to search
+   * @param blockSize The size of the block in bytes
+   * @param name The name of the entry
+   * @return The ID of the inode the entry refers to, 0 if the block contains no entry of the given name, or an empty
+   * optional if the block is corrupted
+   *
+   * @since 1.0
+   */
+  std::optional<u32> find_entry(u08 const * const block, std::size_t const blockSize, std::string_view const name);
+
+  }
+
+#endif
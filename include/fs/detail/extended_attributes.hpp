@@ -0,0 +1,206 @@
+#ifndef EXTFS_EXTENDED_ATTRIBUTES_HPP
+#define EXTFS_EXTENDED_ATTRIBUTES_HPP
+
+#include "fs/detail/types.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace fs::detail
+  {
+
+  /**
+   * @brief The magic number at the start of the extended attribute area of an inode and of extended attribute blocks
+   *
+   * @since 1.0
+   */
+  auto constexpr kExtendedAttributeMagic = u32{0xea020000};
+
+  /**
+   * @brief The namespaces of extended attributes, as encoded in the name index of an entry
+   *
+   * @since 1.0
+   */
+  enum struct attribute_namespace : u08
+    {
+    user = 1, ///< The @p user. namespace
+    posix_acl_access = 2, ///< The @p system.posix_acl_access attribute
+    posix_acl_default = 3, ///< The @p system.posix_acl_default attribute
+    trusted = 4, ///< The @p trusted. namespace
+    security = 6, ///< The @p security. namespace
+    system = 7, ///< The @p system. namespace
+    system_richacl = 8, ///< The @p system.richacl attribute
+    };
+
+  /**
+   * This structure describes the header of an extended attribute entry
+   *
+   * The header is immediately followed by the name of the attribute, without the prefix of its namespace. Entries are
+   * aligned to 4 bytes, and the list of entries is terminated by 4 zero bytes.
+   *
+   * @since 1.0
+   */
+  struct extended_attribute_entry
+    {
+    u08 name_length{}; ///< The length of the name of the attribute
+    u08 name_index{}; ///< The #attribute_namespace of the attribute
+    u16 value_offset{}; ///< The offset of the value, relative to the first entry for in-inode attributes or to the start of the block
+    u32 value_inode_id{}; ///< The ID of the inode storing the value, or 0 if the value is stored next to the entries
+    u32 value_size{}; ///< The size of the value in bytes
+    u32 hash{}; ///< The hash of the attribute
+    };
+
+  static_assert(sizeof(extended_attribute_entry) == 16, "An ext4 extended attribute entry header must have an exact size of 16 bytes!");
+
+  /**
+   * This structure describes the header of a block storing extended attributes
+   *
+   * Entries start immediately after the header. A single block may be shared by any number of inodes with identical
+   * attributes, as counted in #references_count.
+   *
+   * @since 1.0
+   */
+  struct extended_attribute_block_header
+    {
+    u32 magic{}; ///< The magic number, which must be #kExtendedAttributeMagic
+    u32 references_count{}; ///< The number of inodes referring to the block
+    u32 blocks_count{}; ///< The number of blocks used to store the attributes, which is always 1
+    u32 hash{}; ///< The hash of all attributes in the block
+    u32 checksum{}; ///< The checksum of the block
+    u32_arr<3> _reserved{}; ///< Reserved
+    };
+
+  static_assert(sizeof(extended_attribute_block_header) == 32, "An ext4 extended attribute block header must have an exact size of 32 bytes!");
+
+  /**
+   * @brief The function called for every extended attribute of an inode
+   *
+   * The visitor receives the full name of an attribute, including the prefix of its namespace, a pointer to its value and
+   * the size of the value, and returns whether to continue with the next attribute. The value is only valid for the
+   * duration of the call.
+   *
+   * @since 1.0
+   */
+  using attribute_visitor = std::function<bool(std::string_view const name, u08 const * const value, std::size_t const size)>;
+
+  /**
+   * @brief A region of extended attribute entries
+   *
+   * @since 1.0
+   */
+  struct attribute_region
+    {
+    u08 const * entries{}; ///< The first entry of the region
+    std::size_t length{}; ///< The number of bytes available to the entries and their values
+    };
+
+  /**
+   * @brief Locate the extended attributes stored in the extra space of an on-disk inode
+   *
+   * @param rawInode The raw bytes of the on-disk inode
+   * @param inodeSize The size of an on-disk inode in bytes
+   * @return The region of the in-inode entries, whose values are located relative to the first entry. The region is empty
+   * if the inode has no in-inode attributes.
+   *
+   * @since 1.0
+   */
+  attribute_region in_inode_attributes(u08 const * const rawInode, u32 const inodeSize);
+
+  /**
+   * @brief Locate the extended attributes stored in an extended attribute block
+   *
+   * @param block The block
+   * @param blockSize The size of the block in bytes
+   * @return The region of the entries of the block, whose values are located relative to the start of the block. The
+   * region is empty if the block does not start with a valid #extended_attribute_block_header.
+   *
+   * @since 1.0
+   */
+  attribute_region block_attributes(u08 const * const block, std::size_t const blockSize);
+
+  /**
+   * @brief Get the full name of an extended attribute
+   *
+   * @param nameIndex The #attribute_namespace recorded in the entry of the attribute
+   * @param name The name recorded in the entry of the attribute
+   * @return The name including the prefix of its namespace, or an empty optional if the namespace is unknown
+   *
+   * @since 1.0
+   */
+  std::optional<std::string> attribute_name(u08 const nameIndex, std::string_view const name);
+
+  /**
+   * @brief Split the full name of an extended attribute into the name index and the name recorded in its entry
+   *
+   * This is the inverse of #attribute_name().
+   *
+   * @param name The full name of the attribute, e.g. @p security.selinux
+   * @return The #attribute_namespace and the name without its prefix, or an empty optional if the name does not belong
+   * to any known namespace
+   *
+   * @since 1.0
+   */
+  std::optional<std::pair<u08, std::string_view>> split_attribute_name(std::string_view const name);
+
+  /**
+   * @brief Visit all entries of a list of extended attributes
+   *
+   * @param entries The first entry of the list
+   * @param length The number of bytes available to the entries
+   * @param values The base the value offsets of the entries are relative to
+   * @param valuesLength The number of bytes available to the values
+   * @param visitor The callable to invoke for every entry. It receives the #extended_attribute_entry, the name of the
+   * attribute and a pointer to its value, which is @p nullptr if the value is stored in a separate inode, and returns
+   * whether to continue with the next entry.
+   * @return @p true, iff. the list is well-formed or the visitor stopped early, @p false if the list is corrupted
+   *
+   * @since 1.0
+   */
+  template<typename Visitor>
+  bool visit_attributes(u08 const * const entries, std::size_t const length, u08 const * const values,
+                        std::size_t const valuesLength, Visitor && visitor)
+    {
+    auto offset = std::size_t{};
+    while(offset + sizeof(u32) <= length)
+      {
+      auto marker = u32{};
+      std::memcpy(&marker, entries + offset, sizeof(marker));
+      if(!marker)
+        {
+        return true;
+        }
+
+      auto entry = extended_attribute_entry{};
+      if(offset + sizeof(entry) > length)
+        {
+        return false;
+        }
+
+      std::memcpy(&entry, entries + offset, sizeof(entry));
+      if(offset + sizeof(entry) + entry.name_length > length ||
+         (!entry.value_inode_id && std::size_t{entry.value_offset} + entry.value_size > valuesLength))
+        {
+        return false;
+        }
+
+      auto const name = std::string_view{reinterpret_cast<char const *>(entries + offset + sizeof(entry)), entry.name_length};
+      auto const value = entry.value_inode_id ? nullptr : values + entry.value_offset;
+      if(!visitor(entry, name, value))
+        {
+        return true;
+        }
+
+      offset += (sizeof(entry) + entry.name_length + 3) / 4 * 4;
+      }
+
+    return offset == length;
+    }
+
+  }
+
+#endif
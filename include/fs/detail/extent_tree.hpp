@@ -0,0 +1,125 @@
+#ifndef EXTFS_EXTENT_TREE_HPP
+#define EXTFS_EXTENT_TREE_HPP
+
+#include "fs/detail/block_device.hpp"
+#include "fs/detail/block_map.hpp"
+#include "fs/detail/checksum.hpp"
+#include "fs/detail/types.hpp"
+
+namespace fs::detail
+  {
+
+  /**
+   * This structure describes the header of every node of an extent tree
+   *
+   * @since 1.0
+   */
+  struct extent_header
+    {
+    u16 magic_number{}; ///< The magic number identifying an extent tree node
+    u16 entries_count{}; ///< The number of valid entries following the header
+    u16 maximum_entries_count{}; ///< The number of entries the node can hold
+    u16 depth{}; ///< The depth of the tree below this node. Leaf nodes have a depth of 0.
+    u32 generation{}; ///< The generation of the tree
+    };
+
+  static_assert(sizeof(extent_header) == 12, "An ext4 extent header must have an exact size of 12 bytes!");
+
+  /**
+   * This structure describes an entry of an interior node of an extent tree
+   *
+   * @since 1.0
+   */
+  struct extent_index
+    {
+    u32 logical_block_id{}; ///< The first logical block covered by the child node
+    u32 child_block_id_lo{}; ///< The lower 32 bits of the ID of the block containing the child node
+    u16 child_block_id_hi{}; ///< The upper 16 bits of the ID of the block containing the child node
+    u16 _reserved0{}; ///< Padding
+
+    /**
+     * @brief Get the ID of the block containing the child node
+     *
+     * @since 1.0
+     */
+    u64 child_block_id() const;
+    };
+
+  static_assert(sizeof(extent_index) == 12, "An ext4 extent index must have an exact size of 12 bytes!");
+
+  /**
+   * This structure describes an entry of a leaf node of an extent tree
+   *
+   * @since 1.0
+   */
+  struct extent
+    {
+    u32 logical_block_id{}; ///< The first logical block covered by the extent
+    u16 length{}; ///< The number of blocks covered by the extent. Values above 32768 denote uninitialized extents.
+    u16 physical_block_id_hi{}; ///< The upper 16 bits of the first physical block of the extent
+    u32 physical_block_id_lo{}; ///< The lower 32 bits of the first physical block of the extent
+
+    /**
+     * @brief Get the first physical block of the extent
+     *
+     * @since 1.0
+     */
+    u64 physical_block_id() const;
+
+    /**
+     * @brief Get the number of blocks covered by the extent
+     *
+     * @since 1.0
+     */
+    u32 blocks_count() const;
+
+    /**
+     * @brief Check if the extent is allocated, but not yet initialized
+     *
+     * @since 1.0
+     */
+    bool uninitialized() const;
+    };
+
+  static_assert(sizeof(extent) == 12, "An ext4 extent must have an exact size of 12 bytes!");
+
+  /**
+   * @brief The resolved extents of a single inode
+   *
+   * The extent status maps logical blocks of an inode to physical blocks by walking the inode's extent tree. Walking the
+   * tree only reads the index and leaf blocks on the path to the requested block. The extents of every leaf that was
+   * visited are remembered, together with the logical range the leaf covers.
+   *
+   * @since 1.0
+   */
+  struct extent_status final : block_map
+    {
+    /**
+     * @brief Create the extent status for the extent tree with the given root
+     *
+     * @param device The device to read the tree nodes from. It must outlive the extent status.
+     * @param blockSize The size of a block in bytes
+     * @param root The block map of the inode, which contains the root node of the extent tree
+     * @param checksums The verifier to check every node read from the device with, or @p nullptr to not verify them. It
+     * must outlive the extent status.
+     * @param inodeSeed The checksum seed of the inode owning the tree
+     *
+     * @since 1.0
+     */
+    extent_status(block_device const & device, u32 const blockSize, u32_arr<15> const & root,
+                  metadata_checksums const * const checksums = nullptr, u32 const inodeSeed = 0);
+
+    protected:
+      bool load(u64 const firstBlock, u64 const endBlock) override;
+
+    private:
+      block_device const & m_device;
+      u32 const m_blockSize;
+      u32_arr<15> const m_root;
+      metadata_checksums const * const m_checksums;
+      u32 const m_inodeSeed;
+    };
+
+  }
+
+#endif
@@ -0,0 +1,153 @@
+#ifndef EXTFS_FREE_EXTENTS_HPP
+#define EXTFS_FREE_EXTENTS_HPP
+
+#include "fs/detail/block_device.hpp"
+#include "fs/detail/geometry.hpp"
+#include "fs/detail/group_descriptor_table.hpp"
+#include "fs/detail/types.hpp"
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace fs::detail
+  {
+
+  /**
+   * @brief A histogram of the sizes of free extents
+   *
+   * A free extent is a maximal run of consecutive free blocks. Extents are sorted into buckets by the power of two of their
+   * length, so that bucket @p n holds all extents of at least @p 2^n and less than @p 2^(n+1) blocks.
+   *
+   * @since 1.0
+   */
+  struct free_extent_histogram
+    {
+    /**
+     * @brief The number of buckets of the histogram
+     *
+     * @since 1.0
+     */
+    static std::size_t constexpr kBucketsCount{64};
+
+    std::array<u64, kBucketsCount> extents_count{}; ///< The number of extents in each bucket
+    std::array<u64, kBucketsCount> blocks_count{}; ///< The number of free blocks in each bucket
+    u64 free_extents_count{}; ///< The total number of free extents
+    u64 free_blocks_count{}; ///< The total number of free blocks
+    u64 largest_extent{}; ///< The length of the largest free extent in blocks
+    u64 smallest_extent{}; ///< The length of the smallest free extent in blocks
+
+    /**
+     * @brief Get the bucket an extent of the given length belongs to
+     *
+     * @since 1.0
+     */
+    static std::size_t bucket(u64 const length);
+
+    /**
+     * @brief Record a free extent of the given length
+     *
+     * Extents of length 0 are ignored.
+     *
+     * @since 1.0
+     */
+    void add(u64 const length);
+
+    /**
+     * @brief Record all extents of another histogram
+     *
+     * @since 1.0
+     */
+    void merge(free_extent_histogram const & other);
+
+    /**
+     * @brief Get the average length of the free extents in blocks
+     *
+     * @since 1.0
+     */
+    double average_extent() const;
+    };
+
+  /**
+   * @brief The free extents of every group and of the whole file system
+   *
+   * The histogram of a group only counts the parts of free extents that lie within the group. Extents that continue across
+   * group boundaries are counted as a whole in the histogram of the file system.
+   *
+   * @since 1.0
+   */
+  struct fragmentation_report
+    {
+    std::vector<free_extent_histogram> groups{}; ///< The histogram of every group, ordered by group ID
+    free_extent_histogram total{}; ///< The histogram of the whole file system
+    };
+
+  /**
+   * @brief The free runs found in a single block bitmap
+   *
+   * @since 1.0
+   */
+  struct bitmap_runs
+    {
+    u64 head{}; ///< The length of the free run starting at the first bit
+    u64 tail{}; ///< The length of the free run ending at the last bit
+    free_extent_histogram interior{}; ///< All free runs touching neither the first nor the last bit
+    bool completely_free{}; ///< Whether all bits are free, in which case #head and #tail both span the whole bitmap
+    };
+
+  /**
+   * @brief A function receiving the index of the first bit and the length of a single run of free blocks
+   *
+   * @since 1.0
+   */
+  using free_run_visitor = std::function<void(std::size_t first, u64 length)>;
+
+  /**
+   * @brief Visit all maximal runs of free blocks in a block bitmap, in ascending order
+   *
+   * The bitmap is scanned one 64-bit word at a time. Completely used words are skipped as a whole, and runs within a word
+   * are located by counting trailing zeros rather than by testing individual bits. Runs spanning multiple words are
+   * joined before they are passed to the visitor.
+   *
+   * @param bitmap The bitmap to scan, in on-disk bit order
+   * @param bitsCount The number of valid bits in the bitmap
+   * @param visitor The function to call for each run
+   *
+   * @since 1.0
+   */
+  void visit_free_runs(u08 const * const bitmap, std::size_t const bitsCount, free_run_visitor const & visitor);
+
+  /**
+   * @brief Find all runs of free blocks in a block bitmap
+   *
+   * The runs are located via #visit_free_runs().
+   *
+   * @param bitmap The bitmap to scan, in on-disk bit order
+   * @param bitsCount The number of valid bits in the bitmap
+   *
+   * @since 1.0
+   */
+  bitmap_runs find_free_runs(u08 const * const bitmap, std::size_t const bitsCount);
+
+  /**
+   * @brief Build a histogram of the free extents of a file system by scanning all block bitmaps
+   *
+   * The bitmaps are visited in parallel via #visit_bitmaps(). Extents that span multiple groups are stitched together
+   * afterwards.
+   *
+   * @param device The device to read the bitmaps from
+   * @param layout The geometry of the file system
+   * @param groups The group descriptors of the file system
+   * @param threads The number of threads to use, or @p 0 to use one thread per processor
+   * @return The fragmentation report, or an empty optional if any bitmap could not be read
+   *
+   * @since 1.0
+   */
+  std::optional<fragmentation_report> scan_free_extents(block_device const & device, geometry const & layout,
+                                                        group_descriptor_table const & groups, unsigned const threads = 0);
+
+  }
+
+#endif
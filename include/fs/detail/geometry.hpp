@@ -0,0 +1,253 @@
+#ifndef EXTFS_GEOMETRY_HPP
+#define EXTFS_GEOMETRY_HPP
+
+#include "fs/detail/superblock.hpp"
+#include "fs/detail/types.hpp"
+
+#include <vector>
+
+namespace fs::detail
+  {
+
+  /**
+   * @brief The physical layout of an ext2/3/4 file system
+   *
+   * The geometry derives the location of the on-disk structures of a file system from the values stored in its superblock.
+   * All values are computed once, so that the hot paths of the implementation do not need to repeatedly decode the
+   * superblock.
+   *
+   * @since 1.0
+   */
+  struct geometry
+    {
+    /**
+     * @brief Create an empty geometry
+     *
+     * @since 1.0
+     */
+    geometry() = default;
+
+    /**
+     * @brief Derive the geometry of the file system described by the given superblock
+     *
+     * @since 1.0
+     */
+    explicit geometry(superblock const & block);
+
+    /**
+     * @brief Get the size of a block in bytes
+     *
+     * @since 1.0
+     */
+    u32 block_size() const;
+
+    /**
+     * @brief Get the total number of blocks in the file system
+     *
+     * @since 1.0
+     */
+    u64 blocks_count() const;
+
+    /**
+     * @brief Get the number of block groups in the file system
+     *
+     * @since 1.0
+     */
+    u32 groups_count() const;
+
+    /**
+     * @brief Get the size of a single group descriptor in bytes
+     *
+     * @since 1.0
+     */
+    u32 descriptor_size() const;
+
+    /**
+     * @brief Get the number of group descriptors stored in a single block
+     *
+     * @since 1.0
+     */
+    u32 descriptors_per_block() const;
+
+    /**
+     * @brief Get the number of blocks used to store all group descriptors
+     *
+     * @since 1.0
+     */
+    u32 descriptor_blocks_count() const;
+
+    /**
+     * @brief Get the ID of the block containing the group descriptors with the given index
+     *
+     * If the file system uses meta block groups, the group descriptor blocks are scattered across the file system. Otherwise
+     * they directly follow the superblock the geometry was derived from. Geometries derived from a backup superblock thus
+     * locate the backup copies of the group descriptors.
+     *
+     * @param index The index of the group descriptor block, starting at 0
+     *
+     * @since 1.0
+     */
+    u64 descriptor_block_id(u32 const index) const;
+
+    /**
+     * @brief Get the ID of the first block of the given group
+     *
+     * @since 1.0
+     */
+    u64 group_first_block_id(u32 const group) const;
+
+    /**
+     * @brief Get the number of blocks in each group
+     *
+     * @since 1.0
+     */
+    u32 blocks_per_group() const;
+
+    /**
+     * @brief Get the number of blocks in the given group
+     *
+     * All groups but the last one contain exactly @p blocks_per_group blocks.
+     *
+     * @since 1.0
+     */
+    u32 group_blocks_count(u32 const group) const;
+
+    /**
+     * @brief Check if the given group contains a copy of the superblock
+     *
+     * @since 1.0
+     */
+    bool has_superblock(u32 const group) const;
+
+    /**
+     * @brief Check if groups may be left partially uninitialized
+     *
+     * File systems that checksum their group descriptors initialize block groups lazily. Their group descriptors record
+     * whether the bitmaps and the inode table of a group are initialized, and how many inodes at the end of the inode
+     * table have never been used.
+     *
+     * @since 1.0
+     */
+    bool lazy_group_initialization() const;
+
+    /**
+     * @brief Get the number of groups in each flexible block group
+     *
+     * File systems with flexible block groups place the bitmaps and inode tables of all groups of a flexible block group
+     * next to each other, usually at the start of its first group. Without the feature, every group is its own flexible
+     * block group of size 1.
+     *
+     * @since 1.0
+     */
+    u32 flexible_group_size() const;
+
+    /**
+     * @brief Get the ID of the group hosting the superblock the geometry was derived from
+     *
+     * @since 1.0
+     */
+    u32 superblock_group() const;
+
+    /**
+     * @brief Get the IDs of all groups that contain a copy of the superblock, in ascending order
+     *
+     * @since 1.0
+     */
+    std::vector<u32> superblock_groups() const;
+
+    /**
+     * @brief Get the absolute byte offset of the copy of the superblock in the given group
+     *
+     * @note The group must contain a copy of the superblock.
+     * @since 1.0
+     */
+    u64 superblock_offset(u32 const group) const;
+
+    /**
+     * @brief Get the number of blocks of the given group occupied by copies of the superblock and the group descriptors
+     *
+     * This includes the blocks reserved for growing the group descriptor table.
+     *
+     * @since 1.0
+     */
+    u32 group_overhead_blocks_count(u32 const group) const;
+
+    /**
+     * @brief Get the size of a single on-disk inode in bytes
+     *
+     * @since 1.0
+     */
+    u32 inode_size() const;
+
+    /**
+     * @brief Get the total number of inodes in the file system
+     *
+     * @since 1.0
+     */
+    u32 inodes_count() const;
+
+    /**
+     * @brief Get the number of inodes in each group
+     *
+     * @since 1.0
+     */
+    u32 inodes_per_group() const;
+
+    /**
+     * @brief Get the group containing the inode with the given ID
+     *
+     * @since 1.0
+     */
+    u32 inode_group(u32 const inodeId) const;
+
+    /**
+     * @brief Get the index of the inode with the given ID within its group's inode table
+     *
+     * @since 1.0
+     */
+    u32 inode_index(u32 const inodeId) const;
+
+    /**
+     * @brief Get the number of blocks occupied by the inode table of a single group
+     *
+     * @since 1.0
+     */
+    u32 inode_table_blocks_count() const;
+
+    private:
+      u32 m_blockSize{};
+      u32 m_firstDataBlockId{};
+      u32 m_blocksPerGroup{};
+      u32 m_inodesPerGroup{};
+      u32 m_inodesCount{};
+      u32 m_inodeSize{};
+      u32 m_firstMetaBlockGroupId{};
+      u32 m_reservedDescriptorBlocksCount{};
+      u32 m_superblockGroup{};
+      u32 m_flexibleGroupSize{1};
+      bool m_metaBlockGroups{};
+      bool m_sparseSuperblock{};
+      bool m_sparseSuperblockV2{};
+      bool m_lazyGroupInitialization{};
+      u32_arr<2> m_backupGroupIds{};
+      u64 m_blocksCount{};
+      u32 m_groupsCount{};
+      u32 m_descriptorSize{};
+      u32 m_descriptorsPerBlock{};
+      u32 m_descriptorBlocksCount{};
+    };
+
+  /**
+   * @brief Check if the superblock describes a layout a #geometry can be derived from
+   *
+   * A superblock is rejected if its blocks are larger than 64 KiB, if it has no blocks or inodes per group, or if its
+   * group descriptors are not a power of two in size or do not fit into a block. Deriving a geometry from such a
+   * superblock would divide by zero.
+   *
+   * @since 1.0
+   */
+  bool valid_geometry(superblock const & block);
+
+  }
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef EXTFS_GROUP_DESCRIPTOR_HPP
+#define EXTFS_GROUP_DESCRIPTOR_HPP
+
+#include "fs/detail/types.hpp"
+
+#include <type_traits>
+
+namespace fs::detail
+  {
+
+  /**
+   * This structure describes an ext2/3/4 block group descriptor
+   *
+   * The first 32 bytes of the structure are present in all file systems. The remaining fields are only present if the file
+   * system is a 64-bit file system, in which case the size of a descriptor is recorded in the superblock.
+   *
+   * @since 1.0
+   */
+  struct group_descriptor
+    {
+    /**
+     * @brief The flags of a block group
+     *
+     * @since 1.0
+     */
+    enum struct flag : u16
+      {
+      inodes_uninitialized = 1, ///< The inode table and inode bitmap of the group are not initialized
+      block_bitmap_uninitialized = 2, ///< The block bitmap of the group is not initialized
+      inode_table_zeroed = 4, ///< The inode table of the group is zeroed
+      };
+
+    /**
+     * @brief The underlying type of #flag
+     *
+     * @since 1.0
+     */
+    using flg = std::underlying_type_t<flag>;
+
+    u32 block_bitmap_block_id_lo{}; ///< The lower 32 bits of the ID of the block bitmap block
+    u32 inode_bitmap_block_id_lo{}; ///< The lower 32 bits of the ID of the inode bitmap block
+    u32 inode_table_block_id_lo{}; ///< The lower 32 bits of the ID of the first inode table block
+    u16 free_blocks_count_lo{}; ///< The lower 16 bits of the number of free blocks in the group
+    u16 free_inodes_count_lo{}; ///< The lower 16 bits of the number of free inodes in the group
+    u16 used_directories_count_lo{}; ///< The lower 16 bits of the number of directories in the group
+    flg flags{}; ///< The flags of the group
+    u32 exclude_bitmap_block_id_lo{}; ///< The lower 32 bits of the ID of the snapshot exclusion bitmap block
+    u16 block_bitmap_checksum_lo{}; ///< The lower 16 bits of the checksum of the block bitmap
+    u16 inode_bitmap_checksum_lo{}; ///< The lower 16 bits of the checksum of the inode bitmap
+    u16 unused_inodes_count_lo{}; ///< The lower 16 bits of the number of unused inodes at the end of the inode table
+    u16 checksum{}; ///< The checksum of the group descriptor
+    u32 block_bitmap_block_id_hi{}; ///< The upper 32 bits of the ID of the block bitmap block
+    u32 inode_bitmap_block_id_hi{}; ///< The upper 32 bits of the ID of the inode bitmap block
+    u32 inode_table_block_id_hi{}; ///< The upper 32 bits of the ID of the first inode table block
+    u16 free_blocks_count_hi{}; ///< The upper 16 bits of the number of free blocks in the group
+    u16 free_inodes_count_hi{}; ///< The upper 16 bits of the number of free inodes in the group
+    u16 used_directories_count_hi{}; ///< The upper 16 bits of the number of directories in the group
+    u16 unused_inodes_count_hi{}; ///< The upper 16 bits of the number of unused inodes at the end of the inode table
+    u32 exclude_bitmap_block_id_hi{}; ///< The upper 32 bits of the ID of the snapshot exclusion bitmap block
+    u16 block_bitmap_checksum_hi{}; ///< The upper 16 bits of the checksum of the block bitmap
+    u16 inode_bitmap_checksum_hi{}; ///< The upper 16 bits of the checksum of the inode bitmap
+    u32 _reserved0{}; ///< Padding
+    };
+
+  static_assert(sizeof(group_descriptor) == 64, "An ext2/3/4 group descriptor must have an exact size of 64 bytes!");
+
+  }
+
+#endif
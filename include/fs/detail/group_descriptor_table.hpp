@@ -0,0 +1,122 @@
+#ifndef EXTFS_GROUP_DESCRIPTOR_TABLE_HPP
+#define EXTFS_GROUP_DESCRIPTOR_TABLE_HPP
+
+#include "fs/detail/block_device.hpp"
+#include "fs/detail/checksum.hpp"
+#include "fs/detail/geometry.hpp"
+#include "fs/detail/group_descriptor.hpp"
+#include "fs/detail/types.hpp"
+
+#include <atomic>
+#include <memory>
+#include <optional>
+
+namespace fs::detail
+  {
+
+  /**
+   * @brief The decoded description of a single block group
+   *
+   * In contrast to #group_descriptor, which mirrors the on-disk layout, all split fields of a block group are combined into
+   * their full width.
+   *
+   * @since 1.0
+   */
+  struct block_group
+    {
+    u32 id{}; ///< The ID of the group
+    u64 block_bitmap_block_id{}; ///< The ID of the block bitmap block
+    u64 inode_bitmap_block_id{}; ///< The ID of the inode bitmap block
+    u64 inode_table_block_id{}; ///< The ID of the first inode table block
+    u32 free_blocks_count{}; ///< The number of free blocks in the group
+    u32 free_inodes_count{}; ///< The number of free inodes in the group
+    u32 used_directories_count{}; ///< The number of directories in the group
+    u32 unused_inodes_count{}; ///< The number of unused inodes at the end of the inode table
+    group_descriptor::flg flags{}; ///< The flags of the group
+    u16 checksum{}; ///< The checksum of the group descriptor
+    u32 block_bitmap_checksum{}; ///< The checksum of the block bitmap. Only the lower 16 bits are set for 32-byte descriptors.
+    u32 inode_bitmap_checksum{}; ///< The checksum of the inode bitmap. Only the lower 16 bits are set for 32-byte descriptors.
+
+    /**
+     * @brief Check if the group has the given flag
+     *
+     * @since 1.0
+     */
+    bool has(group_descriptor::flag const flag) const;
+    };
+
+  /**
+   * @brief The lazily loaded table of all group descriptors of a file system
+   *
+   * Large file systems consist of hundreds of thousands of block groups. Instead of reading all group descriptors when a file
+   * system is opened, the table reads a block of group descriptors the first time one of the groups it describes is
+   * accessed. Decoded descriptors are kept in a structure-of-arrays layout, one page per descriptor block, so that scans
+   * over a single field of many groups stay cache friendly.
+   *
+   * @par Thread safety
+   * All @p const member functions can safely be called concurrently. If multiple threads fault in the same descriptor
+   * block at the same time, exactly one of the decoded pages is kept.
+   *
+   * @since 1.0
+   */
+  struct group_descriptor_table
+    {
+    /**
+     * @brief Create a table for the file system on the given device
+     *
+     * @param device The device to read the descriptors from
+     * @param layout The geometry of the file system
+     * @param checksums The verifier to check every descriptor with when it is loaded, or @p nullptr to not verify them
+     *
+     * @note The device and the verifier must outlive the table.
+     * @since 1.0
+     */
+    group_descriptor_table(block_device const & device, geometry const & layout,
+                           metadata_checksums const * const checksums = nullptr);
+
+    ~group_descriptor_table();
+
+    group_descriptor_table(group_descriptor_table const &) = delete;
+    group_descriptor_table & operator=(group_descriptor_table const &) = delete;
+
+    /**
+     * @brief Get the description of the given group
+     *
+     * @return The decoded group descriptor or an empty optional if the group does not exist, its descriptor block could
+     * not be read, or its checksum is invalid
+     *
+     * @since 1.0
+     */
+    std::optional<block_group> operator[](u32 const group) const;
+
+    /**
+     * @brief Get the number of descriptor blocks that have been loaded so far
+     *
+     * @since 1.0
+     */
+    u32 loaded_blocks_count() const;
+
+    /**
+     * @brief Get the verifier the descriptors are checked with
+     *
+     * @return The verifier, or @p nullptr if checksums are not verified
+     *
+     * @since 1.0
+     */
+    metadata_checksums const * checksums() const;
+
+    private:
+      struct page;
+
+      page const * load(u32 const index) const;
+
+      block_device const & m_device;
+      geometry const m_geometry;
+      metadata_checksums const * const m_checksums;
+      std::unique_ptr<std::atomic<page const *>[]> m_pages;
+      mutable std::atomic<u32> m_loadedBlocksCount{};
+    };
+
+  }
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef EXTFS_GROUP_PREFETCH_HPP
+#define EXTFS_GROUP_PREFETCH_HPP
+
+#include "fs/detail/block_device.hpp"
+#include "fs/detail/block_extent.hpp"
+#include "fs/detail/buffer_cache.hpp"
+#include "fs/detail/geometry.hpp"
+#include "fs/detail/group_descriptor_table.hpp"
+#include "fs/detail/types.hpp"
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace fs::detail
+  {
+
+  /**
+   * @brief The maximum number of unneeded blocks read to join two metadata extents into a single read
+   *
+   * @since 1.0
+   */
+  auto constexpr kMaximumMetadataGapBlocks = 8u;
+
+  /**
+   * @brief The statistics of a #group_prefetcher
+   *
+   * @since 1.0
+   */
+  struct group_prefetch_statistics
+    {
+    u64 prefetched_groups_count{}; ///< The number of groups whose metadata was prefetched
+    u64 reads_count{}; ///< The number of reads issued to prefetch the metadata
+    u64 blocks_count{}; ///< The number of blocks covered by the reads
+    };
+
+  /**
+   * @brief Get the on-disk extents holding the bitmaps and inode tables of a range of groups
+   *
+   * Bitmaps that are not initialized on disk, as well as the never used inodes at the end of lazily initialized inode
+   * tables, are left out. The remaining blocks are sorted and joined into extents, bridging gaps of up to
+   * @p maximumGapBlocks blocks. With flexible block groups, the metadata of a whole flexible block group thus collapses
+   * into very few extents. Groups whose descriptor can not be loaded are skipped.
+   *
+   * @param layout The geometry of the file system
+   * @param groups The group descriptors of the file system
+   * @param firstGroup The ID of the first group
+   * @param endGroup The ID of the group following the last group
+   * @param maximumGapBlocks The maximum number of unneeded blocks between two joined extents
+   * @return The extents in ascending order
+   *
+   * @since 1.0
+   */
+  std::vector<block_extent> group_metadata_extents(geometry const & layout, group_descriptor_table const & groups,
+                                                   u32 const firstGroup, u32 const endGroup,
+                                                   u32 const maximumGapBlocks = kMaximumMetadataGapBlocks);
+
+  /**
+   * @brief Prefetches the bitmaps and inode tables of block groups with few large reads
+   *
+   * If a #buffer_cache is given, the metadata is loaded into it via buffer_cache::preload(), so that the following small
+   * reads of single inodes and bitmaps are served from memory. Otherwise the device is hinted about the extents.
+   *
+   * @par Thread safety
+   * All @p const member functions can safely be called concurrently. Each flexible block group is prefetched by
+   * #touch() at most once.
+   *
+   * @since 1.0
+   */
+  struct group_prefetcher
+    {
+    /**
+     * @brief Create a prefetcher for the file system on the given device
+     *
+     * @param device The device to hint about the metadata if there is no buffer cache
+     * @param buffers The buffer cache to load the metadata into, or @p nullptr
+     * @param layout The geometry of the file system
+     * @param groups The group descriptors of the file system
+     *
+     * @note The device, the buffer cache and the group descriptors must outlive the prefetcher.
+     * @since 1.0
+     */
+    group_prefetcher(block_device const & device, buffer_cache const * const buffers, geometry const & layout,
+                     group_descriptor_table const & groups);
+
+    /**
+     * @brief Prefetch the metadata of the flexible block group containing the given group, unless this already happened
+     *
+     * File systems without flexible block groups scatter the metadata of their groups across the device, so that a single
+     * group gains nothing from being prefetched in advance. Touching their groups has no effect.
+     *
+     * @since 1.0
+     */
+    void touch(u32 const group) const;
+
+    /**
+     * @brief Prefetch the metadata of a range of groups
+     *
+     * @param firstGroup The ID of the first group
+     * @param endGroup The ID of the group following the last group
+     *
+     * @since 1.0
+     */
+    void prefetch(u32 const firstGroup, u32 const endGroup) const;
+
+    /**
+     * @brief Get a snapshot of the statistics of the prefetcher
+     *
+     * @since 1.0
+     */
+    group_prefetch_statistics statistics() const;
+
+    private:
+      block_device const & m_device;
+      buffer_cache const * const m_buffers;
+      geometry const m_geometry;
+      group_descriptor_table const & m_groups;
+      std::unique_ptr<std::atomic<bool>[]> m_touched;
+      mutable std::atomic<u64> m_prefetchedGroupsCount{};
+      mutable std::atomic<u64> m_readsCount{};
+      mutable std::atomic<u64> m_blocksCount{};
+    };
+
+  }
+
+#endif
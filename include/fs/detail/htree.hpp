@@ -0,0 +1,115 @@
+#ifndef EXTFS_HTREE_HPP
+#define EXTFS_HTREE_HPP
+
+#include "fs/detail/block_device.hpp"
+#include "fs/detail/name_hash.hpp"
+#include "fs/detail/types.hpp"
+
+#include <functional>
+#include <optional>
+#include <string_view>
+
+namespace fs::detail
+  {
+
+  /**
+   * This structure describes the header of the index in the root block of a hash tree
+   *
+   * @since 1.0
+   */
+  struct dx_root_info
+    {
+    u32 _reserved0{}; ///< Always zero
+    u08 hash_version{}; ///< The #hash_algorithm used to hash the names in the directory
+    u08 info_length{}; ///< The length of this structure in bytes
+    u08 indirect_levels{}; ///< The number of index levels below the root
+    u08 unused_flags{}; ///< Unused flags
+    };
+
+  static_assert(sizeof(dx_root_info) == 8, "An ext3/4 hash tree root info must have an exact size of 8 bytes!");
+
+  /**
+   * This structure describes the number of entries in an index block of a hash tree
+   *
+   * The structure overlays the hash of the first index entry, which is implicitly 0.
+   *
+   * @since 1.0
+   */
+  struct dx_count_limit
+    {
+    u16 limit{}; ///< The maximum number of entries that fit into the block
+    u16 count{}; ///< The number of valid entries in the block
+    };
+
+  static_assert(sizeof(dx_count_limit) == 4, "An ext3/4 hash tree count and limit must have an exact size of 4 bytes!");
+
+  /**
+   * This structure describes an entry of an index block of a hash tree
+   *
+   * @since 1.0
+   */
+  struct dx_entry
+    {
+    u32 hash{}; ///< The lowest hash of the names stored below the entry
+    u32 block{}; ///< The logical block of the directory the entry points to
+    };
+
+  static_assert(sizeof(dx_entry) == 8, "An ext3/4 hash tree entry must have an exact size of 8 bytes!");
+
+  /**
+   * @brief The hash tree index of a directory
+   *
+   * Directories with the inode::flag::hash_indexed flag store an index of their entries, ordered by the hash of their names,
+   * in a tree rooted in the first block of the directory. Looking up a name only reads one block per level of the tree,
+   * plus the leaf block(s) holding entries with the hash of the name. Trees have at most two levels, or three on file
+   * systems with the superblock::incompatible_feature::large_directory feature.
+   *
+   * @since 1.0
+   */
+  struct htree
+    {
+    /**
+     * @brief A function reading a logical block of the directory
+     *
+     * The function shall return @p nullptr if the block could not be read.
+     *
+     * @since 1.0
+     */
+    using block_source = std::function<bytes(u64 const logicalBlock)>;
+
+    /**
+     * @brief Create the hash tree of a directory
+     *
+     * @param source The function used to read the blocks of the directory
+     * @param blockSize The size of a block in bytes
+     * @param seed The hash seed of the file system
+     * @param unsignedHashes Whether names are hashed as unsigned characters
+     * @param largeDirectories Whether the tree may have three levels
+     *
+     * @since 1.0
+     */
+    htree(block_source source, u32 const blockSize, u32_arr<4> const & seed, bool const unsignedHashes,
+          bool const largeDirectories);
+
+    /**
+     * @brief Find an entry by name
+     *
+     * @param name The name of the entry
+     * @return The ID of the inode the entry refers to, 0 if the directory contains no entry of the given name, or an empty
+     * optional if the tree is corrupted or could not be read
+     *
+     * @since 1.0
+     */
+    std::optional<u32> find(std::string_view const name) const;
+
+    private:
+      block_source m_source;
+      u32 m_blockSize;
+      u32_arr<4> m_seed;
+      bool m_unsignedHashes;
+      bool m_largeDirectories;
+    };
+
+  }
+
+#endif
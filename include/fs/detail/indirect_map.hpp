@@ -0,0 +1,62 @@
+#ifndef EXTFS_INDIRECT_MAP_HPP
+#define EXTFS_INDIRECT_MAP_HPP
+
+#include "fs/detail/block_device.hpp"
+#include "fs/detail/block_map.hpp"
+#include "fs/detail/types.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+namespace fs::detail
+  {
+
+  /**
+   * @brief The resolved indirect block map of a single inode
+   *
+   * Inodes that do not use extents map their first 12 blocks directly, followed by a single, a double and a triple
+   * indirect block. Ranges are resolved level by level: all indirect blocks needed on one level of the requested range are
+   * collected, sorted by their physical location and read in a single batch, with physically adjacent blocks merged into
+   * one vectored read. All pointers of a leaf indirect block are remembered and its whole logical span is covered, and the
+   * double and triple indirect blocks above the leaves are kept, so that resolving a file in sequential chunks reads every
+   * indirect block only once.
+   *
+   * @since 1.0
+   */
+  struct indirect_map final : block_map
+    {
+    /**
+     * @brief Create the indirect map for the given block map
+     *
+     * @param device The device to read the indirect blocks from. It must outlive the indirect map.
+     * @param blockSize The size of a block in bytes
+     * @param root The block map of the inode
+     *
+     * @since 1.0
+     */
+    indirect_map(block_device const & device, u32 const blockSize, u32_arr<15> const & root);
+
+    /**
+     * @brief Get the number of read requests issued to the device so far
+     *
+     * @since 1.0
+     */
+    std::size_t read_requests_count() const;
+
+    protected:
+      bool load(u64 const firstBlock, u64 const endBlock) override;
+      std::size_t metadata_footprint() const override;
+
+    private:
+      block_device const & m_device;
+      u32 const m_blockSize;
+      u32_arr<15> const m_root;
+      std::atomic<std::size_t> m_readRequestsCount{};
+      std::unordered_map<u64, std::vector<u32>> m_interiorBlocks{};
+    };
+
+  }
+
+#endif
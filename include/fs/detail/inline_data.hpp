@@ -0,0 +1,77 @@
+#ifndef EXTFS_INLINE_DATA_HPP
+#define EXTFS_INLINE_DATA_HPP
+
+#include "fs/detail/inode.hpp"
+#include "fs/detail/types.hpp"
+
+#include <cstddef>
+#include <optional>
+
+namespace fs::detail
+  {
+
+  /**
+   * @brief The number of bytes of inline data stored in the block map area of an inode
+   *
+   * @since 1.0
+   */
+  auto constexpr kInlineDataHeadSize = sizeof(inode::block);
+
+  /**
+   * @brief The number of bytes at the start of an inline directory that hold the ID of its parent directory
+   *
+   * @since 1.0
+   */
+  auto constexpr kInlineDirectoryHeaderSize = sizeof(u32);
+
+  /**
+   * @brief The content of an inode that stores its data inside the inode itself
+   *
+   * The first #kInlineDataHeadSize bytes of the content are stored in the block map area of the inode. Any remaining bytes
+   * are stored in the value of the in-inode @p system.data extended attribute. Both parts point directly into the raw
+   * inode they were located in, and are only valid for as long as the inode is.
+   *
+   * @since 1.0
+   */
+  struct inline_data
+    {
+    u08 const * head{}; ///< The part of the content stored in the block map area
+    std::size_t head_size{}; ///< The number of bytes in the block map area that belong to the content
+    u08 const * tail{}; ///< The part of the content stored in the @p system.data attribute, or @p nullptr
+    std::size_t tail_size{}; ///< The number of bytes in the @p system.data attribute that belong to the content
+
+    /**
+     * @brief Get the size of the content in bytes
+     *
+     * @since 1.0
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Copy a range of the content
+     *
+     * @param offset The byte offset of the first byte to copy
+     * @param buffer The buffer to copy the bytes to. It must be at least @p length bytes large.
+     * @param length The maximum number of bytes to copy
+     * @return The number of bytes copied, which is less than @p length if the range extends beyond the content
+     *
+     * @since 1.0
+     */
+    std::size_t copy(u64 const offset, void * const buffer, std::size_t const length) const;
+    };
+
+  /**
+   * @brief Locate the inline content of an on-disk inode
+   *
+   * @param rawInode The raw bytes of the on-disk inode
+   * @param inodeSize The size of an on-disk inode in bytes
+   * @return The content of the inode, or an empty optional if the inode does not store its data inline, or its size
+   * exceeds the inline space it has
+   *
+   * @since 1.0
+   */
+  std::optional<inline_data> inline_data_of(u08 const * const rawInode, u32 const inodeSize);
+
+  }
+
+#endif
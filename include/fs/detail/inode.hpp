@@ -0,0 +1,137 @@
+#ifndef EXTFS_INODE_HPP
+#define EXTFS_INODE_HPP
+
+#include "fs/detail/types.hpp"
+
+#include <type_traits>
+
+namespace fs::detail
+  {
+
+  /**
+   * This structure describes an ext2/3/4 inode
+   *
+   * The first 128 bytes of the structure are present in all file systems. The remaining fields are only valid if the inode
+   * is large enough to contain them, as recorded in #extra_size.
+   *
+   * @since 1.0
+   */
+  struct inode
+    {
+    /**
+     * @brief The types of files an inode can describe
+     *
+     * @since 1.0
+     */
+    enum struct file_type : u16
+      {
+      fifo = 0x1000, ///< A named pipe
+      character_device = 0x2000, ///< A character device
+      directory = 0x4000, ///< A directory
+      block_device = 0x6000, ///< A block device
+      regular_file = 0x8000, ///< A regular file
+      symbolic_link = 0xa000, ///< A symbolic link
+      socket = 0xc000, ///< A unix domain socket
+      };
+
+    /**
+     * @brief The flags of an inode
+     *
+     * @since 1.0
+     */
+    enum struct flag : u32
+      {
+      secure_deletion = 0x1, ///< The inode must be securely deleted
+      undelete = 0x2, ///< The content of the inode should be preserved on deletion
+      compressed = 0x4, ///< The content of the inode is compressed
+      synchronous = 0x8, ///< All writes to the inode are synchronous
+      immutable = 0x10, ///< The inode is immutable
+      append_only = 0x20, ///< The inode can only be appended to
+      no_dump = 0x40, ///< The inode should not be backed up by dump
+      no_access_time = 0x80, ///< The access time of the inode is not updated
+      hash_indexed = 0x1000, ///< The directory described by the inode uses a hash tree index
+      journaled_data = 0x4000, ///< The content of the inode is journaled
+      directory_sync = 0x10000, ///< All writes to the directory are synchronous
+      top_directory = 0x20000, ///< The directory is the top of a directory hierarchy
+      huge_file = 0x40000, ///< The block count of the inode is in units of file system blocks
+      extents = 0x80000, ///< The inode uses extents to map its content
+      extended_attribute_inode = 0x200000, ///< The inode stores a large extended attribute value
+      inline_data = 0x10000000, ///< The content of the inode is stored inside the inode itself
+      };
+
+    /**
+     * @brief The underlying type of #flag
+     *
+     * @since 1.0
+     */
+    using flg = std::underlying_type_t<flag>;
+
+    u16 mode{}; ///< The file type and access rights of the inode
+    u16 user_id{}; ///< The lower 16 bits of the owner's user ID
+    u32 size_lo{}; ///< The lower 32 bits of the size of the inode in bytes
+    u32 access_timestamp{}; ///< The unix timestamp of the last access
+    u32 change_timestamp{}; ///< The unix timestamp of the last change of the inode
+    u32 modification_timestamp{}; ///< The unix timestamp of the last modification of the content
+    u32 deletion_timestamp{}; ///< The unix timestamp of the deletion of the inode
+    u16 group_id{}; ///< The lower 16 bits of the owner's group ID
+    u16 links_count{}; ///< The number of hard links to the inode
+    u32 blocks_count_lo{}; ///< The lower 32 bits of the number of blocks used by the inode
+    flg flags{}; ///< The flags of the inode
+    u32 version{}; ///< The lower 32 bits of the version of the inode
+    u32_arr<15> block{}; ///< The block map, extent tree root or inline data of the inode
+    u32 generation{}; ///< The file version, as used by NFS
+    u32 extended_attributes_block_id_lo{}; ///< The lower 32 bits of the ID of the extended attribute block
+    u32 size_hi{}; ///< The upper 32 bits of the size of the inode in bytes
+    u32 fragment_address{}; ///< The obsolete fragment address
+    u16 blocks_count_hi{}; ///< The upper 16 bits of the number of blocks used by the inode
+    u16 extended_attributes_block_id_hi{}; ///< The upper 16 bits of the ID of the extended attribute block
+    u16 user_id_hi{}; ///< The upper 16 bits of the owner's user ID
+    u16 group_id_hi{}; ///< The upper 16 bits of the owner's group ID
+    u16 checksum_lo{}; ///< The lower 16 bits of the checksum of the inode
+    u16 _reserved0{}; ///< Padding
+    u16 extra_size{}; ///< The number of bytes of this inode beyond the first 128 bytes that are in use
+    u16 checksum_hi{}; ///< The upper 16 bits of the checksum of the inode
+    u32 change_timestamp_extra{}; ///< The extra precision bits of the change timestamp
+    u32 modification_timestamp_extra{}; ///< The extra precision bits of the modification timestamp
+    u32 access_timestamp_extra{}; ///< The extra precision bits of the access timestamp
+    u32 creation_timestamp{}; ///< The unix timestamp of the creation of the inode
+    u32 creation_timestamp_extra{}; ///< The extra precision bits of the creation timestamp
+    u32 version_hi{}; ///< The upper 32 bits of the version of the inode
+    u32 project_id{}; ///< The project ID of the inode
+
+    /**
+     * @brief Get the type of the file described by the inode
+     *
+     * @since 1.0
+     */
+    file_type type() const;
+
+    /**
+     * @brief Get the size of the inode's content in bytes
+     *
+     * @since 1.0
+     */
+    u64 size() const;
+
+    /**
+     * @brief Get the ID of the block holding the extended attributes of the inode
+     *
+     * @return The ID of the extended attribute block or 0 if the inode has no extended attribute block
+     *
+     * @since 1.0
+     */
+    u64 extended_attributes_block_id() const;
+
+    /**
+     * @brief Check if the inode has the given flag
+     *
+     * @since 1.0
+     */
+    bool has(flag const flag) const;
+    };
+
+  static_assert(sizeof(inode) == 160, "An ext2/3/4 inode must have an exact size of 160 bytes!");
+
+  }
+
+#endif
@@ -0,0 +1,143 @@
+#ifndef EXTFS_INODE_SCAN_HPP
+#define EXTFS_INODE_SCAN_HPP
+
+#include "fs/detail/block_device.hpp"
+#include "fs/detail/geometry.hpp"
+#include "fs/detail/group_descriptor_table.hpp"
+#include "fs/detail/inode.hpp"
+#include "fs/detail/types.hpp"
+
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace fs::detail
+  {
+
+  /**
+   * @brief A sequential pass over the inode tables of a range of groups
+   *
+   * Instead of reading inodes one at a time, the scan reads the inode tables in large chunks and hands out the inodes of a
+   * chunk from memory. While the inodes of a chunk are handed out, the device is hinted to read the next one. On file
+   * systems that initialize groups lazily, groups whose inode table was never initialized are skipped completely, and
+   * only the part of each inode table that was ever used is read.
+   *
+   * All inodes within the scanned range are handed out, including unused ones. If the group descriptor table verifies
+   * checksums, inodes with an invalid checksum are skipped.
+   *
+   * @note Scanned inodes bypass the inode cache of the file system.
+   *
+   * @par Thread safety
+   * A scan must not be used by multiple threads at the same time. Multiple scans of the same file system can be used
+   * concurrently.
+   *
+   * @since 1.0
+   */
+  struct inode_scan
+    {
+    /**
+     * @brief The default number of bytes of an inode table to read at once
+     *
+     * @since 1.0
+     */
+    static auto constexpr kDefaultChunkSize = std::size_t{1} << 20;
+
+    /**
+     * @brief Create a scan over the inode tables of the given range of groups
+     *
+     * @param device The device to read the inode tables from. It must outlive the scan.
+     * @param layout The geometry of the file system
+     * @param groups The group descriptors of the file system. They must outlive the scan.
+     * @param firstGroup The ID of the first group to scan
+     * @param endGroup The ID of the group after the last group to scan. It is clamped to the number of groups.
+     * @param chunkSize The maximum number of bytes to read at once. It is rounded down to whole blocks, but at least one.
+     *
+     * @since 1.0
+     */
+    inode_scan(block_device const & device, geometry const & layout, group_descriptor_table const & groups,
+               u32 const firstGroup, u32 const endGroup, std::size_t const chunkSize = kDefaultChunkSize);
+
+    /**
+     * @brief Advance to the next inode
+     *
+     * @return The ID of the next inode, or an empty optional if the scan is complete or failed
+     *
+     * @since 1.0
+     */
+    std::optional<u32> next();
+
+    /**
+     * @brief Get the current inode
+     *
+     * Bytes beyond the on-disk inode are zero.
+     *
+     * @note Only valid after #next() returned an inode ID.
+     * @since 1.0
+     */
+    inode const & current() const;
+
+    /**
+     * @brief Check if a group descriptor or an inode table could not be read
+     *
+     * @since 1.0
+     */
+    bool failed() const;
+
+    /**
+     * @brief Get the number of chunks read so far
+     *
+     * @since 1.0
+     */
+    u64 chunks_count() const;
+
+    private:
+      bool start_group();
+      bool read_chunk();
+      void prefetch_chunk() const;
+
+      block_device const & m_device;
+      geometry const & m_geometry;
+      group_descriptor_table const & m_groups;
+      u32 m_group;
+      u32 const m_endGroup;
+      u32 const m_chunkInodesCount;
+      std::vector<u08> m_buffer{};
+      inode m_current{};
+      u64 m_tableOffset{};
+      u32 m_tableInodesCount{};
+      u32 m_chunkStart{};
+      u32 m_chunkInodes{};
+      u32 m_index{};
+      bool m_started{};
+      bool m_failed{};
+      u64 m_chunksCount{};
+    };
+
+  /**
+   * @brief The function called for every scanned inode
+   *
+   * @since 1.0
+   */
+  using inode_visitor = std::function<void(u32 const inodeId, inode const & node)>;
+
+  /**
+   * @brief Scan the inode tables of all groups of a file system in parallel
+   *
+   * The groups are handed out to a number of threads in batches, each of which is scanned using an #inode_scan.
+   *
+   * @param device The device to read the inode tables from
+   * @param layout The geometry of the file system
+   * @param groups The group descriptors of the file system
+   * @param threads The number of threads to use, or @p 0 to use one thread per processor
+   * @param visitor The function to call for each inode. It is called concurrently from multiple threads.
+   * @return @p true, iff. all inode tables could be read, @p false otherwise
+   *
+   * @since 1.0
+   */
+  bool scan_inodes(block_device const & device, geometry const & layout, group_descriptor_table const & groups,
+                   unsigned const threads, inode_visitor const & visitor);
+
+  }
+
+#endif
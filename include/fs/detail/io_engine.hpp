@@ -0,0 +1,218 @@
+#ifndef EXTFS_IO_ENGINE_HPP
+#define EXTFS_IO_ENGINE_HPP
+
+#include "fs/detail/types.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace fs::detail
+  {
+
+  /**
+   * @brief A single target buffer of a vectored read
+   *
+   * @since 1.0
+   */
+  struct io_vector
+    {
+    void * buffer; ///< The buffer to read into
+    std::size_t length; ///< The number of bytes to read into the buffer
+    };
+
+  /**
+   * @brief An asynchronous read request
+   *
+   * @since 1.0
+   */
+  struct io_request
+    {
+    u64 offset{}; ///< The absolute byte offset of the first byte to read
+    std::vector<io_vector> vectors{}; ///< The buffers to fill, in order
+    std::function<void(bool)> completion{}; ///< Called with @p true iff. all buffers were filled completely
+    };
+
+  /**
+   * @brief The interface of all asynchronous I/O engines
+   *
+   * An I/O engine executes read requests against an open file descriptor in the background. Requests are submitted in
+   * batches, and at most #queue_depth() requests are in flight at the same time. Submitting more requests blocks until
+   * earlier requests complete.
+   *
+   * @par Thread safety
+   * All member functions can safely be called concurrently. Completions are invoked on threads owned by the engine, and
+   * must therefore not block for long, nor submit further requests to the same engine.
+   *
+   * @since 1.0
+   */
+  struct io_engine
+    {
+    virtual ~io_engine() = default;
+
+    /**
+     * @brief Submit a batch of read requests
+     *
+     * @since 1.0
+     */
+    virtual void submit(std::vector<io_request> requests) = 0;
+
+    /**
+     * @brief Get the maximum number of requests in flight
+     *
+     * @since 1.0
+     */
+    virtual std::size_t queue_depth() const = 0;
+    };
+
+  /**
+   * @brief Read a contiguous range of bytes from a descriptor into multiple buffers
+   *
+   * Interrupted and short reads are retried until all buffers are filled.
+   *
+   * @return @p true, iff. all buffers could be filled completely, @p false otherwise
+   *
+   * @since 1.0
+   */
+  bool read_vectors(int const descriptor, u64 const offset, std::vector<io_vector> const & vectors);
+
+  /**
+   * @brief Write multiple buffers to a contiguous range of bytes of a descriptor
+   *
+   * Interrupted and short writes are retried until all buffers are written.
+   *
+   * @return @p true, iff. all buffers could be written completely, @p false otherwise
+   *
+   * @since 1.0
+   */
+  bool write_vectors(int const descriptor, u64 const offset, std::vector<io_vector> const & vectors);
+
+  /**
+   * @brief An I/O engine that executes requests with @p preadv on a pool of threads
+   *
+   * This engine works on every system, and is used whenever io_uring is not available.
+   *
+   * @since 1.0
+   */
+  struct pool_engine final : io_engine
+    {
+    /**
+     * @brief Create a pool of threads reading from the given descriptor
+     *
+     * @param descriptor The descriptor to read from. It must stay open for the lifetime of the engine.
+     * @param queueDepth The maximum number of requests in flight. The pool uses at most #kMaximumWorkers threads.
+     *
+     * @since 1.0
+     */
+    pool_engine(int const descriptor, std::size_t const queueDepth);
+
+    /**
+     * @brief The maximum number of threads in the pool
+     *
+     * @since 1.0
+     */
+    static std::size_t constexpr kMaximumWorkers{8};
+
+    ~pool_engine() override;
+
+    pool_engine(pool_engine const &) = delete;
+    pool_engine & operator=(pool_engine const &) = delete;
+
+    void submit(std::vector<io_request> requests) override;
+    std::size_t queue_depth() const override;
+
+    private:
+      void work();
+
+      int const m_descriptor;
+      std::size_t const m_queueDepth;
+      std::mutex m_mutex{};
+      std::condition_variable m_available{};
+      std::condition_variable m_drained{};
+      std::deque<io_request> m_pending{};
+      std::size_t m_inFlight{};
+      bool m_stopping{};
+      std::vector<std::thread> m_workers{};
+    };
+
+  /**
+   * @brief An I/O engine that executes requests via Linux io_uring
+   *
+   * The engine talks to the kernel via the raw io_uring system calls. A whole batch of requests is handed to the kernel with
+   * a single system call, and a dedicated thread reaps the completions. The reaper only waits for completions while the
+   * kernel holds submitted requests.
+   *
+   * Requests the kernel does not accept are completed as failed. If waiting for completions fails, all outstanding
+   * requests are completed as failed, and all further requests fail immediately.
+   *
+   * @since 1.0
+   */
+  struct uring_engine final : io_engine
+    {
+    /**
+     * @brief Set up an io_uring instance for the given descriptor
+     *
+     * @param descriptor The descriptor to read from. It must stay open for the lifetime of the engine.
+     * @param queueDepth The maximum number of requests in flight
+     *
+     * @note Use #ready() to check if the kernel supports io_uring.
+     * @since 1.0
+     */
+    uring_engine(int const descriptor, std::size_t const queueDepth);
+
+    ~uring_engine() override;
+
+    uring_engine(uring_engine const &) = delete;
+    uring_engine & operator=(uring_engine const &) = delete;
+
+    /**
+     * @brief Check if the io_uring instance was set up successfully
+     *
+     * @since 1.0
+     */
+    bool ready() const;
+
+    void submit(std::vector<io_request> requests) override;
+    std::size_t queue_depth() const override;
+
+    private:
+      struct ring;
+      struct operation;
+
+      void queue(operation * const pending);
+      void flush(std::vector<operation *> & failed);
+      void fail(std::vector<operation *> const & failed);
+      void reap();
+
+      int const m_descriptor;
+      std::size_t m_queueDepth{};
+      std::unique_ptr<ring> m_ring;
+      std::mutex m_mutex{};
+      std::condition_variable m_available{};
+      std::condition_variable m_submitted{};
+      std::unordered_set<operation *> m_operations{};
+      std::size_t m_inFlight{};
+      std::size_t m_inKernel{};
+      bool m_broken{};
+      bool m_stopping{};
+      std::thread m_reaper{};
+    };
+
+  /**
+   * @brief Create the most efficient I/O engine available for the given descriptor
+   *
+   * An io_uring engine is used if the kernel supports it, a thread pool engine otherwise.
+   *
+   * @since 1.0
+   */
+  std::unique_ptr<io_engine> make_io_engine(int const descriptor, std::size_t const queueDepth);
+
+  }
+
+#endif
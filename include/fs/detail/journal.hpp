@@ -0,0 +1,228 @@
+#ifndef EXTFS_JOURNAL_HPP
+#define EXTFS_JOURNAL_HPP
+
+#include "fs/detail/block_device.hpp"
+#include "fs/detail/block_run.hpp"
+#include "fs/detail/types.hpp"
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace fs::detail
+  {
+
+  /**
+   * @brief The magic number identifying the blocks of a JBD2 journal
+   *
+   * @since 1.0
+   */
+  auto constexpr kJournalMagic = u32{0xc03b3998};
+
+  /**
+   * @brief Convert a big-endian on-disk value of the journal to the native byte order
+   *
+   * @since 1.0
+   */
+  inline u32 from_big_endian(u32 const value)
+    {
+    return __builtin_bswap32(value);
+    }
+
+  /**
+   * @brief The header at the start of every metadata block of a JBD2 journal
+   *
+   * Unlike the rest of the file system, the journal stores all of its fields in big-endian byte order.
+   *
+   * @since 1.0
+   */
+  struct journal_header
+    {
+    /**
+     * @brief The types of the metadata blocks of a journal
+     *
+     * @since 1.0
+     */
+    enum struct block_type : u32
+      {
+      descriptor = 1, ///< The block describes the blocks logged by a transaction
+      commit = 2, ///< The block marks the end of a committed transaction
+      superblock_v1 = 3, ///< The block is a version 1 journal superblock
+      superblock_v2 = 4, ///< The block is a version 2 journal superblock
+      revoke = 5, ///< The block lists blocks whose earlier copies must not be used
+      };
+
+    u32 magic_number{}; ///< The magic number of the journal, see #kJournalMagic
+    u32 type{}; ///< The #block_type of the block
+    u32 sequence{}; ///< The sequence number of the transaction the block belongs to
+    };
+
+  static_assert(sizeof(journal_header) == 12, "A JBD2 block header must have an exact size of 12 bytes!");
+
+  /**
+   * @brief The superblock of a JBD2 journal, stored in the first block of the journal
+   *
+   * @since 1.0
+   */
+  struct journal_superblock
+    {
+    /**
+     * @brief The incompatible features of a journal
+     *
+     * @since 1.0
+     */
+    enum struct incompatible_feature : u32
+      {
+      revoke = 0x1, ///< The journal contains revoke blocks
+      large_block_ids = 0x2, ///< Block IDs are stored with 64 bits
+      asynchronous_commit = 0x4, ///< Commit blocks may be written before the blocks of their transaction
+      checksum_v2 = 0x8, ///< Metadata blocks and logged blocks are checksummed with 16-bit tag checksums
+      checksum_v3 = 0x10, ///< Metadata blocks and logged blocks are checksummed with 32-bit tag checksums
+      fast_commit = 0x20, ///< The journal ends with an area for fast commits
+      };
+
+    /**
+     * @brief The underlying type of incompatible_feature
+     *
+     * @since 1.0
+     */
+    using ift = std::underlying_type_t<incompatible_feature>;
+
+    journal_header header{}; ///< The header of the block
+    u32 block_size{}; ///< The size of a journal block in bytes
+    u32 blocks_count{}; ///< The total number of blocks of the journal
+    u32 first_log_block_id{}; ///< The first block of the journal that holds transactions
+    u32 sequence{}; ///< The sequence number of the first transaction that needs to be replayed
+    u32 start_block_id{}; ///< The block the first transaction that needs to be replayed starts at, or 0 if the journal is clean
+    s32 error{}; ///< The error the journal was aborted with
+    u32 compatible_features_bitmap{}; ///< The active compatible features
+    ift incompatible_features_bitmap{}; ///< The active incompatible features
+    u32 read_only_compatible_features_bitmap{}; ///< The active read-only compatible features
+    u08_arr<16> uuid{}; ///< The UUID of the journal
+    u32 users_count{}; ///< The number of file systems sharing the journal
+    u32 dynamic_superblock_block_id{}; ///< The location of a dynamic superblock copy. Unused.
+    u32 maximum_transaction_blocks{}; ///< The maximum number of blocks per transaction
+    u32 maximum_transaction_data_blocks{}; ///< The maximum number of data blocks per transaction
+    u08 checksum_type{}; ///< The checksum algorithm of the journal
+    u08_arr<3> _reserved0{}; ///< Alignment padding
+    u32 fast_commit_blocks_count{}; ///< The number of blocks of the fast commit area, or 0 for the default size
+    u32 head_block_id{}; ///< The block of the oldest transaction that is still in use
+    u32_arr<40> _reserved1{}; ///< Padding
+    u32 checksum{}; ///< The checksum of the superblock
+    u08_arr<768> users{}; ///< The UUIDs of the file systems sharing the journal
+
+    /**
+     * @brief Check if the journal has the desired incompatible feature
+     *
+     * @since 1.0
+     */
+    bool has(incompatible_feature const feature) const;
+    };
+
+  static_assert(sizeof(journal_superblock) == 1024, "A JBD2 superblock must have an exact size of 1024 bytes!");
+
+  /**
+   * @brief The location of the latest committed copy of a block in the journal
+   *
+   * @since 1.0
+   */
+  struct journal_block
+    {
+    u64 block_id{}; ///< The ID of the file system block holding the copy
+    u32 sequence{}; ///< The sequence number of the transaction that logged the copy
+    bool escaped{}; ///< Whether the first four bytes of the copy were replaced because they matched #kJournalMagic
+    };
+
+  /**
+   * @brief The statistics of a journal scan
+   *
+   * @since 1.0
+   */
+  struct journal_statistics
+    {
+    u32 first_sequence{}; ///< The sequence number of the first transaction that needed to be replayed
+    u32 transactions_count{}; ///< The number of committed transactions found
+    u64 logged_blocks_count{}; ///< The number of block copies logged by the committed transactions
+    u64 revoked_blocks_count{}; ///< The number of block copies that were ignored because the block was revoked later on
+    u64 blocks_count{}; ///< The number of distinct blocks with a committed copy in the journal
+    bool incomplete{}; ///< Whether the journal ends with a transaction that was never committed
+    };
+
+  /**
+   * @brief The latest committed copy of every block found in a journal
+   *
+   * @since 1.0
+   */
+  struct journal_index
+    {
+    std::map<u64, journal_block> blocks{}; ///< The location of the latest copy, by the ID of the block it is a copy of
+    journal_statistics statistics{}; ///< The statistics of the scan that built the index
+    };
+
+  /**
+   * @brief Scan a JBD2 journal and index the latest committed copy of every logged block
+   *
+   * The journal is walked once from its start, following the sequence numbers of the transactions in the same way the
+   * kernel does during recovery. Only transactions with a valid commit block are considered. Copies of blocks that are
+   * revoked by the same or a later committed transaction are ignored. If the journal uses checksums, descriptor, revoke and
+   * commit blocks with invalid checksums end the walk.
+   *
+   * @param device The device the journal is stored on
+   * @param blockSize The size of a block of the file system in bytes
+   * @param runs The runs mapping the journal inode. Holes end the usable part of the journal.
+   * @return The index of all committed copies, which is empty if the journal is clean, or an empty optional if the journal
+   * superblock could not be read, is invalid, or uses unsupported features
+   *
+   * @since 1.0
+   */
+  std::optional<journal_index> scan_journal(block_device const & device, u32 const blockSize,
+                                            std::vector<block_run> const & runs);
+
+  /**
+   * @brief A read-only block device serving blocks with a committed copy in the journal from the journal
+   *
+   * The overlay makes a file system that needs recovery readable without replaying its journal. Every read, fetch and batch
+   * is executed on the underlying device first, after which all blocks with a copy in the journal are replaced by that copy.
+   * Reads that do not touch such blocks are forwarded unchanged.
+   *
+   * @since 1.0
+   */
+  struct journal_overlay final : block_device
+    {
+    /**
+     * @brief Create an overlay over the given device
+     *
+     * @param device The device holding both the file system and its journal
+     * @param blockSize The size of a block of the file system in bytes
+     * @param blocks The index of the journal, as built by #scan_journal()
+     *
+     * @since 1.0
+     */
+    journal_overlay(std::unique_ptr<block_device> device, u32 const blockSize, std::map<u64, journal_block> blocks);
+
+    u64 size() const override;
+    bool writeable() const override;
+    bool mapped() const override;
+    bool read(u64 const offset, void * const buffer, std::size_t const length) const override;
+    bool read(u64 const offset, std::vector<io_vector> const & vectors) const override;
+    bytes fetch(u64 const offset, std::size_t const length) const override;
+    void prefetch(u64 const offset, u64 const length) const override;
+    void submit(std::vector<io_request> requests) const override;
+
+    private:
+      bool overlaps(u64 const offset, u64 const length) const;
+
+      template<typename Sink>
+      bool patch(u64 const offset, u64 const length, Sink && sink) const;
+
+      std::unique_ptr<block_device> m_device;
+      u32 const m_blockSize;
+      std::map<u64, journal_block> const m_blocks;
+    };
+
+  }
+
+#endif
@@ -0,0 +1,246 @@
+#ifndef EXTFS_LRU_CACHE_HPP
+#define EXTFS_LRU_CACHE_HPP
+
+#include "fs/detail/cache_statistics.hpp"
+#include "fs/detail/types.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+
+namespace fs::detail
+  {
+
+  /**
+   * @brief A bounded, sharded least-recently-used cache
+   *
+   * The cache is split into a number of independent shards, each protected by its own lock, so that concurrent lookups of
+   * different keys rarely contend. Every entry is inserted with a cost in bytes. Whenever a shard exceeds its share of the
+   * total capacity, its least recently used entries are evicted.
+   *
+   * @par Thread safety
+   * All member functions can safely be called concurrently.
+   *
+   * @tparam Key The type of the keys
+   * @tparam Value The type of the cached values. Values are returned by copy, so they should be cheap to copy.
+   * @tparam Hash The hash function for keys
+   *
+   * @since 1.0
+   */
+  template<typename Key, typename Value, typename Hash = std::hash<Key>>
+  struct lru_cache
+    {
+    /**
+     * @brief Create a cache with the given capacity
+     *
+     * @param capacity The maximum number of bytes the cache may hold
+     * @param shards The number of shards to distribute the entries across. This is rounded up to the next power of 2.
+     *
+     * @since 1.0
+     */
+    explicit lru_cache(std::size_t const capacity, std::size_t const shards = 16) :
+      m_shardBits{bits_for(shards)},
+      m_shards{new shard[std::size_t{1} << m_shardBits]}
+      {
+      resize(capacity);
+      }
+
+    lru_cache(lru_cache const &) = delete;
+    lru_cache & operator=(lru_cache const &) = delete;
+
+    /**
+     * @brief Look up the value associated with the given key
+     *
+     * A successful lookup marks the entry as the most recently used entry of its shard.
+     *
+     * @since 1.0
+     */
+    std::optional<Value> find(Key const & key) const
+      {
+      auto & target = shard_for(key);
+      auto lock = std::lock_guard<std::mutex>{target.mutex};
+
+      auto const found = target.index.find(key);
+      if(found == target.index.end())
+        {
+        ++target.misses;
+        return std::nullopt;
+        }
+
+      ++target.hits;
+      target.entries.splice(target.entries.begin(), target.entries, found->second);
+      return found->second->value;
+      }
+
+    /**
+     * @brief Insert or replace the value associated with the given key
+     *
+     * @param key The key of the entry
+     * @param value The value of the entry
+     * @param cost The number of bytes to account for the entry
+     *
+     * @since 1.0
+     */
+    void insert(Key const & key, Value value, std::size_t const cost)
+      {
+      auto & target = shard_for(key);
+      auto lock = std::lock_guard<std::mutex>{target.mutex};
+
+      auto const found = target.index.find(key);
+      if(found != target.index.end())
+        {
+        target.size -= found->second->cost;
+        target.entries.erase(found->second);
+        target.index.erase(found);
+        }
+
+      target.entries.push_front(entry{key, std::move(value), cost});
+      target.index.emplace(key, target.entries.begin());
+      target.size += cost;
+      evict(target);
+      }
+
+    /**
+     * @brief Remove the entry associated with the given key, if any
+     *
+     * @since 1.0
+     */
+    void erase(Key const & key)
+      {
+      auto & target = shard_for(key);
+      auto lock = std::lock_guard<std::mutex>{target.mutex};
+
+      auto const found = target.index.find(key);
+      if(found != target.index.end())
+        {
+        target.size -= found->second->cost;
+        target.entries.erase(found->second);
+        target.index.erase(found);
+        }
+      }
+
+    /**
+     * @brief Remove all entries from the cache
+     *
+     * @since 1.0
+     */
+    void clear()
+      {
+      for_each_shard([](shard & target){
+        target.entries.clear();
+        target.index.clear();
+        target.size = 0;
+      });
+      }
+
+    /**
+     * @brief Change the capacity of the cache
+     *
+     * If the new capacity is smaller than the current size of the cache, entries are evicted immediately.
+     *
+     * @since 1.0
+     */
+    void resize(std::size_t const capacity)
+      {
+      auto const shardCapacity = capacity >> m_shardBits;
+      for_each_shard([&](shard & target){
+        target.capacity = shardCapacity;
+        evict(target);
+      });
+      }
+
+    /**
+     * @brief Get a snapshot of the statistics of the cache
+     *
+     * @since 1.0
+     */
+    cache_statistics statistics() const
+      {
+      auto result = cache_statistics{};
+      for_each_shard([&](shard const & target){
+        result.hits += target.hits;
+        result.misses += target.misses;
+        result.evictions += target.evictions;
+        result.entries += target.entries.size();
+        result.size += target.size;
+        result.capacity += target.capacity;
+      });
+      return result;
+      }
+
+    private:
+      struct entry
+        {
+        Key key;
+        Value value;
+        std::size_t cost;
+        };
+
+      struct shard
+        {
+        std::mutex mutex{};
+        std::list<entry> entries{};
+        std::unordered_map<Key, typename std::list<entry>::iterator, Hash> index{};
+        std::size_t size{};
+        std::size_t capacity{};
+        u64 hits{};
+        u64 misses{};
+        u64 evictions{};
+        };
+
+      static unsigned bits_for(std::size_t const shards)
+        {
+        auto bits = 0u;
+        while((std::size_t{1} << bits) < shards)
+          {
+          ++bits;
+          }
+        return bits;
+        }
+
+      shard & shard_for(Key const & key) const
+        {
+        if(!m_shardBits)
+          {
+          return m_shards[0];
+          }
+
+        auto const mixed = static_cast<u64>(Hash{}(key)) * 0x9e3779b97f4a7c15ull;
+        return m_shards[mixed >> (64 - m_shardBits)];
+        }
+
+      template<typename Function>
+      void for_each_shard(Function && function) const
+        {
+        for(auto index = std::size_t{}; index < (std::size_t{1} << m_shardBits); ++index)
+          {
+          auto lock = std::lock_guard<std::mutex>{m_shards[index].mutex};
+          function(m_shards[index]);
+          }
+        }
+
+      static void evict(shard & target)
+        {
+        while(target.size > target.capacity && !target.entries.empty())
+          {
+          auto const & victim = target.entries.back();
+          target.size -= victim.cost;
+          target.index.erase(victim.key);
+          target.entries.pop_back();
+          ++target.evictions;
+          }
+        }
+
+      unsigned const m_shardBits;
+      std::unique_ptr<shard[]> const m_shards;
+    };
+
+  }
+
+#endif
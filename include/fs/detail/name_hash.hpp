@@ -0,0 +1,61 @@
+#ifndef EXTFS_NAME_HASH_HPP
+#define EXTFS_NAME_HASH_HPP
+
+#include "fs/detail/types.hpp"
+
+#include <string_view>
+#include <type_traits>
+
+namespace fs::detail
+  {
+
+  /**
+   * @brief The algorithms used to hash the names of directory entries
+   *
+   * The unsigned variants interpret the bytes of a name as unsigned characters. They are selected by the
+   * superblock::flag::unsigned_directory_hash flag, and are never stored on disk.
+   *
+   * @since 1.0
+   */
+  enum struct hash_algorithm : u08
+    {
+    legacy = 0, ///< The legacy "dx hack" hash
+    half_md4 = 1, ///< A cut down version of MD4
+    tea = 2, ///< The tiny encryption algorithm
+    legacy_unsigned = 3, ///< The legacy hash with unsigned characters
+    half_md4_unsigned = 4, ///< The half MD4 hash with unsigned characters
+    tea_unsigned = 5, ///< The tiny encryption algorithm with unsigned characters
+    };
+
+  /**
+   * @brief The underlying type of #hash_algorithm
+   *
+   * @since 1.0
+   */
+  using hal = std::underlying_type_t<hash_algorithm>;
+
+  /**
+   * @brief The hash of a directory entry name
+   *
+   * @since 1.0
+   */
+  struct name_hash
+    {
+    u32 major; ///< The hash used to order the entries of a hash tree. The lowest bit is always clear.
+    u32 minor; ///< The secondary hash, used to disambiguate collisions of the major hash
+    };
+
+  /**
+   * @brief Hash the name of a directory entry
+   *
+   * @param name The name to hash
+   * @param algorithm The algorithm to use
+   * @param seed The hash seed of the file system. If all words of the seed are zero, the default seed is used.
+   *
+   * @since 1.0
+   */
+  name_hash hash_name(std::string_view const name, hash_algorithm const algorithm, u32_arr<4> const & seed);
+
+  }
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef EXTFS_POPCOUNT_HPP
+#define EXTFS_POPCOUNT_HPP
+
+#include "fs/detail/types.hpp"
+
+#include <cstddef>
+
+namespace fs::detail
+  {
+
+  /**
+   * @brief The available implementations of #popcount()
+   *
+   * @since 1.0
+   */
+  enum struct popcount_kernel
+    {
+    scalar, ///< Portable 64-bit population counts
+    avx2, ///< Nibble lookups via AVX2 byte shuffles
+    avx512, ///< Native 64-bit population counts via AVX-512 VPOPCNTDQ
+    };
+
+  /**
+   * @brief Check if the current processor supports the given kernel
+   *
+   * @since 1.0
+   */
+  bool supported(popcount_kernel const kernel);
+
+  /**
+   * @brief Get the fastest kernel supported by the current processor
+   *
+   * The kernel is selected once, on first use.
+   *
+   * @since 1.0
+   */
+  popcount_kernel best_popcount_kernel();
+
+  /**
+   * @brief Count the set bits in the given bytes using the fastest supported kernel
+   *
+   * @since 1.0
+   */
+  u64 popcount(u08 const * const data, std::size_t const length);
+
+  /**
+   * @brief Count the set bits in the given bytes using the given kernel
+   *
+   * @note The kernel must be #supported() by the current processor.
+   * @since 1.0
+   */
+  u64 popcount(u08 const * const data, std::size_t const length, popcount_kernel const kernel);
+
+  /**
+   * @brief Count the set bits among the first @p bitsCount bits of an on-disk bitmap
+   *
+   * Bits are numbered starting at the least significant bit of the first byte, as in all ext2/3/4 bitmaps. Any bits
+   * following the first @p bitsCount bits are ignored.
+   *
+   * @since 1.0
+   */
+  u64 count_set_bits(u08 const * const bitmap, std::size_t const bitsCount);
+
+  }
+
+#endif
@@ -147,6 +147,9 @@ namespace fs::detail
       large_file = 2, ///< The file system supports large files
       binary_tree_directories = 4, ///< The file system uses sorted binary trees for directories
       huge_file = 8, ///< The file system contains files represented by the number of logical blocks (e.g. HUGE files)
+      group_descriptor_checksum = 16, ///< The group descriptors are protected by a CRC16 checksum
+      directory_link_count = 32, ///< Directories may contain more than 65000 subdirectories
+      metadata_checksum = 1024, ///< All metadata is protected by CRC32C checksums
       };
 
     /**
@@ -183,6 +186,25 @@ namespace fs::detail
      */
     using cpr = std::underlying_type_t<compression_algorithm>;
 
+    /**
+     * @brief Miscellaneous flags of ext2/3/4 file systems
+     *
+     * @since 1.0
+     */
+    enum struct flag : u32
+      {
+      signed_directory_hash = 1, ///< Directory hashes treat the bytes of a name as signed characters
+      unsigned_directory_hash = 2, ///< Directory hashes treat the bytes of a name as unsigned characters
+      test_file_system = 4, ///< The file system is used to test development code
+      };
+
+    /**
+     * @brief The underlying type of #flag
+     *
+     * @since 1.0
+     */
+    using flg = std::underlying_type_t<flag>;
+
     u32 inodes_count{}; ///< The total number of inodes in the file system
     u32 blocks_count{}; ///< The total number of blocks in the file system
     u32 reserved_blocks_count{}; ///< The number of blocks reserved for the super user
@@ -220,17 +242,57 @@ namespace fs::detail
     cpr compression_algorithms_bitmap{}; ///< The compression algorithms used in the file system
     u08 file_preallocated_blocks_count{}; ///< The number of blocks to preallocate for a file
     u08 directory_preallocated_blocks_count{}; ///< The number of block to preallocate for a directory
-    u16 _padding{}; ///< Alignment padding
+    u16 reserved_descriptor_blocks_count{}; ///< The number of blocks reserved after the group descriptors for future growth
     u08_arr<16> journal_superblock_uuid{}; ///< The UUID of the superblock containing the journal
     u32 journal_inode_id{}; ///< The ID of the inode hosting the journal
     u32 journal_device_number{}; ///< The device number of the journal
     u32 last_orphan_inode_id{}; ///< The first inode in the list of inodes to delete
     u32_arr<4> hash_seed{}; ///< The seed for the directory hashing algorithm
     u08 hash_version{}; ///< The version of the directory hashing algorithm
-    u08_arr<3> _reserved0{}; ///< Alignment padding
+    u08 journal_backup_type{}; ///< The way the journal inode is backed up in #journal_blocks
+    u16 group_descriptor_size{}; ///< The size of a group descriptor in bytes if the file system is a 64-bit file system
     u32 default_mount_options{}; ///< The default mount options for the file system
     u32 first_meta_block_group_id{}; ///< The ID of the first meta block group
-    u08_arr<760> _reserved1{}; ///< Padding
+    u32 creation_timestamp{}; ///< The unix timestamp of the creation of the file system
+    u32_arr<17> journal_blocks{}; ///< A backup of the block map of the journal inode
+    u32 blocks_count_hi{}; ///< The upper 32 bits of the total number of blocks in a 64-bit file system
+    u32 reserved_blocks_count_hi{}; ///< The upper 32 bits of the number of blocks reserved for the super user
+    u32 free_blocks_count_hi{}; ///< The upper 32 bits of the number of free blocks in the file system
+    u16 minimum_extra_inode_size{}; ///< The number of extra bytes all inodes have
+    u16 desired_extra_inode_size{}; ///< The number of extra bytes new inodes should have
+    u32 flags{}; ///< Miscellaneous flags
+    u16 raid_stride{}; ///< The number of blocks to read or write before moving to the next disk of a RAID
+    u16 multiple_mount_protection_interval{}; ///< The number of seconds to wait during multiple mount protection checks
+    u64 multiple_mount_protection_block_id{}; ///< The block containing the multiple mount protection data
+    u32 raid_stripe_width{}; ///< The number of blocks on all data disks of a RAID
+    u08 logical_flexible_group_size{}; ///< The number of groups in a flexible block group (1 << logical_flexible_group_size)
+    u08 checksum_type{}; ///< The metadata checksum algorithm
+    u16 _reserved0{}; ///< Alignment padding
+    u64 kilobytes_written{}; ///< The number of kilobytes written to the file system during its lifetime
+    u32 snapshot_inode_id{}; ///< The ID of the inode of the active snapshot
+    u32 snapshot_id{}; ///< The sequential ID of the active snapshot
+    u64 snapshot_reserved_blocks_count{}; ///< The number of blocks reserved for the active snapshot
+    u32 snapshot_list_inode_id{}; ///< The ID of the inode at the head of the snapshot list
+    u32 error_count{}; ///< The number of errors seen
+    u32 first_error_timestamp{}; ///< The unix timestamp of the first error
+    u32 first_error_inode_id{}; ///< The ID of the inode involved in the first error
+    u64 first_error_block_id{}; ///< The ID of the block involved in the first error
+    chr_arr<32> first_error_function{}; ///< The name of the function in which the first error occured
+    u32 first_error_line{}; ///< The line number at which the first error occured
+    u32 last_error_timestamp{}; ///< The unix timestamp of the last error
+    u32 last_error_inode_id{}; ///< The ID of the inode involved in the last error
+    u32 last_error_line{}; ///< The line number at which the last error occured
+    u64 last_error_block_id{}; ///< The ID of the block involved in the last error
+    chr_arr<32> last_error_function{}; ///< The name of the function in which the last error occured
+    chr_arr<64> mount_options{}; ///< The default mount options as a string
+    u32 user_quota_inode_id{}; ///< The ID of the inode used for user quota tracking
+    u32 group_quota_inode_id{}; ///< The ID of the inode used for group quota tracking
+    u32 overhead_blocks_count{}; ///< The number of blocks used by file system metadata
+    u32_arr<2> backup_group_ids{}; ///< The groups containing backup superblocks if compatible_feature::sparse_superblock_v2 is active
+    u08_arr<28> _reserved1{}; ///< Encryption and quota fields that are not supported by this implementation
+    u32 checksum_seed{}; ///< The metadata checksum seed, if incompatible_feature::metadata_checksum_seed_in_superblock is active
+    u08_arr<392> _reserved2{}; ///< Padding
+    u32 checksum{}; ///< The checksum of the superblock
 
     /**
      * @brief Check if the file system has the desired "compatible feature"
@@ -322,6 +384,15 @@ namespace fs::detail
      */
     bool has_any(std::initializer_list<read_only_compatible_feature> const features) const;
 
+    /**
+     * @brief Check if the superblock has the desired flag set
+     *
+     * @param flag The #flag to check for
+     * @return @p true iff. the flag is set, @p false otherwise
+     * @since 1.0
+     */
+    bool has(flag const flag) const;
+
     };
 
   static_assert(sizeof(superblock) == 1024, "An ext2/3/4 super block must have an exact size of 1024 bytes!");
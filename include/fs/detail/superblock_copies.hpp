@@ -0,0 +1,81 @@
+#ifndef EXTFS_SUPERBLOCK_COPIES_HPP
+#define EXTFS_SUPERBLOCK_COPIES_HPP
+
+#include "fs/detail/block_device.hpp"
+#include "fs/detail/geometry.hpp"
+#include "fs/detail/superblock.hpp"
+#include "fs/detail/types.hpp"
+
+#include <vector>
+
+namespace fs::detail
+  {
+
+  /**
+   * @brief A copy of the superblock, as found on the device
+   *
+   * @since 1.0
+   */
+  struct superblock_copy
+    {
+    u32 group{}; ///< The ID of the group hosting the copy
+    u64 offset{}; ///< The absolute byte offset of the copy
+    bool readable{}; ///< Whether the copy could be read from the device
+    bool valid{}; ///< Whether the copy carries the ext2/3/4 magic number and, if it uses metadata checksums, a valid checksum
+    superblock contents{}; ///< The contents of the copy, if it could be read
+    std::vector<char const *> differences{}; ///< The names of the fields the copy disagrees with the reference on
+
+    /**
+     * @brief Check if the copy is valid and agrees with the reference superblock
+     *
+     * @since 1.0
+     */
+    bool consistent() const;
+    };
+
+  /**
+   * @brief Compare the fields of two superblocks that must be equal in all copies
+   *
+   * Only the kernel's copy of the superblock is updated while a file system is mounted, so the summary counters, the
+   * timestamps and the mount state of backups are usually outdated. Like @p e2fsck, the comparison is thus limited to the
+   * fields that describe the layout and identity of the file system. The feature flags that the kernel sets on its own
+   * are ignored.
+   *
+   * @return The names of all fields that differ
+   *
+   * @since 1.0
+   */
+  std::vector<char const *> compare_superblocks(superblock const & reference, superblock const & copy);
+
+  /**
+   * @brief Read all copies of the superblock of a file system
+   *
+   * The copies are located using the given geometry, and all of them are read as a single I/O batch. Every copy is checked
+   * and compared to the reference superblock. The copy the reference was read from is not included.
+   *
+   * @param device The device to read the copies from
+   * @param layout The geometry of the file system
+   * @param reference The superblock to compare the copies to
+   * @return The copies in ascending group order
+   *
+   * @since 1.0
+   */
+  std::vector<superblock_copy> read_superblock_copies(block_device const & device, geometry const & layout,
+                                                      superblock const & reference);
+
+  /**
+   * @brief Look for the first backup superblock without knowing the geometry of the file system
+   *
+   * If the primary superblock is damaged, the location of its backups is unknown. Like @p e2fsck, this function assumes
+   * the default of 8 blocks per group per byte of a block, and reads the copy in group 1 for every possible block size
+   * as a single I/O batch.
+   *
+   * @return All copies that carry the ext2/3/4 magic number, in ascending block size order
+   *
+   * @since 1.0
+   */
+  std::vector<superblock_copy> probe_superblock_copies(block_device const & device);
+
+  }
+
+#endif
@@ -7,6 +7,7 @@
 namespace fs::detail
   {
 
+  using u64 = std::uint64_t; ///< An unsigned 64-bit integer
   using u32 = std::uint32_t; ///< An unsigned 32-bit integer
   using s32 = std::int32_t; ///< A signed 32-bit integer
   using u16 = std::uint16_t; ///< An unsigned 16-bit integer
@@ -0,0 +1,99 @@
+#ifndef EXTFS_VIEW_HPP
+#define EXTFS_VIEW_HPP
+
+#include "fs/detail/block_device.hpp"
+
+#include <type_traits>
+#include <utility>
+
+namespace fs::detail
+  {
+
+  /**
+   * @brief A typed, read-only view of on-disk data
+   *
+   * A view interprets a chunk of #bytes as an instance of an on-disk structure, without copying the underlying data. Views
+   * share ownership of the bytes they refer to, and thus stay valid even if the device they were read from is closed.
+   *
+   * @tparam Type The on-disk structure to interpret the bytes as
+   *
+   * @since 1.0
+   */
+  template<typename Type>
+  struct view
+    {
+    static_assert(std::is_trivially_copyable_v<Type>, "Only trivially copyable types can be viewed!");
+
+    /**
+     * @brief Create an empty view
+     *
+     * @since 1.0
+     */
+    view() = default;
+
+    /**
+     * @brief Create a view of the given bytes
+     *
+     * @param data The bytes to view. The caller must ensure that at least @p sizeof(Type) bytes are available.
+     *
+     * @since 1.0
+     */
+    explicit view(bytes data) : m_data{std::move(data)} { }
+
+    /**
+     * @brief Check if the view refers to any data
+     *
+     * @since 1.0
+     */
+    explicit operator bool() const
+      {
+      return static_cast<bool>(m_data);
+      }
+
+    /**
+     * @brief Access the viewed structure
+     *
+     * @since 1.0
+     */
+    Type const & operator*() const
+      {
+      return *get();
+      }
+
+    /**
+     * @brief Access the members of the viewed structure
+     *
+     * @since 1.0
+     */
+    Type const * operator->() const
+      {
+      return get();
+      }
+
+    /**
+     * @brief Get a pointer to the viewed structure
+     *
+     * @since 1.0
+     */
+    Type const * get() const
+      {
+      return reinterpret_cast<Type const *>(m_data.get());
+      }
+
+    /**
+     * @brief Get the bytes backing this view
+     *
+     * @since 1.0
+     */
+    bytes const & data() const
+      {
+      return m_data;
+      }
+
+    private:
+      bytes m_data{};
+    };
+
+  }
+
+#endif
@@ -1,10 +1,41 @@
 #ifndef EXTFS_EXTFS_HPP
 #define EXTFS_EXTFS_HPP
 
+#include "fs/detail/bitmap_scan.hpp"
+#include "fs/detail/block_allocator.hpp"
+#include "fs/detail/block_device.hpp"
+#include "fs/detail/block_map.hpp"
+#include "fs/detail/block_run.hpp"
+#include "fs/detail/buffer_cache.hpp"
+#include "fs/detail/bulk_read.hpp"
+#include "fs/detail/cache_statistics.hpp"
+#include "fs/detail/checksum.hpp"
+#include "fs/detail/dentry.hpp"
+#include "fs/detail/directory.hpp"
+#include "fs/detail/extended_attributes.hpp"
+#include "fs/detail/free_extents.hpp"
+#include "fs/detail/geometry.hpp"
+#include "fs/detail/group_descriptor_table.hpp"
+#include "fs/detail/group_prefetch.hpp"
+#include "fs/detail/inline_data.hpp"
+#include "fs/detail/inode.hpp"
+#include "fs/detail/inode_scan.hpp"
+#include "fs/detail/journal.hpp"
+#include "fs/detail/lru_cache.hpp"
 #include "fs/detail/superblock.hpp"
+#include "fs/detail/superblock_copies.hpp"
+#include "fs/detail/types.hpp"
+#include "fs/detail/view.hpp"
+#include "fs/file_reader.hpp"
+#include "fs/tree_walk.hpp"
 
-#include <fstream>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <vector>
 
 namespace fs
   {
@@ -15,6 +46,14 @@ namespace fs
    * This abstraction provides a top-level interface to an ext* family file system. It grants access to information like the
    * size of the file system, the space left on the file system as well as the label.
    *
+   * All on-disk data is accessed through a #fs::detail::block_device. File systems opened in read_only mode are memory
+   * mapped whenever possible, so that metadata can be viewed in place instead of being copied.
+   *
+   * @par Thread safety
+   * Reads never depend on a shared file position. A file system that was opened in read_only mode can therefore be shared
+   * between any number of threads, all of which may call any @p const member function concurrently. Constructing,
+   * moving and destroying a file system, as well as all non-@p const member functions, require exclusive access.
+   *
    * @since 1.0
    */
   struct extfs
@@ -30,6 +69,33 @@ namespace fs
       writeable, ///< Open in read-write mode
       };
 
+    /**
+     * @brief The default number of entries per batch of #list_with_attributes()
+     *
+     * @since 1.0
+     */
+    static auto constexpr kListingBatchSize = std::size_t{1024};
+
+    /**
+     * @brief Tuning parameters of the file system
+     *
+     * @since 1.0
+     */
+    struct settings
+      {
+      std::size_t inode_cache_size{std::size_t{4} << 20}; ///< The maximum number of bytes used to cache inodes
+      std::size_t block_map_cache_size{std::size_t{4} << 20}; ///< The maximum number of bytes used to cache resolved block maps
+      std::size_t dentry_cache_size{std::size_t{1} << 20}; ///< The maximum number of bytes used to cache directory entries
+      std::size_t buffer_cache_size{std::size_t{8} << 20}; ///< The maximum number of bytes used to cache blocks
+      std::size_t attribute_block_cache_size{std::size_t{1} << 20}; ///< The maximum number of bytes used to cache extended attribute blocks
+      bool memory_map{true}; ///< Whether to memory map file systems opened in read_only mode
+      std::size_t io_queue_depth{64}; ///< The maximum number of asynchronous reads in flight on devices that are not mapped
+      bool verify_checksums{true}; ///< Whether to verify the metadata checksums of file systems that have them
+      detail::u64 superblock_offset{}; ///< The byte offset of the superblock copy to open the file system from, or 0 for the primary superblock
+      bool overlay_journal{true}; ///< Whether to read file systems opened in read_only mode that need recovery through their journal
+      bool prefetch_flexible_groups{true}; ///< Whether to prefetch the metadata of a whole flexible block group when the first of its inodes is loaded
+      };
+
     /**
      * @brief Open the filesystem at a given path
      *
@@ -43,6 +109,17 @@ namespace fs
      */
     explicit extfs(std::string const & path, mode const openMode = mode::read_only);
 
+    /**
+     * @brief Open the filesystem at a given path using custom settings
+     *
+     * @param path The path to a device/file containing an ext* file system.
+     * @param openMode Whether to open the file system in read_only or writeable mode.
+     * @param configuration The settings to use for the file system
+     *
+     * @since 1.0
+     */
+    extfs(std::string const & path, mode const openMode, settings const & configuration);
+
     /**
      * @brief Check if the filesystem is open.
      *
@@ -77,9 +154,519 @@ namespace fs
      */
     bool has_label() const;
 
+    /**
+     * @brief Get the number of block groups in the file system
+     *
+     * @return The number of block groups, or 0 if the file system is not open
+     *
+     * @since 1.0
+     */
+    detail::u32 groups_count() const;
+
+    /**
+     * @brief Get the description of a block group
+     *
+     * Group descriptors are read lazily. Opening a file system does not read any of them, and accessing a group only reads
+     * the single block containing its descriptor, the first time any group described by that block is accessed.
+     *
+     * @param id The ID of the block group, starting at 0
+     * @return The description of the group, or an empty optional if the group does not exist or could not be read
+     *
+     * @since 1.0
+     */
+    std::optional<detail::block_group> group(detail::u32 const id) const;
+
+    /**
+     * @brief Get an inode
+     *
+     * Inodes are located via the group descriptor of the group they belong to and are kept in a bounded, sharded LRU cache,
+     * so that repeated lookups of the same inodes do not need to access the device. The size of the cache is configured via
+     * #settings::inode_cache_size.
+     *
+     * @param id The ID of the inode, starting at 1
+     * @return A view of the inode, or an empty view if the inode does not exist or could not be read. The view covers the
+     * complete on-disk inode, but at least @p sizeof(detail::inode) bytes. Bytes beyond the on-disk inode are zero.
+     *
+     * @since 1.0
+     */
+    detail::view<detail::inode> inode(detail::u32 const id) const;
+
+    /**
+     * @brief Hint that a number of inodes will be read soon
+     *
+     * The inode table blocks holding the inodes are sorted and adjacent blocks are merged, so that the device receives one
+     * hint per contiguous range of the inode tables.
+     *
+     * @param inodeIds The IDs of the inodes that will be read
+     *
+     * @since 1.0
+     */
+    void prefetch_inodes(std::vector<detail::u32> inodeIds) const;
+
+    /**
+     * @brief Load the bitmaps and inode tables of a range of groups with few large reads
+     *
+     * The metadata blocks of the groups are joined into extents via detail::group_metadata_extents(). File systems that
+     * are not memory mapped load each extent into their buffer cache, so that the following reads of single inodes and
+     * bitmaps are served from memory. Memory mapped file systems hint the device about each extent instead.
+     *
+     * If #settings::prefetch_flexible_groups is set, the metadata of a whole flexible block group is prefetched
+     * automatically the first time an inode of one of its groups is loaded.
+     *
+     * @param firstGroup The ID of the first group
+     * @param endGroup The ID of the group following the last group
+     *
+     * @since 1.0
+     */
+    void prefetch_group_metadata(detail::u32 const firstGroup, detail::u32 const endGroup) const;
+
+    /**
+     * @brief Get the statistics of the group metadata prefetches
+     *
+     * @since 1.0
+     */
+    detail::group_prefetch_statistics group_prefetch_statistics() const;
+
+    /**
+     * @brief Create a sequential scan over the inode tables of a range of groups
+     *
+     * The scan reads the inode tables in large chunks and skips inode tables, or parts thereof, that were never
+     * initialized. Scanned inodes bypass the inode cache.
+     *
+     * @param firstGroup The ID of the first group to scan
+     * @param endGroup The ID of the group after the last group to scan
+     * @return The scan, or an empty optional if the file system is not open
+     *
+     * @since 1.0
+     */
+    std::optional<detail::inode_scan> inode_scanner(detail::u32 const firstGroup = 0,
+                                                    detail::u32 const endGroup = ~detail::u32{}) const;
+
+    /**
+     * @brief Scan all inode tables of the file system in parallel
+     *
+     * The groups are distributed across a number of threads, each of which scans its groups using a detail::inode_scan.
+     *
+     * @param visitor The function to call for every inode. It is called concurrently from multiple threads.
+     * @param threads The number of threads to scan with, or @p 0 to use one thread per processor
+     * @return @p true, iff. the file system is open and all inode tables could be read, @p false otherwise
+     *
+     * @since 1.0
+     */
+    bool scan_inodes(detail::inode_visitor const & visitor, unsigned const threads = 0) const;
+
+    /**
+     * @brief Get the statistics of the inode cache
+     *
+     * @since 1.0
+     */
+    detail::cache_statistics inode_cache_statistics() const;
+
+    /**
+     * @brief Map a range of logical blocks of an inode to physical blocks
+     *
+     * Inodes using extents are resolved through a detail::extent_status, all other inodes through a detail::indirect_map.
+     * Either way, the resolved block map is kept in a per-inode cache, so that repeated and sequential resolutions do not
+     * read the same mapping metadata again. The size of the cache is configured via #settings::block_map_cache_size.
+     *
+     * @param inodeId The ID of the inode
+     * @param firstBlock The first logical block to map
+     * @param blocksCount The number of blocks to map
+     * @return The runs covering the requested range in ascending logical order. Holes are reported as sparse runs. If the
+     * inode does not exist, its block map is corrupted or the inode does not map its content to blocks, an empty optional
+     * is returned.
+     *
+     * @since 1.0
+     */
+    std::optional<std::vector<detail::block_run>> resolve(detail::u32 const inodeId,
+                                                          detail::u64 const firstBlock,
+                                                          detail::u64 const blocksCount) const;
+
+    /**
+     * @brief Read the content of an inode
+     *
+     * The requested range is mapped to physical blocks in one go. Physically contiguous blocks are read with a single
+     * request straight into @p buffer, and holes as well as uninitialized extents are filled with zeroes without accessing
+     * the device. The content of inodes that store their data inline is copied straight from the cached inode.
+     *
+     * @param inodeId The ID of the inode
+     * @param offset The byte offset within the content of the inode to start reading at
+     * @param buffer The buffer to read into. It must be at least @p length bytes large.
+     * @param length The maximum number of bytes to read
+     * @return The number of bytes read, which is less than @p length if the content ends before, or an empty optional if
+     * the inode does not exist or its content could not be read
+     *
+     * @since 1.0
+     */
+    std::optional<std::size_t> read(detail::u32 const inodeId,
+                                    detail::u64 const offset,
+                                    void * const buffer,
+                                    std::size_t const length) const;
+
+    /**
+     * @brief Hint that a range of the content of an inode will be read soon
+     *
+     * @param inodeId The ID of the inode
+     * @param offset The byte offset within the content of the inode
+     * @param length The number of bytes that will be read
+     *
+     * @since 1.0
+     */
+    void prefetch(detail::u32 const inodeId, detail::u64 const offset, detail::u64 const length) const;
+
+    /**
+     * @brief Read the content of many inodes in the order it is stored on the device
+     *
+     * The inodes are resolved up front, and their content is then read via detail::read_bulk(), which orders the reads by
+     * physical position across all inodes. The content of inodes that store their data inline is delivered, and the inodes
+     * are completed, before any content is read from the device. Inodes that do not exist, or whose content can not be
+     * located, are reported as failed before any content is read from the device.
+     *
+     * @param inodeIds The IDs of the inodes to read
+     * @param sink The function receiving the pieces of content. It returns whether to continue.
+     * @param completion The function to call once an inode was read completely or failed to be read. May be empty.
+     * @return The statistics of the read, or an empty optional if the file system is not open
+     *
+     * @since 1.0
+     */
+    std::optional<detail::bulk_read_statistics> read_bulk(std::vector<detail::u32> const & inodeIds,
+                                                          detail::content_sink const & sink,
+                                                          detail::completion_sink const & completion = {}) const;
+
+    /**
+     * @brief Create a streaming reader for the content of an inode
+     *
+     * @param inodeId The ID of the inode
+     *
+     * @since 1.0
+     */
+    file_reader reader(detail::u32 const inodeId) const;
+
+    /**
+     * @brief Get the statistics of the block map cache
+     *
+     * @since 1.0
+     */
+    detail::cache_statistics block_map_cache_statistics() const;
+
+    /**
+     * @brief Find an entry of a directory by name
+     *
+     * Directories with a hash tree index are searched by descending the tree, which only reads one block per level of the
+     * tree and the leaf block holding the name. All other directories, as well as directories with a corrupted index, are
+     * searched linearly. The results of all searches, including searches for names that do not exist, are kept in a bounded
+     * dentry cache. The size of the cache is configured via #settings::dentry_cache_size.
+     *
+     * @param directoryId The ID of the directory inode
+     * @param name The name of the entry
+     * @return The ID of the inode the entry refers to, 0 if the directory contains no entry of the given name, or an empty
+     * optional if the inode is not a directory or could not be read
+     *
+     * @since 1.0
+     */
+    std::optional<detail::u32> find(detail::u32 const directoryId, std::string_view const name) const;
+
+    /**
+     * @brief Resolve an absolute path to an inode
+     *
+     * The path is resolved component by component, starting at the root directory. Every component is looked up via
+     * #find(), so that paths sharing a common prefix resolve the prefix from the dentry cache. Empty components and
+     * components consisting of a single dot are skipped. Symbolic links are not followed.
+     *
+     * @param path The absolute path to resolve
+     * @return The ID of the inode the path refers to, 0 if any component of the path does not exist, or an empty optional
+     * if the path is not absolute, a component other than the last is not a directory, or a directory could not be read
+     *
+     * @since 1.0
+     */
+    std::optional<detail::u32> lookup(std::string_view const path) const;
+
+    /**
+     * @brief List all entries of a directory
+     *
+     * The blocks of the directory are read in logical order, and the entries of every block are passed to the visitor in
+     * the order they are stored in, including the entries "." and "..". Directories with a hash tree index are listed the
+     * same way, since the index is stored in entries that are never used. Directories that store their entries inline are
+     * listed from the cached inode, starting with the entries "." and "..", which they do not store. If the file system
+     * does not record file types in directory entries, all entries are reported with an unknown type.
+     *
+     * @param directoryId The ID of the directory inode
+     * @param visitor The function to call for every entry. It returns whether to continue with the next entry.
+     * @return @p true, iff. the directory was listed completely or the visitor stopped early, @p false if the inode is not
+     * a directory or a block of the directory could not be read
+     *
+     * @since 1.0
+     */
+    bool list(detail::u32 const directoryId, detail::entry_visitor const & visitor) const;
+
+    /**
+     * @brief List all entries of a directory together with their inodes
+     *
+     * The entries are collected in batches. The inodes of a batch are located in the inode tables and read in the order
+     * they are stored in, so that listing a large directory reads the inode tables front to back instead of jumping
+     * between them. Inodes that lie close together are read as a single range, and inodes found in the inode cache are not
+     * read at all. All inodes read are added to the inode cache. Entries of an unknown type are assigned the type of their
+     * inode.
+     *
+     * If only the names and types of the entries are needed, #list() does not read any inodes on file systems that record
+     * file types in directory entries.
+     *
+     * @param directoryId The ID of the directory inode
+     * @param visitor The function to call for every batch of entries. It returns whether to continue with the next batch.
+     * @param batchSize The maximum number of entries per batch
+     * @return @p true, iff. the directory was listed completely or the visitor stopped early, @p false if the inode is not
+     * a directory or a block of the directory or an inode could not be read
+     *
+     * @since 1.0
+     */
+    bool list_with_attributes(detail::u32 const directoryId, detail::listing_visitor const & visitor,
+                              std::size_t const batchSize = kListingBatchSize) const;
+
+    /**
+     * @brief Walk the directory tree below a directory in parallel
+     *
+     * See #fs::walk_tree() for details.
+     *
+     * @param directoryId The ID of the directory to start at
+     * @param visitor The function to call for every entry. It is called concurrently from multiple threads.
+     * @param threads The number of threads to walk with, or @p 0 to use one thread per processor
+     * @return The statistics of the walk, or an empty optional if the file system is not open or the inode is not a
+     * directory
+     *
+     * @since 1.0
+     */
+    std::optional<walk_statistics> walk(detail::u32 const directoryId, walk_visitor const & visitor,
+                                        unsigned const threads = 0) const;
+
+    /**
+     * @brief Get the statistics of the dentry cache
+     *
+     * @since 1.0
+     */
+    detail::cache_statistics dentry_cache_statistics() const;
+
+    /**
+     * @brief List all extended attributes of an inode
+     *
+     * Attributes stored in the extra space of the inode are taken straight from the cached inode and are listed first. The
+     * remaining attributes are stored in an extended attribute block, which ext4 shares between all inodes with identical
+     * attributes. These blocks are kept in a dedicated cache keyed by their block ID, so that the attributes of any number
+     * of inodes sharing a block are read from the device only once. The size of the cache is configured via
+     * #settings::attribute_block_cache_size. Values stored in separate inodes are read from their inode. Attributes of
+     * unknown namespaces are skipped.
+     *
+     * @param inodeId The ID of the inode
+     * @param visitor The function to call for every attribute. It returns whether to continue with the next attribute.
+     * @return @p true, iff. all attributes were listed or the visitor stopped early, @p false if the inode does not exist
+     * or its attributes could not be read
+     *
+     * @since 1.0
+     */
+    bool list_extended_attributes(detail::u32 const inodeId, detail::attribute_visitor const & visitor) const;
+
+    /**
+     * @brief Get the value of an extended attribute of an inode
+     *
+     * The attribute is searched for the same way as in #list_extended_attributes(), but only the value of the requested attribute
+     * is copied.
+     *
+     * @param inodeId The ID of the inode
+     * @param name The full name of the attribute, e.g. @p security.selinux or @p system.posix_acl_access
+     * @return The value of the attribute, or an empty optional if the inode has no such attribute or its attributes could
+     * not be read
+     *
+     * @since 1.0
+     */
+    std::optional<std::vector<detail::u08>> extended_attribute(detail::u32 const inodeId, std::string_view const name) const;
+
+    /**
+     * @brief Get the statistics of the extended attribute block cache
+     *
+     * @since 1.0
+     */
+    detail::cache_statistics attribute_block_cache_statistics() const;
+
+    /**
+     * @brief Get the statistics of the block buffer cache
+     *
+     * File systems that are not memory mapped read all metadata blocks through a shared detail::buffer_cache. Memory mapped
+     * file systems access metadata in place and do not use the buffer cache at all. The size of the cache is configured via
+     * #settings::buffer_cache_size.
+     *
+     * @since 1.0
+     */
+    detail::cache_statistics buffer_cache_statistics() const;
+
+    /**
+     * @brief Get the write statistics of the block buffer cache
+     *
+     * @since 1.0
+     */
+    detail::write_statistics buffer_cache_write_statistics() const;
+
+    /**
+     * @brief Write all modified blocks to the device and make them durable
+     *
+     * File systems opened in writeable mode buffer all modifications in the detail::buffer_cache, which writes them back
+     * when it runs out of space and when the file system is destroyed. This function writes all of them immediately,
+     * metadata blocks before data blocks, and waits until they reached stable storage.
+     *
+     * @return @p true, iff. the file system was opened in writeable mode and all modified blocks could be written, @p false
+     * otherwise
+     *
+     * @since 1.0
+     */
+    bool sync();
+
+    /**
+     * @brief Allocate blocks for the content of an inode
+     *
+     * The blocks are taken from the detail::block_allocator of the file system. Without an explicit goal, the allocation
+     * aims for the block following the last mapped block of the inode, so that growing files stay contiguous, and falls back
+     * to the first block of the group of the inode for files that do not have any blocks yet.
+     *
+     * @param inodeId The ID of the inode the blocks are allocated for
+     * @param blocksCount The number of blocks to allocate
+     * @param goal The ID of the block the allocation should preferably start at, or @p 0 to derive it from the inode
+     * @return The allocated extents, or an empty vector if the file system is not open in writeable mode, the inode could
+     * not be read, or there are not enough free blocks
+     *
+     * @since 1.0
+     */
+    std::vector<detail::block_extent> allocate_blocks(detail::u32 const inodeId, detail::u64 const blocksCount,
+                                                      detail::u64 const goal = 0);
+
+    /**
+     * @brief Return blocks previously obtained via #allocate_blocks()
+     *
+     * @return @p true, iff. the file system is open in writeable mode and the extent was released
+     *
+     * @since 1.0
+     */
+    bool release_blocks(detail::block_extent const & extent);
+
+    /**
+     * @brief Get the statistics of the block allocator
+     *
+     * @since 1.0
+     */
+    detail::allocator_statistics block_allocator_statistics() const;
+
+    /**
+     * @brief Check if the file system was not unmounted cleanly and its journal needs to be replayed
+     *
+     * @since 1.0
+     */
+    bool needs_recovery() const;
+
+    /**
+     * @brief Get the statistics of the journal scan performed when the file system was opened
+     *
+     * File systems opened in read_only mode that #needs_recovery() are not replayed. Instead, if
+     * #settings::overlay_journal is set, the journal is scanned once when the file system is opened, and every block with a
+     * committed copy in the journal is read from there via a detail::journal_overlay. The file system thus appears in the
+     * state it would be in after recovery, while the device is left untouched.
+     *
+     * @return The statistics of the scan, or an empty optional if the journal was not scanned
+     *
+     * @since 1.0
+     */
+    std::optional<detail::journal_statistics> journal_statistics() const;
+
+    /**
+     * @brief Check if the metadata checksums of the file system are verified
+     *
+     * Checksums are verified if the file system was created with metadata checksums and #settings::verify_checksums is
+     * set. In that case, the superblock is verified when the file system is opened, and group descriptors, bitmaps,
+     * inodes, extent tree blocks, directory blocks and extended attribute blocks are verified whenever they are read from
+     * the device. Metadata that fails verification is treated like metadata that could not be read.
+     *
+     * @since 1.0
+     */
+    bool verifies_checksums() const;
+
+    /**
+     * @brief Get the number of metadata checksums that failed verification so far
+     *
+     * @since 1.0
+     */
+    detail::u64 checksum_failures_count() const;
+
+    /**
+     * @brief Read and check all other copies of the superblock
+     *
+     * Groups hosting a copy of the superblock are determined by the sparse superblock features of the file system. All
+     * copies are read as a single batch, so that their reads proceed in parallel, and are compared against the superblock
+     * the file system was opened with. A file system can be opened from any of the copies via
+     * #settings::superblock_offset.
+     *
+     * @return All other copies in ascending group order, or an empty vector if the file system is not open
+     *
+     * @since 1.0
+     */
+    std::vector<detail::superblock_copy> superblock_copies() const;
+
+    /**
+     * @brief Count the free blocks and inodes of the file system by scanning all allocation bitmaps
+     *
+     * The free counts stored in the superblock and the group descriptors are summary values, which are frequently stale on
+     * file systems that were not unmounted cleanly. This function derives the exact counts from the bitmaps, scanning the
+     * groups in parallel, and reports which of the summary values disagree with them.
+     *
+     * @param threads The number of threads to scan with, or @p 0 to use one thread per processor
+     * @return The exact usage of the file system, or an empty optional if the file system is not open or a bitmap could not
+     * be read
+     *
+     * @since 1.0
+     */
+    std::optional<detail::space_usage> scan_free_space(unsigned const threads = 0) const;
+
+    /**
+     * @brief Build a histogram of the sizes of all free extents of the file system
+     *
+     * The report contains a histogram for every block group as well as one for the whole file system, in which free extents
+     * spanning multiple groups are counted as a single extent. Like #scan_free_space(), the groups are scanned in parallel.
+     *
+     * @param threads The number of threads to scan with, or @p 0 to use one thread per processor
+     * @return The fragmentation report, or an empty optional if the file system is not open or a bitmap could not be read
+     *
+     * @since 1.0
+     */
+    std::optional<detail::fragmentation_report> scan_free_extents(unsigned const threads = 0) const;
+
     private:
-      detail::superblock m_primarySuperblock{};
-      std::fstream m_stream{};
+      void mount(settings const & configuration);
+      void overlay_journal(settings const & configuration);
+      detail::bytes block_of(detail::u32 const inodeId, detail::u32 const inodeSeed, detail::u64 const logicalBlock) const;
+      std::optional<detail::u32> search(detail::u32 const directoryId, std::string_view const name) const;
+      std::optional<detail::u64> inode_offset(detail::u32 const inodeId) const;
+      std::optional<detail::inline_data> inline_content(detail::view<detail::inode> const & node) const;
+      bool list_inline(detail::u32 const directoryId, detail::view<detail::inode> const & node,
+                       detail::entry_visitor const & visitor) const;
+      bool for_each_attribute(detail::u32 const inodeId,
+                              std::function<bool(detail::extended_attribute_entry const & entry,
+                                                 std::string_view const name,
+                                                 detail::u08 const * const value)> const & visitor) const;
+      detail::bytes attribute_block(detail::u64 const blockId) const;
+      std::optional<std::vector<detail::u08>> external_attribute_value(detail::extended_attribute_entry const & entry) const;
+      std::shared_ptr<detail::u08> inode_storage() const;
+      detail::view<detail::inode> cache_inode(detail::u32 const inodeId, std::shared_ptr<detail::u08> storage) const;
+      bool load_attributes(std::vector<detail::listed_entry> & entries) const;
+
+      std::unique_ptr<detail::block_device> m_device{};
+      detail::buffer_cache * m_buffers{};
+      detail::view<detail::superblock> m_primarySuperblock{};
+      detail::geometry m_geometry{};
+      std::unique_ptr<detail::metadata_checksums> m_checksums{};
+      std::unique_ptr<detail::group_descriptor_table> m_groups{};
+      std::unique_ptr<detail::group_prefetcher> m_prefetcher{};
+      bool m_prefetchFlexibleGroups{};
+      std::unique_ptr<detail::lru_cache<detail::u32, detail::view<detail::inode>>> m_inodes{};
+      std::unique_ptr<detail::lru_cache<detail::u32, std::shared_ptr<detail::block_map>>> m_blockMaps{};
+      std::unique_ptr<detail::lru_cache<detail::dentry_key, detail::u32, detail::dentry_key_hash>> m_dentries{};
+      std::unique_ptr<detail::lru_cache<detail::u64, detail::bytes>> m_attributeBlocks{};
+      std::unique_ptr<detail::block_allocator> m_allocator{};
+      std::optional<detail::journal_statistics> m_journal{};
     };
 
   }
@@ -0,0 +1,109 @@
+#ifndef EXTFS_FILE_READER_HPP
+#define EXTFS_FILE_READER_HPP
+
+#include "fs/detail/types.hpp"
+
+#include <cstddef>
+#include <optional>
+
+namespace fs
+  {
+
+  struct extfs;
+
+  /**
+   * @brief A streaming reader for the content of an inode
+   *
+   * The reader keeps track of a current position and detects sequential access. While the content is read sequentially,
+   * the reader hints the device about the upcoming range via extfs::prefetch(), doubling the size of the hinted window on
+   * every step up to #kMaximumReadaheadSize. Any non-sequential access resets the window.
+   *
+   * @par Thread safety
+   * A reader must not be used by multiple threads at the same time. Multiple readers of the same file system can be used
+   * concurrently.
+   *
+   * @since 1.0
+   */
+  struct file_reader
+    {
+    /**
+     * @brief The size of the first readahead window in bytes
+     *
+     * @since 1.0
+     */
+    static auto constexpr kInitialReadaheadSize = std::size_t{128} << 10;
+
+    /**
+     * @brief The maximum size of the readahead window in bytes
+     *
+     * @since 1.0
+     */
+    static auto constexpr kMaximumReadaheadSize = std::size_t{4} << 20;
+
+    /**
+     * @brief Create a reader for the content of an inode
+     *
+     * @param fileSystem The file system containing the inode. It must outlive the reader.
+     * @param inodeId The ID of the inode
+     *
+     * @since 1.0
+     */
+    file_reader(extfs const & fileSystem, detail::u32 const inodeId);
+
+    /**
+     * @brief Read from the current position and advance it by the number of bytes read
+     *
+     * @param buffer The buffer to read into. It must be at least @p length bytes large.
+     * @param length The maximum number of bytes to read
+     * @return The number of bytes read, which is 0 at the end of the content, or an empty optional if the content could not
+     * be read
+     *
+     * @since 1.0
+     */
+    std::optional<std::size_t> read(void * const buffer, std::size_t const length);
+
+    /**
+     * @brief Move the current position
+     *
+     * @since 1.0
+     */
+    void seek(detail::u64 const position);
+
+    /**
+     * @brief Get the current position
+     *
+     * @since 1.0
+     */
+    detail::u64 position() const;
+
+    /**
+     * @brief Get the size of the content of the inode
+     *
+     * @return The size in bytes, or 0 if the inode does not exist
+     *
+     * @since 1.0
+     */
+    detail::u64 size() const;
+
+    /**
+     * @brief Get the size of the current readahead window in bytes
+     *
+     * @since 1.0
+     */
+    std::size_t readahead_size() const;
+
+    private:
+      void read_ahead(std::size_t const length);
+
+      extfs const * m_fileSystem;
+      detail::u32 m_inodeId;
+      detail::u64 m_size{};
+      detail::u64 m_position{};
+      detail::u64 m_readaheadEnd{};
+      std::size_t m_readaheadSize{kInitialReadaheadSize};
+      bool m_sequential{true};
+    };
+
+  }
+
+#endif
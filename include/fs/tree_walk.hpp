@@ -0,0 +1,90 @@
+#ifndef EXTFS_TREE_WALK_HPP
+#define EXTFS_TREE_WALK_HPP
+
+#include "fs/detail/directory.hpp"
+#include "fs/detail/types.hpp"
+
+#include <functional>
+#include <optional>
+#include <string_view>
+
+namespace fs
+  {
+
+  struct extfs;
+
+  /**
+   * @brief An entry encountered while walking a directory tree
+   *
+   * @since 1.0
+   */
+  struct walk_entry
+    {
+    detail::u32 parent_id; ///< The ID of the directory containing the entry
+    detail::u32 inode_id; ///< The ID of the inode the entry refers to
+    std::string_view path; ///< The path of the entry, relative to the root of the walk
+    std::string_view name; ///< The name of the entry
+    detail::directory_entry::file_type type; ///< The type of the file the entry refers to
+    unsigned depth; ///< The depth of the entry, 1 for entries of the root of the walk
+    };
+
+  /**
+   * @brief How to continue after visiting an entry
+   *
+   * @since 1.0
+   */
+  enum struct walk_action : char
+    {
+    descend, ///< Continue, and descend into the entry if it is a directory
+    prune, ///< Continue, but do not descend into the entry
+    stop, ///< Stop the whole walk as soon as possible
+    };
+
+  /**
+   * @brief The function called for every entry encountered while walking a directory tree
+   *
+   * @since 1.0
+   */
+  using walk_visitor = std::function<walk_action(walk_entry const & entry)>;
+
+  /**
+   * @brief The statistics of a completed walk
+   *
+   * @since 1.0
+   */
+  struct walk_statistics
+    {
+    detail::u64 directories_count; ///< The number of directories that were listed
+    detail::u64 entries_count; ///< The number of entries that were visited
+    detail::u64 failures_count; ///< The number of directories that could not be listed
+    detail::u64 steals_count; ///< The number of directories a thread took from the queue of another thread
+    bool stopped; ///< Whether the walk was stopped by the visitor
+    };
+
+  /**
+   * @brief Walk a directory tree in parallel
+   *
+   * Every thread owns a double-ended queue of directories to list. A thread lists the directory at the back of its own
+   * queue and pushes the subdirectories it finds onto the same end, so that it walks its part of the tree depth first.
+   * Threads that run out of directories steal from the front of the queues of other threads, which holds the directories
+   * closest to the root and thus, usually, the largest subtrees. Before visiting the entries of a directory, the inode
+   * table blocks holding their inodes are prefetched via extfs::prefetch_inodes().
+   *
+   * The entries "." and ".." are not visited. Every directory is listed at most once, even if a corrupted file system links
+   * it from multiple places.
+   *
+   * @param fileSystem The file system to walk
+   * @param rootId The ID of the directory to start at. The directory itself is not visited.
+   * @param visitor The function to call for every entry. It is called concurrently from multiple threads and decides
+   * whether to descend into directories.
+   * @param threads The number of threads to walk with, or @p 0 to use one thread per processor
+   * @return The statistics of the walk, or an empty optional if the root is not a directory or could not be read
+   *
+   * @since 1.0
+   */
+  std::optional<walk_statistics> walk_tree(extfs const & fileSystem, detail::u32 const rootId,
+                                           walk_visitor const & visitor, unsigned const threads = 0);
+
+  }
+
+#endif
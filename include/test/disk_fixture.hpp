@@ -0,0 +1,43 @@
+#ifndef EXTFS_TEST_DISK_FIXTURE_HPP
+#define EXTFS_TEST_DISK_FIXTURE_HPP
+
+#include "fs/detail/block_device.hpp"
+#include "fs/detail/checksum.hpp"
+#include "fs/detail/geometry.hpp"
+#include "fs/detail/group_descriptor_table.hpp"
+#include "fs/detail/superblock.hpp"
+#include "fs/detail/view.hpp"
+
+#include <memory>
+#include <stdexcept>
+
+/**
+ * @brief A test disk image, opened together with its geometry and group descriptor table
+ */
+struct disk_fixture
+  {
+  explicit disk_fixture(char const * const path, bool const verify = false) :
+    device{fs::detail::open_block_device(path, false)}
+    {
+    if(!device)
+      {
+      throw std::runtime_error{"Failed to open test disk image!"};
+      }
+
+    superblock = fs::detail::view<fs::detail::superblock>{device->fetch(1024, sizeof(fs::detail::superblock))};
+    layout = fs::detail::geometry{*superblock};
+    if(verify)
+      {
+      checksums = std::make_unique<fs::detail::metadata_checksums>(*superblock);
+      }
+    table = std::make_unique<fs::detail::group_descriptor_table>(*device, layout, checksums.get());
+    }
+
+  std::unique_ptr<fs::detail::block_device> device;
+  fs::detail::view<fs::detail::superblock> superblock;
+  fs::detail::geometry layout;
+  std::unique_ptr<fs::detail::metadata_checksums> checksums;
+  std::unique_ptr<fs::detail::group_descriptor_table> table;
+  };
+
+#endif
@@ -3,7 +3,9 @@
 #include <linenoise.h>
 
 #include <cstdint>
+#include <iomanip>
 #include <iostream>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 
@@ -15,12 +17,174 @@ enum struct result : std::uint8_t
   unknown,
   };
 
-result process(std::string const & command)
+result print_free_space(fs::extfs const & disk)
   {
-  if(command == "exit" || command.empty())
+  auto const usage = disk.scan_free_space();
+  if(!usage)
+    {
+    return result::fatal_error;
+    }
+
+  std::cout << "free blocks: " << usage->free_blocks_count << " (superblock: " << usage->recorded_free_blocks_count << ")\n"
+            << "free inodes: " << usage->free_inodes_count << " (superblock: " << usage->recorded_free_inodes_count << ")\n";
+  for(auto const & group : usage->groups)
+    {
+    if(!group.consistent())
+      {
+      std::cout << "group " << group.id << ": " << group.free_blocks_count << " free blocks (descriptor: "
+                << group.recorded_free_blocks_count << "), " << group.free_inodes_count << " free inodes (descriptor: "
+                << group.recorded_free_inodes_count << ")\n";
+      }
+    }
+
+  return result::keep_going;
+  }
+
+void print_histogram(fs::detail::free_extent_histogram const & histogram)
+  {
+  std::cout << "free extents: " << histogram.free_extents_count << ", free blocks: " << histogram.free_blocks_count << "\n"
+            << "min/avg/max extent: " << histogram.smallest_extent << "/" << std::fixed << std::setprecision(1)
+            << histogram.average_extent() << "/" << histogram.largest_extent << " blocks\n"
+            << std::setw(24) << "extent size (blocks)" << std::setw(12) << "extents" << std::setw(14) << "blocks" << "\n";
+
+  for(auto bucket = std::size_t{}; bucket < histogram.kBucketsCount; ++bucket)
+    {
+    if(!histogram.extents_count[bucket])
+      {
+      continue;
+      }
+
+    auto const range = std::to_string(std::uint64_t{1} << bucket) + "..." +
+                       std::to_string((std::uint64_t{1} << bucket << 1) - 1);
+    std::cout << std::setw(24) << range << std::setw(12) << histogram.extents_count[bucket] << std::setw(14)
+              << histogram.blocks_count[bucket] << "\n";
+    }
+  }
+
+result print_free_extents(fs::extfs const & disk, std::istream & arguments)
+  {
+  auto const report = disk.scan_free_extents();
+  if(!report)
+    {
+    return result::fatal_error;
+    }
+
+  auto group = std::uint32_t{};
+  if(arguments >> group)
+    {
+    if(group >= report->groups.size())
+      {
+      std::cout << "no such group\n";
+      return result::keep_going;
+      }
+    print_histogram(report->groups[group]);
+    }
+  else
+    {
+    print_histogram(report->total);
+    }
+
+  return result::keep_going;
+  }
+
+result print_superblock_copies(fs::extfs const & disk)
+  {
+  for(auto const & copy : disk.superblock_copies())
+    {
+    std::cout << "group " << copy.group << " at byte " << copy.offset << ": ";
+    if(!copy.readable)
+      {
+      std::cout << "unreadable\n";
+      }
+    else if(!copy.valid)
+      {
+      std::cout << "invalid\n";
+      }
+    else if(copy.differences.empty())
+      {
+      std::cout << "consistent\n";
+      }
+    else
+      {
+      std::cout << "differs in";
+      for(auto const field : copy.differences)
+        {
+        std::cout << " " << field;
+        }
+      std::cout << "\n";
+      }
+    }
+
+  return result::keep_going;
+  }
+
+result print_directory(fs::extfs const & disk, std::istream & arguments)
+  {
+  auto path = std::string{"/"};
+  auto detailed = false;
+  for(auto argument = std::string{}; arguments >> argument;)
+    {
+    if(argument == "-l")
+      {
+      detailed = true;
+      }
+    else
+      {
+      path = argument;
+      }
+    }
+
+  auto const directory = disk.lookup(path).value_or(0);
+  auto const listed = detailed ? disk.list_with_attributes(directory, [](auto const & batch){
+    for(auto const & entry : batch)
+      {
+      auto const & node = *entry.attributes;
+      std::cout << std::setw(10) << entry.inode_id << " " << std::oct << std::setw(6) << std::setfill('0') << node.mode
+                << std::dec << std::setfill(' ') << std::setw(6) << node.links_count << std::setw(8)
+                << (std::uint32_t{node.user_id_hi} << 16 | node.user_id) << std::setw(8)
+                << (std::uint32_t{node.group_id_hi} << 16 | node.group_id) << std::setw(14) << node.size() << " "
+                << entry.name << "\n";
+      }
+    return true;
+  }) : disk.list(directory, [](auto, auto const name, auto){
+    std::cout << name << "\n";
+    return true;
+  });
+
+  if(!listed)
+    {
+    std::cout << "no such directory\n";
+    }
+
+  return result::keep_going;
+  }
+
+result process(fs::extfs const & disk, std::string const & command)
+  {
+  auto arguments = std::istringstream{command};
+  auto name = std::string{};
+  arguments >> name;
+
+  if(name == "exit" || command.empty())
     {
     return result::exit;
     }
+  else if(name == "free")
+    {
+    return print_free_space(disk);
+    }
+  else if(name == "frag")
+    {
+    return print_free_extents(disk, arguments);
+    }
+  else if(name == "superblocks")
+    {
+    return print_superblock_copies(disk);
+    }
+  else if(name == "ls")
+    {
+    return print_directory(disk, arguments);
+    }
 
   return result::unknown;
   }
@@ -45,7 +209,7 @@ std::string prompt(fs::extfs const & disk)
 void repl(fs::extfs & disk)
   {
   result commandResult = result::unknown;
-  while((commandResult = process(prompt(disk))) != result::exit)
+  while((commandResult = process(disk, prompt(disk))) != result::exit)
     {
     switch(commandResult)
       {
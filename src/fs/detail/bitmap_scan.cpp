@@ -0,0 +1,226 @@
+#include "fs/detail/bitmap_scan.hpp"
+#include "fs/detail/popcount.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+  {
+  auto constexpr kGroupsPerBatch = 64u;
+  auto constexpr kBaseDescriptorSize = 32u;
+
+  void mark(fs::detail::u08 * const bitmap, fs::detail::u64 const first, fs::detail::u64 const end)
+    {
+    for(auto bit = first; bit < end; ++bit)
+      {
+      bitmap[bit / 8] |= static_cast<fs::detail::u08>(1u << (bit % 8));
+      }
+    }
+
+  void mark_within(fs::detail::u08 * const bitmap, fs::detail::u64 const groupFirst, fs::detail::u64 const groupEnd,
+                   fs::detail::u64 const first, fs::detail::u64 const count)
+    {
+    auto const begin = std::max(first, groupFirst);
+    auto const end = std::min(first + count, groupEnd);
+    if(begin < end)
+      {
+      mark(bitmap, begin - groupFirst, end - groupFirst);
+      }
+    }
+  }
+
+namespace fs::detail
+  {
+
+  bool group_usage::consistent() const
+    {
+    return free_blocks_count == recorded_free_blocks_count && free_inodes_count == recorded_free_inodes_count;
+    }
+
+  bool space_usage::consistent() const
+    {
+    return free_blocks_count == recorded_free_blocks_count && free_inodes_count == recorded_free_inodes_count &&
+           std::all_of(groups.begin(), groups.end(), [](auto const & group){ return group.consistent(); });
+    }
+
+  std::vector<u32> space_usage::inconsistent_groups() const
+    {
+    auto result = std::vector<u32>{};
+    for(auto const & group : groups)
+      {
+      if(!group.consistent())
+        {
+        result.push_back(group.id);
+        }
+      }
+    return result;
+    }
+
+  void synthesize_block_bitmap(geometry const & layout, block_group const & group, u08 * const bitmap)
+    {
+    auto const first = layout.group_first_block_id(group.id);
+    auto const end = first + layout.group_blocks_count(group.id);
+
+    std::fill(bitmap, bitmap + layout.block_size(), u08{});
+    mark(bitmap, 0, std::min<u64>(layout.group_overhead_blocks_count(group.id), end - first));
+    mark_within(bitmap, first, end, group.block_bitmap_block_id, 1);
+    mark_within(bitmap, first, end, group.inode_bitmap_block_id, 1);
+    mark_within(bitmap, first, end, group.inode_table_block_id, layout.inode_table_blocks_count());
+    }
+
+  bool verify_block_bitmap(geometry const & layout, metadata_checksums const & checksums, block_group const & group,
+                           u08 const * const blockBitmap)
+    {
+    return (layout.lazy_group_initialization() && group.has(group_descriptor::flag::block_bitmap_uninitialized)) ||
+           checksums.verify_bitmap(blockBitmap, layout.blocks_per_group() / 8, group.block_bitmap_checksum,
+                                   layout.descriptor_size() > kBaseDescriptorSize);
+    }
+
+  bool verify_bitmaps(geometry const & layout, metadata_checksums const & checksums, block_group const & group,
+                      u08 const * const blockBitmap, u08 const * const inodeBitmap)
+    {
+    auto const inodeBitmapValid = (layout.lazy_group_initialization() &&
+                                   group.has(group_descriptor::flag::inodes_uninitialized)) ||
+                                  checksums.verify_bitmap(inodeBitmap, layout.inodes_per_group() / 8,
+                                                          group.inode_bitmap_checksum,
+                                                          layout.descriptor_size() > kBaseDescriptorSize);
+    return verify_block_bitmap(layout, checksums, group, blockBitmap) && inodeBitmapValid;
+    }
+
+  bool visit_bitmaps(block_device const & device, geometry const & layout, group_descriptor_table const & groups,
+                     unsigned const threads, bitmap_visitor const & visitor)
+    {
+    auto const groupsCount = layout.groups_count();
+    auto const blockSize = layout.block_size();
+    auto const checksums = groups.checksums();
+    auto const lazy = layout.lazy_group_initialization();
+    auto nextBatch = std::atomic<u32>{};
+    auto failed = std::atomic<bool>{};
+
+    auto const scan = [&]{
+      auto storage = std::vector<u08>(std::size_t{2} * kGroupsPerBatch * blockSize);
+      auto descriptors = std::vector<block_group>{};
+      auto requests = std::vector<io_request>{};
+
+      while(!failed)
+        {
+        auto const first = nextBatch.fetch_add(1) * kGroupsPerBatch;
+        if(first >= groupsCount)
+          {
+          return;
+          }
+
+        auto const end = std::min(first + kGroupsPerBatch, groupsCount);
+        descriptors.clear();
+        requests.clear();
+        for(auto id = first; id < end; ++id)
+          {
+          auto const group = groups[id];
+          if(!group)
+            {
+            failed = true;
+            return;
+            }
+
+          auto const slot = storage.data() + std::size_t{2} * (id - first) * blockSize;
+          if(lazy && group->has(group_descriptor::flag::block_bitmap_uninitialized))
+            {
+            synthesize_block_bitmap(layout, *group, slot);
+            }
+          else
+            {
+            requests.push_back(io_request{group->block_bitmap_block_id * blockSize, {{slot, blockSize}}});
+            }
+
+          if(lazy && group->has(group_descriptor::flag::inodes_uninitialized))
+            {
+            std::fill(slot + blockSize, slot + 2 * blockSize, u08{});
+            }
+          else
+            {
+            requests.push_back(io_request{group->inode_bitmap_block_id * blockSize, {{slot + blockSize, blockSize}}});
+            }
+          descriptors.push_back(*group);
+          }
+
+        if(!device.read_batch(std::move(requests)))
+          {
+          failed = true;
+          return;
+          }
+
+        for(auto const & group : descriptors)
+          {
+          auto const slot = storage.data() + std::size_t{2} * (group.id - first) * blockSize;
+          if(checksums && !verify_bitmaps(layout, *checksums, group, slot, slot + blockSize))
+            {
+            failed = true;
+            return;
+            }
+          visitor(group, slot, slot + blockSize);
+          }
+        }
+    };
+
+    auto const hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    auto const batchesCount = (groupsCount + kGroupsPerBatch - 1) / kGroupsPerBatch;
+    auto const workersCount = std::max(std::min(threads ? threads : hardwareThreads, batchesCount), 1u);
+
+    auto workers = std::vector<std::thread>{};
+    for(auto index = 1u; index < workersCount; ++index)
+      {
+      workers.emplace_back(scan);
+      }
+    scan();
+    for(auto & worker : workers)
+      {
+      worker.join();
+      }
+
+    return !failed;
+    }
+
+  std::optional<space_usage> scan_bitmaps(block_device const & device, geometry const & layout,
+                                          group_descriptor_table const & groups, superblock const & block,
+                                          unsigned const threads)
+    {
+    auto usage = space_usage{};
+    usage.groups.resize(layout.groups_count());
+    usage.recorded_free_blocks_count = block.free_blocks_count;
+    if(block.has(superblock::incompatible_feature::large_file_system))
+      {
+      usage.recorded_free_blocks_count |= u64{block.free_blocks_count_hi} << 32;
+      }
+    usage.recorded_free_inodes_count = block.free_inodes_count;
+
+    auto const visited = visit_bitmaps(device, layout, groups, threads, [&](auto const & group, auto blockBitmap,
+                                                                            auto inodeBitmap){
+      auto & result = usage.groups[group.id];
+      result.id = group.id;
+      result.recorded_free_blocks_count = group.free_blocks_count;
+      result.recorded_free_inodes_count = group.free_inodes_count;
+
+      auto const blocksCount = layout.group_blocks_count(group.id);
+      result.free_blocks_count = blocksCount - static_cast<u32>(count_set_bits(blockBitmap, blocksCount));
+      auto const inodesCount = layout.inodes_per_group();
+      result.free_inodes_count = inodesCount - static_cast<u32>(count_set_bits(inodeBitmap, inodesCount));
+    });
+
+    if(!visited)
+      {
+      return std::nullopt;
+      }
+
+    for(auto const & group : usage.groups)
+      {
+      usage.free_blocks_count += group.free_blocks_count;
+      usage.free_inodes_count += group.free_inodes_count;
+      }
+
+    return usage;
+    }
+
+  }
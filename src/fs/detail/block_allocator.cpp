@@ -0,0 +1,285 @@
+#include "fs/detail/bitmap_scan.hpp"
+#include "fs/detail/block_allocator.hpp"
+#include "fs/detail/free_extents.hpp"
+
+#include <algorithm>
+
+namespace fs::detail
+  {
+
+  block_allocator::block_allocator(block_device const & device, geometry const & layout,
+                                   group_descriptor_table const & groups) :
+    m_device{device},
+    m_geometry{layout},
+    m_groups{groups},
+    m_extents(layout.groups_count()),
+    m_unreadable(layout.groups_count())
+    {
+    }
+
+  std::vector<block_extent> block_allocator::allocate(u64 const goal, u64 const blocksCount)
+    {
+    auto lock = std::lock_guard<std::mutex>{m_mutex};
+    auto const groupsCount = m_geometry.groups_count();
+    auto const firstBlockId = m_geometry.group_first_block_id(0);
+    auto const target = goal >= firstBlockId && goal < m_geometry.blocks_count() ? goal : firstBlockId;
+    auto const goalGroup = group_of(target);
+
+    auto result = std::vector<block_extent>{};
+    auto remaining = blocksCount;
+    auto const append = [&](group_extents & extents, std::map<u64, u64>::iterator extent, u64 const first, u64 const count){
+      take(extents, extent, first, count);
+      remaining -= count;
+      if(!result.empty() && result.back().end_block_id() == first)
+        {
+        result.back().blocks_count += count;
+        }
+      else
+        {
+        result.push_back(block_extent{first, count});
+        }
+    };
+
+    if(!remaining)
+      {
+      return result;
+      }
+
+    if(auto extents = load(goalGroup))
+      {
+      auto extent = extents->by_position.upper_bound(target);
+      if(extent != extents->by_position.begin() && (--extent)->first + extent->second > target)
+        {
+        append(*extents, extent, target, std::min(remaining, extent->first + extent->second - target));
+        ++m_statistics.goal_hits_count;
+        }
+      }
+
+    while(remaining)
+      {
+      auto fitted = false;
+      for(auto step = 0u; step < groupsCount && !fitted; ++step)
+        {
+        auto const group = (goalGroup + step) % groupsCount;
+        if(available(group) < remaining)
+          {
+          continue;
+          }
+
+        auto const extents = load(group);
+        if(!extents)
+          {
+          continue;
+          }
+
+        auto const fit = extents->by_length.lower_bound({remaining, 0});
+        if(fit != extents->by_length.end())
+          {
+          append(*extents, extents->by_position.find(fit->second), fit->second, remaining);
+          fitted = true;
+          }
+        }
+
+      if(fitted)
+        {
+        break;
+        }
+
+      auto found = false;
+      for(auto step = 0u; step < groupsCount && !found; ++step)
+        {
+        auto const group = (goalGroup + step) % groupsCount;
+        auto const extents = available(group) ? load(group) : nullptr;
+        if(extents && !extents->by_length.empty())
+          {
+          auto const largest = *extents->by_length.rbegin();
+          append(*extents, extents->by_position.find(largest.second), largest.second, std::min(remaining, largest.first));
+          found = true;
+          }
+        }
+
+      if(!found)
+        {
+        for(auto const & extent : result)
+          {
+          give_back(extent);
+          }
+        return {};
+        }
+      }
+
+    ++m_statistics.allocations_count;
+    m_statistics.allocated_blocks_count += blocksCount;
+    m_statistics.allocated_extents_count += result.size();
+    return result;
+    }
+
+  bool block_allocator::release(block_extent const & extent)
+    {
+    auto lock = std::lock_guard<std::mutex>{m_mutex};
+    auto const firstBlockId = m_geometry.group_first_block_id(0);
+    if(!extent.blocks_count || extent.first_block_id < firstBlockId || extent.end_block_id() > m_geometry.blocks_count() ||
+       extent.end_block_id() < extent.first_block_id)
+      {
+      return false;
+      }
+
+    for(auto group = group_of(extent.first_block_id); group <= group_of(extent.end_block_id() - 1); ++group)
+      {
+      auto const extents = load(group);
+      if(!extents)
+        {
+        return false;
+        }
+
+      auto const groupFirst = std::max(extent.first_block_id, m_geometry.group_first_block_id(group));
+      auto const groupEnd = std::min(extent.end_block_id(), m_geometry.group_first_block_id(group) +
+                                                            m_geometry.group_blocks_count(group));
+      auto const next = extents->by_position.lower_bound(groupFirst);
+      auto const overlapsNext = next != extents->by_position.end() && next->first < groupEnd;
+      auto const overlapsPrevious = next != extents->by_position.begin() && std::prev(next)->first +
+                                                                            std::prev(next)->second > groupFirst;
+      if(overlapsNext || overlapsPrevious)
+        {
+        return false;
+        }
+      }
+
+    give_back(extent);
+    m_statistics.released_blocks_count += extent.blocks_count;
+    return true;
+    }
+
+  std::optional<u64> block_allocator::free_blocks_count(u32 const group)
+    {
+    auto lock = std::lock_guard<std::mutex>{m_mutex};
+    auto const extents = group < m_extents.size() ? load(group) : nullptr;
+    return extents ? std::optional{extents->free_blocks_count} : std::nullopt;
+    }
+
+  std::optional<u64> block_allocator::largest_free_extent(u32 const group)
+    {
+    auto lock = std::lock_guard<std::mutex>{m_mutex};
+    auto const extents = group < m_extents.size() ? load(group) : nullptr;
+    if(!extents)
+      {
+      return std::nullopt;
+      }
+    return extents->by_length.empty() ? 0 : extents->by_length.rbegin()->first;
+    }
+
+  allocator_statistics block_allocator::statistics() const
+    {
+    auto lock = std::lock_guard<std::mutex>{m_mutex};
+    return m_statistics;
+    }
+
+  block_allocator::group_extents * block_allocator::load(u32 const group)
+    {
+    if(m_extents[group] || m_unreadable[group])
+      {
+      return m_extents[group].get();
+      }
+
+    auto const descriptor = m_groups[group];
+    auto const blockSize = m_geometry.block_size();
+    auto bitmap = std::vector<u08>(blockSize);
+    if(descriptor && m_geometry.lazy_group_initialization() &&
+       descriptor->has(group_descriptor::flag::block_bitmap_uninitialized))
+      {
+      synthesize_block_bitmap(m_geometry, *descriptor, bitmap.data());
+      }
+    else if(!descriptor || !m_device.read(descriptor->block_bitmap_block_id * blockSize, bitmap.data(), blockSize) ||
+            (m_groups.checksums() && !verify_block_bitmap(m_geometry, *m_groups.checksums(), *descriptor, bitmap.data())))
+      {
+      m_unreadable[group] = true;
+      return nullptr;
+      }
+
+    auto extents = std::make_unique<group_extents>();
+    auto const groupFirst = m_geometry.group_first_block_id(group);
+    visit_free_runs(bitmap.data(), m_geometry.group_blocks_count(group), [&](auto const first, auto const count){
+      insert(*extents, groupFirst + first, count);
+    });
+
+    ++m_statistics.loaded_groups_count;
+    m_extents[group] = std::move(extents);
+    return m_extents[group].get();
+    }
+
+  u32 block_allocator::group_of(u64 const blockId) const
+    {
+    return static_cast<u32>((blockId - m_geometry.group_first_block_id(0)) / m_geometry.blocks_per_group());
+    }
+
+  u64 block_allocator::available(u32 const group) const
+    {
+    if(m_extents[group])
+      {
+      return m_extents[group]->free_blocks_count;
+      }
+    else if(m_unreadable[group])
+      {
+      return 0;
+      }
+
+    auto const descriptor = m_groups[group];
+    return descriptor ? descriptor->free_blocks_count : 0;
+    }
+
+  void block_allocator::insert(group_extents & extents, u64 const firstBlockId, u64 const blocksCount)
+    {
+    extents.by_position.emplace(firstBlockId, blocksCount);
+    extents.by_length.emplace(blocksCount, firstBlockId);
+    extents.free_blocks_count += blocksCount;
+    }
+
+  void block_allocator::take(group_extents & extents, std::map<u64, u64>::iterator extent, u64 const firstBlockId,
+                             u64 const blocksCount)
+    {
+    auto const start = extent->first;
+    auto const end = extent->first + extent->second;
+    extents.by_length.erase({extent->second, extent->first});
+    extents.by_position.erase(extent);
+    extents.free_blocks_count -= end - start;
+
+    if(firstBlockId > start)
+      {
+      insert(extents, start, firstBlockId - start);
+      }
+    if(firstBlockId + blocksCount < end)
+      {
+      insert(extents, firstBlockId + blocksCount, end - firstBlockId - blocksCount);
+      }
+    }
+
+  void block_allocator::give_back(block_extent const & extent)
+    {
+    for(auto group = group_of(extent.first_block_id); group <= group_of(extent.end_block_id() - 1); ++group)
+      {
+      auto & extents = *m_extents[group];
+      auto const groupFirst = m_geometry.group_first_block_id(group);
+      auto first = std::max(extent.first_block_id, groupFirst);
+      auto end = std::min(extent.end_block_id(), groupFirst + m_geometry.group_blocks_count(group));
+
+      auto const next = extents.by_position.find(end);
+      if(next != extents.by_position.end())
+        {
+        auto const length = next->second;
+        take(extents, next, end, length);
+        end += length;
+        }
+
+      auto const following = extents.by_position.lower_bound(first);
+      if(following != extents.by_position.begin() && std::prev(following)->first + std::prev(following)->second == first)
+        {
+        auto const previous = std::prev(following);
+        auto const start = previous->first;
+        take(extents, previous, start, first - start);
+        first = start;
+        }
+
+      insert(extents, first, end - first);
+      }
+    }
+  }
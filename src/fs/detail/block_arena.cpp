@@ -0,0 +1,51 @@
+#include "fs/detail/block_arena.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+
+namespace fs::detail
+  {
+
+  block_arena::block_arena(std::size_t const blockSize, std::size_t const blocksPerSlab) :
+    m_blockSize{blockSize},
+    m_blocksPerSlab{std::max<std::size_t>(blocksPerSlab, 1)}
+    {
+    }
+
+  u08 * block_arena::allocate()
+    {
+    auto lock = std::lock_guard<std::mutex>{m_mutex};
+    if(m_free.empty())
+      {
+      m_slabs.emplace_back(new u08[m_blockSize * m_blocksPerSlab]);
+      auto const slab = m_slabs.back().get();
+      for(auto index = m_blocksPerSlab; index > 0; --index)
+        {
+        m_free.push_back(slab + (index - 1) * m_blockSize);
+        }
+      }
+
+    auto const block = m_free.back();
+    m_free.pop_back();
+    return block;
+    }
+
+  void block_arena::release(u08 * const block)
+    {
+    auto lock = std::lock_guard<std::mutex>{m_mutex};
+    m_free.push_back(block);
+    }
+
+  std::size_t block_arena::block_size() const
+    {
+    return m_blockSize;
+    }
+
+  std::size_t block_arena::reserved() const
+    {
+    auto lock = std::lock_guard<std::mutex>{m_mutex};
+    return m_slabs.size() * m_blocksPerSlab * m_blockSize;
+    }
+
+  }
@@ -0,0 +1,369 @@
+#include "fs/detail/block_device.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+  {
+  bool in_bounds(fs::detail::u64 const size, fs::detail::u64 const offset, std::size_t const length)
+    {
+    return offset <= size && length <= size - offset;
+    }
+
+  std::size_t total_length(std::vector<fs::detail::io_vector> const & vectors)
+    {
+    return std::accumulate(vectors.begin(), vectors.end(), std::size_t{}, [](auto const sum, auto const & vector){
+      return sum + vector.length;
+    });
+    }
+
+  fs::detail::u64 device_size(int const descriptor)
+    {
+    auto const end = ::lseek(descriptor, 0, SEEK_END);
+    return end < 0 ? 0 : static_cast<fs::detail::u64>(end);
+    }
+  }
+
+namespace fs::detail
+  {
+
+  bool block_device::write(u64 const, void const * const, std::size_t const)
+    {
+    return false;
+    }
+
+  bool block_device::write(u64 const, std::vector<io_vector> const &)
+    {
+    return false;
+    }
+
+  bool block_device::sync()
+    {
+    return true;
+    }
+
+  void block_device::submit(std::vector<io_request> requests) const
+    {
+    for(auto & request : requests)
+      {
+      auto const success = read(request.offset, request.vectors);
+      if(request.completion)
+        {
+        request.completion(success);
+        }
+      }
+    }
+
+  bool block_device::read_batch(std::vector<io_request> requests) const
+    {
+    auto mutex = std::mutex{};
+    auto done = std::condition_variable{};
+    auto remaining = requests.size();
+    auto success = true;
+
+    for(auto & request : requests)
+      {
+      request.completion = [&, completion = std::move(request.completion)](bool const completed){
+        if(completion)
+          {
+          completion(completed);
+          }
+
+        auto lock = std::lock_guard<std::mutex>{mutex};
+        success = success && completed;
+        if(!--remaining)
+          {
+          done.notify_one();
+          }
+      };
+      }
+
+    submit(std::move(requests));
+
+    auto lock = std::unique_lock<std::mutex>{mutex};
+    done.wait(lock, [&]{ return !remaining; });
+    return success;
+    }
+
+  mapped_block_device::mapped_block_device(std::string const & path)
+    {
+    auto const descriptor = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(descriptor < 0)
+      {
+      return;
+      }
+
+    struct stat status{};
+    if(::fstat(descriptor, &status) || !S_ISREG(status.st_mode) || status.st_size <= 0)
+      {
+      ::close(descriptor);
+      return;
+      }
+
+    auto const size = static_cast<u64>(status.st_size);
+    auto const address = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, descriptor, 0);
+    ::close(descriptor);
+
+    if(address == MAP_FAILED)
+      {
+      return;
+      }
+
+    m_size = size;
+    m_mapping = std::shared_ptr<u08 const>{static_cast<u08 const *>(address), [size](u08 const * mapping){
+      ::munmap(const_cast<u08 *>(mapping), size);
+    }};
+    }
+
+  bool mapped_block_device::mapped() const
+    {
+    return static_cast<bool>(m_mapping);
+    }
+
+  u64 mapped_block_device::size() const
+    {
+    return m_size;
+    }
+
+  bool mapped_block_device::writeable() const
+    {
+    return false;
+    }
+
+  bool mapped_block_device::read(u64 const offset, void * const buffer, std::size_t const length) const
+    {
+    if(!m_mapping || !in_bounds(m_size, offset, length))
+      {
+      return false;
+      }
+
+    std::memcpy(buffer, m_mapping.get() + offset, length);
+    return true;
+    }
+
+  bool mapped_block_device::read(u64 const offset, std::vector<io_vector> const & vectors) const
+    {
+    if(!m_mapping || !in_bounds(m_size, offset, total_length(vectors)))
+      {
+      return false;
+      }
+
+    auto source = m_mapping.get() + offset;
+    for(auto const & vector : vectors)
+      {
+      std::memcpy(vector.buffer, source, vector.length);
+      source += vector.length;
+      }
+
+    return true;
+    }
+
+  bytes mapped_block_device::fetch(u64 const offset, std::size_t const length) const
+    {
+    if(!m_mapping || !in_bounds(m_size, offset, length))
+      {
+      return nullptr;
+      }
+
+    return bytes{m_mapping, m_mapping.get() + offset};
+    }
+
+  void mapped_block_device::prefetch(u64 const offset, u64 const length) const
+    {
+    if(!m_mapping || offset >= m_size)
+      {
+      return;
+      }
+
+    auto const pageSize = static_cast<u64>(::sysconf(_SC_PAGESIZE));
+    auto const first = offset / pageSize * pageSize;
+    auto const end = std::min(m_size, offset + std::min(length, m_size - offset));
+    ::madvise(const_cast<u08 *>(m_mapping.get()) + first, end - first, MADV_WILLNEED);
+    }
+
+  positional_block_device::positional_block_device(std::string const & path, bool const writeable,
+                                                   std::size_t const queueDepth) :
+    m_descriptor{::open(path.c_str(), (writeable ? O_RDWR : O_RDONLY) | O_CLOEXEC)},
+    m_writeable{writeable},
+    m_queueDepth{queueDepth}
+    {
+    if(m_descriptor >= 0)
+      {
+      m_size = device_size(m_descriptor);
+      }
+    }
+
+  positional_block_device::~positional_block_device()
+    {
+    m_engine.reset();
+    if(m_descriptor >= 0)
+      {
+      ::close(m_descriptor);
+      }
+    }
+
+  bool positional_block_device::opened() const
+    {
+    return m_descriptor >= 0;
+    }
+
+  u64 positional_block_device::size() const
+    {
+    return m_size;
+    }
+
+  bool positional_block_device::writeable() const
+    {
+    return m_writeable && opened();
+    }
+
+  bool positional_block_device::mapped() const
+    {
+    return false;
+    }
+
+  bool positional_block_device::read(u64 const offset, void * const buffer, std::size_t const length) const
+    {
+    if(!opened() || !in_bounds(m_size, offset, length))
+      {
+      return false;
+      }
+
+    auto target = static_cast<char *>(buffer);
+    auto remaining = length;
+    auto position = static_cast<off_t>(offset);
+
+    while(remaining)
+      {
+      auto const count = ::pread(m_descriptor, target, remaining, position);
+      if(count < 0 && errno == EINTR)
+        {
+        continue;
+        }
+      else if(count <= 0)
+        {
+        return false;
+        }
+
+      target += count;
+      position += count;
+      remaining -= static_cast<std::size_t>(count);
+      }
+
+    return true;
+    }
+
+  bool positional_block_device::read(u64 const offset, std::vector<io_vector> const & vectors) const
+    {
+    if(!opened() || !in_bounds(m_size, offset, total_length(vectors)))
+      {
+      return false;
+      }
+
+    return read_vectors(m_descriptor, offset, vectors);
+    }
+
+  bytes positional_block_device::fetch(u64 const offset, std::size_t const length) const
+    {
+    if(!opened() || !in_bounds(m_size, offset, length))
+      {
+      return nullptr;
+      }
+
+    auto buffer = std::shared_ptr<u08>{new u08[length], std::default_delete<u08[]>{}};
+    if(!read(offset, buffer.get(), length))
+      {
+      return nullptr;
+      }
+
+    return buffer;
+    }
+
+  void positional_block_device::prefetch(u64 const offset, u64 const length) const
+    {
+    if(opened())
+      {
+      ::posix_fadvise(m_descriptor, static_cast<off_t>(offset), static_cast<off_t>(length), POSIX_FADV_WILLNEED);
+      }
+    }
+
+  bool positional_block_device::write(u64 const offset, void const * const buffer, std::size_t const length)
+    {
+    return write(offset, std::vector<io_vector>{{const_cast<void *>(buffer), length}});
+    }
+
+  bool positional_block_device::write(u64 const offset, std::vector<io_vector> const & vectors)
+    {
+    if(!writeable() || !in_bounds(m_size, offset, total_length(vectors)))
+      {
+      return false;
+      }
+
+    return write_vectors(m_descriptor, offset, vectors);
+    }
+
+  bool positional_block_device::sync()
+    {
+    return !writeable() || !::fdatasync(m_descriptor);
+    }
+
+  void positional_block_device::submit(std::vector<io_request> requests) const
+    {
+    if(!opened())
+      {
+      block_device::submit(std::move(requests));
+      return;
+      }
+
+    auto valid = std::vector<io_request>{};
+    valid.reserve(requests.size());
+    for(auto & request : requests)
+      {
+      if(in_bounds(m_size, request.offset, total_length(request.vectors)))
+        {
+        valid.push_back(std::move(request));
+        }
+      else if(request.completion)
+        {
+        request.completion(false);
+        }
+      }
+
+    std::call_once(m_engineStarted, [this]{ m_engine = make_io_engine(m_descriptor, m_queueDepth); });
+    m_engine->submit(std::move(valid));
+    }
+
+  std::unique_ptr<block_device> open_block_device(std::string const & path, bool const writeable, bool const allowMapping,
+                                                  std::size_t const queueDepth)
+    {
+    if(!writeable && allowMapping)
+      {
+      auto mapped = std::make_unique<mapped_block_device>(path);
+      if(mapped->mapped())
+        {
+        return mapped;
+        }
+      }
+
+    auto positional = std::make_unique<positional_block_device>(path, writeable, queueDepth);
+    if(positional->opened())
+      {
+      return positional;
+      }
+
+    return nullptr;
+    }
+
+  }
@@ -0,0 +1,184 @@
+#include "fs/detail/block_map.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace
+  {
+  auto constexpr kLogicalBlocksLimit = fs::detail::u64{1} << 32;
+  auto constexpr kNodeOverhead = 64u;
+
+  void append(std::vector<fs::detail::block_run> & runs, fs::detail::block_run const & run)
+    {
+    if(!runs.empty())
+      {
+      auto & last = runs.back();
+      auto const bothHoles = !last.physical_block_id && !run.physical_block_id;
+      auto const contiguous = last.physical_block_id && run.physical_block_id &&
+                              last.uninitialized == run.uninitialized &&
+                              last.physical_block_id + last.blocks_count == run.physical_block_id;
+      if(bothHoles || contiguous)
+        {
+        last.blocks_count += run.blocks_count;
+        return;
+        }
+      }
+
+    runs.push_back(run);
+    }
+  }
+
+namespace fs::detail
+  {
+
+  std::optional<std::vector<block_run>> block_map::resolve(u64 const firstBlock, u64 const blocksCount)
+    {
+    auto lock = std::lock_guard<std::mutex>{m_mutex};
+    auto runs = std::vector<block_run>{};
+    auto position = firstBlock;
+    auto const end = firstBlock + blocksCount;
+
+    while(position < end)
+      {
+      if(position >= kLogicalBlocksLimit)
+        {
+        append(runs, block_run{position, 0, end - position, false});
+        break;
+        }
+
+      auto covered = covering(position);
+      if(covered == m_coverage.end())
+        {
+        auto const next = m_coverage.upper_bound(position);
+        auto const gapEnd = std::min({end, kLogicalBlocksLimit, next == m_coverage.end() ? end : next->first});
+        if(!load(position, gapEnd) || (covered = covering(position)) == m_coverage.end())
+          {
+          return std::nullopt;
+          }
+        }
+
+      auto const limit = std::min(end, covered->second);
+      auto mapped = m_mappings.upper_bound(position);
+      if(mapped != m_mappings.begin() && std::prev(mapped)->first + std::prev(mapped)->second.blocksCount > position)
+        {
+        --mapped;
+        }
+
+      while(position < limit)
+        {
+        if(mapped == m_mappings.end() || mapped->first >= limit)
+          {
+          append(runs, block_run{position, 0, limit - position, false});
+          position = limit;
+          break;
+          }
+
+        if(mapped->first > position)
+          {
+          append(runs, block_run{position, 0, mapped->first - position, false});
+          position = mapped->first;
+          }
+
+        auto const & entry = mapped->second;
+        if(mapped->first + entry.blocksCount <= position)
+          {
+          ++mapped;
+          continue;
+          }
+
+        auto const runEnd = std::min(limit, mapped->first + entry.blocksCount);
+        auto const physical = entry.physicalBlockId + (position - mapped->first);
+        append(runs, block_run{position, physical, runEnd - position, entry.uninitialized});
+        position = runEnd;
+        ++mapped;
+        }
+      }
+
+    return runs;
+    }
+
+  std::size_t block_map::footprint() const
+    {
+    auto lock = std::lock_guard<std::mutex>{m_mutex};
+    return sizeof(*this) + (m_mappings.size() + m_coverage.size()) * kNodeOverhead + metadata_footprint();
+    }
+
+  std::size_t block_map::loaded_blocks_count() const
+    {
+    auto lock = std::lock_guard<std::mutex>{m_mutex};
+    return m_loadedBlocksCount;
+    }
+
+  void block_map::remember(u64 const logicalBlock, u64 const physicalBlock, u64 const blocksCount, bool const uninitialized)
+    {
+    if(!blocksCount)
+      {
+      return;
+      }
+
+    auto const next = m_mappings.lower_bound(logicalBlock);
+    if(next != m_mappings.begin())
+      {
+      auto & previous = *std::prev(next);
+      auto const logicallyAdjacent = previous.first + previous.second.blocksCount == logicalBlock;
+      auto const physicallyAdjacent = previous.second.physicalBlockId + previous.second.blocksCount == physicalBlock;
+      if(logicallyAdjacent && physicallyAdjacent && previous.second.uninitialized == uninitialized)
+        {
+        previous.second.blocksCount += blocksCount;
+        return;
+        }
+      }
+
+    m_mappings[logicalBlock] = mapping{physicalBlock, blocksCount, uninitialized};
+    }
+
+  void block_map::cover(u64 const firstBlock, u64 const endBlock)
+    {
+    if(firstBlock >= endBlock)
+      {
+      return;
+      }
+
+    auto first = firstBlock;
+    auto end = endBlock;
+    auto next = m_coverage.upper_bound(first);
+    if(next != m_coverage.begin() && std::prev(next)->second >= first)
+      {
+      --next;
+      first = next->first;
+      }
+
+    while(next != m_coverage.end() && next->first <= end)
+      {
+      end = std::max(end, next->second);
+      next = m_coverage.erase(next);
+      }
+
+    m_coverage.emplace(first, end);
+    }
+
+  void block_map::count_loaded_blocks(std::size_t const count)
+    {
+    m_loadedBlocksCount += count;
+    }
+
+  std::size_t block_map::metadata_footprint() const
+    {
+    return 0;
+    }
+
+  std::map<u64, u64>::const_iterator block_map::covering(u64 const logicalBlock) const
+    {
+    auto covered = m_coverage.upper_bound(logicalBlock);
+    if(covered == m_coverage.begin() || std::prev(covered)->second <= logicalBlock)
+      {
+      return m_coverage.end();
+      }
+
+    return std::prev(covered);
+    }
+
+  }
@@ -0,0 +1,555 @@
+#include "fs/detail/buffer_cache.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace
+  {
+  auto constexpr kRecentShare = 4u;
+  auto constexpr kGhostShare = 2u;
+  auto constexpr kMaximumFlushVectors = std::size_t{IOV_MAX};
+
+  unsigned bits_for(std::size_t const shards)
+    {
+    auto bits = 0u;
+    while((std::size_t{1} << bits) < shards)
+      {
+      ++bits;
+      }
+    return bits;
+    }
+
+  template<typename Entries>
+  auto unpinned(Entries & entries)
+    {
+    auto candidate = entries.end();
+    while(candidate != entries.begin())
+      {
+      --candidate;
+      if(!candidate->dirty && candidate->data.use_count() == 1)
+        {
+        return candidate;
+        }
+      }
+    return entries.end();
+    }
+  }
+
+namespace fs::detail
+  {
+
+  buffer_cache::buffer_cache(std::unique_ptr<block_device> device, u32 const blockSize, std::size_t const capacity,
+                             std::size_t const shards) :
+    m_device{std::move(device)},
+    m_blockSize{blockSize},
+    m_capacity{capacity},
+    m_arena{std::make_shared<block_arena>(blockSize)},
+    m_shardBits{bits_for(shards)},
+    m_shards{new shard[std::size_t{1} << m_shardBits]}
+    {
+    auto const shardsCount = std::size_t{1} << m_shardBits;
+    auto const blocksCount = capacity / blockSize;
+    for(auto index = std::size_t{}; index < shardsCount; ++index)
+      {
+      m_shards[index].capacity = blocksCount / shardsCount + (index < blocksCount % shardsCount);
+      }
+    }
+
+  buffer_cache::~buffer_cache()
+    {
+    flush();
+    }
+
+  bytes buffer_cache::block(u64 const blockId) const
+    {
+    auto & target = shard_for(blockId);
+    auto lock = std::unique_lock<std::mutex>{target.mutex};
+    auto found = target.index.find(blockId);
+    if(found != target.index.end())
+      {
+      ++target.hits;
+      auto const cached = found->second;
+      if(cached->frequent)
+        {
+        target.frequent.splice(target.frequent.begin(), target.frequent, cached);
+        }
+      return cached->data;
+      }
+
+    ++target.misses;
+    lock.unlock();
+    auto loaded = load(blockId);
+    if(!loaded || !target.capacity)
+      {
+      return loaded;
+      }
+
+    lock.lock();
+    found = target.index.find(blockId);
+    if(found != target.index.end())
+      {
+      return found->second->data;
+      }
+
+    auto const ghost = target.ghostIndex.find(blockId);
+    auto const frequent = ghost != target.ghostIndex.end();
+    if(frequent)
+      {
+      target.ghosts.erase(ghost->second);
+      target.ghostIndex.erase(ghost);
+      }
+
+    auto & queue = frequent ? target.frequent : target.recent;
+    queue.push_front(entry{blockId, loaded, frequent});
+    target.index.emplace(blockId, queue.begin());
+    evict(target);
+    return loaded;
+    }
+
+  u64 buffer_cache::preload(u64 const firstBlockId, u64 const blocksCount) const
+    {
+    auto const limit = u64{m_capacity / m_blockSize / kRecentShare};
+    auto const endBlockId = std::min(firstBlockId + std::min(blocksCount, limit), size() / m_blockSize);
+    auto preloaded = u64{};
+    for(auto chunkStart = firstBlockId; chunkStart < endBlockId; chunkStart += kMaximumPreloadBlocks)
+      {
+      auto const chunkEnd = std::min(chunkStart + kMaximumPreloadBlocks, endBlockId);
+      auto missing = false;
+      for(auto blockId = chunkStart; blockId < chunkEnd && !missing; ++blockId)
+        {
+        auto & target = shard_for(blockId);
+        auto lock = std::lock_guard<std::mutex>{target.mutex};
+        missing = !target.index.count(blockId);
+        }
+
+      if(!missing)
+        {
+        continue;
+        }
+
+      auto blocks = std::vector<bytes>{};
+      auto vectors = std::vector<io_vector>{};
+      blocks.reserve(chunkEnd - chunkStart);
+      vectors.reserve(chunkEnd - chunkStart);
+      for(auto blockId = chunkStart; blockId < chunkEnd; ++blockId)
+        {
+        blocks.push_back(allocate());
+        vectors.push_back({const_cast<u08 *>(blocks.back().get()), m_blockSize});
+        }
+
+      if(!m_device->read(chunkStart * m_blockSize, vectors))
+        {
+        break;
+        }
+
+      for(auto blockId = chunkStart; blockId < chunkEnd; ++blockId)
+        {
+        auto & target = shard_for(blockId);
+        auto lock = std::lock_guard<std::mutex>{target.mutex};
+        if(!target.capacity || target.index.count(blockId))
+          {
+          continue;
+          }
+
+        target.recent.push_front(entry{blockId, std::move(blocks[blockId - chunkStart]), false});
+        target.index.emplace(blockId, target.recent.begin());
+        evict(target);
+        ++preloaded;
+        }
+      }
+
+    return preloaded;
+    }
+
+  cache_statistics buffer_cache::statistics() const
+    {
+    auto result = cache_statistics{};
+    for(auto index = std::size_t{}; index < (std::size_t{1} << m_shardBits); ++index)
+      {
+      auto & target = m_shards[index];
+      auto lock = std::lock_guard<std::mutex>{target.mutex};
+      result.hits += target.hits;
+      result.misses += target.misses;
+      result.evictions += target.evictions;
+      result.entries += target.index.size();
+      }
+
+    result.size = result.entries * m_blockSize;
+    result.capacity = m_capacity;
+    return result;
+    }
+
+  write_statistics buffer_cache::flush_statistics() const
+    {
+    return {m_dirtyCount, m_flushesCount, m_writesCount, m_writtenBlocksCount};
+    }
+
+  bool buffer_cache::write(u64 const offset, void const * const buffer, std::size_t const length, block_kind const kind)
+    {
+    if(!writeable() || offset > size() || length > size() - offset)
+      {
+      return false;
+      }
+
+    auto source = static_cast<u08 const *>(buffer);
+    for(auto position = offset; position < offset + length;)
+      {
+      auto const within = static_cast<std::size_t>(position % m_blockSize);
+      auto const count = static_cast<std::size_t>(std::min<u64>(m_blockSize - within, offset + length - position));
+      auto const target = dirty_block(position / m_blockSize, kind, count == m_blockSize);
+      if(!target)
+        {
+        return false;
+        }
+
+      std::memcpy(target + within, source, count);
+      source += count;
+      position += count;
+      }
+
+    return m_dirtyCount * m_blockSize < m_capacity || flush();
+    }
+
+  bool buffer_cache::flush()
+    {
+    if(!m_dirtyCount)
+      {
+      return true;
+      }
+
+    ++m_flushesCount;
+    return flush(block_kind::metadata) && flush(block_kind::data);
+    }
+
+  u64 buffer_cache::size() const
+    {
+    return m_device->size();
+    }
+
+  bool buffer_cache::writeable() const
+    {
+    return m_device->writeable();
+    }
+
+  bool buffer_cache::mapped() const
+    {
+    return false;
+    }
+
+  bool buffer_cache::read(u64 const offset, void * const buffer, std::size_t const length) const
+    {
+    if(!within_block(offset, length))
+      {
+      if(!m_device->read(offset, buffer, length))
+        {
+        return false;
+        }
+
+      overlay(offset, {{buffer, length}});
+      return true;
+      }
+
+    auto const cached = block(offset / m_blockSize);
+    if(!cached)
+      {
+      return false;
+      }
+
+    std::memcpy(buffer, cached.get() + offset % m_blockSize, length);
+    return true;
+    }
+
+  bool buffer_cache::read(u64 const offset, std::vector<io_vector> const & vectors) const
+    {
+    if(!m_device->read(offset, vectors))
+      {
+      return false;
+      }
+
+    overlay(offset, vectors);
+    return true;
+    }
+
+  bytes buffer_cache::fetch(u64 const offset, std::size_t const length) const
+    {
+    if(!within_block(offset, length) && m_dirtyCount)
+      {
+      auto buffer = std::shared_ptr<u08>{new u08[length], std::default_delete<u08[]>{}};
+      return read(offset, buffer.get(), length) ? buffer : nullptr;
+      }
+    else if(!within_block(offset, length))
+      {
+      return m_device->fetch(offset, length);
+      }
+
+    auto const cached = block(offset / m_blockSize);
+    if(!cached)
+      {
+      return nullptr;
+      }
+
+    return bytes{cached, cached.get() + offset % m_blockSize};
+    }
+
+  void buffer_cache::prefetch(u64 const offset, u64 const length) const
+    {
+    m_device->prefetch(offset, length);
+    }
+
+  bool buffer_cache::write(u64 const offset, void const * const buffer, std::size_t const length)
+    {
+    return write(offset, buffer, length, block_kind::data);
+    }
+
+  bool buffer_cache::write(u64 const offset, std::vector<io_vector> const & vectors)
+    {
+    auto position = offset;
+    for(auto const & vector : vectors)
+      {
+      if(!write(position, vector.buffer, vector.length, block_kind::data))
+        {
+        return false;
+        }
+      position += vector.length;
+      }
+
+    return true;
+    }
+
+  bool buffer_cache::sync()
+    {
+    if(m_dirtyCount)
+      {
+      ++m_flushesCount;
+      }
+
+    return flush(block_kind::metadata) && m_device->sync() && flush(block_kind::data) && m_device->sync();
+    }
+
+  void buffer_cache::submit(std::vector<io_request> requests) const
+    {
+    if(m_dirtyCount)
+      {
+      for(auto & request : requests)
+        {
+        request.completion = [this, offset = request.offset, vectors = request.vectors,
+                              completion = std::move(request.completion)](bool const success){
+          if(success)
+            {
+            overlay(offset, vectors);
+            }
+          if(completion)
+            {
+            completion(success);
+            }
+        };
+        }
+      }
+
+    m_device->submit(std::move(requests));
+    }
+
+  buffer_cache::shard & buffer_cache::shard_for(u64 const blockId) const
+    {
+    if(!m_shardBits)
+      {
+      return m_shards[0];
+      }
+
+    auto const mixed = blockId * 0x9e3779b97f4a7c15ull;
+    return m_shards[mixed >> (64 - m_shardBits)];
+    }
+
+  bytes buffer_cache::allocate() const
+    {
+    return bytes{m_arena->allocate(), [arena = m_arena](u08 const * block){
+      arena->release(const_cast<u08 *>(block));
+    }};
+    }
+
+  bytes buffer_cache::load(u64 const blockId) const
+    {
+    auto loaded = allocate();
+    if(!m_device->read(blockId * m_blockSize, const_cast<u08 *>(loaded.get()), m_blockSize))
+      {
+      return nullptr;
+      }
+
+    return loaded;
+    }
+
+  void buffer_cache::evict(shard & target) const
+    {
+    auto const recentCapacity = std::max<std::size_t>(target.capacity / kRecentShare, 1);
+    auto const ghostCapacity = std::max<std::size_t>(target.capacity / kGhostShare, 1);
+
+    while(target.index.size() > target.capacity)
+      {
+      auto const preferRecent = target.recent.size() > recentCapacity || target.frequent.empty();
+      auto & first = preferRecent ? target.recent : target.frequent;
+      auto & second = preferRecent ? target.frequent : target.recent;
+
+      auto * queue = &first;
+      auto victim = unpinned(first);
+      if(victim == first.end())
+        {
+        queue = &second;
+        victim = unpinned(second);
+        if(victim == second.end())
+          {
+          break;
+          }
+        }
+
+      if(!victim->frequent)
+        {
+        target.ghosts.push_front(victim->blockId);
+        target.ghostIndex.emplace(victim->blockId, target.ghosts.begin());
+        if(target.ghosts.size() > ghostCapacity)
+          {
+          target.ghostIndex.erase(target.ghosts.back());
+          target.ghosts.pop_back();
+          }
+        }
+
+      target.index.erase(victim->blockId);
+      queue->erase(victim);
+      ++target.evictions;
+      }
+    }
+
+  bool buffer_cache::within_block(u64 const offset, std::size_t const length) const
+    {
+    return length && offset / m_blockSize == (offset + length - 1) / m_blockSize;
+    }
+
+  u08 * buffer_cache::dirty_block(u64 const blockId, block_kind const kind, bool const overwritten)
+    {
+    auto & target = shard_for(blockId);
+    auto lock = std::unique_lock<std::mutex>{target.mutex};
+    auto found = target.index.find(blockId);
+    if(found == target.index.end())
+      {
+      lock.unlock();
+      auto const loaded = overwritten ? allocate() : load(blockId);
+      if(!loaded)
+        {
+        return nullptr;
+        }
+
+      lock.lock();
+      found = target.index.find(blockId);
+      if(found == target.index.end())
+        {
+        target.recent.push_front(entry{blockId, loaded, false});
+        found = target.index.emplace(blockId, target.recent.begin()).first;
+        }
+      }
+
+    auto & cached = *found->second;
+    if(!cached.dirty)
+      {
+      cached.dirty = true;
+      cached.kind = kind;
+      target.dirty.insert(blockId);
+      ++m_dirtyCount;
+      }
+    else if(kind == block_kind::metadata)
+      {
+      cached.kind = kind;
+      }
+
+    evict(target);
+    return const_cast<u08 *>(cached.data.get());
+    }
+
+  bool buffer_cache::flush(block_kind const kind)
+    {
+    auto blocks = std::vector<std::pair<u64, bytes>>{};
+    for(auto index = std::size_t{}; m_dirtyCount && index < (std::size_t{1} << m_shardBits); ++index)
+      {
+      auto & target = m_shards[index];
+      auto lock = std::lock_guard<std::mutex>{target.mutex};
+      for(auto const blockId : target.dirty)
+        {
+        auto const & cached = *target.index.at(blockId);
+        if(cached.kind == kind)
+          {
+          blocks.emplace_back(blockId, cached.data);
+          }
+        }
+      }
+
+    std::sort(blocks.begin(), blocks.end(), [](auto const & lhs, auto const & rhs){ return lhs.first < rhs.first; });
+
+    auto success = true;
+    for(auto first = blocks.begin(); first != blocks.end();)
+      {
+      auto last = std::next(first);
+      while(last != blocks.end() && last->first == std::prev(last)->first + 1 &&
+            static_cast<std::size_t>(last - first) < kMaximumFlushVectors)
+        {
+        ++last;
+        }
+
+      auto vectors = std::vector<io_vector>{};
+      std::transform(first, last, std::back_inserter(vectors), [&](auto const & block){
+        return io_vector{const_cast<u08 *>(block.second.get()), m_blockSize};
+      });
+
+      ++m_writesCount;
+      if(!m_device->write(first->first * m_blockSize, vectors))
+        {
+        success = false;
+        first = last;
+        continue;
+        }
+
+      m_writtenBlocksCount += vectors.size();
+      for(; first != last; ++first)
+        {
+        auto & target = shard_for(first->first);
+        auto lock = std::lock_guard<std::mutex>{target.mutex};
+        target.index.at(first->first)->dirty = false;
+        target.dirty.erase(first->first);
+        --m_dirtyCount;
+        }
+      }
+
+    return success;
+    }
+
+  bytes buffer_cache::dirty_content(u64 const blockId) const
+    {
+    auto & target = shard_for(blockId);
+    auto lock = std::lock_guard<std::mutex>{target.mutex};
+    return target.dirty.count(blockId) ? target.index.at(blockId)->data : nullptr;
+    }
+
+  void buffer_cache::overlay(u64 const offset, std::vector<io_vector> const & vectors) const
+    {
+    auto position = offset;
+    for(auto const & vector : vectors)
+      {
+      auto const destination = static_cast<u08 *>(vector.buffer);
+      for(auto done = std::size_t{}; m_dirtyCount && done < vector.length;)
+        {
+        auto const within = static_cast<std::size_t>((position + done) % m_blockSize);
+        auto const count = std::min<std::size_t>(m_blockSize - within, vector.length - done);
+        if(auto const content = dirty_content((position + done) / m_blockSize))
+          {
+          std::memcpy(destination + done, content.get() + within, count);
+          }
+        done += count;
+        }
+      position += vector.length;
+      }
+    }
+
+  }
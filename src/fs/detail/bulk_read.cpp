@@ -0,0 +1,190 @@
+#include "fs/detail/block_device.hpp"
+#include "fs/detail/bulk_read.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace
+  {
+  using fs::detail::u64;
+
+  struct segment
+    {
+    u64 physical;
+    u64 logical;
+    std::size_t length;
+    std::size_t file;
+    };
+
+  struct request
+    {
+    u64 offset;
+    std::size_t length;
+    std::size_t firstSegment;
+    std::size_t endSegment;
+    };
+
+  std::vector<request> merge(std::vector<segment> const & segments)
+    {
+    using fs::detail::kMaximumBulkGapSize;
+    using fs::detail::kMaximumBulkRequestSize;
+
+    auto requests = std::vector<request>{};
+    for(auto index = std::size_t{}; index < segments.size(); ++index)
+      {
+      auto const & current = segments[index];
+      auto const end = current.physical + current.length;
+      if(!requests.empty())
+        {
+        auto & last = requests.back();
+        if(current.physical <= last.offset + last.length + kMaximumBulkGapSize &&
+           end - last.offset <= kMaximumBulkRequestSize)
+          {
+          last.length = std::max<std::size_t>(last.length, end - last.offset);
+          last.endSegment = index + 1;
+          continue;
+          }
+        }
+
+      requests.push_back(request{current.physical, current.length, index, index + 1});
+      }
+
+    return requests;
+    }
+  }
+
+namespace fs::detail
+  {
+
+  bulk_read_statistics read_bulk(block_device const & device, u32 const blockSize, std::vector<bulk_file> const & files,
+                                 content_sink const & sink, completion_sink const & completion)
+    {
+    auto statistics = bulk_read_statistics{};
+    auto segments = std::vector<segment>{};
+    auto remaining = std::vector<std::size_t>(files.size());
+    auto failed = std::vector<bool>(files.size());
+
+    for(auto index = std::size_t{}; index < files.size(); ++index)
+      {
+      auto const & file = files[index];
+      for(auto const & run : file.runs)
+        {
+        auto const first = run.logical_block_id * blockSize;
+        if(run.sparse() || first >= file.size)
+          {
+          continue;
+          }
+
+        auto const length = std::min(run.blocks_count * blockSize, file.size - first);
+        for(auto done = u64{}; done < length; done += kMaximumBulkRequestSize)
+          {
+          auto const pieceLength = static_cast<std::size_t>(std::min<u64>(kMaximumBulkRequestSize, length - done));
+          segments.push_back(segment{run.physical_block_id * blockSize + done, first + done, pieceLength, index});
+          ++remaining[index];
+          }
+        }
+      }
+
+    auto const complete = [&](std::size_t const index, bool const success){
+      ++(success ? statistics.files_count : statistics.failures_count);
+      if(completion)
+        {
+        completion(files[index].inode_id, success);
+        }
+    };
+
+    for(auto index = std::size_t{}; index < files.size(); ++index)
+      {
+      if(!remaining[index])
+        {
+        complete(index, true);
+        }
+      }
+
+    std::stable_sort(segments.begin(), segments.end(), [](auto const & lhs, auto const & rhs){
+      return lhs.physical < rhs.physical;
+    });
+    auto const requests = merge(segments);
+    statistics.requests_count = requests.size();
+
+    auto const windowEnd = [&](std::size_t const first){
+      auto end = first;
+      auto total = std::size_t{};
+      while(end < requests.size() && (end == first || total + requests[end].length <= kBulkWindowSize))
+        {
+        total += requests[end++].length;
+        }
+      return end;
+    };
+
+    auto buffer = device.mapped() ? nullptr : std::shared_ptr<u08>{new u08[kBulkWindowSize], std::default_delete<u08[]>{}};
+    for(auto first = std::size_t{}, end = windowEnd(0); first < requests.size(); first = end, end = windowEnd(end))
+      {
+      for(auto index = end, next = windowEnd(end); index < next; ++index)
+        {
+        device.prefetch(requests[index].offset, requests[index].length);
+        }
+
+      auto data = std::vector<bytes>(end - first);
+      if(device.mapped())
+        {
+        for(auto index = first; index < end; ++index)
+          {
+          data[index - first] = device.fetch(requests[index].offset, requests[index].length);
+          }
+        }
+      else
+        {
+        auto batch = std::vector<io_request>{};
+        auto position = std::size_t{};
+        for(auto index = first; index < end; ++index)
+          {
+          auto const target = bytes{buffer, buffer.get() + position};
+          auto & result = data[index - first];
+          batch.push_back(io_request{requests[index].offset, {{buffer.get() + position, requests[index].length}},
+                                     [&result, target](bool const success){ result = success ? target : nullptr; }});
+          position += requests[index].length;
+          }
+        device.read_batch(std::move(batch));
+        }
+
+      for(auto index = first; index < end; ++index)
+        {
+        auto const & current = requests[index];
+        auto const & content = data[index - first];
+        for(auto segmentIndex = current.firstSegment; segmentIndex < current.endSegment; ++segmentIndex)
+          {
+          auto const & piece = segments[segmentIndex];
+          if(failed[piece.file])
+            {
+            continue;
+            }
+          else if(!content)
+            {
+            failed[piece.file] = true;
+            complete(piece.file, false);
+            continue;
+            }
+
+          if(!sink(content_piece{files[piece.file].inode_id, piece.logical, content.get() + (piece.physical - current.offset),
+                                 piece.length}))
+            {
+            statistics.stopped = true;
+            return statistics;
+            }
+
+          statistics.bytes_count += piece.length;
+          if(!--remaining[piece.file])
+            {
+            complete(piece.file, true);
+            }
+          }
+        }
+      }
+
+    return statistics;
+    }
+
+  }
@@ -0,0 +1,380 @@
+#include "fs/detail/checksum.hpp"
+#include "fs/detail/directory.hpp"
+#include "fs/detail/extended_attributes.hpp"
+#include "fs/detail/extent_tree.hpp"
+#include "fs/detail/group_descriptor.hpp"
+#include "fs/detail/htree.hpp"
+#include "fs/detail/inode.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define EXTFS_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace
+  {
+  using fs::detail::u08;
+  using fs::detail::u16;
+  using fs::detail::u32;
+  using fs::detail::u64;
+
+  auto constexpr kPolynomial = u32{0x82f63b78};
+  auto constexpr kCrc32cChecksumType = 1u;
+  auto constexpr kBaseInodeSize = 128u;
+  auto constexpr kDirectoryTailFileType = u08{0xde};
+  auto constexpr kRootCountOffset = 32u;
+  auto constexpr kNodeCountOffset = 8u;
+  auto constexpr kDotRecordLength = 12u;
+  auto constexpr kRootInfoOffset = 24u;
+
+  static_assert(offsetof(fs::detail::superblock, checksum_seed) == 0x270, "Misplaced superblock checksum seed!");
+  static_assert(offsetof(fs::detail::superblock, checksum) == 0x3fc, "Misplaced superblock checksum!");
+
+  using crc_tables = std::array<std::array<u32, 256>, 8>;
+
+  crc_tables const & tables()
+    {
+    static auto const generated = []{
+      auto result = crc_tables{};
+      for(auto byte = 0u; byte < 256; ++byte)
+        {
+        auto crc = byte;
+        for(auto bit = 0; bit < 8; ++bit)
+          {
+          crc = (crc >> 1) ^ (crc & 1 ? kPolynomial : 0);
+          }
+        result[0][byte] = crc;
+        }
+
+      for(auto byte = 0u; byte < 256; ++byte)
+        {
+        for(auto slice = 1u; slice < result.size(); ++slice)
+          {
+          auto const previous = result[slice - 1][byte];
+          result[slice][byte] = (previous >> 8) ^ result[0][previous & 0xff];
+          }
+        }
+
+      return result;
+    }();
+
+    return generated;
+    }
+
+  u32 table(u32 crc, u08 const * data, std::size_t length)
+    {
+    auto const & lookup = tables();
+    while(length >= sizeof(u64))
+      {
+      auto word = u64{};
+      std::memcpy(&word, data, sizeof(word));
+      word ^= crc;
+      crc = lookup[7][word & 0xff] ^ lookup[6][(word >> 8) & 0xff] ^ lookup[5][(word >> 16) & 0xff] ^
+            lookup[4][(word >> 24) & 0xff] ^ lookup[3][(word >> 32) & 0xff] ^ lookup[2][(word >> 40) & 0xff] ^
+            lookup[1][(word >> 48) & 0xff] ^ lookup[0][word >> 56];
+      data += sizeof(word);
+      length -= sizeof(word);
+      }
+
+    while(length--)
+      {
+      crc = (crc >> 8) ^ lookup[0][(crc ^ *data++) & 0xff];
+      }
+
+    return crc;
+    }
+
+#ifdef EXTFS_X86_KERNELS
+  __attribute__((target("sse4.2"))) u32 sse42(u32 const crc, u08 const * data, std::size_t length)
+    {
+    auto state = u64{crc};
+    while(length >= sizeof(u64))
+      {
+      auto word = u64{};
+      std::memcpy(&word, data, sizeof(word));
+      state = _mm_crc32_u64(state, word);
+      data += sizeof(word);
+      length -= sizeof(word);
+      }
+
+    auto result = static_cast<u32>(state);
+    while(length--)
+      {
+      result = _mm_crc32_u8(result, *data++);
+      }
+
+    return result;
+    }
+#endif
+
+  template<typename Value>
+  u32 crc32c_of(u32 const crc, Value const & value)
+    {
+    return fs::detail::crc32c(crc, &value, sizeof(value));
+    }
+
+  bool all_zero(u08 const * const data, std::size_t const length)
+    {
+    return std::all_of(data, data + length, [](auto const byte){ return !byte; });
+    }
+
+  bool verify_index_block(u32 const inodeSeed, u08 const * const block, std::size_t const blockSize,
+                          std::size_t const countOffset)
+    {
+    auto header = fs::detail::dx_count_limit{};
+    std::memcpy(&header, block + countOffset, sizeof(header));
+    auto const tailOffset = countOffset + header.limit * sizeof(fs::detail::dx_entry);
+    if(header.count > header.limit || tailOffset + 2 * sizeof(u32) > blockSize)
+      {
+      return false;
+      }
+
+    auto reserved = u32{};
+    auto expected = u32{};
+    std::memcpy(&reserved, block + tailOffset, sizeof(reserved));
+    std::memcpy(&expected, block + tailOffset + sizeof(reserved), sizeof(expected));
+
+    auto const covered = countOffset + header.count * sizeof(fs::detail::dx_entry);
+    return crc32c_of(crc32c_of(fs::detail::crc32c(inodeSeed, block, covered), reserved), u32{}) == expected;
+    }
+
+  bool verify_directory(u32 const inodeSeed, u08 const * const block, std::size_t const blockSize)
+    {
+    auto const tailSize = sizeof(fs::detail::directory_entry) + sizeof(u32);
+    if(blockSize < kRootCountOffset + sizeof(fs::detail::dx_count_limit) || blockSize < tailSize)
+      {
+      return false;
+      }
+
+    auto tail = fs::detail::directory_entry{};
+    std::memcpy(&tail, block + blockSize - tailSize, sizeof(tail));
+    if(!tail.inode_id && tail.record_length == tailSize && !tail.name_length && tail.type == kDirectoryTailFileType)
+      {
+      auto expected = u32{};
+      std::memcpy(&expected, block + blockSize - sizeof(expected), sizeof(expected));
+      return fs::detail::crc32c(inodeSeed, block, blockSize - tailSize) == expected;
+      }
+
+    auto first = fs::detail::directory_entry{};
+    std::memcpy(&first, block, sizeof(first));
+    if(first.record_length == blockSize)
+      {
+      return verify_index_block(inodeSeed, block, blockSize, kNodeCountOffset);
+      }
+
+    auto second = fs::detail::directory_entry{};
+    std::memcpy(&second, block + first.record_length % blockSize, sizeof(second));
+    auto info = fs::detail::dx_root_info{};
+    std::memcpy(&info, block + kRootInfoOffset, sizeof(info));
+    if(first.record_length == kDotRecordLength && second.record_length == blockSize - kDotRecordLength && info.info_length == sizeof(info))
+      {
+      return verify_index_block(inodeSeed, block, blockSize, kRootCountOffset);
+      }
+
+    return false;
+    }
+  }
+
+namespace fs::detail
+  {
+
+  bool supported(crc32c_kernel const kernel)
+    {
+    switch(kernel)
+      {
+      case crc32c_kernel::table:
+        return true;
+#ifdef EXTFS_X86_KERNELS
+      case crc32c_kernel::sse42:
+        return __builtin_cpu_supports("sse4.2");
+#endif
+      default:
+        return false;
+      }
+    }
+
+  crc32c_kernel best_crc32c_kernel()
+    {
+    static auto const best = supported(crc32c_kernel::sse42) ? crc32c_kernel::sse42 : crc32c_kernel::table;
+    return best;
+    }
+
+  u32 crc32c(u32 const crc, void const * const data, std::size_t const length)
+    {
+    return crc32c(crc, data, length, best_crc32c_kernel());
+    }
+
+  u32 crc32c(u32 const crc, void const * const data, std::size_t const length, crc32c_kernel const kernel)
+    {
+    auto const bytes = static_cast<u08 const *>(data);
+    switch(kernel)
+      {
+#ifdef EXTFS_X86_KERNELS
+      case crc32c_kernel::sse42:
+        return sse42(crc, bytes, length);
+#endif
+      default:
+        return table(crc, bytes, length);
+      }
+    }
+
+  bool verify_superblock(superblock const & block)
+    {
+    if(!block.has(superblock::read_only_compatible_feature::metadata_checksum))
+      {
+      return true;
+      }
+
+    return block.checksum_type == kCrc32cChecksumType &&
+           crc32c(~u32{}, &block, offsetof(superblock, checksum)) == block.checksum;
+    }
+
+  metadata_checksums::metadata_checksums(superblock const & block) :
+    m_seed{block.has(superblock::incompatible_feature::metadata_checksum_seed_in_superblock)
+             ? block.checksum_seed
+             : crc32c(~u32{}, block.uuid.data(), block.uuid.size())}
+    {
+    }
+
+  u32 metadata_checksums::seed() const
+    {
+    return m_seed;
+    }
+
+  u32 metadata_checksums::inode_seed(u32 const inodeId, u32 const generation) const
+    {
+    return crc32c_of(crc32c_of(m_seed, inodeId), generation);
+    }
+
+  bool metadata_checksums::verify_group_descriptor(u32 const group, u08 const * const descriptor, u32 const size) const
+    {
+    auto constexpr checksumOffset = offsetof(group_descriptor, checksum);
+    auto constexpr checksumEnd = checksumOffset + sizeof(group_descriptor::checksum);
+    if(size < checksumEnd)
+      {
+      return count(false);
+      }
+
+    auto expected = u16{};
+    std::memcpy(&expected, descriptor + checksumOffset, sizeof(expected));
+
+    auto crc = crc32c_of(m_seed, group);
+    crc = crc32c(crc, descriptor, checksumOffset);
+    crc = crc32c_of(crc, u16{});
+    crc = crc32c(crc, descriptor + checksumEnd, size - checksumEnd);
+    return count(static_cast<u16>(crc) == expected);
+    }
+
+  bool metadata_checksums::verify_bitmap(u08 const * const bitmap, std::size_t const length, u32 const expected,
+                                         bool const wide) const
+    {
+    auto const crc = crc32c(m_seed, bitmap, length);
+    return count(wide ? crc == expected : static_cast<u16>(crc) == static_cast<u16>(expected));
+    }
+
+  bool metadata_checksums::verify_inode(u32 const inodeId, u08 const * const node, u32 const size) const
+    {
+    auto constexpr lowOffset = offsetof(inode, checksum_lo);
+    auto constexpr highOffset = offsetof(inode, checksum_hi);
+    auto constexpr highEnd = highOffset + sizeof(inode::checksum_hi);
+    if(size < kBaseInodeSize)
+      {
+      return count(false);
+      }
+    else if(all_zero(node, size))
+      {
+      return true;
+      }
+
+    auto header = inode{};
+    std::memcpy(&header, node, std::min<std::size_t>(size, sizeof(header)));
+    auto const wide = size > kBaseInodeSize && kBaseInodeSize + header.extra_size >= highEnd;
+
+    auto crc = inode_seed(inodeId, header.generation);
+    crc = crc32c(crc, node, lowOffset);
+    crc = crc32c_of(crc, u16{});
+    crc = crc32c(crc, node + lowOffset + sizeof(u16), kBaseInodeSize - lowOffset - sizeof(u16));
+    if(size > kBaseInodeSize)
+      {
+      crc = crc32c(crc, node + kBaseInodeSize, highOffset - kBaseInodeSize);
+      if(wide)
+        {
+        crc = crc32c_of(crc, u16{});
+        crc = crc32c(crc, node + highEnd, size - highEnd);
+        }
+      else
+        {
+        crc = crc32c(crc, node + highOffset, size - highOffset);
+        }
+      }
+
+    if(wide)
+      {
+      return count(crc == (header.checksum_lo | u32{header.checksum_hi} << 16));
+      }
+
+    return count(static_cast<u16>(crc) == header.checksum_lo);
+    }
+
+  bool metadata_checksums::verify_extent_block(u32 const inodeSeed, u08 const * const block,
+                                               std::size_t const blockSize) const
+    {
+    auto header = extent_header{};
+    std::memcpy(&header, block, sizeof(header));
+    auto const tailOffset = sizeof(header) + header.maximum_entries_count * sizeof(extent);
+    if(tailOffset + sizeof(u32) > blockSize)
+      {
+      return count(false);
+      }
+
+    auto expected = u32{};
+    std::memcpy(&expected, block + tailOffset, sizeof(expected));
+    return count(crc32c(inodeSeed, block, tailOffset) == expected);
+    }
+
+  bool metadata_checksums::verify_directory_block(u32 const inodeSeed, u08 const * const block,
+                                                  std::size_t const blockSize) const
+    {
+    return count(verify_directory(inodeSeed, block, blockSize));
+    }
+
+  bool metadata_checksums::verify_attribute_block(u64 const blockId, u08 const * const block,
+                                                  std::size_t const blockSize) const
+    {
+    auto constexpr checksumOffset = offsetof(extended_attribute_block_header, checksum);
+    auto constexpr checksumEnd = checksumOffset + sizeof(extended_attribute_block_header::checksum);
+    if(blockSize < sizeof(extended_attribute_block_header))
+      {
+      return count(false);
+      }
+
+    auto expected = u32{};
+    std::memcpy(&expected, block + checksumOffset, sizeof(expected));
+
+    auto crc = crc32c_of(m_seed, blockId);
+    crc = crc32c(crc, block, checksumOffset);
+    crc = crc32c_of(crc, u32{});
+    crc = crc32c(crc, block + checksumEnd, blockSize - checksumEnd);
+    return count(crc == expected);
+    }
+
+  u64 metadata_checksums::failures_count() const
+    {
+    return m_failuresCount.load(std::memory_order_relaxed);
+    }
+
+  bool metadata_checksums::count(bool const valid) const
+    {
+    if(!valid)
+      {
+      m_failuresCount.fetch_add(1, std::memory_order_relaxed);
+      }
+    return valid;
+    }
+
+  }
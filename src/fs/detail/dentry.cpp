@@ -0,0 +1,29 @@
+#include "fs/detail/dentry.hpp"
+
+#include <functional>
+#include <string>
+
+namespace
+  {
+  auto constexpr kEntryOverhead = 96u;
+  }
+
+namespace fs::detail
+  {
+
+  std::size_t dentry_key::footprint() const
+    {
+    return kEntryOverhead + 2 * (sizeof(*this) + name.size());
+    }
+
+  bool dentry_key::operator==(dentry_key const & other) const
+    {
+    return parent_id == other.parent_id && name == other.name;
+    }
+
+  std::size_t dentry_key_hash::operator()(dentry_key const & key) const
+    {
+    return std::hash<std::string>{}(key.name) ^ static_cast<std::size_t>(key.parent_id * 0x9e3779b97f4a7c15ull);
+    }
+
+  }
@@ -0,0 +1,39 @@
+#include "fs/detail/directory.hpp"
+
+#include <optional>
+#include <string_view>
+
+namespace fs::detail
+  {
+
+  directory_entry::file_type entry_type_of(inode::file_type const type)
+    {
+    switch(type)
+      {
+      case inode::file_type::fifo: return directory_entry::file_type::fifo;
+      case inode::file_type::character_device: return directory_entry::file_type::character_device;
+      case inode::file_type::directory: return directory_entry::file_type::directory;
+      case inode::file_type::block_device: return directory_entry::file_type::block_device;
+      case inode::file_type::regular_file: return directory_entry::file_type::regular_file;
+      case inode::file_type::symbolic_link: return directory_entry::file_type::symbolic_link;
+      case inode::file_type::socket: return directory_entry::file_type::socket;
+      }
+
+    return directory_entry::file_type::unknown;
+    }
+
+  std::optional<u32> find_entry(u08 const * const block, std::size_t const blockSize, std::string_view const name)
+    {
+    auto found = u32{};
+    auto const valid = visit_entries(block, blockSize, [&](auto const inodeId, auto const entryName, auto){
+      if(entryName == name)
+        {
+        found = inodeId;
+        }
+      return !found;
+    });
+
+    return valid ? std::optional<u32>{found} : std::nullopt;
+    }
+
+  }
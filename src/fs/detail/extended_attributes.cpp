@@ -0,0 +1,107 @@
+#include "fs/detail/extended_attributes.hpp"
+#include "fs/detail/inode.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+
+namespace
+  {
+  auto constexpr kBaseInodeSize = 128u;
+
+  struct attribute_prefix
+    {
+    fs::detail::attribute_namespace space;
+    std::string_view prefix;
+    };
+
+  /* Prefixes naming a single attribute come before the namespace they are part of */
+  auto constexpr kAttributePrefixes = std::array<attribute_prefix, 7>{{
+    {fs::detail::attribute_namespace::posix_acl_access, "system.posix_acl_access"},
+    {fs::detail::attribute_namespace::posix_acl_default, "system.posix_acl_default"},
+    {fs::detail::attribute_namespace::system_richacl, "system.richacl"},
+    {fs::detail::attribute_namespace::user, "user."},
+    {fs::detail::attribute_namespace::trusted, "trusted."},
+    {fs::detail::attribute_namespace::security, "security."},
+    {fs::detail::attribute_namespace::system, "system."},
+  }};
+
+  bool names_namespace(attribute_prefix const & prefix)
+    {
+    return prefix.prefix.back() == '.';
+    }
+  }
+
+namespace fs::detail
+  {
+
+  attribute_region in_inode_attributes(u08 const * const rawInode, u32 const inodeSize)
+    {
+    auto extraSize = u16{};
+    std::memcpy(&extraSize, rawInode + offsetof(inode, extra_size), sizeof(extraSize));
+    auto const start = std::size_t{kBaseInodeSize} + extraSize;
+    if(inodeSize <= kBaseInodeSize || start + sizeof(u32) > inodeSize)
+      {
+      return {};
+      }
+
+    auto magic = u32{};
+    std::memcpy(&magic, rawInode + start, sizeof(magic));
+    if(magic != kExtendedAttributeMagic)
+      {
+      return {};
+      }
+
+    return {rawInode + start + sizeof(magic), inodeSize - start - sizeof(magic)};
+    }
+
+  attribute_region block_attributes(u08 const * const block, std::size_t const blockSize)
+    {
+    auto header = extended_attribute_block_header{};
+    if(blockSize <= sizeof(header))
+      {
+      return {};
+      }
+
+    std::memcpy(&header, block, sizeof(header));
+    if(header.magic != kExtendedAttributeMagic || header.blocks_count != 1)
+      {
+      return {};
+      }
+
+    return {block + sizeof(header), blockSize - sizeof(header)};
+    }
+
+  std::optional<std::string> attribute_name(u08 const nameIndex, std::string_view const name)
+    {
+    for(auto const & prefix : kAttributePrefixes)
+      {
+      if(static_cast<u08>(prefix.space) == nameIndex)
+        {
+        return std::string{prefix.prefix}.append(name);
+        }
+      }
+
+    return std::nullopt;
+    }
+
+  std::optional<std::pair<u08, std::string_view>> split_attribute_name(std::string_view const name)
+    {
+    for(auto const & prefix : kAttributePrefixes)
+      {
+      if(name.substr(0, prefix.prefix.size()) != prefix.prefix)
+        {
+        continue;
+        }
+
+      auto const suffix = name.substr(prefix.prefix.size());
+      if(names_namespace(prefix) != suffix.empty())
+        {
+        return std::pair{static_cast<u08>(prefix.space), suffix};
+        }
+      }
+
+    return std::nullopt;
+    }
+
+  }
@@ -0,0 +1,147 @@
+#include "fs/detail/extent_tree.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <optional>
+
+namespace
+  {
+  auto constexpr kExtentMagic = 0xf30a;
+  auto constexpr kMaximumDepth = 5;
+  auto constexpr kMaximumInitializedLength = 32768u;
+  auto constexpr kLogicalBlocksLimit = fs::detail::u64{1} << 32;
+
+  bool valid_node(fs::detail::extent_header const & header, std::size_t const nodeSize)
+    {
+    return header.magic_number == kExtentMagic &&
+           header.entries_count <= header.maximum_entries_count &&
+           sizeof(header) + header.entries_count * sizeof(fs::detail::extent) <= nodeSize &&
+           header.depth <= kMaximumDepth;
+    }
+  }
+
+namespace fs::detail
+  {
+
+  u64 extent_index::child_block_id() const
+    {
+    return child_block_id_lo | u64{child_block_id_hi} << 32;
+    }
+
+  u64 extent::physical_block_id() const
+    {
+    return physical_block_id_lo | u64{physical_block_id_hi} << 32;
+    }
+
+  u32 extent::blocks_count() const
+    {
+    return length > kMaximumInitializedLength ? length - kMaximumInitializedLength : length;
+    }
+
+  bool extent::uninitialized() const
+    {
+    return length > kMaximumInitializedLength;
+    }
+
+  extent_status::extent_status(block_device const & device, u32 const blockSize, u32_arr<15> const & root,
+                               metadata_checksums const * const checksums, u32 const inodeSeed) :
+    m_device{device},
+    m_blockSize{blockSize},
+    m_root{root},
+    m_checksums{checksums},
+    m_inodeSeed{inodeSeed}
+    {
+    }
+
+  bool extent_status::load(u64 const logicalBlock, u64 const)
+    {
+    auto storage = bytes{};
+    auto node = reinterpret_cast<u08 const *>(m_root.data());
+    auto nodeSize = sizeof(m_root);
+    auto lower = u64{};
+    auto upper = kLogicalBlocksLimit;
+    auto expectedDepth = std::optional<u16>{};
+
+    while(true)
+      {
+      auto header = extent_header{};
+      std::memcpy(&header, node, sizeof(header));
+      if(!valid_node(header, nodeSize) || (expectedDepth && header.depth != *expectedDepth))
+        {
+        return false;
+        }
+
+      auto const entries = node + sizeof(header);
+      if(!header.depth)
+        {
+        for(auto index = 0u; index < header.entries_count; ++index)
+          {
+          auto leaf = extent{};
+          std::memcpy(&leaf, entries + index * sizeof(leaf), sizeof(leaf));
+          auto const first = std::max<u64>(leaf.logical_block_id, lower);
+          auto const last = std::min<u64>(u64{leaf.logical_block_id} + leaf.blocks_count(), upper);
+          if(first < last)
+            {
+            auto const physical = leaf.physical_block_id() + (first - leaf.logical_block_id);
+            remember(first, physical, last - first, leaf.uninitialized());
+            }
+          }
+
+        cover(lower, upper);
+        return true;
+        }
+
+      auto selected = -1;
+      for(auto index = 0; index < header.entries_count; ++index)
+        {
+        auto candidate = extent_index{};
+        std::memcpy(&candidate, entries + index * sizeof(candidate), sizeof(candidate));
+        if(candidate.logical_block_id > logicalBlock)
+          {
+          break;
+          }
+        selected = index;
+        }
+
+      if(selected < 0)
+        {
+        auto first = extent_index{};
+        if(header.entries_count)
+          {
+          std::memcpy(&first, entries, sizeof(first));
+          }
+
+        auto const holeEnd = header.entries_count ? std::min<u64>(first.logical_block_id, upper) : upper;
+        cover(lower, std::max(holeEnd, logicalBlock + 1));
+        return true;
+        }
+
+      auto child = extent_index{};
+      std::memcpy(&child, entries + selected * sizeof(child), sizeof(child));
+      if(selected + 1 < header.entries_count)
+        {
+        auto next = extent_index{};
+        std::memcpy(&next, entries + (selected + 1) * sizeof(next), sizeof(next));
+        upper = std::min<u64>(next.logical_block_id, upper);
+        }
+      lower = std::max<u64>(child.logical_block_id, lower);
+
+      if(lower >= upper)
+        {
+        return false;
+        }
+
+      storage = m_device.fetch(child.child_block_id() * m_blockSize, m_blockSize);
+      if(!storage || (m_checksums && !m_checksums->verify_extent_block(m_inodeSeed, storage.get(), m_blockSize)))
+        {
+        return false;
+        }
+
+      count_loaded_blocks(1);
+      expectedDepth = header.depth - 1;
+      node = storage.get();
+      nodeSize = m_blockSize;
+      }
+    }
+
+  }
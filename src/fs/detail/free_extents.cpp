@@ -0,0 +1,173 @@
+#include "fs/detail/bitmap_scan.hpp"
+#include "fs/detail/free_extents.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace
+  {
+  auto constexpr kWordBits = 64u;
+  auto constexpr kAllUsed = ~fs::detail::u64{};
+
+  fs::detail::u64 word_at(fs::detail::u08 const * const bitmap, std::size_t const index, std::size_t const bitsCount)
+    {
+    auto const firstByte = index * sizeof(fs::detail::u64);
+    auto const bytesCount = std::min<std::size_t>(sizeof(fs::detail::u64), (bitsCount + 7) / 8 - firstByte);
+    auto word = fs::detail::u64{};
+    std::memcpy(&word, bitmap + firstByte, bytesCount);
+    return word;
+    }
+  }
+
+namespace fs::detail
+  {
+
+  std::size_t free_extent_histogram::bucket(u64 const length)
+    {
+    return length ? kWordBits - 1 - static_cast<std::size_t>(__builtin_clzll(length)) : 0;
+    }
+
+  void free_extent_histogram::add(u64 const length)
+    {
+    if(!length)
+      {
+      return;
+      }
+
+    auto const index = bucket(length);
+    ++extents_count[index];
+    blocks_count[index] += length;
+    ++free_extents_count;
+    free_blocks_count += length;
+    largest_extent = std::max(largest_extent, length);
+    smallest_extent = smallest_extent ? std::min(smallest_extent, length) : length;
+    }
+
+  void free_extent_histogram::merge(free_extent_histogram const & other)
+    {
+    for(auto index = std::size_t{}; index < kBucketsCount; ++index)
+      {
+      extents_count[index] += other.extents_count[index];
+      blocks_count[index] += other.blocks_count[index];
+      }
+
+    free_extents_count += other.free_extents_count;
+    free_blocks_count += other.free_blocks_count;
+    largest_extent = std::max(largest_extent, other.largest_extent);
+    if(other.smallest_extent)
+      {
+      smallest_extent = smallest_extent ? std::min(smallest_extent, other.smallest_extent) : other.smallest_extent;
+      }
+    }
+
+  double free_extent_histogram::average_extent() const
+    {
+    return free_extents_count ? static_cast<double>(free_blocks_count) / free_extents_count : 0.0;
+    }
+
+  void visit_free_runs(u08 const * const bitmap, std::size_t const bitsCount, free_run_visitor const & visitor)
+    {
+    auto const wordsCount = (bitsCount + kWordBits - 1) / kWordBits;
+    auto start = std::size_t{};
+    auto length = u64{};
+
+    auto const extend = [&](std::size_t const position, u64 const count){
+      if(length && start + length != position)
+        {
+        visitor(start, length);
+        length = 0;
+        }
+      if(!length)
+        {
+        start = position;
+        }
+      length += count;
+    };
+
+    for(auto index = std::size_t{}; index < wordsCount; ++index)
+      {
+      auto const first = index * kWordBits;
+      auto const validBits = static_cast<unsigned>(std::min<std::size_t>(kWordBits, bitsCount - first));
+      auto const valid = validBits < kWordBits ? ~(kAllUsed << validBits) : kAllUsed;
+      auto freeBits = ~word_at(bitmap, index, bitsCount) & valid;
+      while(freeBits)
+        {
+        auto const position = static_cast<unsigned>(__builtin_ctzll(freeBits));
+        auto const rest = freeBits >> position;
+        auto const count = rest == kAllUsed >> position ? kWordBits - position : static_cast<unsigned>(__builtin_ctzll(~rest));
+        extend(first + position, count);
+        freeBits = count + position < kWordBits ? freeBits & (kAllUsed << (position + count)) : 0;
+        }
+      }
+
+    if(length)
+      {
+      visitor(start, length);
+      }
+    }
+
+  bitmap_runs find_free_runs(u08 const * const bitmap, std::size_t const bitsCount)
+    {
+    auto runs = bitmap_runs{};
+    visit_free_runs(bitmap, bitsCount, [&](auto const first, auto const length){
+      if(!first)
+        {
+        runs.head = length;
+        }
+      if(first + length == bitsCount)
+        {
+        runs.tail = length;
+        }
+      if(first && first + length != bitsCount)
+        {
+        runs.interior.add(length);
+        }
+    });
+
+    runs.completely_free = bitsCount > 0 && runs.head == bitsCount;
+    return runs;
+    }
+
+  std::optional<fragmentation_report> scan_free_extents(block_device const & device, geometry const & layout,
+                                                        group_descriptor_table const & groups, unsigned const threads)
+    {
+    auto runs = std::vector<bitmap_runs>(layout.groups_count());
+    auto const visited = visit_bitmaps(device, layout, groups, threads, [&](auto const & group, auto blockBitmap, auto){
+      runs[group.id] = find_free_runs(blockBitmap, layout.group_blocks_count(group.id));
+    });
+
+    if(!visited)
+      {
+      return std::nullopt;
+      }
+
+    auto report = fragmentation_report{};
+    report.groups.reserve(runs.size());
+    auto carried = u64{};
+    for(auto const & group : runs)
+      {
+      auto histogram = group.interior;
+      histogram.add(group.head);
+      if(!group.completely_free)
+        {
+        histogram.add(group.tail);
+        }
+      report.groups.push_back(histogram);
+
+      if(group.completely_free)
+        {
+        carried += group.head;
+        continue;
+        }
+
+      report.total.add(carried + group.head);
+      report.total.merge(group.interior);
+      carried = group.tail;
+      }
+    report.total.add(carried);
+
+    return report;
+    }
+
+  }
@@ -0,0 +1,301 @@
+#include "fs/detail/geometry.hpp"
+#include "fs/detail/superblock.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+  {
+  auto constexpr kBaseBlockSize = 1024u;
+  auto constexpr kBaseDescriptorSize = 32u;
+  auto constexpr kBaseInodeSize = 128u;
+  auto constexpr kMaximumLogicalBlockSize = 6u;
+  auto constexpr kPrimarySuperblockOffset = 1024u;
+
+  bool is_power_of(fs::detail::u32 value, fs::detail::u32 const base)
+    {
+    while(value > 1 && !(value % base))
+      {
+      value /= base;
+      }
+
+    return value == 1;
+    }
+  }
+
+namespace fs::detail
+  {
+
+  geometry::geometry(superblock const & block) :
+    m_blockSize{kBaseBlockSize << block.logical_block_size},
+    m_firstDataBlockId{block.first_data_block_id},
+    m_blocksPerGroup{block.blocks_per_group},
+    m_inodesPerGroup{block.inodes_per_group},
+    m_inodesCount{block.inodes_count},
+    m_firstMetaBlockGroupId{block.first_meta_block_group_id},
+    m_reservedDescriptorBlocksCount{block.reserved_descriptor_blocks_count},
+    m_superblockGroup{block.superblock_group_id},
+    m_flexibleGroupSize{block.has(superblock::incompatible_feature::flexible_block_groups) &&
+                        block.logical_flexible_group_size < 32 ? 1u << block.logical_flexible_group_size : 1u},
+    m_metaBlockGroups{block.has(superblock::incompatible_feature::meta_block_group)},
+    m_sparseSuperblock{block.has(superblock::read_only_compatible_feature::sparse_superblock)},
+    m_sparseSuperblockV2{block.has(superblock::compatible_feature::sparse_superblock_v2)},
+    m_lazyGroupInitialization{block.has(superblock::compatible_feature::lazy_block_group_initialization) ||
+                              block.has(superblock::read_only_compatible_feature::group_descriptor_checksum) ||
+                              block.has(superblock::read_only_compatible_feature::metadata_checksum)},
+    m_backupGroupIds{block.backup_group_ids}
+    {
+    auto const is64Bit = block.has(superblock::incompatible_feature::large_file_system);
+    auto const isDynamic = block.revision_level != static_cast<superblock::rlv>(superblock::revision_level::good_old);
+
+    m_inodeSize = isDynamic && block.inode_size ? block.inode_size : kBaseInodeSize;
+
+    m_blocksCount = block.blocks_count;
+    if(is64Bit)
+      {
+      m_blocksCount |= static_cast<u64>(block.blocks_count_hi) << 32;
+      }
+
+    m_descriptorSize = is64Bit ? std::max<u32>(block.group_descriptor_size, kBaseDescriptorSize) : kBaseDescriptorSize;
+    m_descriptorsPerBlock = m_blockSize / m_descriptorSize;
+
+    if(m_blocksPerGroup && m_blocksCount > m_firstDataBlockId)
+      {
+      m_groupsCount = static_cast<u32>((m_blocksCount - m_firstDataBlockId + m_blocksPerGroup - 1) / m_blocksPerGroup);
+      m_descriptorBlocksCount = (m_groupsCount + m_descriptorsPerBlock - 1) / m_descriptorsPerBlock;
+      }
+    }
+
+  u32 geometry::block_size() const
+    {
+    return m_blockSize;
+    }
+
+  u64 geometry::blocks_count() const
+    {
+    return m_blocksCount;
+    }
+
+  u32 geometry::groups_count() const
+    {
+    return m_groupsCount;
+    }
+
+  u32 geometry::descriptor_size() const
+    {
+    return m_descriptorSize;
+    }
+
+  u32 geometry::descriptors_per_block() const
+    {
+    return m_descriptorsPerBlock;
+    }
+
+  u32 geometry::descriptor_blocks_count() const
+    {
+    return m_descriptorBlocksCount;
+    }
+
+  u64 geometry::descriptor_block_id(u32 const index) const
+    {
+    if(!m_metaBlockGroups || index < m_firstMetaBlockGroupId)
+      {
+      return group_first_block_id(m_superblockGroup) + 1 + index;
+      }
+
+    auto group = index * m_descriptorsPerBlock;
+    if(m_superblockGroup && group + 1 < m_groupsCount)
+      {
+      ++group;
+      }
+
+    auto offset = has_superblock(group) ? 1u : 0u;
+    if(m_blockSize == kBaseBlockSize && !m_firstDataBlockId)
+      {
+      ++offset;
+      }
+
+    return group_first_block_id(group) + offset;
+    }
+
+  u64 geometry::group_first_block_id(u32 const group) const
+    {
+    return u64{m_firstDataBlockId} + u64{group} * m_blocksPerGroup;
+    }
+
+  u32 geometry::blocks_per_group() const
+    {
+    return m_blocksPerGroup;
+    }
+
+  u32 geometry::group_blocks_count(u32 const group) const
+    {
+    if(group + 1 < m_groupsCount)
+      {
+      return m_blocksPerGroup;
+      }
+
+    return static_cast<u32>(m_blocksCount - group_first_block_id(group));
+    }
+
+  bool geometry::has_superblock(u32 const group) const
+    {
+    if(!group)
+      {
+      return true;
+      }
+    else if(m_sparseSuperblockV2)
+      {
+      return group == m_backupGroupIds[0] || group == m_backupGroupIds[1];
+      }
+    else if(group == 1 || !m_sparseSuperblock)
+      {
+      return true;
+      }
+    else if(!(group & 1))
+      {
+      return false;
+      }
+
+    return is_power_of(group, 3) || is_power_of(group, 5) || is_power_of(group, 7);
+    }
+
+  bool geometry::lazy_group_initialization() const
+    {
+    return m_lazyGroupInitialization;
+    }
+
+  u32 geometry::flexible_group_size() const
+    {
+    return m_flexibleGroupSize;
+    }
+
+  u32 geometry::superblock_group() const
+    {
+    return m_superblockGroup;
+    }
+
+  std::vector<u32> geometry::superblock_groups() const
+    {
+    auto groups = std::vector<u32>{};
+    if(!m_groupsCount)
+      {
+      return groups;
+      }
+
+    groups.push_back(0);
+    if(m_sparseSuperblockV2)
+      {
+      for(auto const group : m_backupGroupIds)
+        {
+        if(group && group < m_groupsCount)
+          {
+          groups.push_back(group);
+          }
+        }
+      }
+    else if(!m_sparseSuperblock)
+      {
+      for(auto group = 1u; group < m_groupsCount; ++group)
+        {
+        groups.push_back(group);
+        }
+      }
+    else
+      {
+      for(auto const base : {3ull, 5ull, 7ull})
+        {
+        for(auto group = 1ull; group < m_groupsCount; group *= base)
+          {
+          groups.push_back(static_cast<u32>(group));
+          }
+        }
+      }
+
+    std::sort(groups.begin(), groups.end());
+    groups.erase(std::unique(groups.begin(), groups.end()), groups.end());
+    return groups;
+    }
+
+  u64 geometry::superblock_offset(u32 const group) const
+    {
+    if(!group)
+      {
+      return kPrimarySuperblockOffset;
+      }
+
+    return group_first_block_id(group) * m_blockSize;
+    }
+
+  u32 geometry::group_overhead_blocks_count(u32 const group) const
+    {
+    auto const hasSuperblock = has_superblock(group);
+    auto overhead = hasSuperblock ? 1u : 0u;
+    if(!m_metaBlockGroups || group / m_descriptorsPerBlock < m_firstMetaBlockGroupId)
+      {
+      if(hasSuperblock)
+        {
+        overhead += m_metaBlockGroups ? m_firstMetaBlockGroupId : m_descriptorBlocksCount + m_reservedDescriptorBlocksCount;
+        }
+      return overhead;
+      }
+
+    auto const position = group % m_descriptorsPerBlock;
+    if(position == 0 || position == 1 || position == m_descriptorsPerBlock - 1)
+      {
+      ++overhead;
+      }
+
+    return overhead;
+    }
+
+  u32 geometry::inode_size() const
+    {
+    return m_inodeSize;
+    }
+
+  u32 geometry::inodes_count() const
+    {
+    return m_inodesCount;
+    }
+
+  u32 geometry::inodes_per_group() const
+    {
+    return m_inodesPerGroup;
+    }
+
+  u32 geometry::inode_group(u32 const inodeId) const
+    {
+    return (inodeId - 1) / m_inodesPerGroup;
+    }
+
+  u32 geometry::inode_index(u32 const inodeId) const
+    {
+    return (inodeId - 1) % m_inodesPerGroup;
+    }
+
+  u32 geometry::inode_table_blocks_count() const
+    {
+    if(!m_blockSize)
+      {
+      return 0;
+      }
+
+    return static_cast<u32>((u64{m_inodesPerGroup} * m_inodeSize + m_blockSize - 1) / m_blockSize);
+    }
+
+  bool valid_geometry(superblock const & block)
+    {
+    if(block.logical_block_size > kMaximumLogicalBlockSize || !block.blocks_per_group || !block.inodes_per_group)
+      {
+      return false;
+      }
+
+    auto const blockSize = kBaseBlockSize << block.logical_block_size;
+    auto const descriptorSize = block.has(superblock::incompatible_feature::large_file_system)
+                                  ? std::max<u32>(block.group_descriptor_size, kBaseDescriptorSize)
+                                  : kBaseDescriptorSize;
+    return descriptorSize <= blockSize && is_power_of(descriptorSize, 2);
+    }
+
+  }
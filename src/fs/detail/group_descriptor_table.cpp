@@ -0,0 +1,168 @@
+#include "fs/detail/group_descriptor_table.hpp"
+
+#include <cstring>
+#include <optional>
+#include <vector>
+
+namespace
+  {
+  auto constexpr kBaseDescriptorSize = 32u;
+  }
+
+namespace fs::detail
+  {
+
+  bool block_group::has(group_descriptor::flag const flag) const
+    {
+    return flags & static_cast<group_descriptor::flg>(flag);
+    }
+
+  struct group_descriptor_table::page
+    {
+    explicit page(u32 const size) :
+      blockBitmaps(size),
+      inodeBitmaps(size),
+      inodeTables(size),
+      freeBlocks(size),
+      freeInodes(size),
+      usedDirectories(size),
+      unusedInodes(size),
+      flags(size),
+      checksums(size),
+      blockBitmapChecksums(size),
+      inodeBitmapChecksums(size),
+      valid(size)
+      {
+      }
+
+    std::vector<u64> blockBitmaps;
+    std::vector<u64> inodeBitmaps;
+    std::vector<u64> inodeTables;
+    std::vector<u32> freeBlocks;
+    std::vector<u32> freeInodes;
+    std::vector<u32> usedDirectories;
+    std::vector<u32> unusedInodes;
+    std::vector<group_descriptor::flg> flags;
+    std::vector<u16> checksums;
+    std::vector<u32> blockBitmapChecksums;
+    std::vector<u32> inodeBitmapChecksums;
+    std::vector<bool> valid;
+    };
+
+  group_descriptor_table::group_descriptor_table(block_device const & device, geometry const & layout,
+                                                 metadata_checksums const * const checksums) :
+    m_device{device},
+    m_geometry{layout},
+    m_checksums{checksums},
+    m_pages{new std::atomic<page const *>[layout.descriptor_blocks_count()]()}
+    {
+    }
+
+  group_descriptor_table::~group_descriptor_table()
+    {
+    for(auto index = 0u; index < m_geometry.descriptor_blocks_count(); ++index)
+      {
+      delete m_pages[index].load();
+      }
+    }
+
+  std::optional<block_group> group_descriptor_table::operator[](u32 const group) const
+    {
+    if(group >= m_geometry.groups_count())
+      {
+      return std::nullopt;
+      }
+
+    auto const descriptorsPerBlock = m_geometry.descriptors_per_block();
+    auto const loaded = load(group / descriptorsPerBlock);
+    if(!loaded)
+      {
+      return std::nullopt;
+      }
+
+    auto const slot = group % descriptorsPerBlock;
+    if(!loaded->valid[slot])
+      {
+      return std::nullopt;
+      }
+
+    return block_group{
+      group,
+      loaded->blockBitmaps[slot],
+      loaded->inodeBitmaps[slot],
+      loaded->inodeTables[slot],
+      loaded->freeBlocks[slot],
+      loaded->freeInodes[slot],
+      loaded->usedDirectories[slot],
+      loaded->unusedInodes[slot],
+      loaded->flags[slot],
+      loaded->checksums[slot],
+      loaded->blockBitmapChecksums[slot],
+      loaded->inodeBitmapChecksums[slot],
+    };
+    }
+
+  u32 group_descriptor_table::loaded_blocks_count() const
+    {
+    return m_loadedBlocksCount.load(std::memory_order_relaxed);
+    }
+
+  metadata_checksums const * group_descriptor_table::checksums() const
+    {
+    return m_checksums;
+    }
+
+  group_descriptor_table::page const * group_descriptor_table::load(u32 const index) const
+    {
+    auto & slot = m_pages[index];
+    if(auto const existing = slot.load(std::memory_order_acquire))
+      {
+      return existing;
+      }
+
+    auto const blockSize = m_geometry.block_size();
+    auto const data = m_device.fetch(m_geometry.descriptor_block_id(index) * blockSize, blockSize);
+    if(!data)
+      {
+      return nullptr;
+      }
+
+    auto const descriptorSize = m_geometry.descriptor_size();
+    auto const descriptorsPerBlock = m_geometry.descriptors_per_block();
+    auto const is64Bit = descriptorSize > kBaseDescriptorSize;
+    auto decoded = std::make_unique<page>(descriptorsPerBlock);
+
+    for(auto entry = 0u; entry < descriptorsPerBlock; ++entry)
+      {
+      auto const raw = data.get() + entry * descriptorSize;
+      auto descriptor = group_descriptor{};
+      std::memcpy(&descriptor, raw, is64Bit ? sizeof(descriptor) : kBaseDescriptorSize);
+
+      decoded->blockBitmaps[entry] = descriptor.block_bitmap_block_id_lo | u64{descriptor.block_bitmap_block_id_hi} << 32;
+      decoded->inodeBitmaps[entry] = descriptor.inode_bitmap_block_id_lo | u64{descriptor.inode_bitmap_block_id_hi} << 32;
+      decoded->inodeTables[entry] = descriptor.inode_table_block_id_lo | u64{descriptor.inode_table_block_id_hi} << 32;
+      decoded->freeBlocks[entry] = descriptor.free_blocks_count_lo | u32{descriptor.free_blocks_count_hi} << 16;
+      decoded->freeInodes[entry] = descriptor.free_inodes_count_lo | u32{descriptor.free_inodes_count_hi} << 16;
+      decoded->usedDirectories[entry] = descriptor.used_directories_count_lo | u32{descriptor.used_directories_count_hi} << 16;
+      decoded->unusedInodes[entry] = descriptor.unused_inodes_count_lo | u32{descriptor.unused_inodes_count_hi} << 16;
+      decoded->flags[entry] = descriptor.flags;
+      decoded->checksums[entry] = descriptor.checksum;
+      decoded->blockBitmapChecksums[entry] = descriptor.block_bitmap_checksum_lo | u32{descriptor.block_bitmap_checksum_hi} << 16;
+      decoded->inodeBitmapChecksums[entry] = descriptor.inode_bitmap_checksum_lo | u32{descriptor.inode_bitmap_checksum_hi} << 16;
+
+      auto const group = index * descriptorsPerBlock + entry;
+      decoded->valid[entry] = !m_checksums || group >= m_geometry.groups_count() ||
+                              m_checksums->verify_group_descriptor(group, raw, descriptorSize);
+      }
+
+    auto expected = static_cast<page const *>(nullptr);
+    if(slot.compare_exchange_strong(expected, decoded.get(), std::memory_order_acq_rel))
+      {
+      m_loadedBlocksCount.fetch_add(1, std::memory_order_relaxed);
+      return decoded.release();
+      }
+
+    return expected;
+    }
+
+  }
@@ -0,0 +1,115 @@
+#include "fs/detail/group_prefetch.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace fs::detail
+  {
+
+  std::vector<block_extent> group_metadata_extents(geometry const & layout, group_descriptor_table const & groups,
+                                                   u32 const firstGroup, u32 const endGroup, u32 const maximumGapBlocks)
+    {
+    auto const lazy = layout.lazy_group_initialization();
+    auto const inodesCount = layout.inodes_per_group();
+    auto const blockSize = u64{layout.block_size()};
+    auto extents = std::vector<block_extent>{};
+    for(auto id = firstGroup; id < std::min(endGroup, layout.groups_count()); ++id)
+      {
+      auto const group = groups[id];
+      if(!group)
+        {
+        continue;
+        }
+
+      if(!lazy || !group->has(group_descriptor::flag::block_bitmap_uninitialized))
+        {
+        extents.push_back(block_extent{group->block_bitmap_block_id, 1});
+        }
+
+      if(lazy && group->has(group_descriptor::flag::inodes_uninitialized))
+        {
+        continue;
+        }
+
+      extents.push_back(block_extent{group->inode_bitmap_block_id, 1});
+      auto const usedCount = lazy ? inodesCount - std::min(group->unused_inodes_count, inodesCount) : inodesCount;
+      auto const tableBlocksCount = (u64{usedCount} * layout.inode_size() + blockSize - 1) / blockSize;
+      if(tableBlocksCount)
+        {
+        extents.push_back(block_extent{group->inode_table_block_id, tableBlocksCount});
+        }
+      }
+
+    std::sort(extents.begin(), extents.end(), [](auto const & lhs, auto const & rhs){
+      return lhs.first_block_id < rhs.first_block_id;
+    });
+
+    auto joined = std::vector<block_extent>{};
+    for(auto const & extent : extents)
+      {
+      if(!joined.empty() && extent.first_block_id <= joined.back().end_block_id() + maximumGapBlocks)
+        {
+        auto const end = std::max(joined.back().end_block_id(), extent.end_block_id());
+        joined.back().blocks_count = end - joined.back().first_block_id;
+        }
+      else
+        {
+        joined.push_back(extent);
+        }
+      }
+
+    return joined;
+    }
+
+  group_prefetcher::group_prefetcher(block_device const & device, buffer_cache const * const buffers,
+                                     geometry const & layout, group_descriptor_table const & groups) :
+    m_device{device},
+    m_buffers{buffers},
+    m_geometry{layout},
+    m_groups{groups},
+    m_touched{new std::atomic<bool>[layout.groups_count() / layout.flexible_group_size() + 1]{}}
+    {
+    }
+
+  void group_prefetcher::touch(u32 const group) const
+    {
+    auto const size = m_geometry.flexible_group_size();
+    if(size == 1 || group >= m_geometry.groups_count() || m_touched[group / size].exchange(true))
+      {
+      return;
+      }
+
+    auto const first = group / size * size;
+    prefetch(first, std::min(first + size, m_geometry.groups_count()));
+    }
+
+  void group_prefetcher::prefetch(u32 const firstGroup, u32 const endGroup) const
+    {
+    auto const blockSize = u64{m_geometry.block_size()};
+    for(auto const & extent : group_metadata_extents(m_geometry, m_groups, firstGroup, endGroup))
+      {
+      if(m_buffers)
+        {
+        m_buffers->preload(extent.first_block_id, extent.blocks_count);
+        }
+      else
+        {
+        m_device.prefetch(extent.first_block_id * blockSize, extent.blocks_count * blockSize);
+        }
+
+      ++m_readsCount;
+      m_blocksCount += extent.blocks_count;
+      }
+
+    if(firstGroup < endGroup)
+      {
+      m_prefetchedGroupsCount += std::min(endGroup, m_geometry.groups_count()) - std::min(firstGroup, m_geometry.groups_count());
+      }
+    }
+
+  group_prefetch_statistics group_prefetcher::statistics() const
+    {
+    return {m_prefetchedGroupsCount, m_readsCount, m_blocksCount};
+    }
+
+  }
@@ -0,0 +1,179 @@
+#include "fs/detail/htree.hpp"
+#include "fs/detail/directory.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <optional>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace
+  {
+  using fs::detail::u32;
+
+  auto constexpr kRootInfoOffset = 24u;
+  auto constexpr kNodeEntriesOffset = 8u;
+  auto constexpr kBlockMask = u32{0x0fffffff};
+  auto constexpr kMaximumLevels = 2u;
+  auto constexpr kMaximumLargeLevels = 3u;
+
+  struct index_node
+    {
+    fs::detail::bytes block;
+    std::size_t offset;
+    u32 count;
+    u32 position;
+
+    fs::detail::dx_entry entry(u32 const index) const
+      {
+      auto value = fs::detail::dx_entry{};
+      std::memcpy(&value, block.get() + offset + index * sizeof(value), sizeof(value));
+      if(!index)
+        {
+        value.hash = 0;
+        }
+      value.block &= kBlockMask;
+      return value;
+      }
+    };
+
+  std::optional<index_node> parse(fs::detail::bytes block, std::size_t const offset, std::size_t const blockSize)
+    {
+    if(!block || offset + sizeof(fs::detail::dx_count_limit) > blockSize)
+      {
+      return std::nullopt;
+      }
+
+    auto header = fs::detail::dx_count_limit{};
+    std::memcpy(&header, block.get() + offset, sizeof(header));
+    if(!header.count || header.count > header.limit || offset + header.limit * sizeof(fs::detail::dx_entry) > blockSize)
+      {
+      return std::nullopt;
+      }
+
+    return index_node{std::move(block), offset, header.count, 0};
+    }
+
+  void select(index_node & node, u32 const hash)
+    {
+    auto lower = u32{1};
+    auto upper = node.count;
+    while(lower < upper)
+      {
+      auto const middle = lower + (upper - lower) / 2;
+      if(node.entry(middle).hash > hash)
+        {
+        upper = middle;
+        }
+      else
+        {
+        lower = middle + 1;
+        }
+      }
+
+    node.position = lower - 1;
+    }
+  }
+
+namespace fs::detail
+  {
+
+  htree::htree(block_source source, u32 const blockSize, u32_arr<4> const & seed, bool const unsignedHashes,
+               bool const largeDirectories) :
+    m_source{std::move(source)},
+    m_blockSize{blockSize},
+    m_seed{seed},
+    m_unsignedHashes{unsignedHashes},
+    m_largeDirectories{largeDirectories}
+    {
+    }
+
+  std::optional<u32> htree::find(std::string_view const name) const
+    {
+    auto const root = m_source(0);
+    if(!root || m_blockSize < kRootInfoOffset + sizeof(dx_root_info))
+      {
+      return std::nullopt;
+      }
+
+    auto info = dx_root_info{};
+    std::memcpy(&info, root.get() + kRootInfoOffset, sizeof(info));
+    auto const levels = info.indirect_levels + 1u;
+    if(info._reserved0 || info.hash_version > static_cast<hal>(hash_algorithm::tea) ||
+       info.info_length != sizeof(info) || levels > (m_largeDirectories ? kMaximumLargeLevels : kMaximumLevels))
+      {
+      return std::nullopt;
+      }
+
+    auto algorithm = static_cast<hash_algorithm>(info.hash_version);
+    if(m_unsignedHashes)
+      {
+      algorithm = static_cast<hash_algorithm>(info.hash_version + static_cast<hal>(hash_algorithm::legacy_unsigned));
+      }
+    auto const hash = hash_name(name, algorithm, m_seed).major;
+
+    auto path = std::vector<index_node>{};
+    auto node = parse(root, kRootInfoOffset + info.info_length, m_blockSize);
+    while(true)
+      {
+      if(!node)
+        {
+        return std::nullopt;
+        }
+
+      select(*node, hash);
+      path.push_back(std::move(*node));
+      if(path.size() == levels)
+        {
+        break;
+        }
+
+      node = parse(m_source(path.back().entry(path.back().position).block), kNodeEntriesOffset, m_blockSize);
+      }
+
+    while(true)
+      {
+      auto const leaf = m_source(path.back().entry(path.back().position).block);
+      if(!leaf)
+        {
+        return std::nullopt;
+        }
+
+      auto const found = find_entry(leaf.get(), m_blockSize, name);
+      if(!found || *found)
+        {
+        return found;
+        }
+
+      auto level = path.size();
+      while(level && path[level - 1].position + 1 >= path[level - 1].count)
+        {
+        --level;
+        }
+
+      if(!level)
+        {
+        return u32{};
+        }
+
+      auto & next = path[level - 1];
+      ++next.position;
+      if((next.entry(next.position).hash & ~u32{1}) != hash)
+        {
+        return u32{};
+        }
+
+      for(; level < path.size(); ++level)
+        {
+        auto child = parse(m_source(path[level - 1].entry(path[level - 1].position).block), kNodeEntriesOffset, m_blockSize);
+        if(!child)
+          {
+          return std::nullopt;
+          }
+        path[level] = std::move(*child);
+        }
+      }
+    }
+
+  }
@@ -0,0 +1,187 @@
+#include "fs/detail/indirect_map.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace
+  {
+  auto constexpr kDirectBlocksCount = 12u;
+  auto constexpr kMaximumDepth = 3u;
+
+  struct node
+    {
+    fs::detail::u64 blockId;
+    fs::detail::u64 firstLogicalBlock;
+    fs::detail::u32 depth;
+    };
+  }
+
+namespace fs::detail
+  {
+
+  indirect_map::indirect_map(block_device const & device, u32 const blockSize, u32_arr<15> const & root) :
+    m_device{device},
+    m_blockSize{blockSize},
+    m_root{root}
+    {
+    }
+
+  std::size_t indirect_map::read_requests_count() const
+    {
+    return m_readRequestsCount;
+    }
+
+  bool indirect_map::load(u64 const firstBlock, u64 const endBlock)
+    {
+    auto const pointersPerBlock = u64{m_blockSize / sizeof(u32)};
+    auto const deviceBlocksCount = m_device.size() / m_blockSize;
+    auto const valid = [&](u64 const blockId){ return blockId < deviceBlocksCount; };
+
+    auto pending = std::vector<node>{};
+    auto base = u64{kDirectBlocksCount};
+    auto span = pointersPerBlock;
+    for(auto depth = 1u; depth <= kMaximumDepth; ++depth)
+      {
+      if(base < endBlock && base + span > firstBlock && m_root[kDirectBlocksCount + depth - 1])
+        {
+        pending.push_back(node{m_root[kDirectBlocksCount + depth - 1], base, depth});
+        }
+      base += span;
+      span *= pointersPerBlock;
+      }
+
+    for(auto logical = firstBlock; logical < std::min<u64>(endBlock, kDirectBlocksCount); ++logical)
+      {
+      if(!m_root[logical])
+        {
+        continue;
+        }
+      else if(!valid(m_root[logical]))
+        {
+        return false;
+        }
+      remember(logical, m_root[logical], 1, false);
+      }
+
+    auto storage = std::vector<u32>{};
+    while(!pending.empty())
+      {
+      auto pointers = std::vector<u32 const *>(pending.size());
+      auto order = std::vector<std::size_t>{};
+      for(auto index = std::size_t{}; index < pending.size(); ++index)
+        {
+        if(!valid(pending[index].blockId))
+          {
+          return false;
+          }
+
+        auto const cached = m_interiorBlocks.find(pending[index].blockId);
+        if(cached != m_interiorBlocks.end())
+          {
+          pointers[index] = cached->second.data();
+          }
+        else
+          {
+          order.push_back(index);
+          }
+        }
+
+      std::sort(order.begin(), order.end(), [&](auto const left, auto const right){
+        return pending[left].blockId < pending[right].blockId;
+      });
+
+      storage.assign(pending.size() * pointersPerBlock, 0);
+      auto const buffer = [&](auto const index){ return storage.data() + index * pointersPerBlock; };
+
+      auto requests = std::vector<io_request>{};
+      for(auto first = order.begin(); first != order.end();)
+        {
+        auto vectors = std::vector<io_vector>{{buffer(*first), m_blockSize}};
+        auto last = std::next(first);
+        while(last != order.end() && pending[*last].blockId == pending[*std::prev(last)].blockId + 1)
+          {
+          vectors.push_back(io_vector{buffer(*last), m_blockSize});
+          ++last;
+          }
+
+        requests.push_back(io_request{pending[*first].blockId * m_blockSize, std::move(vectors)});
+        first = last;
+        }
+
+      m_readRequestsCount += requests.size();
+      if(requests.size() == 1 ? !m_device.read(requests.front().offset, requests.front().vectors)
+                              : requests.size() > 1 && !m_device.read_batch(std::move(requests)))
+        {
+        return false;
+        }
+      count_loaded_blocks(order.size());
+
+      for(auto const index : order)
+        {
+        pointers[index] = buffer(index);
+        if(pending[index].depth > 1)
+          {
+          auto & kept = m_interiorBlocks[pending[index].blockId];
+          kept.assign(buffer(index), buffer(index) + pointersPerBlock);
+          pointers[index] = kept.data();
+          }
+        }
+
+      auto next = std::vector<node>{};
+      for(auto index = std::size_t{}; index < pending.size(); ++index)
+        {
+        auto const & parent = pending[index];
+        auto childSpan = u64{1};
+        for(auto level = 1u; level < parent.depth; ++level)
+          {
+          childSpan *= pointersPerBlock;
+          }
+
+        auto const parentEnd = parent.firstLogicalBlock + childSpan * pointersPerBlock;
+        auto const leaf = parent.depth == 1;
+        auto const begin = leaf ? 0 : (std::max(firstBlock, parent.firstLogicalBlock) - parent.firstLogicalBlock) / childSpan;
+        auto const end = leaf ? pointersPerBlock
+                              : (std::min(endBlock, parentEnd) - parent.firstLogicalBlock + childSpan - 1) / childSpan;
+        for(auto slot = begin; slot < end; ++slot)
+          {
+          auto const pointer = u64{pointers[index][slot]};
+          auto const logical = parent.firstLogicalBlock + slot * childSpan;
+          if(!pointer)
+            {
+            continue;
+            }
+          else if(!valid(pointer))
+            {
+            return false;
+            }
+          else if(leaf)
+            {
+            remember(logical, pointer, 1, false);
+            }
+          else
+            {
+            next.push_back(node{pointer, logical, parent.depth - 1});
+            }
+          }
+
+        if(leaf)
+          {
+          cover(parent.firstLogicalBlock, parentEnd);
+          }
+        }
+
+      pending = std::move(next);
+      }
+
+    cover(firstBlock, endBlock);
+    return true;
+    }
+
+  std::size_t indirect_map::metadata_footprint() const
+    {
+    return m_interiorBlocks.size() * m_blockSize;
+    }
+
+  }
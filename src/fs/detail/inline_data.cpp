@@ -0,0 +1,81 @@
+#include "fs/detail/extended_attributes.hpp"
+#include "fs/detail/inline_data.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string_view>
+
+namespace
+  {
+  auto constexpr kInlineDataName = std::string_view{"data"};
+  }
+
+namespace fs::detail
+  {
+
+  std::size_t inline_data::size() const
+    {
+    return head_size + tail_size;
+    }
+
+  std::size_t inline_data::copy(u64 const offset, void * const buffer, std::size_t const length) const
+    {
+    if(offset >= size())
+      {
+      return 0;
+      }
+
+    auto const target = static_cast<u08 *>(buffer);
+    auto const count = static_cast<std::size_t>(std::min<u64>(length, size() - offset));
+    auto const fromHead = offset < head_size ? std::min<std::size_t>(count, head_size - offset) : 0;
+    if(fromHead)
+      {
+      std::memcpy(target, head + offset, fromHead);
+      }
+    if(count > fromHead)
+      {
+      std::memcpy(target + fromHead, tail + (offset + fromHead - head_size), count - fromHead);
+      }
+    return count;
+    }
+
+  std::optional<inline_data> inline_data_of(u08 const * const rawInode, u32 const inodeSize)
+    {
+    auto node = inode{};
+    std::memcpy(&node, rawInode, std::min<std::size_t>(inodeSize, sizeof(node)));
+    if(!node.has(inode::flag::inline_data))
+      {
+      return std::nullopt;
+      }
+
+    auto const size = node.size();
+    auto data = inline_data{rawInode + offsetof(inode, block), static_cast<std::size_t>(std::min<u64>(size, kInlineDataHeadSize))};
+    if(size == data.head_size)
+      {
+      return data;
+      }
+
+    auto const region = in_inode_attributes(rawInode, inodeSize);
+    auto const valid = visit_attributes(region.entries, region.length, region.entries, region.length,
+                                        [&](auto const & entry, auto const name, auto const value){
+      if(entry.name_index != static_cast<u08>(attribute_namespace::system) || name != kInlineDataName || !value)
+        {
+        return true;
+        }
+
+      data.tail = value;
+      data.tail_size = entry.value_size;
+      return false;
+    });
+
+    if(!valid || !data.tail || size - data.head_size > data.tail_size)
+      {
+      return std::nullopt;
+      }
+
+    data.tail_size = static_cast<std::size_t>(size - data.head_size);
+    return data;
+    }
+
+  }
@@ -0,0 +1,31 @@
+#include "fs/detail/inode.hpp"
+
+namespace
+  {
+  auto constexpr kFileTypeMask = 0xf000;
+  }
+
+namespace fs::detail
+  {
+
+  inode::file_type inode::type() const
+    {
+    return static_cast<file_type>(mode & kFileTypeMask);
+    }
+
+  u64 inode::size() const
+    {
+    return size_lo | u64{size_hi} << 32;
+    }
+
+  u64 inode::extended_attributes_block_id() const
+    {
+    return extended_attributes_block_id_lo | u64{extended_attributes_block_id_hi} << 32;
+    }
+
+  bool inode::has(inode::flag const flag) const
+    {
+    return flags & static_cast<flg>(flag);
+    }
+
+  }
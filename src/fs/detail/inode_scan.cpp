@@ -0,0 +1,198 @@
+#include "fs/detail/inode_scan.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+namespace
+  {
+  auto constexpr kGroupsPerBatch = 16u;
+  }
+
+namespace fs::detail
+  {
+
+  inode_scan::inode_scan(block_device const & device, geometry const & layout, group_descriptor_table const & groups,
+                         u32 const firstGroup, u32 const endGroup, std::size_t const chunkSize) :
+    m_device{device},
+    m_geometry{layout},
+    m_groups{groups},
+    m_group{firstGroup},
+    m_endGroup{std::min(endGroup, layout.groups_count())},
+    m_chunkInodesCount{static_cast<u32>(std::max<std::size_t>(chunkSize / layout.block_size(), 1) * layout.block_size() /
+                                        layout.inode_size())}
+    {
+    m_buffer.resize(std::size_t{m_chunkInodesCount} * layout.inode_size());
+    }
+
+  std::optional<u32> inode_scan::next()
+    {
+    auto const inodeSize = m_geometry.inode_size();
+    auto const checksums = m_groups.checksums();
+    while(!m_failed)
+      {
+      if(m_started)
+        {
+        ++m_index;
+        }
+      else if(!start_group())
+        {
+        return std::nullopt;
+        }
+
+      if(m_index == m_tableInodesCount)
+        {
+        ++m_group;
+        m_started = false;
+        continue;
+        }
+      else if(m_index == m_chunkStart + m_chunkInodes && !read_chunk())
+        {
+        return std::nullopt;
+        }
+
+      auto const id = m_group * m_geometry.inodes_per_group() + m_index + 1;
+      auto const raw = m_buffer.data() + std::size_t{m_index - m_chunkStart} * inodeSize;
+      if(checksums && !checksums->verify_inode(id, raw, inodeSize))
+        {
+        continue;
+        }
+
+      m_current = inode{};
+      std::memcpy(&m_current, raw, std::min<std::size_t>(inodeSize, sizeof(m_current)));
+      return id;
+      }
+
+    return std::nullopt;
+    }
+
+  inode const & inode_scan::current() const
+    {
+    return m_current;
+    }
+
+  bool inode_scan::failed() const
+    {
+    return m_failed;
+    }
+
+  u64 inode_scan::chunks_count() const
+    {
+    return m_chunksCount;
+    }
+
+  bool inode_scan::start_group()
+    {
+    while(m_group < m_endGroup)
+      {
+      auto const group = m_groups[m_group];
+      if(!group)
+        {
+        m_failed = true;
+        return false;
+        }
+
+      auto const lazy = m_geometry.lazy_group_initialization();
+      if(lazy && group->has(group_descriptor::flag::inodes_uninitialized))
+        {
+        ++m_group;
+        continue;
+        }
+
+      auto const inodesCount = m_geometry.inodes_per_group();
+      m_tableInodesCount = lazy ? inodesCount - std::min(group->unused_inodes_count, inodesCount) : inodesCount;
+      m_tableOffset = group->inode_table_block_id * m_geometry.block_size();
+      m_index = 0;
+      m_chunkStart = 0;
+      m_chunkInodes = 0;
+      m_started = true;
+      return true;
+      }
+
+    return false;
+    }
+
+  bool inode_scan::read_chunk()
+    {
+    auto const inodeSize = m_geometry.inode_size();
+    m_chunkStart = m_index;
+    m_chunkInodes = std::min(m_chunkInodesCount, m_tableInodesCount - m_index);
+    if(!m_device.read(m_tableOffset + u64{m_chunkStart} * inodeSize, m_buffer.data(), std::size_t{m_chunkInodes} * inodeSize))
+      {
+      m_failed = true;
+      return false;
+      }
+
+    ++m_chunksCount;
+    prefetch_chunk();
+    return true;
+    }
+
+  void inode_scan::prefetch_chunk() const
+    {
+    auto const inodeSize = m_geometry.inode_size();
+    auto const nextStart = m_chunkStart + m_chunkInodes;
+    if(nextStart < m_tableInodesCount)
+      {
+      auto const count = std::min(m_chunkInodesCount, m_tableInodesCount - nextStart);
+      m_device.prefetch(m_tableOffset + u64{nextStart} * inodeSize, u64{count} * inodeSize);
+      }
+    else if(m_group + 1 < m_endGroup)
+      {
+      if(auto const group = m_groups[m_group + 1])
+        {
+        m_device.prefetch(group->inode_table_block_id * m_geometry.block_size(), u64{m_chunkInodesCount} * inodeSize);
+        }
+      }
+    }
+
+  bool scan_inodes(block_device const & device, geometry const & layout, group_descriptor_table const & groups,
+                   unsigned const threads, inode_visitor const & visitor)
+    {
+    auto const groupsCount = layout.groups_count();
+    auto nextBatch = std::atomic<u32>{};
+    auto failed = std::atomic<bool>{};
+
+    auto const scan = [&]{
+      while(!failed)
+        {
+        auto const first = nextBatch.fetch_add(1) * kGroupsPerBatch;
+        if(first >= groupsCount)
+          {
+          return;
+          }
+
+        auto batch = inode_scan{device, layout, groups, first, first + kGroupsPerBatch};
+        while(auto const id = batch.next())
+          {
+          visitor(*id, batch.current());
+          }
+
+        if(batch.failed())
+          {
+          failed = true;
+          }
+        }
+    };
+
+    auto const hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    auto const batchesCount = (groupsCount + kGroupsPerBatch - 1) / kGroupsPerBatch;
+    auto const workersCount = std::max(std::min(threads ? threads : hardwareThreads, batchesCount), 1u);
+
+    auto workers = std::vector<std::thread>{};
+    for(auto index = 1u; index < workersCount; ++index)
+      {
+      workers.emplace_back(scan);
+      }
+    scan();
+    for(auto & worker : workers)
+      {
+      worker.join();
+      }
+
+    return !failed;
+    }
+
+  }
@@ -0,0 +1,156 @@
+#include "fs/detail/io_engine.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <utility>
+
+#include <sys/uio.h>
+
+namespace
+  {
+  using fs::detail::io_vector;
+  using fs::detail::u64;
+
+  template<typename Transfer>
+  bool transfer_vectors(int const descriptor, u64 const offset, std::vector<io_vector> const & vectors, Transfer transfer)
+    {
+    auto pending = std::vector<iovec>{};
+    pending.reserve(vectors.size());
+    for(auto const & vector : vectors)
+      {
+      if(vector.length)
+        {
+        pending.push_back(iovec{vector.buffer, vector.length});
+        }
+      }
+
+    auto first = pending.begin();
+    auto position = static_cast<off_t>(offset);
+
+    while(first != pending.end())
+      {
+      auto const batch = static_cast<int>(std::min<std::ptrdiff_t>(pending.end() - first, IOV_MAX));
+      auto count = transfer(descriptor, &*first, batch, position);
+      if(count < 0 && errno == EINTR)
+        {
+        continue;
+        }
+      else if(count <= 0)
+        {
+        return false;
+        }
+
+      position += count;
+      while(count && static_cast<std::size_t>(count) >= first->iov_len)
+        {
+        count -= first->iov_len;
+        ++first;
+        }
+
+      if(count)
+        {
+        first->iov_base = static_cast<char *>(first->iov_base) + count;
+        first->iov_len -= static_cast<std::size_t>(count);
+        }
+      }
+
+    return true;
+    }
+  }
+
+namespace fs::detail
+  {
+
+  bool read_vectors(int const descriptor, u64 const offset, std::vector<io_vector> const & vectors)
+    {
+    return transfer_vectors(descriptor, offset, vectors, ::preadv);
+    }
+
+  bool write_vectors(int const descriptor, u64 const offset, std::vector<io_vector> const & vectors)
+    {
+    return transfer_vectors(descriptor, offset, vectors, ::pwritev);
+    }
+
+  pool_engine::pool_engine(int const descriptor, std::size_t const queueDepth) :
+    m_descriptor{descriptor},
+    m_queueDepth{std::max<std::size_t>(queueDepth, 1)}
+    {
+    auto const workers = std::min(m_queueDepth, kMaximumWorkers);
+    m_workers.reserve(workers);
+    for(auto index = std::size_t{}; index < workers; ++index)
+      {
+      m_workers.emplace_back([this]{ work(); });
+      }
+    }
+
+  pool_engine::~pool_engine()
+    {
+      {
+      auto lock = std::unique_lock<std::mutex>{m_mutex};
+      m_stopping = true;
+      }
+
+    m_available.notify_all();
+    for(auto & worker : m_workers)
+      {
+      worker.join();
+      }
+    }
+
+  void pool_engine::submit(std::vector<io_request> requests)
+    {
+    auto lock = std::unique_lock<std::mutex>{m_mutex};
+    for(auto & request : requests)
+      {
+      m_drained.wait(lock, [&]{ return m_inFlight < m_queueDepth; });
+      m_pending.push_back(std::move(request));
+      ++m_inFlight;
+      m_available.notify_one();
+      }
+    }
+
+  std::size_t pool_engine::queue_depth() const
+    {
+    return m_queueDepth;
+    }
+
+  void pool_engine::work()
+    {
+    auto lock = std::unique_lock<std::mutex>{m_mutex};
+    while(true)
+      {
+      m_available.wait(lock, [&]{ return m_stopping || !m_pending.empty(); });
+      if(m_pending.empty())
+        {
+        return;
+        }
+
+      auto request = std::move(m_pending.front());
+      m_pending.pop_front();
+      lock.unlock();
+
+      auto const success = read_vectors(m_descriptor, request.offset, request.vectors);
+      if(request.completion)
+        {
+        request.completion(success);
+        }
+
+      lock.lock();
+      --m_inFlight;
+      m_drained.notify_one();
+      }
+    }
+
+  std::unique_ptr<io_engine> make_io_engine(int const descriptor, std::size_t const queueDepth)
+    {
+    auto uring = std::make_unique<uring_engine>(descriptor, queueDepth);
+    if(uring->ready())
+      {
+      return uring;
+      }
+
+    return std::make_unique<pool_engine>(descriptor, queueDepth);
+    }
+
+  }
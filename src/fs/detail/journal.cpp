@@ -0,0 +1,436 @@
+#include "fs/detail/checksum.hpp"
+#include "fs/detail/journal.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace
+  {
+  using fs::detail::journal_header;
+  using fs::detail::journal_superblock;
+  using fs::detail::u08;
+  using fs::detail::u16;
+  using fs::detail::u32;
+  using fs::detail::u64;
+
+  using feature = journal_superblock::incompatible_feature;
+
+  auto constexpr kKnownFeatures = static_cast<journal_superblock::ift>(0x3f);
+  auto constexpr kDefaultFastCommitBlocksCount = u32{256};
+  auto constexpr kChecksumSize = sizeof(u32);
+  auto constexpr kUuidSize = std::size_t{16};
+  auto constexpr kCommitChecksumOffset = std::size_t{16};
+  auto constexpr kRevokeRecordsOffset = std::size_t{16};
+
+  auto constexpr kTagEscaped = u32{0x1};
+  auto constexpr kTagSameUuid = u32{0x2};
+  auto constexpr kTagLast = u32{0x8};
+
+  u32 load32(u08 const * const data)
+    {
+    auto value = u32{};
+    std::memcpy(&value, data, sizeof(value));
+    return fs::detail::from_big_endian(value);
+    }
+
+  u16 load16(u08 const * const data)
+    {
+    return static_cast<u16>(data[0] << 8 | data[1]);
+    }
+
+  bool newer_or_same(u32 const sequence, u32 const other)
+    {
+    return static_cast<fs::detail::s32>(sequence - other) >= 0;
+    }
+
+  struct logged_block
+    {
+    u64 target;
+    u64 journalBlock;
+    bool escaped;
+    };
+
+  struct transaction
+    {
+    u32 sequence;
+    std::vector<logged_block> blocks;
+    std::vector<u64> revoked;
+    };
+
+  struct journal_reader
+    {
+    journal_reader(fs::detail::block_device const & device, u32 const blockSize,
+                   std::vector<fs::detail::block_run> const & runs) :
+      m_device{device},
+      m_blockSize{blockSize},
+      m_runs{runs}
+      {
+      }
+
+    std::optional<u64> physical(u64 const journalBlock) const
+      {
+      auto const run = std::upper_bound(m_runs.begin(), m_runs.end(), journalBlock, [](auto const block, auto const & entry){
+        return block < entry.logical_block_id;
+      });
+      if(run == m_runs.begin())
+        {
+        return std::nullopt;
+        }
+
+      auto const & candidate = *std::prev(run);
+      if(candidate.sparse() || journalBlock >= candidate.logical_block_id + candidate.blocks_count)
+        {
+        return std::nullopt;
+        }
+      return candidate.physical_block_id + journalBlock - candidate.logical_block_id;
+      }
+
+    bool read(u64 const journalBlock, std::vector<u08> & buffer) const
+      {
+      auto const block = physical(journalBlock);
+      return block && m_device.read(*block * m_blockSize, buffer.data(), m_blockSize);
+      }
+
+    private:
+      fs::detail::block_device const & m_device;
+      u32 const m_blockSize;
+      std::vector<fs::detail::block_run> const & m_runs;
+    };
+
+  bool verify_tail(u32 const seed, std::vector<u08> & block, std::size_t const checksumOffset)
+    {
+    auto const expected = load32(block.data() + checksumOffset);
+    std::fill(block.begin() + checksumOffset, block.begin() + checksumOffset + kChecksumSize, u08{});
+    return fs::detail::crc32c(seed, block.data(), block.size()) == expected;
+    }
+  }
+
+namespace fs::detail
+  {
+
+  bool journal_superblock::has(incompatible_feature const feature) const
+    {
+    return from_big_endian(incompatible_features_bitmap) & static_cast<ift>(feature);
+    }
+
+  std::optional<journal_index> scan_journal(block_device const & device, u32 const blockSize,
+                                            std::vector<block_run> const & runs)
+    {
+    auto const reader = journal_reader{device, blockSize, runs};
+    auto buffer = std::vector<u08>(std::max<std::size_t>(blockSize, sizeof(journal_superblock)));
+    if(!reader.read(0, buffer))
+      {
+      return std::nullopt;
+      }
+
+    auto superblock = journal_superblock{};
+    std::memcpy(&superblock, buffer.data(), sizeof(superblock));
+    auto const type = static_cast<journal_header::block_type>(from_big_endian(superblock.header.type));
+    auto const version2 = type == journal_header::block_type::superblock_v2;
+    if(from_big_endian(superblock.header.magic_number) != kJournalMagic ||
+       (type != journal_header::block_type::superblock_v1 && !version2) ||
+       from_big_endian(superblock.block_size) != blockSize ||
+       (version2 && from_big_endian(superblock.incompatible_features_bitmap) & ~kKnownFeatures))
+      {
+      return std::nullopt;
+      }
+
+    auto index = journal_index{};
+    auto const first = u64{from_big_endian(superblock.first_log_block_id)};
+    auto const start = u64{from_big_endian(superblock.start_block_id)};
+    index.statistics.first_sequence = from_big_endian(superblock.sequence);
+    if(!start)
+      {
+      return index;
+      }
+
+    auto const has = [&](feature const flag){ return version2 && superblock.has(flag); };
+    auto last = u64{from_big_endian(superblock.blocks_count)};
+    if(has(feature::fast_commit))
+      {
+      auto const fastCommitBlocks = from_big_endian(superblock.fast_commit_blocks_count);
+      last -= fastCommitBlocks ? fastCommitBlocks : kDefaultFastCommitBlocksCount;
+      }
+    if(first >= last || start < first || start >= last)
+      {
+      return std::nullopt;
+      }
+
+    auto const checksummed = has(feature::checksum_v2) || has(feature::checksum_v3);
+    auto const largeBlockIds = has(feature::large_block_ids);
+    auto const seed = checksummed ? crc32c(~u32{}, superblock.uuid.data(), kUuidSize) : u32{};
+    auto const tagSize = has(feature::checksum_v3) ? std::size_t{16} :
+                         std::size_t{12} + (has(feature::checksum_v2) ? 2 : 0) - (largeBlockIds ? 0 : 4);
+    auto const usable = blockSize - (checksummed ? kChecksumSize : 0);
+
+    auto transactions = std::vector<transaction>{};
+    auto current = transaction{index.statistics.first_sequence, {}, {}};
+    auto position = start;
+    auto const advance = [&]{ position = position + 1 == last ? first : position + 1; };
+
+    buffer.resize(blockSize);
+    for(auto steps = u64{}; steps < last - first; ++steps)
+      {
+      if(!reader.read(position, buffer))
+        {
+        break;
+        }
+
+      auto const header = buffer.data();
+      if(load32(header) != kJournalMagic || load32(header + 8) != current.sequence)
+        {
+        break;
+        }
+
+      auto const blockType = static_cast<journal_header::block_type>(load32(header + 4));
+      if(blockType == journal_header::block_type::descriptor)
+        {
+        if(checksummed && !verify_tail(seed, buffer, blockSize - kChecksumSize))
+          {
+          break;
+          }
+
+        advance();
+        auto valid = true;
+        for(auto offset = sizeof(journal_header); offset + tagSize <= usable && valid;)
+          {
+          auto const tag = buffer.data() + offset;
+          auto const low = u64{load32(tag)};
+          auto const high = largeBlockIds ? u64{load32(tag + 8)} : u64{};
+          auto const flags = has(feature::checksum_v3) ? load32(tag + 4) : u32{load16(tag + 6)};
+          auto const copy = reader.physical(position);
+          valid = copy.has_value();
+          if(valid)
+            {
+            current.blocks.push_back(logged_block{high << 32 | low, *copy, static_cast<bool>(flags & kTagEscaped)});
+            }
+
+          advance();
+          offset += tagSize + (flags & kTagSameUuid ? 0 : kUuidSize);
+          if(flags & kTagLast)
+            {
+            break;
+            }
+          }
+
+        if(!valid)
+          {
+          break;
+          }
+        continue;
+        }
+      else if(blockType == journal_header::block_type::revoke)
+        {
+        if(checksummed && !verify_tail(seed, buffer, blockSize - kChecksumSize))
+          {
+          break;
+          }
+
+        auto const recordSize = largeBlockIds ? std::size_t{8} : std::size_t{4};
+        auto const used = std::min<std::size_t>(load32(header + 12), usable);
+        for(auto offset = kRevokeRecordsOffset; offset + recordSize <= used; offset += recordSize)
+          {
+          auto const record = buffer.data() + offset;
+          current.revoked.push_back(largeBlockIds ? u64{load32(record)} << 32 | load32(record + 4) : u64{load32(record)});
+          }
+        }
+      else if(blockType == journal_header::block_type::commit)
+        {
+        if(checksummed && !verify_tail(seed, buffer, kCommitChecksumOffset))
+          {
+          break;
+          }
+
+        auto const sequence = current.sequence;
+        transactions.push_back(std::move(current));
+        current = transaction{sequence + 1, {}, {}};
+        }
+      else
+        {
+        break;
+        }
+
+      advance();
+      }
+
+    index.statistics.incomplete = !current.blocks.empty() || !current.revoked.empty();
+    index.statistics.transactions_count = static_cast<u32>(transactions.size());
+
+    auto revoked = std::unordered_map<u64, u32>{};
+    for(auto const & committed : transactions)
+      {
+      for(auto const block : committed.revoked)
+        {
+        auto const known = revoked.find(block);
+        if(known == revoked.end() || newer_or_same(committed.sequence, known->second))
+          {
+          revoked[block] = committed.sequence;
+          }
+        }
+      }
+
+    for(auto const & committed : transactions)
+      {
+      for(auto const & logged : committed.blocks)
+        {
+        ++index.statistics.logged_blocks_count;
+        auto const revocation = revoked.find(logged.target);
+        if(revocation != revoked.end() && newer_or_same(revocation->second, committed.sequence))
+          {
+          ++index.statistics.revoked_blocks_count;
+          continue;
+          }
+        index.blocks[logged.target] = journal_block{logged.journalBlock, committed.sequence, logged.escaped};
+        }
+      }
+
+    index.statistics.blocks_count = index.blocks.size();
+    return index;
+    }
+
+  journal_overlay::journal_overlay(std::unique_ptr<block_device> device, u32 const blockSize,
+                                   std::map<u64, journal_block> blocks) :
+    m_device{std::move(device)},
+    m_blockSize{blockSize},
+    m_blocks{std::move(blocks)}
+    {
+    }
+
+  u64 journal_overlay::size() const
+    {
+    return m_device->size();
+    }
+
+  bool journal_overlay::writeable() const
+    {
+    return false;
+    }
+
+  bool journal_overlay::mapped() const
+    {
+    return m_device->mapped();
+    }
+
+  bool journal_overlay::read(u64 const offset, void * const buffer, std::size_t const length) const
+    {
+    return m_device->read(offset, buffer, length) && patch(offset, length, [&](u64 const position, u08 const * const data,
+                                                                              std::size_t const count){
+      std::memcpy(static_cast<u08 *>(buffer) + (position - offset), data, count);
+    });
+    }
+
+  bool journal_overlay::read(u64 const offset, std::vector<io_vector> const & vectors) const
+    {
+    auto length = u64{};
+    for(auto const & vector : vectors)
+      {
+      length += vector.length;
+      }
+
+    return m_device->read(offset, vectors) && patch(offset, length, [&](u64 position, u08 const * data, std::size_t count){
+      auto start = offset;
+      for(auto const & vector : vectors)
+        {
+        auto const end = start + vector.length;
+        if(count && position < end && position + count > start)
+          {
+          auto const skip = position > start ? position - start : 0;
+          auto const copied = std::min<std::size_t>(count, vector.length - skip);
+          std::memcpy(static_cast<u08 *>(vector.buffer) + skip, data, copied);
+          data += copied;
+          count -= copied;
+          position += copied;
+          }
+        start = end;
+        }
+    });
+    }
+
+  bytes journal_overlay::fetch(u64 const offset, std::size_t const length) const
+    {
+    if(!overlaps(offset, length))
+      {
+      return m_device->fetch(offset, length);
+      }
+
+    auto copy = std::shared_ptr<u08>{new u08[length], std::default_delete<u08[]>{}};
+    return read(offset, copy.get(), length) ? bytes{copy} : nullptr;
+    }
+
+  void journal_overlay::prefetch(u64 const offset, u64 const length) const
+    {
+    m_device->prefetch(offset, length);
+    }
+
+  void journal_overlay::submit(std::vector<io_request> requests) const
+    {
+    auto forwarded = std::vector<io_request>{};
+    for(auto & request : requests)
+      {
+      auto length = u64{};
+      for(auto const & vector : request.vectors)
+        {
+        length += vector.length;
+        }
+
+      if(!overlaps(request.offset, length))
+        {
+        forwarded.push_back(std::move(request));
+        continue;
+        }
+
+      auto const success = read(request.offset, request.vectors);
+      if(request.completion)
+        {
+        request.completion(success);
+        }
+      }
+
+    if(!forwarded.empty())
+      {
+      m_device->submit(std::move(forwarded));
+      }
+    }
+
+  bool journal_overlay::overlaps(u64 const offset, u64 const length) const
+    {
+    auto const block = m_blocks.lower_bound(offset / m_blockSize);
+    return length && block != m_blocks.end() && block->first * m_blockSize < offset + length;
+    }
+
+  template<typename Sink>
+  bool journal_overlay::patch(u64 const offset, u64 const length, Sink && sink) const
+    {
+    auto const end = offset + length;
+    for(auto block = m_blocks.lower_bound(offset / m_blockSize); block != m_blocks.end() && block->first * m_blockSize < end;
+        ++block)
+      {
+      auto const content = m_device->fetch(block->second.block_id * m_blockSize, m_blockSize);
+      if(!content)
+        {
+        return false;
+        }
+
+      auto const blockStart = block->first * m_blockSize;
+      auto const first = std::max(offset, blockStart);
+      auto const count = static_cast<std::size_t>(std::min(end, blockStart + m_blockSize) - first);
+      auto const within = static_cast<std::size_t>(first - blockStart);
+      if(!block->second.escaped || within >= sizeof(kJournalMagic))
+        {
+        sink(first, content.get() + within, count);
+        continue;
+        }
+
+      auto restored = std::vector<u08>(content.get(), content.get() + m_blockSize);
+      auto const magic = from_big_endian(kJournalMagic);
+      std::memcpy(restored.data(), &magic, sizeof(magic));
+      sink(first, restored.data() + within, count);
+      }
+
+    return true;
+    }
+
+  }
@@ -0,0 +1,187 @@
+#include "fs/detail/name_hash.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <string_view>
+
+namespace
+  {
+  using fs::detail::u32;
+
+  auto constexpr kDefaultSeed = fs::detail::u32_arr<4>{{0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476}};
+  auto constexpr kTeaDelta = u32{0x9e3779b9};
+  auto constexpr kHalfMd4Round2 = u32{0x5a827999};
+  auto constexpr kHalfMd4Round3 = u32{0x6ed9eba1};
+  auto constexpr kEndOfDirectoryHash = u32{0x7fffffff} << 1;
+
+  u32 rotate_left(u32 const value, unsigned const shift)
+    {
+    return value << shift | value >> (32 - shift);
+    }
+
+  u32 character(char const value, bool const isSigned)
+    {
+    return isSigned ? static_cast<u32>(static_cast<signed char>(value)) : static_cast<unsigned char>(value);
+    }
+
+  u32 legacy_hash(std::string_view const name, bool const isSigned)
+    {
+    auto previous = u32{0x37abe8f9};
+    auto current = u32{0x12a3fe2d};
+    for(auto const value : name)
+      {
+      auto hash = previous + (current ^ (character(value, isSigned) * 7152373));
+      if(hash & 0x80000000)
+        {
+        hash -= 0x7fffffff;
+        }
+      previous = current;
+      current = hash;
+      }
+
+    return current << 1;
+    }
+
+  template<std::size_t Words>
+  void fill_words(std::string_view const name, u32 (& words)[Words], bool const isSigned)
+    {
+    auto const length = static_cast<u32>(name.size());
+    auto padding = length | length << 8;
+    padding |= padding << 16;
+
+    auto value = padding;
+    auto word = std::size_t{};
+    auto const used = std::min(name.size(), Words * 4);
+    for(auto index = std::size_t{}; index < used; ++index)
+      {
+      value = character(name[index], isSigned) + (value << 8);
+      if(index % 4 == 3)
+        {
+        words[word++] = value;
+        value = padding;
+        }
+      }
+
+    if(word < Words)
+      {
+      words[word++] = value;
+      }
+
+    std::fill(words + word, words + Words, padding);
+    }
+
+  void tea_transform(u32 (& buffer)[4], u32 const (& input)[4])
+    {
+    auto sum = u32{};
+    auto first = buffer[0];
+    auto second = buffer[1];
+    for(auto round = 0; round < 16; ++round)
+      {
+      sum += kTeaDelta;
+      first += ((second << 4) + input[0]) ^ (second + sum) ^ ((second >> 5) + input[1]);
+      second += ((first << 4) + input[2]) ^ (first + sum) ^ ((first >> 5) + input[3]);
+      }
+
+    buffer[0] += first;
+    buffer[1] += second;
+    }
+
+  void half_md4_transform(u32 (& buffer)[4], u32 const (& input)[8])
+    {
+    auto const f = [](u32 x, u32 y, u32 z){ return z ^ (x & (y ^ z)); };
+    auto const g = [](u32 x, u32 y, u32 z){ return (x & y) + ((x ^ y) & z); };
+    auto const h = [](u32 x, u32 y, u32 z){ return x ^ y ^ z; };
+    auto const round = [](auto const function, u32 & a, u32 b, u32 c, u32 d, u32 x, unsigned shift){
+      a = rotate_left(a + function(b, c, d) + x, shift);
+    };
+
+    auto a = buffer[0];
+    auto b = buffer[1];
+    auto c = buffer[2];
+    auto d = buffer[3];
+
+    round(f, a, b, c, d, input[0], 3);
+    round(f, d, a, b, c, input[1], 7);
+    round(f, c, d, a, b, input[2], 11);
+    round(f, b, c, d, a, input[3], 19);
+    round(f, a, b, c, d, input[4], 3);
+    round(f, d, a, b, c, input[5], 7);
+    round(f, c, d, a, b, input[6], 11);
+    round(f, b, c, d, a, input[7], 19);
+
+    round(g, a, b, c, d, input[1] + kHalfMd4Round2, 3);
+    round(g, d, a, b, c, input[3] + kHalfMd4Round2, 5);
+    round(g, c, d, a, b, input[5] + kHalfMd4Round2, 9);
+    round(g, b, c, d, a, input[7] + kHalfMd4Round2, 13);
+    round(g, a, b, c, d, input[0] + kHalfMd4Round2, 3);
+    round(g, d, a, b, c, input[2] + kHalfMd4Round2, 5);
+    round(g, c, d, a, b, input[4] + kHalfMd4Round2, 9);
+    round(g, b, c, d, a, input[6] + kHalfMd4Round2, 13);
+
+    round(h, a, b, c, d, input[3] + kHalfMd4Round3, 3);
+    round(h, d, a, b, c, input[7] + kHalfMd4Round3, 9);
+    round(h, c, d, a, b, input[2] + kHalfMd4Round3, 11);
+    round(h, b, c, d, a, input[6] + kHalfMd4Round3, 15);
+    round(h, a, b, c, d, input[1] + kHalfMd4Round3, 3);
+    round(h, d, a, b, c, input[5] + kHalfMd4Round3, 9);
+    round(h, c, d, a, b, input[0] + kHalfMd4Round3, 11);
+    round(h, b, c, d, a, input[4] + kHalfMd4Round3, 15);
+
+    buffer[0] += a;
+    buffer[1] += b;
+    buffer[2] += c;
+    buffer[3] += d;
+    }
+
+  template<std::size_t Words, typename Transform>
+  void digest(std::string_view name, u32 (& buffer)[4], bool const isSigned, Transform transform)
+    {
+    u32 input[Words];
+    while(!name.empty())
+      {
+      fill_words(name, input, isSigned);
+      transform(buffer, input);
+      name.remove_prefix(std::min(name.size(), Words * 4));
+      }
+    }
+  }
+
+namespace fs::detail
+  {
+
+  name_hash hash_name(std::string_view const name, hash_algorithm const algorithm, u32_arr<4> const & seed)
+    {
+    auto const useSeed = std::any_of(seed.begin(), seed.end(), [](auto const word){ return word != 0; });
+    auto const & initial = useSeed ? seed : kDefaultSeed;
+    u32 buffer[4] = {initial[0], initial[1], initial[2], initial[3]};
+    auto const isSigned = static_cast<hal>(algorithm) < static_cast<hal>(hash_algorithm::legacy_unsigned);
+    auto hash = name_hash{};
+
+    switch(algorithm)
+      {
+      case hash_algorithm::legacy:
+      case hash_algorithm::legacy_unsigned:
+        hash.major = legacy_hash(name, isSigned);
+        break;
+      case hash_algorithm::half_md4:
+      case hash_algorithm::half_md4_unsigned:
+        digest<8>(name, buffer, isSigned, half_md4_transform);
+        hash = name_hash{buffer[1], buffer[2]};
+        break;
+      case hash_algorithm::tea:
+      case hash_algorithm::tea_unsigned:
+        digest<4>(name, buffer, isSigned, tea_transform);
+        hash = name_hash{buffer[0], buffer[1]};
+        break;
+      }
+
+    hash.major &= ~u32{1};
+    if(hash.major == kEndOfDirectoryHash)
+      {
+      hash.major = (u32{0x7fffffff} - 1) << 1;
+      }
+
+    return hash;
+    }
+
+  }
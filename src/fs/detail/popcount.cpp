@@ -0,0 +1,150 @@
+#include "fs/detail/popcount.hpp"
+
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define EXTFS_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace
+  {
+  using fs::detail::u08;
+  using fs::detail::u64;
+
+  u64 scalar(u08 const * const data, std::size_t const length)
+    {
+    auto count = u64{};
+    auto index = std::size_t{};
+    for(; index + sizeof(u64) <= length; index += sizeof(u64))
+      {
+      auto word = u64{};
+      std::memcpy(&word, data + index, sizeof(word));
+      count += static_cast<u64>(__builtin_popcountll(word));
+      }
+
+    for(; index < length; ++index)
+      {
+      count += static_cast<u64>(__builtin_popcount(data[index]));
+      }
+
+    return count;
+    }
+
+#ifdef EXTFS_X86_KERNELS
+  __attribute__((target("avx2"))) u64 avx2(u08 const * const data, std::size_t const length)
+    {
+    auto const lookup = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    auto const low = _mm256_set1_epi8(0x0f);
+    auto sums = _mm256_setzero_si256();
+
+    auto index = std::size_t{};
+    for(; index + sizeof(__m256i) <= length; index += sizeof(__m256i))
+      {
+      auto const chunk = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(data + index));
+      auto const lowCounts = _mm256_shuffle_epi8(lookup, _mm256_and_si256(chunk, low));
+      auto const highCounts = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(chunk, 4), low));
+      sums = _mm256_add_epi64(sums, _mm256_sad_epu8(_mm256_add_epi8(lowCounts, highCounts), _mm256_setzero_si256()));
+      }
+
+    auto lanes = u64{};
+    lanes += static_cast<u64>(_mm256_extract_epi64(sums, 0));
+    lanes += static_cast<u64>(_mm256_extract_epi64(sums, 1));
+    lanes += static_cast<u64>(_mm256_extract_epi64(sums, 2));
+    lanes += static_cast<u64>(_mm256_extract_epi64(sums, 3));
+    return lanes + scalar(data + index, length - index);
+    }
+
+  __attribute__((target("avx512f,avx512vpopcntdq"))) u64 avx512(u08 const * const data, std::size_t const length)
+    {
+    auto sums = _mm512_setzero_si512();
+
+    auto index = std::size_t{};
+    for(; index + sizeof(__m512i) <= length; index += sizeof(__m512i))
+      {
+      auto const chunk = _mm512_loadu_si512(data + index);
+      sums = _mm512_add_epi64(sums, _mm512_popcnt_epi64(chunk));
+      }
+
+    u64 lanes[sizeof(__m512i) / sizeof(u64)];
+    _mm512_storeu_si512(lanes, sums);
+    auto total = u64{};
+    for(auto const lane : lanes)
+      {
+      total += lane;
+      }
+    return total + scalar(data + index, length - index);
+    }
+#endif
+  }
+
+namespace fs::detail
+  {
+
+  bool supported(popcount_kernel const kernel)
+    {
+    switch(kernel)
+      {
+      case popcount_kernel::scalar:
+        return true;
+#ifdef EXTFS_X86_KERNELS
+      case popcount_kernel::avx2:
+        return __builtin_cpu_supports("avx2");
+      case popcount_kernel::avx512:
+        return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vpopcntdq");
+#endif
+      default:
+        return false;
+      }
+    }
+
+  popcount_kernel best_popcount_kernel()
+    {
+    static auto const best = []{
+      for(auto const candidate : {popcount_kernel::avx512, popcount_kernel::avx2})
+        {
+        if(supported(candidate))
+          {
+          return candidate;
+          }
+        }
+      return popcount_kernel::scalar;
+    }();
+
+    return best;
+    }
+
+  u64 popcount(u08 const * const data, std::size_t const length)
+    {
+    return popcount(data, length, best_popcount_kernel());
+    }
+
+  u64 popcount(u08 const * const data, std::size_t const length, popcount_kernel const kernel)
+    {
+    switch(kernel)
+      {
+#ifdef EXTFS_X86_KERNELS
+      case popcount_kernel::avx2:
+        return avx2(data, length);
+      case popcount_kernel::avx512:
+        return avx512(data, length);
+#endif
+      default:
+        return scalar(data, length);
+      }
+    }
+
+  u64 count_set_bits(u08 const * const bitmap, std::size_t const bitsCount)
+    {
+    auto const wholeBytes = bitsCount / 8;
+    auto count = popcount(bitmap, wholeBytes);
+    if(auto const remainder = bitsCount % 8)
+      {
+      count += static_cast<u64>(__builtin_popcount(bitmap[wholeBytes] & ((1u << remainder) - 1)));
+      }
+
+    return count;
+    }
+
+  }
@@ -62,4 +62,9 @@ namespace fs::detail
     });
     }
 
+  bool superblock::has(superblock::flag const flag) const
+    {
+    return flags & static_cast<flg>(flag);
+    }
+
   }
@@ -0,0 +1,134 @@
+#include "fs/detail/checksum.hpp"
+#include "fs/detail/superblock_copies.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace
+  {
+  using fs::detail::superblock;
+  using fs::detail::superblock_copy;
+  using fs::detail::u32;
+  using fs::detail::u64;
+
+  auto constexpr kExtfsMagic = 0xef53;
+  auto constexpr kBaseBlockSize = 1024u;
+  auto constexpr kMaximumBlockSize = 65536u;
+  auto constexpr kBitsPerByte = 8u;
+
+  auto constexpr kIgnoredIncompatibleFeatures = static_cast<u32>(superblock::incompatible_feature::extents) |
+                                                static_cast<u32>(superblock::incompatible_feature::recover);
+  auto constexpr kIgnoredReadOnlyCompatibleFeatures =
+    static_cast<u32>(superblock::read_only_compatible_feature::large_file) |
+    static_cast<u32>(superblock::read_only_compatible_feature::directory_link_count);
+
+  std::vector<superblock_copy> read_copies(fs::detail::block_device const & device, std::vector<superblock_copy> copies)
+    {
+    auto requests = std::vector<fs::detail::io_request>{};
+    requests.reserve(copies.size());
+    for(auto & copy : copies)
+      {
+      requests.push_back(fs::detail::io_request{copy.offset, {{&copy.contents, sizeof(copy.contents)}},
+                                                [&copy](bool const completed){ copy.readable = completed; }});
+      }
+
+    device.read_batch(std::move(requests));
+    for(auto & copy : copies)
+      {
+      copy.valid = copy.readable && copy.contents.magic_number == kExtfsMagic && fs::detail::verify_superblock(copy.contents);
+      }
+
+    return copies;
+    }
+  }
+
+namespace fs::detail
+  {
+
+  bool superblock_copy::consistent() const
+    {
+    return valid && differences.empty();
+    }
+
+  std::vector<char const *> compare_superblocks(superblock const & reference, superblock const & copy)
+    {
+    auto differences = std::vector<char const *>{};
+    auto const compare = [&](char const * const name, auto const & expected, auto const & actual){
+      if(expected != actual)
+        {
+        differences.push_back(name);
+        }
+    };
+
+    compare("inodes_count", reference.inodes_count, copy.inodes_count);
+    compare("blocks_count", reference.blocks_count, copy.blocks_count);
+    compare("blocks_count_hi", reference.blocks_count_hi, copy.blocks_count_hi);
+    compare("first_data_block_id", reference.first_data_block_id, copy.first_data_block_id);
+    compare("logical_block_size", reference.logical_block_size, copy.logical_block_size);
+    compare("blocks_per_group", reference.blocks_per_group, copy.blocks_per_group);
+    compare("inodes_per_group", reference.inodes_per_group, copy.inodes_per_group);
+    compare("inode_size", reference.inode_size, copy.inode_size);
+    compare("uuid", reference.uuid, copy.uuid);
+    compare("compatible_features_bitmap", reference.compatible_features_bitmap, copy.compatible_features_bitmap);
+    compare("incompatible_features_bitmap",
+            reference.incompatible_features_bitmap & ~kIgnoredIncompatibleFeatures,
+            copy.incompatible_features_bitmap & ~kIgnoredIncompatibleFeatures);
+    compare("read_only_compatible_features_bitmap",
+            reference.read_only_compatible_features_bitmap & ~kIgnoredReadOnlyCompatibleFeatures,
+            copy.read_only_compatible_features_bitmap & ~kIgnoredReadOnlyCompatibleFeatures);
+    return differences;
+    }
+
+  std::vector<superblock_copy> read_superblock_copies(block_device const & device, geometry const & layout,
+                                                      superblock const & reference)
+    {
+    auto copies = std::vector<superblock_copy>{};
+    for(auto const group : layout.superblock_groups())
+      {
+      if(group != layout.superblock_group())
+        {
+        copies.push_back(superblock_copy{group, layout.superblock_offset(group)});
+        }
+      }
+
+    copies = read_copies(device, std::move(copies));
+    for(auto & copy : copies)
+      {
+      if(!copy.valid)
+        {
+        continue;
+        }
+
+      copy.differences = compare_superblocks(reference, copy.contents);
+      if(copy.contents.superblock_group_id != static_cast<u16>(copy.group))
+        {
+        copy.differences.push_back("superblock_group_id");
+        }
+      }
+
+    return copies;
+    }
+
+  std::vector<superblock_copy> probe_superblock_copies(block_device const & device)
+    {
+    auto candidates = std::vector<superblock_copy>{};
+    for(auto blockSize = kBaseBlockSize; blockSize <= kMaximumBlockSize; blockSize *= 2)
+      {
+      auto const firstDataBlockId = blockSize == kBaseBlockSize ? 1u : 0u;
+      auto const offset = (u64{firstDataBlockId} + u64{blockSize} * kBitsPerByte) * blockSize;
+      if(offset + sizeof(superblock) <= device.size())
+        {
+        candidates.push_back(superblock_copy{1, offset});
+        }
+      }
+
+    auto copies = read_copies(device, std::move(candidates));
+    copies.erase(std::remove_if(copies.begin(), copies.end(), [](auto const & copy){
+      return !copy.readable || copy.contents.magic_number != kExtfsMagic;
+    }), copies.end());
+    return copies;
+    }
+
+  }
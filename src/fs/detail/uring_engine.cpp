@@ -0,0 +1,370 @@
+#include "fs/detail/io_engine.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <utility>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace
+  {
+  int setup(unsigned const entries, io_uring_params & parameters)
+    {
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, &parameters));
+    }
+
+  int enter(int const descriptor, unsigned const submit, unsigned const wait, unsigned const flags)
+    {
+    return static_cast<int>(::syscall(__NR_io_uring_enter, descriptor, submit, wait, flags, nullptr, 0));
+    }
+
+  template<typename Type>
+  Type * at(void * const base, fs::detail::u32 const offset)
+    {
+    return reinterpret_cast<Type *>(static_cast<char *>(base) + offset);
+    }
+  }
+
+namespace fs::detail
+  {
+
+  struct uring_engine::ring
+    {
+    ~ring()
+      {
+      if(entries != MAP_FAILED)
+        {
+        ::munmap(entries, entriesSize);
+        }
+      if(completionRing != MAP_FAILED)
+        {
+        ::munmap(completionRing, completionRingSize);
+        }
+      if(submissionRing != MAP_FAILED)
+        {
+        ::munmap(submissionRing, submissionRingSize);
+        }
+      if(descriptor >= 0)
+        {
+        ::close(descriptor);
+        }
+      }
+
+    int descriptor{-1};
+    void * submissionRing{MAP_FAILED};
+    std::size_t submissionRingSize{};
+    void * completionRing{MAP_FAILED};
+    std::size_t completionRingSize{};
+    void * entries{MAP_FAILED};
+    std::size_t entriesSize{};
+
+    unsigned * submissionTail{};
+    unsigned submissionMask{};
+    unsigned * submissionArray{};
+    io_uring_sqe * submissionEntries{};
+    unsigned * completionHead{};
+    unsigned * completionTail{};
+    unsigned completionMask{};
+    io_uring_cqe * completionEntries{};
+    unsigned unsubmitted{};
+    };
+
+  struct uring_engine::operation
+    {
+    io_request request;
+    std::vector<iovec> vectors{};
+    std::size_t first{};
+    u64 position{};
+    };
+
+  uring_engine::uring_engine(int const descriptor, std::size_t const queueDepth) :
+    m_descriptor{descriptor},
+    m_queueDepth{std::clamp<std::size_t>(queueDepth, 1, 4096)},
+    m_ring{std::make_unique<ring>()}
+    {
+    auto parameters = io_uring_params{};
+    m_ring->descriptor = setup(static_cast<unsigned>(m_queueDepth), parameters);
+    if(m_ring->descriptor < 0)
+      {
+      m_ring.reset();
+      return;
+      }
+
+    auto & target = *m_ring;
+    target.submissionRingSize = parameters.sq_off.array + parameters.sq_entries * sizeof(unsigned);
+    target.completionRingSize = parameters.cq_off.cqes + parameters.cq_entries * sizeof(io_uring_cqe);
+    target.entriesSize = parameters.sq_entries * sizeof(io_uring_sqe);
+
+    target.submissionRing = ::mmap(nullptr, target.submissionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                   target.descriptor, IORING_OFF_SQ_RING);
+    target.completionRing = ::mmap(nullptr, target.completionRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                   target.descriptor, IORING_OFF_CQ_RING);
+    target.entries = ::mmap(nullptr, target.entriesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            target.descriptor, IORING_OFF_SQES);
+    if(target.submissionRing == MAP_FAILED || target.completionRing == MAP_FAILED || target.entries == MAP_FAILED)
+      {
+      m_ring.reset();
+      return;
+      }
+
+    target.submissionTail = at<unsigned>(target.submissionRing, parameters.sq_off.tail);
+    target.submissionMask = *at<unsigned>(target.submissionRing, parameters.sq_off.ring_mask);
+    target.submissionArray = at<unsigned>(target.submissionRing, parameters.sq_off.array);
+    target.submissionEntries = static_cast<io_uring_sqe *>(target.entries);
+    target.completionHead = at<unsigned>(target.completionRing, parameters.cq_off.head);
+    target.completionTail = at<unsigned>(target.completionRing, parameters.cq_off.tail);
+    target.completionMask = *at<unsigned>(target.completionRing, parameters.cq_off.ring_mask);
+    target.completionEntries = at<io_uring_cqe>(target.completionRing, parameters.cq_off.cqes);
+
+    m_reaper = std::thread{[this]{ reap(); }};
+    }
+
+  uring_engine::~uring_engine()
+    {
+    if(!m_ring)
+      {
+      return;
+      }
+
+      {
+      auto lock = std::unique_lock<std::mutex>{m_mutex};
+      m_available.wait(lock, [&]{ return !m_inFlight; });
+      m_stopping = true;
+      }
+
+    m_submitted.notify_all();
+    m_reaper.join();
+    }
+
+  bool uring_engine::ready() const
+    {
+    return static_cast<bool>(m_ring);
+    }
+
+  void uring_engine::submit(std::vector<io_request> requests)
+    {
+    auto failed = std::vector<operation *>{};
+    auto lock = std::unique_lock<std::mutex>{m_mutex};
+    for(auto & request : requests)
+      {
+      if(m_inFlight == m_queueDepth)
+        {
+        flush(failed);
+        m_available.wait(lock, [&]{ return m_inFlight < m_queueDepth; });
+        }
+
+      auto pending = new operation{std::move(request)};
+      pending->position = pending->request.offset;
+      for(auto const & vector : pending->request.vectors)
+        {
+        if(vector.length)
+          {
+          pending->vectors.push_back(iovec{vector.buffer, vector.length});
+          }
+        }
+
+      if(m_broken)
+        {
+        failed.push_back(pending);
+        continue;
+        }
+      else if(pending->vectors.empty())
+        {
+        lock.unlock();
+        if(pending->request.completion)
+          {
+          pending->request.completion(true);
+          }
+        delete pending;
+        lock.lock();
+        continue;
+        }
+
+      ++m_inFlight;
+      m_operations.insert(pending);
+      queue(pending);
+      }
+
+    flush(failed);
+    lock.unlock();
+    fail(failed);
+    }
+
+  std::size_t uring_engine::queue_depth() const
+    {
+    return m_queueDepth;
+    }
+
+  void uring_engine::queue(operation * const pending)
+    {
+    auto & target = *m_ring;
+    auto const tail = *target.submissionTail;
+    auto const slot = tail & target.submissionMask;
+    auto & entry = target.submissionEntries[slot];
+    auto const count = std::min<std::size_t>(pending->vectors.size() - pending->first, IOV_MAX);
+    entry = io_uring_sqe{};
+    entry.opcode = IORING_OP_READV;
+    entry.fd = m_descriptor;
+    entry.off = pending->position;
+    entry.addr = reinterpret_cast<u64>(pending->vectors.data() + pending->first);
+    entry.len = static_cast<u32>(count);
+    entry.user_data = reinterpret_cast<u64>(pending);
+
+    target.submissionArray[slot] = slot;
+    __atomic_store_n(target.submissionTail, tail + 1, __ATOMIC_RELEASE);
+    ++target.unsubmitted;
+    }
+
+  void uring_engine::flush(std::vector<operation *> & failed)
+    {
+    auto & target = *m_ring;
+    while(target.unsubmitted)
+      {
+      auto const submitted = enter(target.descriptor, target.unsubmitted, 0, 0);
+      if(submitted < 0 && (errno == EINTR || errno == EAGAIN || errno == EBUSY))
+        {
+        continue;
+        }
+      else if(submitted <= 0)
+        {
+        break;
+        }
+      target.unsubmitted -= static_cast<unsigned>(submitted);
+      m_inKernel += static_cast<std::size_t>(submitted);
+      m_submitted.notify_one();
+      }
+
+    if(!target.unsubmitted)
+      {
+      return;
+      }
+
+    // The kernel consumes entries in order, so the entries it did not accept are the last ones queued. They are withdrawn
+    // from the ring, so that a later submission does not hand them to the kernel after they were reported as failed.
+    auto const tail = *target.submissionTail;
+    for(auto index = tail - target.unsubmitted; index != tail; ++index)
+      {
+      auto const slot = target.submissionArray[index & target.submissionMask];
+      auto const pending = reinterpret_cast<operation *>(target.submissionEntries[slot].user_data);
+      m_operations.erase(pending);
+      --m_inFlight;
+      failed.push_back(pending);
+      }
+
+    __atomic_store_n(target.submissionTail, tail - target.unsubmitted, __ATOMIC_RELEASE);
+    target.unsubmitted = 0;
+    m_available.notify_all();
+    }
+
+  void uring_engine::fail(std::vector<operation *> const & failed)
+    {
+    for(auto const pending : failed)
+      {
+      if(pending->request.completion)
+        {
+        pending->request.completion(false);
+        }
+      delete pending;
+      }
+    }
+
+  void uring_engine::reap()
+    {
+    auto & target = *m_ring;
+    while(true)
+      {
+        {
+        auto lock = std::unique_lock<std::mutex>{m_mutex};
+        m_submitted.wait(lock, [&]{ return m_inKernel || m_stopping; });
+        if(!m_inKernel)
+          {
+          return;
+          }
+        }
+
+      if(enter(target.descriptor, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR && errno != EAGAIN &&
+         errno != EBUSY)
+        {
+        auto failed = std::vector<operation *>{};
+          {
+          auto lock = std::lock_guard<std::mutex>{m_mutex};
+          m_broken = true;
+          failed.assign(m_operations.begin(), m_operations.end());
+          m_operations.clear();
+          m_inFlight = 0;
+          m_inKernel = 0;
+          m_available.notify_all();
+          }
+
+        fail(failed);
+        return;
+        }
+
+      auto head = *target.completionHead;
+      auto const tail = __atomic_load_n(target.completionTail, __ATOMIC_ACQUIRE);
+      auto failed = std::vector<operation *>{};
+      for(; head != tail; ++head)
+        {
+        auto const completion = target.completionEntries[head & target.completionMask];
+        auto const pending = reinterpret_cast<operation *>(completion.user_data);
+        auto count = completion.res;
+        if(count == -EINTR || count == -EAGAIN)
+          {
+          count = 0;
+          }
+        else if(count <= 0)
+          {
+          pending->first = pending->vectors.size() + 1;
+          }
+
+        pending->position += static_cast<u64>(std::max(count, 0));
+        while(count > 0 && static_cast<std::size_t>(count) >= pending->vectors[pending->first].iov_len)
+          {
+          count -= static_cast<int>(pending->vectors[pending->first].iov_len);
+          ++pending->first;
+          }
+
+        if(count > 0)
+          {
+          auto & vector = pending->vectors[pending->first];
+          vector.iov_base = static_cast<char *>(vector.iov_base) + count;
+          vector.iov_len -= static_cast<std::size_t>(count);
+          }
+
+        if(pending->first < pending->vectors.size())
+          {
+          auto lock = std::lock_guard<std::mutex>{m_mutex};
+          --m_inKernel;
+          queue(pending);
+          flush(failed);
+          continue;
+          }
+
+          {
+          auto lock = std::lock_guard<std::mutex>{m_mutex};
+          --m_inKernel;
+          m_operations.erase(pending);
+          }
+
+        if(pending->request.completion)
+          {
+          pending->request.completion(pending->first == pending->vectors.size());
+          }
+        delete pending;
+
+        auto lock = std::lock_guard<std::mutex>{m_mutex};
+        --m_inFlight;
+        m_available.notify_all();
+        }
+
+      __atomic_store_n(target.completionHead, head, __ATOMIC_RELEASE);
+      fail(failed);
+      }
+    }
+
+  }
@@ -1,20 +1,51 @@
+#include "fs/detail/bitmap_scan.hpp"
+#include "fs/detail/block_device.hpp"
+#include "fs/detail/block_map.hpp"
+#include "fs/detail/block_run.hpp"
+#include "fs/detail/buffer_cache.hpp"
+#include "fs/detail/bulk_read.hpp"
+#include "fs/detail/checksum.hpp"
+#include "fs/detail/directory.hpp"
+#include "fs/detail/extended_attributes.hpp"
+#include "fs/detail/extent_tree.hpp"
+#include "fs/detail/free_extents.hpp"
+#include "fs/detail/geometry.hpp"
+#include "fs/detail/group_descriptor_table.hpp"
+#include "fs/detail/group_prefetch.hpp"
+#include "fs/detail/htree.hpp"
+#include "fs/detail/indirect_map.hpp"
+#include "fs/detail/inline_data.hpp"
+#include "fs/detail/inode.hpp"
+#include "fs/detail/inode_scan.hpp"
+#include "fs/detail/lru_cache.hpp"
 #include "fs/detail/superblock.hpp"
+#include "fs/detail/superblock_copies.hpp"
+#include "fs/detail/view.hpp"
 #include "fs/extfs.hpp"
+#include "fs/file_reader.hpp"
+#include "fs/tree_walk.hpp"
 
-#include <fstream>
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
 
 namespace
   {
   auto constexpr kPrimarySuperblockLocation = 1024;
   auto constexpr kExtfsMagic = 0xef53;
+  auto constexpr kMaximumNameLength = 255u;
+  auto constexpr kRootDirectoryId = 2u;
+  auto constexpr kMaximumInodeGapBlocks = 8u;
 
-  auto read_superblock(std::fstream & stream, fs::detail::superblock & superblock)
+  auto read_superblock(fs::detail::block_device const & device, fs::detail::u64 const offset)
     {
-    auto const originalPosition = stream.tellg();
-    stream.seekg(kPrimarySuperblockLocation);
-    stream.read(reinterpret_cast<char *>(&superblock), sizeof(fs::detail::superblock));
-    stream.seekg(originalPosition);
+    using fs::detail::superblock;
+    return fs::detail::view<superblock>{device.fetch(offset ? offset : kPrimarySuperblockLocation, sizeof(superblock))};
     }
   }
 
@@ -22,24 +53,1045 @@ namespace fs
   {
 
   extfs::extfs(std::string const & path, extfs::mode const openMode) :
-    m_stream{path, std::ios::binary | (openMode == mode::read_only ? std::ios::in : std::ios::in | std::ios::out)}
+    extfs{path, openMode, settings{}}
     {
-    read_superblock(m_stream, m_primarySuperblock);
+    }
+
+  extfs::extfs(std::string const & path, extfs::mode const openMode, extfs::settings const & configuration) :
+    m_device{detail::open_block_device(path, openMode == mode::writeable, configuration.memory_map,
+                                       configuration.io_queue_depth)}
+    {
+    if(m_device)
+      {
+      m_primarySuperblock = read_superblock(*m_device, configuration.superblock_offset);
+      mount(configuration);
+      }
+
+    if(open() && openMode == mode::read_only && configuration.overlay_journal && needs_recovery())
+      {
+      overlay_journal(configuration);
+      }
+
+    if(open() && m_device->writeable())
+      {
+      m_allocator = std::make_unique<detail::block_allocator>(*m_device, m_geometry, *m_groups);
+      }
+    }
+
+  void extfs::mount(extfs::settings const & configuration)
+    {
+    m_checksums.reset();
+    if(open() && !detail::valid_geometry(*m_primarySuperblock))
+      {
+      m_primarySuperblock = {};
+      }
+
+    if(open() && configuration.verify_checksums &&
+       m_primarySuperblock->has(detail::superblock::read_only_compatible_feature::metadata_checksum))
+      {
+      if(!detail::verify_superblock(*m_primarySuperblock))
+        {
+        m_primarySuperblock = {};
+        }
+      else
+        {
+        m_checksums = std::make_unique<detail::metadata_checksums>(*m_primarySuperblock);
+        }
+      }
+
+    if(open())
+      {
+      m_geometry = detail::geometry{*m_primarySuperblock};
+      if(!m_device->mapped() && !m_buffers)
+        {
+        auto buffers = std::make_unique<detail::buffer_cache>(std::move(m_device), m_geometry.block_size(),
+                                                              configuration.buffer_cache_size);
+        m_buffers = buffers.get();
+        m_device = std::move(buffers);
+        }
+      m_groups = std::make_unique<detail::group_descriptor_table>(*m_device, m_geometry, m_checksums.get());
+      m_prefetcher = std::make_unique<detail::group_prefetcher>(*m_device, m_buffers, m_geometry, *m_groups);
+      m_prefetchFlexibleGroups = configuration.prefetch_flexible_groups;
+      m_inodes = std::make_unique<detail::lru_cache<detail::u32, detail::view<detail::inode>>>(configuration.inode_cache_size);
+      m_blockMaps = std::make_unique<detail::lru_cache<detail::u32, std::shared_ptr<detail::block_map>>>(
+        configuration.block_map_cache_size);
+      m_dentries = std::make_unique<detail::lru_cache<detail::dentry_key, detail::u32, detail::dentry_key_hash>>(
+        configuration.dentry_cache_size);
+      m_attributeBlocks = std::make_unique<detail::lru_cache<detail::u64, detail::bytes>>(
+        configuration.attribute_block_cache_size);
+      }
+    }
+
+  void extfs::overlay_journal(extfs::settings const & configuration)
+    {
+    auto const journalId = m_primarySuperblock->journal_inode_id;
+    auto const journal = inode(journalId);
+    if(m_primarySuperblock->has(detail::superblock::incompatible_feature::journal_device) || !journal)
+      {
+      return;
+      }
+
+    auto const blockSize = m_geometry.block_size();
+    auto const runs = resolve(journalId, 0, journal->size() / blockSize);
+    auto index = runs ? detail::scan_journal(*m_device, blockSize, *runs) : std::nullopt;
+    if(!index)
+      {
+      return;
+      }
+
+    m_journal = index->statistics;
+    if(index->blocks.empty())
+      {
+      return;
+      }
+
+    m_device = std::make_unique<detail::journal_overlay>(std::move(m_device), blockSize, std::move(index->blocks));
+    m_primarySuperblock = read_superblock(*m_device, configuration.superblock_offset);
+    mount(configuration);
     }
 
   bool extfs::open() const
     {
-    return m_stream && m_primarySuperblock.magic_number == kExtfsMagic;
+    return m_primarySuperblock && m_primarySuperblock->magic_number == kExtfsMagic;
     }
 
   std::string extfs::label() const
     {
-    return std::string{m_primarySuperblock.label.data()};
+    if(!m_primarySuperblock)
+      {
+      return {};
+      }
+
+    auto const & label = m_primarySuperblock->label;
+    return std::string{label.data(), std::find(label.begin(), label.end(), '\0')};
     }
 
   bool extfs::has_label() const
     {
-    return m_primarySuperblock.label[0];
+    return m_primarySuperblock && m_primarySuperblock->label[0];
+    }
+
+  detail::u32 extfs::groups_count() const
+    {
+    return m_geometry.groups_count();
+    }
+
+  std::optional<detail::block_group> extfs::group(detail::u32 const id) const
+    {
+    if(!m_groups)
+      {
+      return std::nullopt;
+      }
+
+    return (*m_groups)[id];
+    }
+
+  detail::view<detail::inode> extfs::inode(detail::u32 const id) const
+    {
+    if(!m_inodes)
+      {
+      return {};
+      }
+
+    if(auto cached = m_inodes->find(id))
+      {
+      return *cached;
+      }
+
+    auto const offset = inode_offset(id);
+    if(!offset)
+      {
+      return {};
+      }
+
+    if(m_prefetchFlexibleGroups)
+      {
+      m_prefetcher->touch(m_geometry.inode_group(id));
+      }
+
+    auto storage = inode_storage();
+    if(!m_device->read(*offset, storage.get(), m_geometry.inode_size()))
+      {
+      return {};
+      }
+
+    return cache_inode(id, std::move(storage));
+    }
+
+  void extfs::prefetch_inodes(std::vector<detail::u32> inodeIds) const
+    {
+    if(!open())
+      {
+      return;
+      }
+
+    auto const blockSize = detail::u64{m_geometry.block_size()};
+    auto offsets = std::vector<detail::u64>{};
+    offsets.reserve(inodeIds.size());
+    for(auto const id : inodeIds)
+      {
+      if(auto const offset = inode_offset(id))
+        {
+        offsets.push_back(*offset / blockSize * blockSize);
+        }
+      }
+
+    std::sort(offsets.begin(), offsets.end());
+    for(auto first = offsets.begin(); first != offsets.end();)
+      {
+      auto last = first;
+      while(std::next(last) != offsets.end() && *std::next(last) <= *last + blockSize)
+        {
+        ++last;
+        }
+
+      m_device->prefetch(*first, *last + blockSize - *first);
+      first = std::next(last);
+      }
+    }
+
+  void extfs::prefetch_group_metadata(detail::u32 const firstGroup, detail::u32 const endGroup) const
+    {
+    if(open())
+      {
+      m_prefetcher->prefetch(firstGroup, endGroup);
+      }
+    }
+
+  detail::group_prefetch_statistics extfs::group_prefetch_statistics() const
+    {
+    return m_prefetcher ? m_prefetcher->statistics() : detail::group_prefetch_statistics{};
+    }
+
+  std::optional<detail::inode_scan> extfs::inode_scanner(detail::u32 const firstGroup, detail::u32 const endGroup) const
+    {
+    if(!open())
+      {
+      return std::nullopt;
+      }
+
+    return std::optional<detail::inode_scan>{std::in_place, *m_device, m_geometry, *m_groups, firstGroup, endGroup};
+    }
+
+  bool extfs::scan_inodes(detail::inode_visitor const & visitor, unsigned const threads) const
+    {
+    return open() && detail::scan_inodes(*m_device, m_geometry, *m_groups, threads, visitor);
+    }
+
+  detail::cache_statistics extfs::inode_cache_statistics() const
+    {
+    return m_inodes ? m_inodes->statistics() : detail::cache_statistics{};
+    }
+
+  std::optional<std::vector<detail::block_run>> extfs::resolve(detail::u32 const inodeId,
+                                                             detail::u64 const firstBlock,
+                                                             detail::u64 const blocksCount) const
+    {
+    auto const node = inode(inodeId);
+    if(!node || node->has(detail::inode::flag::inline_data))
+      {
+      return std::nullopt;
+      }
+
+    auto const fastSymbolicLink = node->type() == detail::inode::file_type::symbolic_link && node->size() < sizeof(node->block);
+    if(fastSymbolicLink)
+      {
+      return std::nullopt;
+      }
+
+    auto map = m_blockMaps->find(inodeId).value_or(nullptr);
+    auto const isNew = !map;
+    if(isNew && node->has(detail::inode::flag::extents))
+      {
+      auto const inodeSeed = m_checksums ? m_checksums->inode_seed(inodeId, node->generation) : 0;
+      map = std::make_shared<detail::extent_status>(*m_device, m_geometry.block_size(), node->block, m_checksums.get(),
+                                                    inodeSeed);
+      }
+    else if(isNew)
+      {
+      map = std::make_shared<detail::indirect_map>(*m_device, m_geometry.block_size(), node->block);
+      }
+
+    auto const footprint = map->footprint();
+    auto runs = map->resolve(firstBlock, blocksCount);
+    if(isNew || map->footprint() != footprint)
+      {
+      m_blockMaps->insert(inodeId, map, map->footprint());
+      }
+
+    return runs;
+    }
+
+  std::optional<std::size_t> extfs::read(detail::u32 const inodeId,
+                                         detail::u64 const offset,
+                                         void * const buffer,
+                                         std::size_t const length) const
+    {
+    auto const node = inode(inodeId);
+    if(!node)
+      {
+      return std::nullopt;
+      }
+
+    auto const size = node->size();
+    if(offset >= size || !length)
+      {
+      return std::size_t{};
+      }
+
+    if(node->has(detail::inode::flag::inline_data))
+      {
+      auto const content = inline_content(node);
+      return content ? std::optional{content->copy(offset, buffer, length)} : std::nullopt;
+      }
+
+    auto const count = static_cast<std::size_t>(std::min<detail::u64>(length, size - offset));
+    auto const blockSize = detail::u64{m_geometry.block_size()};
+    auto const firstBlock = offset / blockSize;
+    auto const runs = resolve(inodeId, firstBlock, (offset + count - 1) / blockSize - firstBlock + 1);
+    if(!runs)
+      {
+      return std::nullopt;
+      }
+
+    auto const target = static_cast<detail::u08 *>(buffer);
+    auto requests = std::vector<detail::io_request>{};
+    for(auto const & run : *runs)
+      {
+      auto const first = std::max(offset, run.logical_block_id * blockSize);
+      auto const end = std::min(offset + count, (run.logical_block_id + run.blocks_count) * blockSize);
+      if(first >= end)
+        {
+        continue;
+        }
+
+      auto const destination = target + (first - offset);
+      if(run.sparse())
+        {
+        std::memset(destination, 0, end - first);
+        }
+      else
+        {
+        auto const physical = run.physical_block_id * blockSize + (first - run.logical_block_id * blockSize);
+        requests.push_back(detail::io_request{physical, {{destination, static_cast<std::size_t>(end - first)}}});
+        }
+      }
+
+    if(requests.size() == 1)
+      {
+      auto const & request = requests.front();
+      return m_device->read(request.offset, request.vectors) ? std::optional{count} : std::nullopt;
+      }
+
+    return m_device->read_batch(std::move(requests)) ? std::optional{count} : std::nullopt;
+    }
+
+  void extfs::prefetch(detail::u32 const inodeId, detail::u64 const offset, detail::u64 const length) const
+    {
+    auto const blockSize = detail::u64{m_geometry.block_size()};
+    if(!length || !blockSize)
+      {
+      return;
+      }
+
+    auto const firstBlock = offset / blockSize;
+    auto const runs = resolve(inodeId, firstBlock, (offset + length - 1) / blockSize - firstBlock + 1);
+    for(auto const & run : runs.value_or(std::vector<detail::block_run>{}))
+      {
+      if(!run.sparse())
+        {
+        m_device->prefetch(run.physical_block_id * blockSize, run.blocks_count * blockSize);
+        }
+      }
+    }
+
+  std::optional<detail::bulk_read_statistics> extfs::read_bulk(std::vector<detail::u32> const & inodeIds,
+                                                               detail::content_sink const & sink,
+                                                               detail::completion_sink const & completion) const
+    {
+    if(!open())
+      {
+      return std::nullopt;
+      }
+
+    prefetch_inodes(inodeIds);
+
+    auto const blockSize = m_geometry.block_size();
+    auto files = std::vector<detail::bulk_file>{};
+    auto unreadable = std::vector<detail::u32>{};
+    auto inlined = detail::bulk_read_statistics{};
+    for(auto const id : inodeIds)
+      {
+      auto const node = inode(id);
+      if(node && node->has(detail::inode::flag::inline_data))
+        {
+        auto const content = inline_content(node);
+        if(!content)
+          {
+          unreadable.push_back(id);
+          continue;
+          }
+
+        for(auto const & piece : {detail::content_piece{id, 0, content->head, content->head_size},
+                                  detail::content_piece{id, content->head_size, content->tail, content->tail_size}})
+          {
+          if(piece.length && !inlined.stopped)
+            {
+            inlined.bytes_count += piece.length;
+            inlined.stopped = !sink(piece);
+            }
+          }
+
+        if(inlined.stopped)
+          {
+          return inlined;
+          }
+
+        ++inlined.files_count;
+        if(completion)
+          {
+          completion(id, true);
+          }
+        continue;
+        }
+
+      auto runs = node ? resolve(id, 0, (node->size() + blockSize - 1) / blockSize) : std::nullopt;
+      if(runs)
+        {
+        files.push_back(detail::bulk_file{id, node->size(), std::move(*runs)});
+        }
+      else
+        {
+        unreadable.push_back(id);
+        }
+      }
+
+    for(auto const id : unreadable)
+      {
+      if(completion)
+        {
+        completion(id, false);
+        }
+      }
+
+    auto statistics = detail::read_bulk(*m_device, blockSize, files, sink, completion);
+    statistics.files_count += inlined.files_count;
+    statistics.bytes_count += inlined.bytes_count;
+    statistics.failures_count += unreadable.size();
+    return statistics;
+    }
+
+  file_reader extfs::reader(detail::u32 const inodeId) const
+    {
+    return file_reader{*this, inodeId};
+    }
+
+  detail::cache_statistics extfs::block_map_cache_statistics() const
+    {
+    return m_blockMaps ? m_blockMaps->statistics() : detail::cache_statistics{};
+    }
+
+  std::optional<detail::u32> extfs::find(detail::u32 const directoryId, std::string_view const name) const
+    {
+    if(!m_dentries)
+      {
+      return std::nullopt;
+      }
+
+    auto const key = detail::dentry_key{directoryId, std::string{name}};
+    if(auto const cached = m_dentries->find(key))
+      {
+      return cached;
+      }
+
+    auto const found = search(directoryId, name);
+    if(found)
+      {
+      m_dentries->insert(key, *found, key.footprint());
+      }
+
+    return found;
+    }
+
+  std::optional<detail::u32> extfs::lookup(std::string_view const path) const
+    {
+    if(path.empty() || path.front() != '/')
+      {
+      return std::nullopt;
+      }
+
+    auto current = detail::u32{kRootDirectoryId};
+    auto remaining = path;
+    while(!remaining.empty())
+      {
+      auto const separator = remaining.find('/');
+      auto const component = remaining.substr(0, separator);
+      remaining.remove_prefix(separator == std::string_view::npos ? remaining.size() : separator + 1);
+      if(component.empty() || component == ".")
+        {
+        continue;
+        }
+
+      auto const next = find(current, component);
+      if(!next || !*next)
+        {
+        return next;
+        }
+      current = *next;
+      }
+
+    return inode(current) ? std::optional<detail::u32>{current} : std::nullopt;
+    }
+
+  bool extfs::list(detail::u32 const directoryId, detail::entry_visitor const & visitor) const
+    {
+    auto const node = inode(directoryId);
+    if(!node || node->type() != detail::inode::file_type::directory)
+      {
+      return false;
+      }
+
+    auto const typed = m_primarySuperblock->has(detail::superblock::incompatible_feature::filetype);
+    if(node->has(detail::inode::flag::inline_data))
+      {
+      return list_inline(directoryId, node, [&](auto const inodeId, auto const name, auto const type){
+        return visitor(inodeId, name, typed ? type : detail::directory_entry::file_type::unknown);
+      });
+      }
+
+    auto const blockSize = m_geometry.block_size();
+    auto const runs = resolve(directoryId, 0, (node->size() + blockSize - 1) / blockSize);
+    if(!runs)
+      {
+      return false;
+      }
+
+    auto const inodeSeed = m_checksums ? m_checksums->inode_seed(directoryId, node->generation) : 0;
+    auto stopped = false;
+    for(auto const & run : *runs)
+      {
+      if(!run.sparse())
+        {
+        m_device->prefetch(run.physical_block_id * blockSize, run.blocks_count * blockSize);
+        }
+
+      for(auto block = detail::u64{}; !run.sparse() && block < run.blocks_count; ++block)
+        {
+        auto const data = m_device->fetch((run.physical_block_id + block) * blockSize, blockSize);
+        if(!data || (m_checksums && !m_checksums->verify_directory_block(inodeSeed, data.get(), blockSize)))
+          {
+          return false;
+          }
+
+        auto const valid = detail::visit_entries(data.get(), blockSize, [&](auto const inodeId, auto const name, auto const type){
+          stopped = !visitor(inodeId, name, typed ? type : detail::directory_entry::file_type::unknown);
+          return !stopped;
+        });
+        if(!valid || stopped)
+          {
+          return valid;
+          }
+        }
+      }
+
+    return true;
+    }
+
+  bool extfs::list_with_attributes(detail::u32 const directoryId, detail::listing_visitor const & visitor,
+                                   std::size_t const batchSize) const
+    {
+    auto batch = std::vector<detail::listed_entry>{};
+    auto stopped = false;
+    auto failed = false;
+    auto const deliver = [&]{
+      failed = !load_attributes(batch);
+      stopped = failed || !visitor(batch);
+      batch.clear();
+      return !stopped;
+    };
+
+    auto const listed = list(directoryId, [&](auto const inodeId, auto const name, auto const type){
+      batch.push_back(detail::listed_entry{inodeId, std::string{name}, type, {}});
+      return batch.size() < std::max<std::size_t>(batchSize, 1) || deliver();
+    });
+
+    if(listed && !stopped && !batch.empty())
+      {
+      deliver();
+      }
+
+    return listed && !failed;
+    }
+
+  std::optional<walk_statistics> extfs::walk(detail::u32 const directoryId, walk_visitor const & visitor,
+                                             unsigned const threads) const
+    {
+    return open() ? walk_tree(*this, directoryId, visitor, threads) : std::nullopt;
+    }
+
+  detail::cache_statistics extfs::dentry_cache_statistics() const
+    {
+    return m_dentries ? m_dentries->statistics() : detail::cache_statistics{};
+    }
+
+  bool extfs::list_extended_attributes(detail::u32 const inodeId, detail::attribute_visitor const & visitor) const
+    {
+    auto failed = false;
+    auto const listed = for_each_attribute(inodeId, [&](auto const & entry, auto const name, auto const value){
+      auto const fullName = detail::attribute_name(entry.name_index, name);
+      if(!fullName)
+        {
+        return true;
+        }
+      else if(value)
+        {
+        return visitor(*fullName, value, entry.value_size);
+        }
+
+      auto const external = external_attribute_value(entry);
+      failed = !external;
+      return !failed && visitor(*fullName, external->data(), external->size());
+    });
+
+    return listed && !failed;
+    }
+
+  std::optional<std::vector<detail::u08>> extfs::extended_attribute(detail::u32 const inodeId, std::string_view const name) const
+    {
+    auto const key = detail::split_attribute_name(name);
+    if(!key)
+      {
+      return std::nullopt;
+      }
+
+    auto found = std::optional<std::vector<detail::u08>>{};
+    for_each_attribute(inodeId, [&](auto const & entry, auto const entryName, auto const value){
+      if(entry.name_index != key->first || entryName != key->second)
+        {
+        return true;
+        }
+
+      found = value ? std::vector<detail::u08>(value, value + entry.value_size) : external_attribute_value(entry);
+      return false;
+    });
+
+    return found;
+    }
+
+  detail::cache_statistics extfs::attribute_block_cache_statistics() const
+    {
+    return m_attributeBlocks ? m_attributeBlocks->statistics() : detail::cache_statistics{};
+    }
+
+  detail::cache_statistics extfs::buffer_cache_statistics() const
+    {
+    return m_buffers ? m_buffers->statistics() : detail::cache_statistics{};
+    }
+
+  detail::write_statistics extfs::buffer_cache_write_statistics() const
+    {
+    return m_buffers ? m_buffers->flush_statistics() : detail::write_statistics{};
+    }
+
+  bool extfs::sync()
+    {
+    return open() && m_device->writeable() && m_device->sync();
+    }
+
+  std::vector<detail::block_extent> extfs::allocate_blocks(detail::u32 const inodeId, detail::u64 const blocksCount,
+                                                           detail::u64 const goal)
+    {
+    auto const node = m_allocator ? inode(inodeId) : detail::view<detail::inode>{};
+    if(!node)
+      {
+      return {};
+      }
+    else if(goal)
+      {
+      return m_allocator->allocate(goal, blocksCount);
+      }
+
+    auto target = m_geometry.group_first_block_id(m_geometry.inode_group(inodeId));
+    auto const blockSize = m_geometry.block_size();
+    auto const blocks = (node->size() + blockSize - 1) / blockSize;
+    auto const runs = blocks ? resolve(inodeId, blocks - 1, 1) : std::nullopt;
+    if(runs && !runs->empty() && runs->back().physical_block_id)
+      {
+      target = runs->back().physical_block_id + runs->back().blocks_count;
+      }
+
+    return m_allocator->allocate(target, blocksCount);
+    }
+
+  bool extfs::release_blocks(detail::block_extent const & extent)
+    {
+    return m_allocator && m_allocator->release(extent);
+    }
+
+  detail::allocator_statistics extfs::block_allocator_statistics() const
+    {
+    return m_allocator ? m_allocator->statistics() : detail::allocator_statistics{};
+    }
+
+  bool extfs::needs_recovery() const
+    {
+    return open() && m_primarySuperblock->has(detail::superblock::incompatible_feature::recover);
+    }
+
+  std::optional<detail::journal_statistics> extfs::journal_statistics() const
+    {
+    return m_journal;
+    }
+
+  bool extfs::verifies_checksums() const
+    {
+    return static_cast<bool>(m_checksums);
+    }
+
+  detail::u64 extfs::checksum_failures_count() const
+    {
+    return m_checksums ? m_checksums->failures_count() : 0;
+    }
+
+  std::vector<detail::superblock_copy> extfs::superblock_copies() const
+    {
+    if(!open())
+      {
+      return {};
+      }
+
+    return detail::read_superblock_copies(*m_device, m_geometry, *m_primarySuperblock);
+    }
+
+  std::optional<detail::space_usage> extfs::scan_free_space(unsigned const threads) const
+    {
+    if(!open())
+      {
+      return std::nullopt;
+      }
+
+    return detail::scan_bitmaps(*m_device, m_geometry, *m_groups, *m_primarySuperblock, threads);
+    }
+
+  std::optional<detail::fragmentation_report> extfs::scan_free_extents(unsigned const threads) const
+    {
+    if(!open())
+      {
+      return std::nullopt;
+      }
+
+    return detail::scan_free_extents(*m_device, m_geometry, *m_groups, threads);
+    }
+
+  std::optional<detail::u32> extfs::search(detail::u32 const directoryId, std::string_view const name) const
+    {
+    auto const node = inode(directoryId);
+    if(!node || node->type() != detail::inode::file_type::directory)
+      {
+      return std::nullopt;
+      }
+    else if(name.empty() || name.size() > kMaximumNameLength)
+      {
+      return detail::u32{};
+      }
+    else if(node->has(detail::inode::flag::inline_data))
+      {
+      auto found = detail::u32{};
+      auto const valid = list_inline(directoryId, node, [&](auto const inodeId, auto const entryName, auto){
+        found = entryName == name ? inodeId : 0;
+        return !found;
+      });
+      return valid ? std::optional{found} : std::nullopt;
+      }
+
+    auto const & superblock = *m_primarySuperblock;
+    auto const inodeSeed = m_checksums ? m_checksums->inode_seed(directoryId, node->generation) : 0;
+    if(node->has(detail::inode::flag::hash_indexed) && superblock.has(detail::superblock::compatible_feature::directory_indexing))
+      {
+      auto const index = detail::htree{[&](auto const logicalBlock){ return block_of(directoryId, inodeSeed, logicalBlock); },
+                                       m_geometry.block_size(),
+                                       superblock.hash_seed,
+                                       superblock.has(detail::superblock::flag::unsigned_directory_hash),
+                                       superblock.has(detail::superblock::incompatible_feature::large_directory)};
+      if(auto const found = index.find(name))
+        {
+        return found;
+        }
+      }
+
+    auto const blockSize = m_geometry.block_size();
+    auto const runs = resolve(directoryId, 0, (node->size() + blockSize - 1) / blockSize);
+    if(!runs)
+      {
+      return std::nullopt;
+      }
+
+    for(auto const & run : *runs)
+      {
+      for(auto block = detail::u64{}; !run.sparse() && block < run.blocks_count; ++block)
+        {
+        auto const data = m_device->fetch((run.physical_block_id + block) * blockSize, blockSize);
+        auto const valid = data && (!m_checksums || m_checksums->verify_directory_block(inodeSeed, data.get(), blockSize));
+        auto const found = valid ? detail::find_entry(data.get(), blockSize, name) : std::nullopt;
+        if(!found || *found)
+          {
+          return found;
+          }
+        }
+      }
+
+    return detail::u32{};
+    }
+
+  std::optional<detail::inline_data> extfs::inline_content(detail::view<detail::inode> const & node) const
+    {
+    return detail::inline_data_of(reinterpret_cast<detail::u08 const *>(node.get()), m_geometry.inode_size());
+    }
+
+  bool extfs::list_inline(detail::u32 const directoryId, detail::view<detail::inode> const & node,
+                          detail::entry_visitor const & visitor) const
+    {
+    auto const content = inline_content(node);
+    if(!content || content->head_size < detail::kInlineDirectoryHeaderSize)
+      {
+      return false;
+      }
+
+    auto parentId = detail::u32{};
+    std::memcpy(&parentId, content->head, sizeof(parentId));
+    auto const type = detail::directory_entry::file_type::directory;
+    if(!visitor(directoryId, ".", type) || !visitor(parentId, "..", type))
+      {
+      return true;
+      }
+
+    auto stopped = false;
+    auto const visit = [&](auto const inodeId, auto const name, auto const entryType){
+      stopped = !visitor(inodeId, name, entryType);
+      return !stopped;
+    };
+
+    auto const headSize = content->head_size - detail::kInlineDirectoryHeaderSize;
+    if(!detail::visit_entries(content->head + detail::kInlineDirectoryHeaderSize, headSize, visit))
+      {
+      return false;
+      }
+
+    return stopped || !content->tail_size || detail::visit_entries(content->tail, content->tail_size, visit);
+    }
+
+  std::optional<detail::u64> extfs::inode_offset(detail::u32 const inodeId) const
+    {
+    if(!open() || !inodeId || inodeId > m_geometry.inodes_count())
+      {
+      return std::nullopt;
+      }
+
+    auto const group = this->group(m_geometry.inode_group(inodeId));
+    if(!group)
+      {
+      return std::nullopt;
+      }
+
+    auto const tableOffset = group->inode_table_block_id * m_geometry.block_size();
+    return tableOffset + detail::u64{m_geometry.inode_index(inodeId)} * m_geometry.inode_size();
+    }
+
+  bool extfs::for_each_attribute(detail::u32 const inodeId,
+                                 std::function<bool(detail::extended_attribute_entry const & entry,
+                                                    std::string_view const name,
+                                                    detail::u08 const * const value)> const & visitor) const
+    {
+    auto const node = inode(inodeId);
+    if(!node)
+      {
+      return false;
+      }
+
+    auto stopped = false;
+    auto const visit = [&](auto const & entry, auto const name, auto const value){
+      stopped = !visitor(entry, name, value);
+      return !stopped;
+    };
+
+    auto const raw = reinterpret_cast<detail::u08 const *>(node.get());
+    auto const inInode = detail::in_inode_attributes(raw, m_geometry.inode_size());
+    if(!detail::visit_attributes(inInode.entries, inInode.length, inInode.entries, inInode.length, visit))
+      {
+      return false;
+      }
+    else if(stopped || !node->extended_attributes_block_id())
+      {
+      return true;
+      }
+
+    auto const block = attribute_block(node->extended_attributes_block_id());
+    if(!block)
+      {
+      return false;
+      }
+
+    auto const blockSize = m_geometry.block_size();
+    auto const region = detail::block_attributes(block.get(), blockSize);
+    return detail::visit_attributes(region.entries, region.length, block.get(), blockSize, visit);
+    }
+
+  detail::bytes extfs::attribute_block(detail::u64 const blockId) const
+    {
+    if(blockId >= m_geometry.blocks_count())
+      {
+      return nullptr;
+      }
+    else if(auto cached = m_attributeBlocks->find(blockId))
+      {
+      return *cached;
+      }
+
+    auto const blockSize = m_geometry.block_size();
+    auto storage = std::shared_ptr<detail::u08>{new detail::u08[blockSize], std::default_delete<detail::u08[]>{}};
+    if(!m_device->read(blockId * blockSize, storage.get(), blockSize) ||
+       !detail::block_attributes(storage.get(), blockSize).entries ||
+       (m_checksums && !m_checksums->verify_attribute_block(blockId, storage.get(), blockSize)))
+      {
+      return nullptr;
+      }
+
+    m_attributeBlocks->insert(blockId, storage, blockSize);
+    return storage;
+    }
+
+  std::optional<std::vector<detail::u08>> extfs::external_attribute_value(
+    detail::extended_attribute_entry const & entry) const
+    {
+    auto const node = inode(entry.value_inode_id);
+    if(!node || !node->has(detail::inode::flag::extended_attribute_inode) || node->size() < entry.value_size)
+      {
+      return std::nullopt;
+      }
+
+    auto value = std::vector<detail::u08>(entry.value_size);
+    auto const length = read(entry.value_inode_id, 0, value.data(), value.size());
+    return length == value.size() ? std::optional{std::move(value)} : std::nullopt;
+    }
+
+  std::shared_ptr<detail::u08> extfs::inode_storage() const
+    {
+    auto const storageSize = std::max<std::size_t>(m_geometry.inode_size(), sizeof(detail::inode));
+    return std::shared_ptr<detail::u08>{new detail::u08[storageSize](), std::default_delete<detail::u08[]>{}};
+    }
+
+  detail::view<detail::inode> extfs::cache_inode(detail::u32 const inodeId, std::shared_ptr<detail::u08> storage) const
+    {
+    if(m_checksums && !m_checksums->verify_inode(inodeId, storage.get(), m_geometry.inode_size()))
+      {
+      return {};
+      }
+
+    auto const loaded = detail::view<detail::inode>{std::move(storage)};
+    m_inodes->insert(inodeId, loaded, std::max<std::size_t>(m_geometry.inode_size(), sizeof(detail::inode)));
+    return loaded;
+    }
+
+  bool extfs::load_attributes(std::vector<detail::listed_entry> & entries) const
+    {
+    struct location
+      {
+      detail::u64 offset;
+      detail::listed_entry * entry;
+      };
+
+    auto locations = std::vector<location>{};
+    locations.reserve(entries.size());
+    for(auto & entry : entries)
+      {
+      auto const offset = inode_offset(entry.inode_id);
+      if(!offset)
+        {
+        return false;
+        }
+      locations.push_back(location{*offset, &entry});
+      }
+
+    std::stable_sort(locations.begin(), locations.end(), [](auto const & lhs, auto const & rhs){
+      return lhs.offset < rhs.offset;
+    });
+
+    auto const blockSize = detail::u64{m_geometry.block_size()};
+    auto const inodeSize = m_geometry.inode_size();
+    auto const blockOf = [&](auto const & location){ return location.offset / blockSize; };
+    for(auto first = locations.begin(); first != locations.end();)
+      {
+      auto last = first;
+      while(std::next(last) != locations.end() && blockOf(*std::next(last)) <= blockOf(*last) + kMaximumInodeGapBlocks)
+        {
+        ++last;
+        }
+
+      auto range = detail::bytes{};
+      auto const rangeOffset = blockOf(*first) * blockSize;
+      auto const rangeLength = (blockOf(*last) + 1) * blockSize - rangeOffset;
+      for(auto current = first; current != std::next(last); ++current)
+        {
+        auto & entry = *current->entry;
+        if(current != first && current->offset == std::prev(current)->offset)
+          {
+          entry.attributes = std::prev(current)->entry->attributes;
+          continue;
+          }
+        else if(auto cached = m_inodes->find(entry.inode_id))
+          {
+          entry.attributes = std::move(*cached);
+          continue;
+          }
+
+        if(!range && !(range = m_device->fetch(rangeOffset, rangeLength)))
+          {
+          return false;
+          }
+
+        auto storage = inode_storage();
+        std::memcpy(storage.get(), range.get() + (current->offset - rangeOffset), inodeSize);
+        if(!(entry.attributes = cache_inode(entry.inode_id, std::move(storage))))
+          {
+          return false;
+          }
+        }
+
+      first = std::next(last);
+      }
+
+    auto sorted = std::vector<detail::listed_entry>{};
+    sorted.reserve(entries.size());
+    for(auto & location : locations)
+      {
+      auto & entry = *location.entry;
+      if(entry.type == detail::directory_entry::file_type::unknown)
+        {
+        entry.type = detail::entry_type_of(entry.attributes->type());
+        }
+      sorted.push_back(std::move(entry));
+      }
+
+    entries = std::move(sorted);
+    return true;
+    }
+
+  detail::bytes extfs::block_of(detail::u32 const inodeId, detail::u32 const inodeSeed, detail::u64 const logicalBlock) const
+    {
+    auto const runs = resolve(inodeId, logicalBlock, 1);
+    if(!runs || runs->empty() || runs->front().sparse())
+      {
+      return nullptr;
+      }
+
+    auto const blockSize = m_geometry.block_size();
+    auto data = m_device->fetch(runs->front().physical_block_id * blockSize, blockSize);
+    if(data && m_checksums && !m_checksums->verify_directory_block(inodeSeed, data.get(), blockSize))
+      {
+      return nullptr;
+      }
+
+    return data;
     }
 
   }
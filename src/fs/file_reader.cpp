@@ -0,0 +1,81 @@
+#include "fs/extfs.hpp"
+#include "fs/file_reader.hpp"
+
+#include <algorithm>
+#include <optional>
+
+namespace fs
+  {
+
+  file_reader::file_reader(extfs const & fileSystem, detail::u32 const inodeId) :
+    m_fileSystem{&fileSystem},
+    m_inodeId{inodeId}
+    {
+    if(auto const node = fileSystem.inode(inodeId))
+      {
+      m_size = node->size();
+      }
+    }
+
+  std::optional<std::size_t> file_reader::read(void * const buffer, std::size_t const length)
+    {
+    if(m_sequential)
+      {
+      read_ahead(length);
+      }
+
+    auto const count = m_fileSystem->read(m_inodeId, m_position, buffer, length);
+    if(count)
+      {
+      m_position += *count;
+      m_sequential = true;
+      }
+
+    return count;
+    }
+
+  void file_reader::seek(detail::u64 const position)
+    {
+    if(position != m_position)
+      {
+      m_position = position;
+      m_readaheadEnd = position;
+      m_readaheadSize = kInitialReadaheadSize;
+      m_sequential = false;
+      }
+    }
+
+  detail::u64 file_reader::position() const
+    {
+    return m_position;
+    }
+
+  detail::u64 file_reader::size() const
+    {
+    return m_size;
+    }
+
+  std::size_t file_reader::readahead_size() const
+    {
+    return m_readaheadSize;
+    }
+
+  void file_reader::read_ahead(std::size_t const length)
+    {
+    auto const needed = std::min(m_size, m_position + length);
+    if(m_readaheadEnd >= std::min(m_size, needed + m_readaheadSize / 2))
+      {
+      return;
+      }
+
+    auto const first = std::max(m_readaheadEnd, m_position);
+    auto const end = std::min(m_size, std::max(needed, first) + m_readaheadSize);
+    if(first < end)
+      {
+      m_fileSystem->prefetch(m_inodeId, first, end - first);
+      m_readaheadEnd = end;
+      m_readaheadSize = std::min(m_readaheadSize * 2, kMaximumReadaheadSize);
+      }
+    }
+
+  }
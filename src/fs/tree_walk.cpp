@@ -0,0 +1,271 @@
+#include "fs/detail/directory.hpp"
+#include "fs/detail/inode.hpp"
+#include "fs/extfs.hpp"
+#include "fs/tree_walk.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace
+  {
+  using fs::detail::directory_entry;
+  using fs::detail::u32;
+  using fs::detail::u64;
+
+  struct directory_task
+    {
+    u32 directoryId;
+    std::string path;
+    unsigned depth;
+    };
+
+  struct task_queue
+    {
+    std::mutex mutex{};
+    std::deque<directory_task> tasks{};
+    };
+
+  struct child
+    {
+    u32 inodeId;
+    std::string name;
+    directory_entry::file_type type;
+    };
+
+  struct tree_walk
+    {
+    tree_walk(fs::extfs const & fileSystem, fs::walk_visitor const & visitor, unsigned const workersCount) :
+      m_fileSystem{fileSystem},
+      m_visitor{visitor},
+      m_queues{std::make_unique<task_queue[]>(workersCount)},
+      m_workersCount{workersCount}
+      {
+      }
+
+    void run(u32 const rootId)
+      {
+      m_visited.insert(rootId);
+      push(0, directory_task{rootId, {}, 0});
+
+      auto workers = std::vector<std::thread>{};
+      for(auto index = 1u; index < m_workersCount; ++index)
+        {
+        workers.emplace_back([this, index]{ work(index); });
+        }
+      work(0);
+      for(auto & worker : workers)
+        {
+        worker.join();
+        }
+      }
+
+    fs::walk_statistics statistics() const
+      {
+      return {m_directoriesCount, m_entriesCount, m_failuresCount, m_stealsCount, m_stopped};
+      }
+
+    private:
+      void push(unsigned const worker, directory_task task)
+        {
+        ++m_pending;
+        {
+        auto lock = std::lock_guard<std::mutex>{m_queues[worker].mutex};
+        m_queues[worker].tasks.push_back(std::move(task));
+        }
+
+        ++m_queued;
+        if(m_sleepers)
+          {
+          auto lock = std::lock_guard<std::mutex>{m_idleMutex};
+          m_idle.notify_one();
+          }
+        }
+
+      std::optional<directory_task> pop(unsigned const worker)
+        {
+        for(auto step = 0u; step < m_workersCount; ++step)
+          {
+          auto const victim = (worker + step) % m_workersCount;
+          auto & queue = m_queues[victim];
+          auto lock = std::lock_guard<std::mutex>{queue.mutex};
+          if(queue.tasks.empty())
+            {
+            continue;
+            }
+
+          auto task = std::optional<directory_task>{};
+          if(victim == worker)
+            {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            }
+          else
+            {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            ++m_stealsCount;
+            }
+
+          --m_queued;
+          return task;
+          }
+
+        return std::nullopt;
+        }
+
+      void finish()
+        {
+        if(!--m_pending)
+          {
+          auto lock = std::lock_guard<std::mutex>{m_idleMutex};
+          m_idle.notify_all();
+          }
+        }
+
+      void stop()
+        {
+        m_stopped = true;
+        auto lock = std::lock_guard<std::mutex>{m_idleMutex};
+        m_idle.notify_all();
+        }
+
+      void work(unsigned const worker)
+        {
+        while(!m_stopped)
+          {
+          if(auto task = pop(worker))
+            {
+            walk(worker, *task);
+            finish();
+            continue;
+            }
+
+          auto lock = std::unique_lock<std::mutex>{m_idleMutex};
+          ++m_sleepers;
+          m_idle.wait(lock, [this]{ return m_queued || !m_pending || m_stopped; });
+          --m_sleepers;
+          if(!m_pending)
+            {
+            return;
+            }
+          }
+        }
+
+      void walk(unsigned const worker, directory_task const & task)
+        {
+        auto children = std::vector<child>{};
+        auto const listed = m_fileSystem.list(task.directoryId, [&](auto const inodeId, auto const name, auto const type){
+          if(name != "." && name != "..")
+            {
+            children.push_back(child{inodeId, std::string{name}, type});
+            }
+          return true;
+        });
+
+        if(!listed)
+          {
+          ++m_failuresCount;
+          return;
+          }
+
+        ++m_directoriesCount;
+        auto inodeIds = std::vector<u32>(children.size());
+        std::transform(children.begin(), children.end(), inodeIds.begin(), [](auto const & entry){ return entry.inodeId; });
+        m_fileSystem.prefetch_inodes(std::move(inodeIds));
+
+        auto path = task.path;
+        if(!path.empty())
+          {
+          path += '/';
+          }
+        auto const prefixLength = path.size();
+
+        for(auto const & entry : children)
+          {
+          if(m_stopped)
+            {
+            return;
+            }
+
+          auto type = entry.type;
+          if(type == directory_entry::file_type::unknown)
+            {
+            auto const node = m_fileSystem.inode(entry.inodeId);
+            type = node ? fs::detail::entry_type_of(node->type()) : type;
+            }
+          path.resize(prefixLength);
+          path += entry.name;
+
+          ++m_entriesCount;
+          auto const action = m_visitor(fs::walk_entry{task.directoryId, entry.inodeId, path, entry.name, type,
+                                                       task.depth + 1});
+          if(action == fs::walk_action::stop)
+            {
+            stop();
+            return;
+            }
+          else if(action == fs::walk_action::descend && type == directory_entry::file_type::directory && visit(entry.inodeId))
+            {
+            push(worker, directory_task{entry.inodeId, path, task.depth + 1});
+            }
+          }
+        }
+
+      bool visit(u32 const directoryId)
+        {
+        auto lock = std::lock_guard<std::mutex>{m_visitedMutex};
+        return m_visited.insert(directoryId).second;
+        }
+
+      fs::extfs const & m_fileSystem;
+      fs::walk_visitor const & m_visitor;
+      std::unique_ptr<task_queue[]> m_queues;
+      unsigned const m_workersCount;
+
+      std::mutex m_idleMutex{};
+      std::condition_variable m_idle{};
+      std::atomic<u64> m_pending{};
+      std::atomic<u64> m_queued{};
+      std::atomic<unsigned> m_sleepers{};
+      std::atomic<bool> m_stopped{};
+
+      std::mutex m_visitedMutex{};
+      std::unordered_set<u32> m_visited{};
+
+      std::atomic<u64> m_directoriesCount{};
+      std::atomic<u64> m_entriesCount{};
+      std::atomic<u64> m_failuresCount{};
+      std::atomic<u64> m_stealsCount{};
+    };
+  }
+
+namespace fs
+  {
+
+  std::optional<walk_statistics> walk_tree(extfs const & fileSystem, detail::u32 const rootId,
+                                           walk_visitor const & visitor, unsigned const threads)
+    {
+    auto const root = fileSystem.inode(rootId);
+    if(!root || root->type() != detail::inode::file_type::directory)
+      {
+      return std::nullopt;
+      }
+
+    auto const hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    auto walk = tree_walk{fileSystem, visitor, threads ? threads : hardwareThreads};
+    walk.run(rootId);
+    return walk.statistics();
+    }
+
+  }
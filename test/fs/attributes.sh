@@ -0,0 +1,19 @@
+#!/bin/sh
+
+# This script adds extended attributes to a test disk image. The attributes of /small do not fit into its inode and spill
+# into an extended attribute block, which /large is made to share, like ext4 does for inodes with identical attributes.
+
+set -e
+
+IMAGE="$1"
+WORK="$(mktemp -d)"
+trap 'rm -rf "${WORK}"' EXIT
+
+seq -s , 1 60 > "${WORK}/spilled"
+
+debugfs -w -R "ea_set /small user.comment small" "${IMAGE}"
+debugfs -w -R "ea_set -f ${WORK}/spilled /small trusted.spilled" "${IMAGE}"
+debugfs -w -R "ea_set /directory security.selinux system_u:object_r:etc_t:s0" "${IMAGE}"
+
+BLOCK="$(debugfs -R "stat /small" "${IMAGE}" | sed -n 's/.*File ACL: \([0-9]*\).*/\1/p')"
+debugfs -w -R "sif /large file_acl ${BLOCK}" "${IMAGE}"
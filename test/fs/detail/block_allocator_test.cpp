@@ -0,0 +1,227 @@
+#include "fs/detail/bitmap_scan.hpp"
+#include "fs/detail/block_allocator.hpp"
+#include "test/disk_fixture.hpp"
+
+#include <cute/cute.h>
+#include <cute/cute_runner.h>
+#include <cute/ostream_listener.h>
+#include <cute/xml_listener.h>
+
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+auto constexpr kGroupsDiskImage = "../test/extfs_data/groups.img";
+auto constexpr kMetaGroupsDiskImage = "../test/extfs_data/metagroups.img";
+
+struct fixture : disk_fixture
+  {
+  explicit fixture(char const * const path, bool const verify = false) :
+    disk_fixture{path, verify},
+    allocator{std::make_unique<fs::detail::block_allocator>(*device, layout, *table)}
+    {
+    }
+
+  fs::detail::u64 free_blocks_count() const
+    {
+    auto total = fs::detail::u64{};
+    for(auto group = 0u; group < layout.groups_count(); ++group)
+      {
+      total += allocator->free_blocks_count(group).value_or(0);
+      }
+    return total;
+    }
+
+  std::unique_ptr<fs::detail::block_allocator> allocator;
+  };
+
+auto blocks_of(std::vector<fs::detail::block_extent> const & extents)
+  {
+  auto total = fs::detail::u64{};
+  for(auto const & extent : extents)
+    {
+    total += extent.blocks_count;
+    }
+  return total;
+  }
+
+void assert_summaries_match_bitmaps(char const * const path, bool const verify)
+  {
+  auto const disk = fixture{path, verify};
+  auto const usage = fs::detail::scan_bitmaps(*disk.device, disk.layout, *disk.table, *disk.superblock, 1);
+  ASSERT(usage);
+  for(auto const & group : usage->groups)
+    {
+    ASSERT_EQUAL(fs::detail::u64{group.free_blocks_count}, disk.allocator->free_blocks_count(group.id).value_or(~0ull));
+    }
+  ASSERT_EQUAL(disk.layout.groups_count(), disk.allocator->statistics().loaded_groups_count);
+  }
+
+void summaries_match_bitmaps()
+  {
+  assert_summaries_match_bitmaps(kGroupsDiskImage, false);
+  }
+
+void summaries_of_uninitialized_groups_match_bitmaps()
+  {
+  assert_summaries_match_bitmaps(kMetaGroupsDiskImage, true);
+  }
+
+void uninitialized_flags_are_ignored_without_lazy_initialization()
+  {
+  auto const copy = std::string{"../test/extfs_data/groups_stray_flags.img"};
+    {
+    auto source = std::ifstream{kGroupsDiskImage, std::ios::binary};
+    auto target = std::ofstream{copy, std::ios::binary};
+    target << source.rdbuf();
+    }
+
+    {
+    // groups.img uses 1024 byte blocks, so its group descriptor table starts in block 2.
+    auto image = std::fstream{copy, std::ios::binary | std::ios::in | std::ios::out};
+    auto const flags = static_cast<fs::detail::group_descriptor::flg>(
+      fs::detail::group_descriptor::flag::block_bitmap_uninitialized);
+    image.seekp(2 * 1024 + offsetof(fs::detail::group_descriptor, flags));
+    image.write(reinterpret_cast<char const *>(&flags), sizeof(flags));
+    }
+
+  auto const original = fixture{kGroupsDiskImage};
+  auto const expected = fs::detail::scan_bitmaps(*original.device, original.layout, *original.table, *original.superblock, 1);
+  auto const disk = fixture{copy.c_str()};
+  auto const freeBlocksCount = disk.allocator->free_blocks_count(0);
+  std::remove(copy.c_str());
+  ASSERT(expected && freeBlocksCount);
+  ASSERT_EQUAL(fs::detail::u64{expected->groups[0].free_blocks_count}, *freeBlocksCount);
+  }
+
+void only_needed_groups_are_loaded()
+  {
+  auto const disk = fixture{kGroupsDiskImage};
+  auto const extents = disk.allocator->allocate(disk.layout.group_first_block_id(5), 8);
+  ASSERT_EQUAL(8u, blocks_of(extents));
+  ASSERT_EQUAL(1u, disk.allocator->statistics().loaded_groups_count);
+  }
+
+void allocation_starts_at_free_goal()
+  {
+  auto const disk = fixture{kGroupsDiskImage};
+  auto const probe = disk.allocator->allocate(disk.layout.group_first_block_id(3), 1);
+  ASSERT_EQUAL(1u, probe.size());
+  ASSERT(disk.allocator->release(probe[0]));
+
+  auto const extents = disk.allocator->allocate(probe[0].first_block_id, 1);
+  ASSERT_EQUAL(1u, extents.size());
+  ASSERT_EQUAL(probe[0].first_block_id, extents[0].first_block_id);
+  ASSERT_EQUAL(1u, disk.allocator->statistics().goal_hits_count);
+  }
+
+void consecutive_allocations_are_contiguous()
+  {
+  auto const disk = fixture{kGroupsDiskImage};
+  auto const first = disk.allocator->allocate(disk.layout.group_first_block_id(7), 4);
+  ASSERT_EQUAL(1u, first.size());
+
+  auto const second = disk.allocator->allocate(first[0].end_block_id(), 4);
+  ASSERT_EQUAL(1u, second.size());
+  ASSERT_EQUAL(first[0].end_block_id(), second[0].first_block_id);
+  }
+
+void large_allocation_spans_few_extents()
+  {
+  auto const disk = fixture{kGroupsDiskImage};
+  auto const freeBefore = disk.free_blocks_count();
+  auto const extents = disk.allocator->allocate(0, 1000);
+  ASSERT_EQUAL(1000u, blocks_of(extents));
+  ASSERT_LESS(extents.size(), std::size_t{8});
+  ASSERT_EQUAL(freeBefore - 1000, disk.free_blocks_count());
+  }
+
+void allocations_never_overlap()
+  {
+  auto const disk = fixture{kGroupsDiskImage};
+  auto const freeBefore = disk.free_blocks_count();
+  auto random = std::mt19937{42};
+  auto blocks = std::set<fs::detail::u64>{};
+  auto allocated = fs::detail::u64{};
+  for(auto round = 0; round < 200; ++round)
+    {
+    auto const goal = std::uniform_int_distribution<fs::detail::u64>{0, disk.layout.blocks_count() - 1}(random);
+    auto const count = std::uniform_int_distribution<fs::detail::u64>{1, 40}(random);
+    auto const extents = disk.allocator->allocate(goal, count);
+    ASSERT_EQUAL(count, blocks_of(extents));
+    for(auto const & extent : extents)
+      {
+      for(auto block = extent.first_block_id; block < extent.end_block_id(); ++block)
+        {
+        ASSERT(blocks.insert(block).second);
+        }
+      }
+    allocated += count;
+    }
+
+  ASSERT_EQUAL(freeBefore - allocated, disk.free_blocks_count());
+  }
+
+void excessive_allocation_changes_nothing()
+  {
+  auto const disk = fixture{kGroupsDiskImage};
+  auto const freeBefore = disk.free_blocks_count();
+  ASSERT(disk.allocator->allocate(0, freeBefore + 1).empty());
+  ASSERT_EQUAL(freeBefore, disk.free_blocks_count());
+  ASSERT_EQUAL(0u, disk.allocator->statistics().allocations_count);
+
+  ASSERT_EQUAL(freeBefore, blocks_of(disk.allocator->allocate(0, freeBefore)));
+  ASSERT_EQUAL(0u, disk.free_blocks_count());
+  }
+
+void released_extents_are_merged()
+  {
+  auto const disk = fixture{kGroupsDiskImage};
+  auto const largest = disk.allocator->largest_free_extent(9).value_or(0);
+  auto const extents = disk.allocator->allocate(disk.layout.group_first_block_id(9), 30);
+  ASSERT_EQUAL(1u, extents.size());
+
+  auto const middle = fs::detail::block_extent{extents[0].first_block_id + 10, 10};
+  ASSERT(disk.allocator->release(fs::detail::block_extent{extents[0].first_block_id, 10}));
+  ASSERT(disk.allocator->release(fs::detail::block_extent{extents[0].first_block_id + 20, 10}));
+  ASSERT(disk.allocator->release(middle));
+  ASSERT_EQUAL(largest, disk.allocator->largest_free_extent(9).value_or(0));
+  }
+
+void releasing_free_blocks_fails()
+  {
+  auto const disk = fixture{kGroupsDiskImage};
+  auto const extents = disk.allocator->allocate(0, 5);
+  ASSERT_EQUAL(1u, extents.size());
+  ASSERT(disk.allocator->release(extents[0]));
+  ASSERT(!disk.allocator->release(extents[0]));
+  ASSERT(!disk.allocator->release(fs::detail::block_extent{disk.layout.blocks_count(), 1}));
+  ASSERT(!disk.allocator->release(fs::detail::block_extent{}));
+  ASSERT_EQUAL(5u, disk.allocator->statistics().released_blocks_count);
+  }
+
+int main(int argc, char * argv[])
+  {
+  auto tests = cute::suite{
+    CUTE(summaries_match_bitmaps),
+    CUTE(summaries_of_uninitialized_groups_match_bitmaps),
+    CUTE(uninitialized_flags_are_ignored_without_lazy_initialization),
+    CUTE(only_needed_groups_are_loaded),
+    CUTE(allocation_starts_at_free_goal),
+    CUTE(consecutive_allocations_are_contiguous),
+    CUTE(large_allocation_spans_few_extents),
+    CUTE(allocations_never_overlap),
+    CUTE(excessive_allocation_changes_nothing),
+    CUTE(released_extents_are_merged),
+    CUTE(releasing_free_blocks_fails),
+  };
+
+  cute::xml_file_opener resultFile{argc, argv};
+  cute::xml_listener<cute::ostream_listener<>> listener{resultFile.out};
+  return !cute::makeRunner(listener, argc, argv)(tests, "fs::detail::block_allocator");
+  }
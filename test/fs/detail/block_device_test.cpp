@@ -0,0 +1,166 @@
+#include "fs/detail/block_device.hpp"
+
+#include <cute/cute.h>
+#include <cute/cute_runner.h>
+#include <cute/ostream_listener.h>
+#include <cute/xml_listener.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+auto constexpr kNonExistantImage = "THIS_DISK_DOES_NOT_EXIST";
+auto constexpr kLabeledDiskImage = "../test/extfs_data/labeled.img";
+auto constexpr kMagicNumberLocation = 1024 + 56;
+
+void open_block_device_with_inexistent_file_returns_null()
+  {
+  ASSERT(!fs::detail::open_block_device(kNonExistantImage, false));
+  }
+
+void open_block_device_in_read_only_mode_maps_the_image()
+  {
+  auto device = fs::detail::open_block_device(kLabeledDiskImage, false);
+  ASSERT(dynamic_cast<fs::detail::mapped_block_device *>(device.get()));
+  ASSERT(!device->writeable());
+  }
+
+void open_block_device_in_writeable_mode_uses_positional_device()
+  {
+  auto device = fs::detail::open_block_device(kLabeledDiskImage, true);
+  ASSERT(dynamic_cast<fs::detail::positional_block_device *>(device.get()));
+  ASSERT(device->writeable());
+  }
+
+void mapped_block_device_has_size_of_image()
+  {
+  auto device = fs::detail::mapped_block_device{kLabeledDiskImage};
+  ASSERT_EQUAL(1024u * 1024u, device.size());
+  }
+
+void mapped_block_device_fetches_superblock_magic()
+  {
+  auto device = fs::detail::mapped_block_device{kLabeledDiskImage};
+  auto data = device.fetch(kMagicNumberLocation, 2);
+  ASSERT(data);
+  ASSERT_EQUAL(0x53, data.get()[0]);
+  ASSERT_EQUAL(0xef, data.get()[1]);
+  }
+
+void mapped_block_device_fetch_does_not_copy()
+  {
+  auto device = fs::detail::mapped_block_device{kLabeledDiskImage};
+  auto first = device.fetch(0, 4096);
+  auto second = device.fetch(1024, 1024);
+  ASSERT_EQUAL(static_cast<void const *>(first.get() + 1024), static_cast<void const *>(second.get()));
+  }
+
+void positional_block_device_reads_superblock_magic()
+  {
+  auto device = fs::detail::positional_block_device{kLabeledDiskImage, false};
+  auto magic = std::array<std::uint8_t, 2>{};
+  ASSERT(device.read(kMagicNumberLocation, magic.data(), magic.size()));
+  ASSERT_EQUAL(0x53, magic[0]);
+  ASSERT_EQUAL(0xef, magic[1]);
+  }
+
+void positional_and_mapped_block_devices_fetch_identical_bytes()
+  {
+  auto mapped = fs::detail::mapped_block_device{kLabeledDiskImage};
+  auto positional = fs::detail::positional_block_device{kLabeledDiskImage, false};
+  auto mappedData = mapped.fetch(1024, 2048);
+  auto positionalData = positional.fetch(1024, 2048);
+  ASSERT(mappedData && positionalData);
+  ASSERT(!std::memcmp(mappedData.get(), positionalData.get(), 2048));
+  }
+
+void block_devices_refuse_reads_past_the_end()
+  {
+  auto mapped = fs::detail::mapped_block_device{kLabeledDiskImage};
+  auto positional = fs::detail::positional_block_device{kLabeledDiskImage, false};
+  ASSERT(!mapped.fetch(mapped.size() - 512, 1024));
+  ASSERT(!positional.fetch(positional.size() - 512, 1024));
+  }
+
+void positional_block_device_refuses_fetches_before_allocating()
+  {
+  auto positional = fs::detail::positional_block_device{kLabeledDiskImage, false};
+  ASSERT(!positional.fetch(0, ~std::size_t{} >> 1));
+  auto const missing = fs::detail::positional_block_device{"/this/file/does/not/exist", false};
+  ASSERT(!missing.fetch(0, 1024));
+  }
+
+void positional_block_device_reads_into_multiple_buffers()
+  {
+  auto device = fs::detail::positional_block_device{kLabeledDiskImage, false};
+  auto head = std::array<std::uint8_t, 56>{};
+  auto magic = std::array<std::uint8_t, 2>{};
+  ASSERT(device.read(1024, {{head.data(), head.size()}, {magic.data(), magic.size()}}));
+  ASSERT_EQUAL(0x53, magic[0]);
+  ASSERT_EQUAL(0xef, magic[1]);
+  }
+
+void mapped_block_device_reads_into_multiple_buffers()
+  {
+  auto device = fs::detail::mapped_block_device{kLabeledDiskImage};
+  auto head = std::array<std::uint8_t, 56>{};
+  auto magic = std::array<std::uint8_t, 2>{};
+  ASSERT(device.read(1024, {{head.data(), head.size()}, {magic.data(), magic.size()}}));
+  ASSERT_EQUAL(0x53, magic[0]);
+  ASSERT_EQUAL(0xef, magic[1]);
+  }
+
+void positional_block_device_supports_concurrent_reads()
+  {
+  auto device = fs::detail::positional_block_device{kLabeledDiskImage, false};
+  auto expected = std::vector<std::uint8_t>(device.size());
+  ASSERT(device.read(0, expected.data(), expected.size()));
+
+  auto mismatches = std::atomic<int>{};
+  auto workers = std::vector<std::thread>{};
+  for(auto worker = 0u; worker < 8; ++worker)
+    {
+    workers.emplace_back([&, worker]{
+      auto block = std::array<std::uint8_t, 1024>{};
+      for(auto index = 0u; index < 1024; ++index)
+        {
+        auto const offset = ((index * 7 + worker * 131) % 1024) * block.size();
+        if(!device.read(offset, block.data(), block.size()) ||
+           !std::equal(block.begin(), block.end(), expected.begin() + offset))
+          {
+          ++mismatches;
+          }
+        }
+    });
+    }
+
+  std::for_each(workers.begin(), workers.end(), [](auto & worker){ worker.join(); });
+  ASSERT_EQUAL(0, mismatches.load());
+  }
+
+int main(int argc, char * argv[])
+  {
+  auto tests = cute::suite{
+    CUTE(open_block_device_with_inexistent_file_returns_null),
+    CUTE(open_block_device_in_read_only_mode_maps_the_image),
+    CUTE(open_block_device_in_writeable_mode_uses_positional_device),
+    CUTE(mapped_block_device_has_size_of_image),
+    CUTE(mapped_block_device_fetches_superblock_magic),
+    CUTE(mapped_block_device_fetch_does_not_copy),
+    CUTE(positional_block_device_reads_superblock_magic),
+    CUTE(positional_and_mapped_block_devices_fetch_identical_bytes),
+    CUTE(block_devices_refuse_reads_past_the_end),
+    CUTE(positional_block_device_refuses_fetches_before_allocating),
+    CUTE(positional_block_device_reads_into_multiple_buffers),
+    CUTE(mapped_block_device_reads_into_multiple_buffers),
+    CUTE(positional_block_device_supports_concurrent_reads),
+  };
+
+  cute::xml_file_opener resultFile{argc, argv};
+  cute::xml_listener<cute::ostream_listener<>> listener{resultFile.out};
+  return !cute::makeRunner(listener, argc, argv)(tests, "fs::detail::block_device");
+  }
@@ -0,0 +1,425 @@
+#include "fs/detail/block_arena.hpp"
+#include "fs/detail/block_device.hpp"
+#include "fs/detail/buffer_cache.hpp"
+
+#include <cute/cute.h>
+#include <cute/cute_runner.h>
+#include <cute/ostream_listener.h>
+#include <cute/xml_listener.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+auto constexpr kGroupsDiskImage = "../test/extfs_data/groups.img";
+auto constexpr kBlockSize = 1024u;
+
+auto make_cache(std::size_t const blocksCount)
+  {
+  auto device = fs::detail::open_block_device(kGroupsDiskImage, false, false);
+  return fs::detail::buffer_cache{std::move(device), kBlockSize, blocksCount * kBlockSize, 1};
+  }
+
+auto content_of(fs::detail::u64 const blockId)
+  {
+  auto device = fs::detail::open_block_device(kGroupsDiskImage, false);
+  auto content = std::vector<fs::detail::u08>(kBlockSize);
+  device->read(blockId * kBlockSize, content.data(), content.size());
+  return content;
+  }
+
+struct recording_device final : fs::detail::block_device
+  {
+  explicit recording_device(std::unique_ptr<fs::detail::block_device> device, std::vector<std::pair<fs::detail::u64,
+                            std::size_t>> & writes) :
+    m_device{std::move(device)},
+    m_writes{writes}
+    {
+    }
+
+  fs::detail::u64 size() const override { return m_device->size(); }
+  bool writeable() const override { return m_device->writeable(); }
+  bool mapped() const override { return false; }
+  void prefetch(fs::detail::u64 const, fs::detail::u64 const) const override {}
+  bool sync() override { return m_device->sync(); }
+
+  bool read(fs::detail::u64 const offset, void * const buffer, std::size_t const length) const override
+    {
+    return m_device->read(offset, buffer, length);
+    }
+
+  bool read(fs::detail::u64 const offset, std::vector<fs::detail::io_vector> const & vectors) const override
+    {
+    return m_device->read(offset, vectors);
+    }
+
+  fs::detail::bytes fetch(fs::detail::u64 const offset, std::size_t const length) const override
+    {
+    return m_device->fetch(offset, length);
+    }
+
+  bool write(fs::detail::u64 const offset, void const * const buffer, std::size_t const length) override
+    {
+    return write(offset, {{const_cast<void *>(buffer), length}});
+    }
+
+  bool write(fs::detail::u64 const offset, std::vector<fs::detail::io_vector> const & vectors) override
+    {
+    m_writes.emplace_back(offset / kBlockSize, vectors.size());
+    return m_device->write(offset, vectors);
+    }
+
+  private:
+    std::unique_ptr<fs::detail::block_device> m_device;
+    std::vector<std::pair<fs::detail::u64, std::size_t>> & m_writes;
+  };
+
+std::string writeable_copy(char const * const name)
+  {
+  auto const path = std::string{"../test/extfs_data/"} + name;
+  auto source = std::ifstream{kGroupsDiskImage, std::ios::binary};
+  auto target = std::ofstream{path, std::ios::binary | std::ios::trunc};
+  target << source.rdbuf();
+  return path;
+  }
+
+auto make_writeable_cache(std::string const & path, std::size_t const blocksCount,
+                          std::vector<std::pair<fs::detail::u64, std::size_t>> & writes)
+  {
+  auto device = std::make_unique<recording_device>(fs::detail::open_block_device(path, true), writes);
+  return std::make_unique<fs::detail::buffer_cache>(std::move(device), kBlockSize, blocksCount * kBlockSize, 1);
+  }
+
+auto block_of(std::string const & path, fs::detail::u64 const blockId)
+  {
+  auto device = fs::detail::open_block_device(path, false, false);
+  auto content = std::vector<fs::detail::u08>(kBlockSize);
+  device->read(blockId * kBlockSize, content.data(), content.size());
+  return content;
+  }
+
+void arena_reuses_released_blocks()
+  {
+  auto arena = fs::detail::block_arena{kBlockSize};
+  auto const block = arena.allocate();
+  arena.release(block);
+  ASSERT_EQUAL(block, arena.allocate());
+  }
+
+void arena_grows_by_whole_slabs()
+  {
+  auto arena = fs::detail::block_arena{kBlockSize, 4};
+  for(auto index = 0; index < 5; ++index)
+    {
+    arena.allocate();
+    }
+  ASSERT_EQUAL(8u * kBlockSize, arena.reserved());
+  }
+
+void buffer_cache_is_not_mapped()
+  {
+  auto const cache = make_cache(16);
+  ASSERT(!cache.mapped());
+  }
+
+void repeated_block_access_hits_the_cache()
+  {
+  auto const cache = make_cache(16);
+  ASSERT(cache.block(1));
+  ASSERT(cache.block(1));
+  ASSERT_EQUAL(1u, cache.statistics().hits);
+  ASSERT_EQUAL(1u, cache.statistics().misses);
+  }
+
+void cached_blocks_contain_device_content()
+  {
+  auto const cache = make_cache(16);
+  auto const block = cache.block(1);
+  auto const expected = content_of(1);
+  ASSERT(std::equal(expected.begin(), expected.end(), block.get()));
+  }
+
+void fetches_within_a_block_share_the_cached_block()
+  {
+  auto const cache = make_cache(16);
+  auto const first = cache.fetch(kBlockSize, 128);
+  auto const second = cache.fetch(kBlockSize + 128, 128);
+  ASSERT_EQUAL(first.get() + 128, second.get());
+  ASSERT_EQUAL(1u, cache.statistics().entries);
+  }
+
+void accesses_spanning_blocks_bypass_the_cache()
+  {
+  auto const cache = make_cache(16);
+  ASSERT(cache.fetch(kBlockSize - 8, 16));
+  auto buffer = std::vector<fs::detail::u08>(2 * kBlockSize);
+  ASSERT(cache.read(0, buffer.data(), buffer.size()));
+  ASSERT_EQUAL(0u, cache.statistics().entries);
+  ASSERT_EQUAL(0u, cache.statistics().misses);
+  }
+
+void cache_respects_its_capacity()
+  {
+  auto const cache = make_cache(16);
+  for(auto block = 0u; block < 100; ++block)
+    {
+    cache.block(block);
+    }
+
+  auto const statistics = cache.statistics();
+  ASSERT_EQUAL(16u, statistics.entries);
+  ASSERT_EQUAL(16u * kBlockSize, statistics.size);
+  ASSERT_EQUAL(84u, statistics.evictions);
+  }
+
+void pinned_blocks_are_not_evicted()
+  {
+  auto const cache = make_cache(16);
+  auto const pinned = cache.block(1);
+  for(auto block = 2u; block < 100; ++block)
+    {
+    cache.block(block);
+    }
+
+  auto const expected = content_of(1);
+  ASSERT(std::equal(expected.begin(), expected.end(), pinned.get()));
+  ASSERT_EQUAL(pinned.get(), cache.block(1).get());
+  }
+
+void zero_capacity_cache_holds_nothing()
+  {
+  auto const cache = make_cache(0);
+  ASSERT(cache.block(1));
+  ASSERT(cache.block(1));
+  ASSERT_EQUAL(0u, cache.statistics().entries);
+  ASSERT_EQUAL(2u, cache.statistics().misses);
+  }
+
+void preloaded_blocks_are_served_from_the_cache()
+  {
+  auto const cache = make_cache(64);
+  ASSERT_EQUAL(8u, cache.preload(10, 8));
+  for(auto block = 10u; block < 18; ++block)
+    {
+    auto const expected = content_of(block);
+    ASSERT(std::equal(expected.begin(), expected.end(), cache.block(block).get()));
+    }
+
+  ASSERT_EQUAL(8u, cache.statistics().hits);
+  ASSERT_EQUAL(0u, cache.statistics().misses);
+  ASSERT_EQUAL(0u, cache.preload(10, 8));
+  }
+
+void preloading_is_limited_to_the_fifo_queue()
+  {
+  auto const cache = make_cache(64);
+  ASSERT_EQUAL(16u, cache.preload(0, 100));
+  ASSERT_EQUAL(16u, cache.statistics().entries);
+  ASSERT_EQUAL(0u, make_cache(0).preload(0, 100));
+  }
+
+void scans_do_not_flush_frequently_used_blocks()
+  {
+  auto const cache = make_cache(16);
+  for(auto block = 0u; block < 20; ++block)
+    {
+    cache.block(block);
+    }
+
+  for(auto block = 0u; block < 4; ++block)
+    {
+    cache.block(block);
+    }
+
+  for(auto block = 100u; block < 1000; ++block)
+    {
+    cache.block(block);
+    }
+
+  auto const hits = cache.statistics().hits;
+  for(auto block = 0u; block < 4; ++block)
+    {
+    cache.block(block);
+    }
+  ASSERT_EQUAL(hits + 4, cache.statistics().hits);
+  }
+
+void read_only_cache_rejects_writes()
+  {
+  auto cache = make_cache(16);
+  auto const byte = fs::detail::u08{42};
+  ASSERT(!cache.write(0, &byte, 1));
+  ASSERT(cache.flush());
+  }
+
+void writes_are_buffered_until_flushed()
+  {
+  auto const path = writeable_copy("buffer_cache_buffered.img");
+  auto writes = std::vector<std::pair<fs::detail::u64, std::size_t>>{};
+  auto cache = make_writeable_cache(path, 64, writes);
+  auto const pattern = std::vector<fs::detail::u08>(kBlockSize, 0xa5);
+  auto const original = block_of(path, 7);
+
+  ASSERT(cache->write(7 * kBlockSize, pattern.data(), pattern.size()));
+  ASSERT(writes.empty());
+  ASSERT(original == block_of(path, 7));
+  ASSERT_EQUAL(1u, cache->flush_statistics().dirty_blocks_count);
+
+  ASSERT(cache->flush());
+  ASSERT(pattern == block_of(path, 7));
+  ASSERT_EQUAL(0u, cache->flush_statistics().dirty_blocks_count);
+  std::remove(path.c_str());
+  }
+
+void reads_observe_dirty_blocks()
+  {
+  auto const path = writeable_copy("buffer_cache_observed.img");
+  auto writes = std::vector<std::pair<fs::detail::u64, std::size_t>>{};
+  auto cache = make_writeable_cache(path, 64, writes);
+  auto const pattern = std::vector<fs::detail::u08>(16, 0x3c);
+  ASSERT(cache->write(2 * kBlockSize - 8, pattern.data(), pattern.size(), fs::detail::block_kind::metadata));
+
+  auto expected = block_of(path, 1);
+  auto const second = block_of(path, 2);
+  expected.insert(expected.end(), second.begin(), second.end());
+  std::fill(expected.begin() + kBlockSize - 8, expected.begin() + kBlockSize + 8, 0x3c);
+
+  auto spanning = std::vector<fs::detail::u08>(2 * kBlockSize);
+  ASSERT(cache->read(kBlockSize, spanning.data(), spanning.size()));
+  ASSERT(expected == spanning);
+
+  auto const fetched = cache->fetch(kBlockSize, 2 * kBlockSize);
+  ASSERT(std::equal(expected.begin(), expected.end(), fetched.get()));
+
+  auto const single = cache->block(2);
+  ASSERT(std::equal(expected.begin() + kBlockSize, expected.end(), single.get()));
+
+  auto batched = std::vector<fs::detail::u08>(2 * kBlockSize);
+  ASSERT(cache->read_batch({{kBlockSize, {{batched.data(), batched.size()}}}}));
+  ASSERT(expected == batched);
+  cache.reset();
+  std::remove(path.c_str());
+  }
+
+void flush_merges_adjacent_blocks()
+  {
+  auto const path = writeable_copy("buffer_cache_merged.img");
+  auto writes = std::vector<std::pair<fs::detail::u64, std::size_t>>{};
+  auto cache = make_writeable_cache(path, 256, writes);
+  auto const pattern = std::vector<fs::detail::u08>(kBlockSize, 0x5a);
+  for(auto const block : {120u, 100u, 300u, 101u, 102u, 103u, 301u, 500u})
+    {
+    ASSERT(cache->write(block * kBlockSize, pattern.data(), pattern.size()));
+    }
+
+  ASSERT(cache->flush());
+  auto const expected = std::vector<std::pair<fs::detail::u64, std::size_t>>{{100, 4}, {120, 1}, {300, 2}, {500, 1}};
+  ASSERT_EQUAL(expected, writes);
+  ASSERT_EQUAL(4u, cache->flush_statistics().writes_count);
+  ASSERT_EQUAL(8u, cache->flush_statistics().written_blocks_count);
+  std::remove(path.c_str());
+  }
+
+void metadata_is_flushed_before_data()
+  {
+  auto const path = writeable_copy("buffer_cache_ordered.img");
+  auto writes = std::vector<std::pair<fs::detail::u64, std::size_t>>{};
+  auto cache = make_writeable_cache(path, 256, writes);
+  auto const pattern = std::vector<fs::detail::u08>(kBlockSize, 0x77);
+  ASSERT(cache->write(10 * kBlockSize, pattern.data(), pattern.size(), fs::detail::block_kind::data));
+  ASSERT(cache->write(11 * kBlockSize, pattern.data(), pattern.size(), fs::detail::block_kind::metadata));
+  ASSERT(cache->write(50 * kBlockSize, pattern.data(), pattern.size(), fs::detail::block_kind::metadata));
+
+  ASSERT(cache->sync());
+  auto const expected = std::vector<std::pair<fs::detail::u64, std::size_t>>{{11, 1}, {50, 1}, {10, 1}};
+  ASSERT_EQUAL(expected, writes);
+  std::remove(path.c_str());
+  }
+
+void dirty_blocks_are_not_evicted()
+  {
+  auto const path = writeable_copy("buffer_cache_dirty.img");
+  auto writes = std::vector<std::pair<fs::detail::u64, std::size_t>>{};
+  auto cache = make_writeable_cache(path, 16, writes);
+  auto const pattern = std::vector<fs::detail::u08>(kBlockSize, 0x11);
+  for(auto block = 0u; block < 8; ++block)
+    {
+    ASSERT(cache->write((1000 + block) * kBlockSize, pattern.data(), pattern.size()));
+    }
+
+  for(auto block = 0u; block < 100; ++block)
+    {
+    cache->block(block);
+    }
+
+  ASSERT_EQUAL(8u, cache->flush_statistics().dirty_blocks_count);
+  ASSERT(writes.empty());
+  ASSERT(std::equal(pattern.begin(), pattern.end(), cache->block(1003).get()));
+  std::remove(path.c_str());
+  }
+
+void full_cache_writes_back_dirty_blocks()
+  {
+  auto const path = writeable_copy("buffer_cache_full.img");
+  auto writes = std::vector<std::pair<fs::detail::u64, std::size_t>>{};
+  auto cache = make_writeable_cache(path, 16, writes);
+  auto const pattern = std::vector<fs::detail::u08>(kBlockSize, 0x22);
+  for(auto block = 0u; block < 20; ++block)
+    {
+    ASSERT(cache->write((1000 + block) * kBlockSize, pattern.data(), pattern.size()));
+    }
+
+  ASSERT_EQUAL(1u, cache->flush_statistics().flushes_count);
+  ASSERT_EQUAL(4u, cache->flush_statistics().dirty_blocks_count);
+  std::remove(path.c_str());
+  }
+
+void destroying_the_cache_flushes_dirty_blocks()
+  {
+  auto const path = writeable_copy("buffer_cache_destroyed.img");
+  auto writes = std::vector<std::pair<fs::detail::u64, std::size_t>>{};
+  auto const pattern = std::vector<fs::detail::u08>(kBlockSize, 0x99);
+  {
+  auto cache = make_writeable_cache(path, 64, writes);
+  ASSERT(cache->write(9 * kBlockSize, pattern.data(), pattern.size()));
+  }
+
+  ASSERT(pattern == block_of(path, 9));
+  std::remove(path.c_str());
+  }
+
+int main(int argc, char * argv[])
+  {
+  auto tests = cute::suite{
+    CUTE(arena_reuses_released_blocks),
+    CUTE(arena_grows_by_whole_slabs),
+    CUTE(buffer_cache_is_not_mapped),
+    CUTE(repeated_block_access_hits_the_cache),
+    CUTE(cached_blocks_contain_device_content),
+    CUTE(fetches_within_a_block_share_the_cached_block),
+    CUTE(accesses_spanning_blocks_bypass_the_cache),
+    CUTE(cache_respects_its_capacity),
+    CUTE(pinned_blocks_are_not_evicted),
+    CUTE(zero_capacity_cache_holds_nothing),
+    CUTE(preloaded_blocks_are_served_from_the_cache),
+    CUTE(preloading_is_limited_to_the_fifo_queue),
+    CUTE(scans_do_not_flush_frequently_used_blocks),
+    CUTE(read_only_cache_rejects_writes),
+    CUTE(writes_are_buffered_until_flushed),
+    CUTE(reads_observe_dirty_blocks),
+    CUTE(flush_merges_adjacent_blocks),
+    CUTE(metadata_is_flushed_before_data),
+    CUTE(dirty_blocks_are_not_evicted),
+    CUTE(full_cache_writes_back_dirty_blocks),
+    CUTE(destroying_the_cache_flushes_dirty_blocks),
+  };
+
+  cute::xml_file_opener resultFile{argc, argv};
+  cute::xml_listener<cute::ostream_listener<>> listener{resultFile.out};
+  return !cute::makeRunner(listener, argc, argv)(tests, "fs::detail::buffer_cache");
+  }
@@ -0,0 +1,182 @@
+#include "fs/detail/block_device.hpp"
+#include "fs/detail/block_run.hpp"
+#include "fs/detail/bulk_read.hpp"
+
+#include <cute/cute.h>
+#include <cute/cute_runner.h>
+#include <cute/ostream_listener.h>
+#include <cute/xml_listener.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+auto constexpr kGroupsDiskImage = "../test/extfs_data/groups.img";
+auto constexpr kBlockSize = 1024u;
+
+struct delivered_piece
+  {
+  fs::detail::u32 inodeId;
+  fs::detail::u64 offset;
+  std::vector<fs::detail::u08> data;
+  };
+
+auto content_of(fs::detail::u64 const blockId, std::size_t const length = kBlockSize)
+  {
+  auto device = fs::detail::open_block_device(kGroupsDiskImage, false);
+  auto content = std::vector<fs::detail::u08>(length);
+  device->read(blockId * kBlockSize, content.data(), content.size());
+  return content;
+  }
+
+auto interleaved_files()
+  {
+  return std::vector<fs::detail::bulk_file>{
+    {1, 2 * kBlockSize, {{0, 100, 1}, {1, 10, 1}}},
+    {2, kBlockSize + 10, {{0, 50, 1}, {1, 60, 1}}},
+  };
+  }
+
+auto read_pieces(bool const mapped, std::vector<fs::detail::bulk_file> const & files,
+                 fs::detail::bulk_read_statistics & statistics)
+  {
+  auto device = fs::detail::open_block_device(kGroupsDiskImage, false, mapped);
+  auto pieces = std::vector<delivered_piece>{};
+  statistics = fs::detail::read_bulk(*device, kBlockSize, files, [&](auto const & piece){
+    pieces.push_back(delivered_piece{piece.inode_id, piece.offset, {piece.data, piece.data + piece.length}});
+    return true;
+  }, {});
+  return pieces;
+  }
+
+void pieces_are_delivered_in_physical_order()
+  {
+  for(auto const mapped : {true, false})
+    {
+    auto statistics = fs::detail::bulk_read_statistics{};
+    auto const pieces = read_pieces(mapped, interleaved_files(), statistics);
+
+    ASSERT_EQUAL(4u, pieces.size());
+    ASSERT_EQUAL(1u, pieces[0].inodeId);
+    ASSERT_EQUAL(kBlockSize, pieces[0].offset);
+    ASSERT(content_of(10) == pieces[0].data);
+    ASSERT_EQUAL(2u, pieces[1].inodeId);
+    ASSERT_EQUAL(0u, pieces[1].offset);
+    ASSERT(content_of(50) == pieces[1].data);
+    ASSERT_EQUAL(2u, pieces[2].inodeId);
+    ASSERT_EQUAL(kBlockSize, pieces[2].offset);
+    ASSERT(content_of(60, 10) == pieces[2].data);
+    ASSERT_EQUAL(1u, pieces[3].inodeId);
+    ASSERT_EQUAL(0u, pieces[3].offset);
+    ASSERT(content_of(100) == pieces[3].data);
+
+    ASSERT_EQUAL(2u, statistics.files_count);
+    ASSERT_EQUAL(3u * kBlockSize + 10, statistics.bytes_count);
+    }
+  }
+
+void nearby_ranges_are_read_with_a_single_request()
+  {
+  auto statistics = fs::detail::bulk_read_statistics{};
+  read_pieces(false, interleaved_files(), statistics);
+  ASSERT_EQUAL(1u, statistics.requests_count);
+  }
+
+void distant_ranges_are_read_separately()
+  {
+  auto const files = std::vector<fs::detail::bulk_file>{
+    {1, kBlockSize, {{0, 1000, 1}}},
+    {2, kBlockSize, {{0, 10, 1}}},
+  };
+
+  auto statistics = fs::detail::bulk_read_statistics{};
+  auto const pieces = read_pieces(false, files, statistics);
+  ASSERT_EQUAL(2u, statistics.requests_count);
+  ASSERT_EQUAL(2u, pieces.front().inodeId);
+  }
+
+void holes_are_not_delivered()
+  {
+  auto const files = std::vector<fs::detail::bulk_file>{
+    {1, 4 * kBlockSize, {{0, 0, 2}, {2, 20, 1, true}, {3, 30, 1}}},
+  };
+
+  auto statistics = fs::detail::bulk_read_statistics{};
+  auto const pieces = read_pieces(false, files, statistics);
+  ASSERT_EQUAL(1u, pieces.size());
+  ASSERT_EQUAL(3u * kBlockSize, pieces.front().offset);
+  ASSERT_EQUAL(1u, statistics.files_count);
+  }
+
+void files_are_completed_after_their_last_piece()
+  {
+  auto device = fs::detail::open_block_device(kGroupsDiskImage, false);
+  auto delivered = std::vector<fs::detail::u32>{};
+  auto completed = std::vector<std::pair<fs::detail::u32, std::size_t>>{};
+  fs::detail::read_bulk(*device, kBlockSize, interleaved_files(), [&](auto const & piece){
+    delivered.push_back(piece.inode_id);
+    return true;
+  }, [&](auto const inodeId, auto const success){
+    ASSERT(success);
+    completed.emplace_back(inodeId, delivered.size());
+  });
+
+  ASSERT_EQUAL(2u, completed.size());
+  ASSERT_EQUAL(2u, completed[0].first);
+  ASSERT_EQUAL(3u, completed[0].second);
+  ASSERT_EQUAL(1u, completed[1].first);
+  ASSERT_EQUAL(4u, completed[1].second);
+  }
+
+void unreadable_ranges_fail_their_file()
+  {
+  auto device = fs::detail::open_block_device(kGroupsDiskImage, false, false);
+  auto const files = std::vector<fs::detail::bulk_file>{
+    {1, kBlockSize, {{0, device->size() / kBlockSize + 10000, 1}}},
+    {2, kBlockSize, {{0, 10, 1}}},
+  };
+
+  auto failures = std::vector<fs::detail::u32>{};
+  auto const statistics = fs::detail::read_bulk(*device, kBlockSize, files, [](auto const &){ return true; },
+                                                [&](auto const inodeId, auto const success){
+    if(!success)
+      {
+      failures.push_back(inodeId);
+      }
+  });
+
+  ASSERT_EQUAL(std::vector<fs::detail::u32>{1}, failures);
+  ASSERT_EQUAL(1u, statistics.files_count);
+  ASSERT_EQUAL(1u, statistics.failures_count);
+  }
+
+void sink_can_stop_the_read()
+  {
+  auto device = fs::detail::open_block_device(kGroupsDiskImage, false);
+  auto count = 0u;
+  auto const statistics = fs::detail::read_bulk(*device, kBlockSize, interleaved_files(), [&](auto const &){
+    return ++count < 2;
+  }, {});
+
+  ASSERT(statistics.stopped);
+  ASSERT_EQUAL(2u, count);
+  }
+
+int main(int argc, char * argv[])
+  {
+  auto tests = cute::suite{
+    CUTE(pieces_are_delivered_in_physical_order),
+    CUTE(nearby_ranges_are_read_with_a_single_request),
+    CUTE(distant_ranges_are_read_separately),
+    CUTE(holes_are_not_delivered),
+    CUTE(files_are_completed_after_their_last_piece),
+    CUTE(unreadable_ranges_fail_their_file),
+    CUTE(sink_can_stop_the_read),
+  };
+
+  cute::xml_file_opener resultFile{argc, argv};
+  cute::xml_listener<cute::ostream_listener<>> listener{resultFile.out};
+  return !cute::makeRunner(listener, argc, argv)(tests, "fs::detail::bulk_read");
+  }
@@ -0,0 +1,162 @@
+#include "fs/detail/checksum.hpp"
+#include "fs/detail/superblock.hpp"
+
+#include <cute/cute.h>
+#include <cute/cute_runner.h>
+#include <cute/ostream_listener.h>
+#include <cute/xml_listener.h>
+
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+auto constexpr kExtentsDiskImage = "../test/extfs_data/extents.img";
+auto constexpr kGroupsDiskImage = "../test/extfs_data/groups.img";
+auto constexpr kCheckValue = "123456789";
+
+auto random_bytes(std::size_t const length)
+  {
+  auto engine = std::mt19937{static_cast<std::mt19937::result_type>(length)};
+  auto distribution = std::uniform_int_distribution<unsigned>{0, 255};
+  auto bytes = std::vector<fs::detail::u08>(length);
+  for(auto & byte : bytes)
+    {
+    byte = static_cast<fs::detail::u08>(distribution(engine));
+    }
+  return bytes;
+  }
+
+auto read_superblock(char const * const path)
+  {
+  auto image = std::ifstream{path, std::ios::binary};
+  auto block = fs::detail::superblock{};
+  if(!image.seekg(1024).read(reinterpret_cast<char *>(&block), sizeof(block)))
+    {
+    throw std::runtime_error{"Failed to read test disk image!"};
+    }
+  return block;
+  }
+
+void check_value(fs::detail::crc32c_kernel const kernel)
+  {
+  if(!fs::detail::supported(kernel))
+    {
+    return;
+    }
+
+  ASSERT_EQUAL(0xe3069283u, ~fs::detail::crc32c(~0u, kCheckValue, std::strlen(kCheckValue), kernel));
+  ASSERT_EQUAL(0x12345678u, fs::detail::crc32c(0x12345678u, kCheckValue, 0, kernel));
+  }
+
+void table_kernel_is_always_supported()
+  {
+  ASSERT(fs::detail::supported(fs::detail::crc32c_kernel::table));
+  }
+
+void best_kernel_is_supported()
+  {
+  ASSERT(fs::detail::supported(fs::detail::best_crc32c_kernel()));
+  }
+
+void table_kernel_computes_check_value()
+  {
+  check_value(fs::detail::crc32c_kernel::table);
+  }
+
+void sse42_kernel_computes_check_value()
+  {
+  check_value(fs::detail::crc32c_kernel::sse42);
+  }
+
+void kernels_agree_on_all_lengths()
+  {
+  if(!fs::detail::supported(fs::detail::crc32c_kernel::sse42))
+    {
+    return;
+    }
+
+  for(auto const length : {0u, 1u, 7u, 8u, 9u, 31u, 64u, 255u, 1024u, 4096u, 4099u})
+    {
+    auto const bytes = random_bytes(length);
+    ASSERT_EQUAL(fs::detail::crc32c(0xdeadbeef, bytes.data(), length, fs::detail::crc32c_kernel::table),
+                 fs::detail::crc32c(0xdeadbeef, bytes.data(), length, fs::detail::crc32c_kernel::sse42));
+    }
+  }
+
+void checksums_can_be_continued()
+  {
+  auto const bytes = random_bytes(1000);
+  auto const partial = fs::detail::crc32c(~0u, bytes.data(), 333);
+  ASSERT_EQUAL(fs::detail::crc32c(~0u, bytes.data(), bytes.size()),
+               fs::detail::crc32c(partial, bytes.data() + 333, bytes.size() - 333));
+  }
+
+void valid_superblock_checksum_is_accepted()
+  {
+  auto const block = read_superblock(kExtentsDiskImage);
+  ASSERT(block.has(fs::detail::superblock::read_only_compatible_feature::metadata_checksum));
+  ASSERT(fs::detail::verify_superblock(block));
+  }
+
+void corrupted_superblock_checksum_is_rejected()
+  {
+  auto block = read_superblock(kExtentsDiskImage);
+  block.label[0] ^= 1;
+  ASSERT(!fs::detail::verify_superblock(block));
+  }
+
+void superblock_without_metadata_checksums_is_accepted()
+  {
+  auto block = read_superblock(kGroupsDiskImage);
+  block.checksum = ~block.checksum;
+  ASSERT(fs::detail::verify_superblock(block));
+  }
+
+void seed_is_derived_from_uuid()
+  {
+  auto const block = read_superblock(kExtentsDiskImage);
+  auto const checksums = fs::detail::metadata_checksums{block};
+  ASSERT_EQUAL(fs::detail::crc32c(~0u, block.uuid.data(), block.uuid.size()), checksums.seed());
+  }
+
+void all_zero_inode_is_valid()
+  {
+  auto const checksums = fs::detail::metadata_checksums{read_superblock(kExtentsDiskImage)};
+  auto const inode = std::vector<fs::detail::u08>(256);
+  ASSERT(checksums.verify_inode(12, inode.data(), inode.size()));
+  ASSERT_EQUAL(0u, checksums.failures_count());
+  }
+
+void failed_verifications_are_counted()
+  {
+  auto const checksums = fs::detail::metadata_checksums{read_superblock(kExtentsDiskImage)};
+  auto const block = random_bytes(4096);
+  ASSERT(!checksums.verify_directory_block(0, block.data(), block.size()));
+  ASSERT(!checksums.verify_bitmap(block.data(), 128, 0, true));
+  ASSERT_EQUAL(2u, checksums.failures_count());
+  }
+
+int main(int argc, char * argv[])
+  {
+  auto tests = cute::suite{
+    CUTE(table_kernel_is_always_supported),
+    CUTE(best_kernel_is_supported),
+    CUTE(table_kernel_computes_check_value),
+    CUTE(sse42_kernel_computes_check_value),
+    CUTE(kernels_agree_on_all_lengths),
+    CUTE(checksums_can_be_continued),
+    CUTE(valid_superblock_checksum_is_accepted),
+    CUTE(corrupted_superblock_checksum_is_rejected),
+    CUTE(superblock_without_metadata_checksums_is_accepted),
+    CUTE(seed_is_derived_from_uuid),
+    CUTE(all_zero_inode_is_valid),
+    CUTE(failed_verifications_are_counted),
+  };
+
+  cute::xml_file_opener resultFile{argc, argv};
+  cute::xml_listener<cute::ostream_listener<>> listener{resultFile.out};
+  return !cute::makeRunner(listener, argc, argv)(tests, "fs::detail::checksum");
+  }
@@ -0,0 +1,118 @@
+#include "fs/detail/extended_attributes.hpp"
+
+#include <cute/cute.h>
+#include <cute/cute_runner.h>
+#include <cute/ostream_listener.h>
+#include <cute/xml_listener.h>
+
+#include <array>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+auto constexpr kBlockSize = 1024u;
+
+using raw_block = std::array<fs::detail::u08, kBlockSize>;
+
+raw_block make_block(std::vector<std::pair<std::string, std::string>> const & attributes)
+  {
+  auto block = raw_block{};
+  auto header = fs::detail::extended_attribute_block_header{};
+  header.magic = fs::detail::kExtendedAttributeMagic;
+  header.references_count = 1;
+  header.blocks_count = 1;
+  std::memcpy(block.data(), &header, sizeof(header));
+
+  auto offset = sizeof(header);
+  auto valueOffset = std::size_t{kBlockSize};
+  for(auto const & [name, value] : attributes)
+    {
+    valueOffset -= (value.size() + 3) / 4 * 4;
+    auto entry = fs::detail::extended_attribute_entry{};
+    entry.name_length = static_cast<fs::detail::u08>(name.size());
+    entry.name_index = static_cast<fs::detail::u08>(fs::detail::attribute_namespace::user);
+    entry.value_offset = static_cast<fs::detail::u16>(valueOffset);
+    entry.value_size = static_cast<fs::detail::u32>(value.size());
+    std::memcpy(block.data() + offset, &entry, sizeof(entry));
+    std::memcpy(block.data() + offset + sizeof(entry), name.data(), name.size());
+    std::memcpy(block.data() + valueOffset, value.data(), value.size());
+    offset += (sizeof(entry) + name.size() + 3) / 4 * 4;
+    }
+
+  return block;
+  }
+
+void names_are_prefixed_with_their_namespace()
+  {
+  using fs::detail::attribute_namespace;
+  auto const name = [](auto const space, auto const suffix){
+    return fs::detail::attribute_name(static_cast<fs::detail::u08>(space), suffix).value_or("");
+  };
+
+  ASSERT_EQUAL(std::string{"user.comment"}, name(attribute_namespace::user, "comment"));
+  ASSERT_EQUAL(std::string{"security.selinux"}, name(attribute_namespace::security, "selinux"));
+  ASSERT_EQUAL(std::string{"system.data"}, name(attribute_namespace::system, "data"));
+  ASSERT_EQUAL(std::string{"system.posix_acl_access"}, name(attribute_namespace::posix_acl_access, ""));
+  ASSERT_EQUAL(std::string{"system.posix_acl_default"}, name(attribute_namespace::posix_acl_default, ""));
+  ASSERT(!fs::detail::attribute_name(5, "lustre"));
+  }
+
+bool splits_into(std::string_view const name, fs::detail::attribute_namespace const space, std::string_view const suffix)
+  {
+  auto const split = fs::detail::split_attribute_name(name);
+  return split && split->first == static_cast<fs::detail::u08>(space) && split->second == suffix;
+  }
+
+void names_are_split_into_namespace_and_suffix()
+  {
+  using fs::detail::attribute_namespace;
+  ASSERT(splits_into("security.selinux", attribute_namespace::security, "selinux"));
+  ASSERT(splits_into("system.posix_acl_access", attribute_namespace::posix_acl_access, ""));
+  ASSERT(splits_into("system.posix_acl_accessed", attribute_namespace::system, "posix_acl_accessed"));
+  ASSERT(splits_into("system.richacl", attribute_namespace::system_richacl, ""));
+  ASSERT(!fs::detail::split_attribute_name("user."));
+  ASSERT(!fs::detail::split_attribute_name("comment"));
+  ASSERT(!fs::detail::split_attribute_name("lustre.lov"));
+  }
+
+void block_attributes_are_located_after_the_header()
+  {
+  auto const block = make_block({{"first", "one"}, {"second", "second value"}});
+  auto const region = fs::detail::block_attributes(block.data(), block.size());
+  ASSERT_EQUAL(static_cast<void const *>(block.data() + sizeof(fs::detail::extended_attribute_block_header)),
+               static_cast<void const *>(region.entries));
+
+  auto attributes = std::vector<std::pair<std::string, std::string>>{};
+  ASSERT(fs::detail::visit_attributes(region.entries, region.length, block.data(), block.size(),
+                                      [&](auto const & entry, auto const name, auto const value){
+    attributes.emplace_back(name, std::string{reinterpret_cast<char const *>(value), entry.value_size});
+    return true;
+  }));
+
+  auto const expected = std::vector<std::pair<std::string, std::string>>{{"first", "one"}, {"second", "second value"}};
+  ASSERT(expected == attributes);
+  }
+
+void blocks_without_magic_have_no_attributes()
+  {
+  auto block = make_block({{"first", "one"}});
+  block[3] = 0;
+  ASSERT(!fs::detail::block_attributes(block.data(), block.size()).entries);
+  ASSERT(!fs::detail::block_attributes(block.data(), sizeof(fs::detail::extended_attribute_block_header)).entries);
+  }
+
+int main(int argc, char * argv[])
+  {
+  auto tests = cute::suite{
+    CUTE(names_are_prefixed_with_their_namespace),
+    CUTE(names_are_split_into_namespace_and_suffix),
+    CUTE(block_attributes_are_located_after_the_header),
+    CUTE(blocks_without_magic_have_no_attributes),
+  };
+
+  cute::xml_file_opener resultFile{argc, argv};
+  cute::xml_listener<cute::ostream_listener<>> listener{resultFile.out};
+  return !cute::makeRunner(listener, argc, argv)(tests, "fs::detail::extended_attributes");
+  }
@@ -0,0 +1,132 @@
+#include "fs/detail/block_device.hpp"
+#include "fs/detail/extent_tree.hpp"
+#include "fs/detail/inode.hpp"
+#include "fs/extfs.hpp"
+
+#include <cute/cute.h>
+#include <cute/cute_runner.h>
+#include <cute/ostream_listener.h>
+#include <cute/xml_listener.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+auto constexpr kExtentsDiskImage = "../test/extfs_data/extents.img";
+auto constexpr kSparseFile = "../test/extfs_data/tree/sparse";
+auto constexpr kSparseFileSize = 1198u * 1024u;
+auto constexpr kBlockSize = 1024u;
+
+struct fixture
+  {
+  fixture() :
+    disk{kExtentsDiskImage},
+    device{fs::detail::open_block_device(kExtentsDiskImage, false)}
+    {
+    for(auto id = 12u; id < 64; ++id)
+      {
+      auto const node = disk.inode(id);
+      if(node && node->size() == kSparseFileSize)
+        {
+        status = std::make_unique<fs::detail::extent_status>(*device, kBlockSize, node->block);
+        return;
+        }
+      }
+
+    throw std::runtime_error{"Failed to find sparse test file!"};
+    }
+
+  fs::extfs disk;
+  std::unique_ptr<fs::detail::block_device> device;
+  std::unique_ptr<fs::detail::extent_status> status;
+  };
+
+void new_extent_status_has_no_loaded_nodes()
+  {
+  auto const test = fixture{};
+  ASSERT_EQUAL(0u, test.status->loaded_blocks_count());
+  }
+
+void resolving_a_single_block_loads_a_single_path()
+  {
+  auto const test = fixture{};
+  auto const runs = test.status->resolve(0, 1);
+  ASSERT(runs);
+  ASSERT_EQUAL(1u, runs->size());
+  ASSERT_EQUAL(2u, test.status->loaded_blocks_count());
+  }
+
+void resolving_a_cached_range_loads_no_nodes()
+  {
+  auto const test = fixture{};
+  test.status->resolve(0, 64);
+  auto const loaded = test.status->loaded_blocks_count();
+  test.status->resolve(0, 64);
+  test.status->resolve(17, 5);
+  ASSERT_EQUAL(loaded, test.status->loaded_blocks_count());
+  }
+
+void sparse_file_alternates_between_data_and_holes()
+  {
+  auto const test = fixture{};
+  auto const runs = test.status->resolve(0, 1198);
+  ASSERT(runs);
+  ASSERT_EQUAL(799u, runs->size());
+  for(auto index = 0u; index < runs->size(); ++index)
+    {
+    auto const & run = (*runs)[index];
+    ASSERT_EQUAL(index % 2 ? 2u : 1u, run.blocks_count);
+    ASSERT_EQUAL(index % 2 == 1, run.sparse());
+    }
+  }
+
+void runs_beyond_the_end_of_the_file_are_holes()
+  {
+  auto const test = fixture{};
+  auto const runs = test.status->resolve(1198, 100);
+  ASSERT(runs);
+  ASSERT_EQUAL(1u, runs->size());
+  ASSERT(runs->front().sparse());
+  ASSERT_EQUAL(100u, runs->front().blocks_count);
+  }
+
+void resolved_blocks_contain_file_content()
+  {
+  auto const test = fixture{};
+  auto expected = std::ifstream{kSparseFile, std::ios::binary};
+  auto const content = std::vector<char>{std::istreambuf_iterator<char>{expected}, std::istreambuf_iterator<char>{}};
+  ASSERT_EQUAL(kSparseFileSize, content.size());
+
+  auto const runs = test.status->resolve(0, 1198);
+  ASSERT(runs);
+  for(auto const & run : *runs)
+    {
+    if(run.sparse())
+      {
+      continue;
+      }
+
+    auto block = std::vector<char>(kBlockSize * run.blocks_count);
+    ASSERT(test.device->read(run.physical_block_id * kBlockSize, block.data(), block.size()));
+    ASSERT(std::equal(block.begin(), block.end(), content.begin() + run.logical_block_id * kBlockSize));
+    }
+  }
+
+int main(int argc, char * argv[])
+  {
+  auto tests = cute::suite{
+    CUTE(new_extent_status_has_no_loaded_nodes),
+    CUTE(resolving_a_single_block_loads_a_single_path),
+    CUTE(resolving_a_cached_range_loads_no_nodes),
+    CUTE(sparse_file_alternates_between_data_and_holes),
+    CUTE(runs_beyond_the_end_of_the_file_are_holes),
+    CUTE(resolved_blocks_contain_file_content),
+  };
+
+  cute::xml_file_opener resultFile{argc, argv};
+  cute::xml_listener<cute::ostream_listener<>> listener{resultFile.out};
+  return !cute::makeRunner(listener, argc, argv)(tests, "fs::detail::extent_tree");
+  }
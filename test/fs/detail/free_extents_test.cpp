@@ -0,0 +1,206 @@
+#include "fs/detail/free_extents.hpp"
+
+#include <cute/cute.h>
+#include <cute/cute_runner.h>
+#include <cute/ostream_listener.h>
+#include <cute/xml_listener.h>
+
+#include <random>
+#include <vector>
+
+auto bitmap_of(std::vector<bool> const & used)
+  {
+  auto bitmap = std::vector<fs::detail::u08>((used.size() + 7) / 8 + 8, 0xff);
+  for(auto bit = std::size_t{}; bit < used.size(); ++bit)
+    {
+    if(!used[bit])
+      {
+      bitmap[bit / 8] &= static_cast<fs::detail::u08>(~(1u << (bit % 8)));
+      }
+    }
+  return bitmap;
+  }
+
+auto reference_runs(std::vector<bool> const & used)
+  {
+  auto runs = fs::detail::bitmap_runs{};
+  auto current = fs::detail::u64{};
+  auto atStart = true;
+  for(auto const bit : used)
+    {
+    if(!bit)
+      {
+      ++current;
+      continue;
+      }
+
+    if(atStart)
+      {
+      runs.head = current;
+      atStart = false;
+      }
+    else
+      {
+      runs.interior.add(current);
+      }
+    current = 0;
+    }
+
+  runs.completely_free = atStart && !used.empty();
+  runs.tail = current;
+  if(atStart)
+    {
+    runs.head = current;
+    }
+  return runs;
+  }
+
+void assert_equal_runs(fs::detail::bitmap_runs const & expected, fs::detail::bitmap_runs const & actual)
+  {
+  ASSERT_EQUAL(expected.head, actual.head);
+  ASSERT_EQUAL(expected.tail, actual.tail);
+  ASSERT_EQUAL(expected.completely_free, actual.completely_free);
+  ASSERT(expected.interior.extents_count == actual.interior.extents_count);
+  ASSERT(expected.interior.blocks_count == actual.interior.blocks_count);
+  ASSERT_EQUAL(expected.interior.largest_extent, actual.interior.largest_extent);
+  ASSERT_EQUAL(expected.interior.smallest_extent, actual.interior.smallest_extent);
+  }
+
+void histogram_sorts_extents_by_power_of_two()
+  {
+  ASSERT_EQUAL(0u, fs::detail::free_extent_histogram::bucket(1));
+  ASSERT_EQUAL(1u, fs::detail::free_extent_histogram::bucket(2));
+  ASSERT_EQUAL(1u, fs::detail::free_extent_histogram::bucket(3));
+  ASSERT_EQUAL(10u, fs::detail::free_extent_histogram::bucket(1024));
+  ASSERT_EQUAL(63u, fs::detail::free_extent_histogram::bucket(~fs::detail::u64{}));
+  }
+
+void histogram_ignores_empty_extents()
+  {
+  auto histogram = fs::detail::free_extent_histogram{};
+  histogram.add(0);
+  ASSERT_EQUAL(0u, histogram.free_extents_count);
+  ASSERT_EQUAL(0u, histogram.smallest_extent);
+  }
+
+void merged_histograms_combine_their_extents()
+  {
+  auto first = fs::detail::free_extent_histogram{};
+  first.add(5);
+  first.add(100);
+  auto second = fs::detail::free_extent_histogram{};
+  second.add(2);
+  first.merge(second);
+
+  ASSERT_EQUAL(3u, first.free_extents_count);
+  ASSERT_EQUAL(107u, first.free_blocks_count);
+  ASSERT_EQUAL(2u, first.smallest_extent);
+  ASSERT_EQUAL(100u, first.largest_extent);
+  ASSERT_EQUAL(1u, first.extents_count[1]);
+  ASSERT_EQUAL(1u, first.extents_count[2]);
+  ASSERT_EQUAL(1u, first.extents_count[6]);
+  }
+
+void completely_free_bitmap_is_a_single_run()
+  {
+  auto const used = std::vector<bool>(1000, false);
+  auto const runs = fs::detail::find_free_runs(bitmap_of(used).data(), used.size());
+  ASSERT(runs.completely_free);
+  ASSERT_EQUAL(1000u, runs.head);
+  ASSERT_EQUAL(1000u, runs.tail);
+  ASSERT_EQUAL(0u, runs.interior.free_extents_count);
+  }
+
+void completely_used_bitmap_has_no_runs()
+  {
+  auto const used = std::vector<bool>(1000, true);
+  auto const runs = fs::detail::find_free_runs(bitmap_of(used).data(), used.size());
+  ASSERT(!runs.completely_free);
+  ASSERT_EQUAL(0u, runs.head);
+  ASSERT_EQUAL(0u, runs.tail);
+  ASSERT_EQUAL(0u, runs.interior.free_extents_count);
+  }
+
+void runs_crossing_word_boundaries_are_joined()
+  {
+  auto used = std::vector<bool>(256, true);
+  for(auto bit = 60u; bit < 200u; ++bit)
+    {
+    used[bit] = false;
+    }
+
+  auto const runs = fs::detail::find_free_runs(bitmap_of(used).data(), used.size());
+  ASSERT_EQUAL(1u, runs.interior.free_extents_count);
+  ASSERT_EQUAL(140u, runs.interior.largest_extent);
+  }
+
+void bits_beyond_the_bitmap_are_ignored()
+  {
+  auto used = std::vector<bool>(100, false);
+  used[10] = true;
+  auto const runs = fs::detail::find_free_runs(bitmap_of(used).data(), used.size());
+  ASSERT_EQUAL(10u, runs.head);
+  ASSERT_EQUAL(89u, runs.tail);
+  }
+
+void visited_runs_are_reported_in_ascending_order()
+  {
+  auto used = std::vector<bool>(200, true);
+  for(auto bit = 0u; bit < 3u; ++bit)
+    {
+    used[bit] = false;
+    }
+  for(auto bit = 60u; bit < 130u; ++bit)
+    {
+    used[bit] = false;
+    }
+  used[199] = false;
+
+  auto firsts = std::vector<std::size_t>{};
+  auto lengths = std::vector<fs::detail::u64>{};
+  fs::detail::visit_free_runs(bitmap_of(used).data(), used.size(), [&](auto const first, auto const length){
+    firsts.push_back(first);
+    lengths.push_back(length);
+  });
+
+  ASSERT_EQUAL((std::vector<std::size_t>{0, 60, 199}), firsts);
+  ASSERT_EQUAL((std::vector<fs::detail::u64>{3, 70, 1}), lengths);
+  }
+
+void runs_of_random_bitmaps_match_reference()
+  {
+  auto engine = std::mt19937{42};
+  for(auto const density : {0.01, 0.3, 0.5, 0.9, 0.999})
+    {
+    auto distribution = std::bernoulli_distribution{density};
+    for(auto const bits : {1u, 63u, 64u, 65u, 1000u, 8192u})
+      {
+      auto used = std::vector<bool>(bits);
+      for(auto bit = 0u; bit < bits; ++bit)
+        {
+        used[bit] = distribution(engine);
+        }
+
+      assert_equal_runs(reference_runs(used), fs::detail::find_free_runs(bitmap_of(used).data(), used.size()));
+      }
+    }
+  }
+
+int main(int argc, char * argv[])
+  {
+  auto tests = cute::suite{
+    CUTE(histogram_sorts_extents_by_power_of_two),
+    CUTE(histogram_ignores_empty_extents),
+    CUTE(merged_histograms_combine_their_extents),
+    CUTE(completely_free_bitmap_is_a_single_run),
+    CUTE(completely_used_bitmap_has_no_runs),
+    CUTE(runs_crossing_word_boundaries_are_joined),
+    CUTE(bits_beyond_the_bitmap_are_ignored),
+    CUTE(visited_runs_are_reported_in_ascending_order),
+    CUTE(runs_of_random_bitmaps_match_reference),
+  };
+
+  cute::xml_file_opener resultFile{argc, argv};
+  cute::xml_listener<cute::ostream_listener<>> listener{resultFile.out};
+  return !cute::makeRunner(listener, argc, argv)(tests, "fs::detail::free_extents");
+  }
@@ -0,0 +1,301 @@
+#include "fs/detail/geometry.hpp"
+#include "fs/detail/superblock.hpp"
+
+#include "test/superblock/ext2-noopts.hpp"
+
+#include <cute/cute.h>
+#include <cute/cute_runner.h>
+#include <cute/ostream_listener.h>
+#include <cute/xml_listener.h>
+
+#include <cstring>
+
+using cft = fs::detail::superblock::compatible_feature;
+using ift = fs::detail::superblock::incompatible_feature;
+using rft = fs::detail::superblock::read_only_compatible_feature;
+
+auto superblock_from_bytes(std::array<std::uint8_t, 1024> const & data)
+  {
+  auto block = fs::detail::superblock{};
+  std::memcpy(reinterpret_cast<char *>(&block), data.data(), data.size());
+  return block;
+  }
+
+auto large_superblock()
+  {
+  auto block = fs::detail::superblock{};
+  block.blocks_count = 1u << 20;
+  block.first_data_block_id = 0;
+  block.logical_block_size = 2;
+  block.blocks_per_group = 1u << 15;
+  block.inodes_per_group = 8192;
+  return block;
+  }
+
+void noopts_geometry_has_1024_byte_blocks()
+  {
+  auto const layout = fs::detail::geometry{superblock_from_bytes(ext2_noopts)};
+  ASSERT_EQUAL(1024u, layout.block_size());
+  }
+
+void noopts_geometry_has_single_group()
+  {
+  auto const layout = fs::detail::geometry{superblock_from_bytes(ext2_noopts)};
+  ASSERT_EQUAL(1u, layout.groups_count());
+  ASSERT_EQUAL(1u, layout.descriptor_blocks_count());
+  }
+
+void noopts_geometry_places_descriptors_after_superblock()
+  {
+  auto const layout = fs::detail::geometry{superblock_from_bytes(ext2_noopts)};
+  ASSERT_EQUAL(2u, layout.descriptor_block_id(0));
+  }
+
+void geometry_without_sparse_superblock_has_superblock_in_every_group()
+  {
+  auto const layout = fs::detail::geometry{large_superblock()};
+  for(auto group = 0u; group < layout.groups_count(); ++group)
+    {
+    ASSERT(layout.has_superblock(group));
+    }
+  }
+
+void geometry_with_sparse_superblock_has_superblock_in_powers_of_3_5_and_7()
+  {
+  auto block = large_superblock();
+  block.read_only_compatible_features_bitmap |= static_cast<fs::detail::superblock::rft>(rft::sparse_superblock);
+  auto const layout = fs::detail::geometry{block};
+
+  auto backups = std::vector<fs::detail::u32>{};
+  for(auto group = 0u; group < layout.groups_count(); ++group)
+    {
+    if(layout.has_superblock(group))
+      {
+      backups.push_back(group);
+      }
+    }
+
+  ASSERT_EQUAL((std::vector<fs::detail::u32>{0, 1, 3, 5, 7, 9, 25, 27}), backups);
+  }
+
+void geometry_with_sparse_superblock_v2_has_superblock_in_backup_groups()
+  {
+  auto block = large_superblock();
+  block.compatible_features_bitmap |= static_cast<fs::detail::superblock::cft>(cft::sparse_superblock_v2);
+  block.backup_group_ids = {{1, 31}};
+  auto const layout = fs::detail::geometry{block};
+
+  ASSERT(layout.has_superblock(0));
+  ASSERT(layout.has_superblock(1));
+  ASSERT(!layout.has_superblock(3));
+  ASSERT(layout.has_superblock(31));
+  }
+
+void geometry_of_64bit_file_system_uses_descriptor_size_from_superblock()
+  {
+  auto block = large_superblock();
+  block.incompatible_features_bitmap |= static_cast<fs::detail::superblock::ift>(ift::large_file_system);
+  block.group_descriptor_size = 64;
+  block.blocks_count_hi = 1;
+  auto const layout = fs::detail::geometry{block};
+
+  ASSERT_EQUAL(64u, layout.descriptor_size());
+  ASSERT_EQUAL(64u, layout.descriptors_per_block());
+  ASSERT_EQUAL((1ull << 32) + (1ull << 20), layout.blocks_count());
+  }
+
+void geometry_with_meta_block_groups_scatters_descriptor_blocks()
+  {
+  auto block = large_superblock();
+  block.incompatible_features_bitmap |= static_cast<fs::detail::superblock::ift>(ift::meta_block_group);
+  block.read_only_compatible_features_bitmap |= static_cast<fs::detail::superblock::rft>(rft::sparse_superblock);
+  block.first_meta_block_group_id = 0;
+  block.blocks_count = 1u << 28;
+  auto const layout = fs::detail::geometry{block};
+
+  ASSERT_EQUAL(1u, layout.descriptor_block_id(0));
+  ASSERT_EQUAL(128u * (1u << 15) + 0, layout.descriptor_block_id(1));
+  ASSERT_EQUAL(384u * (1u << 15) + 0, layout.descriptor_block_id(3));
+  }
+
+void geometry_counts_superblock_and_descriptor_copies_as_overhead()
+  {
+  auto block = large_superblock();
+  block.reserved_descriptor_blocks_count = 15;
+  auto const layout = fs::detail::geometry{block};
+
+  ASSERT_EQUAL(17u, layout.group_overhead_blocks_count(0));
+  ASSERT_EQUAL(17u, layout.group_overhead_blocks_count(2));
+  }
+
+void geometry_with_sparse_superblock_has_no_overhead_outside_backup_groups()
+  {
+  auto block = large_superblock();
+  block.read_only_compatible_features_bitmap |= static_cast<fs::detail::superblock::rft>(rft::sparse_superblock);
+  block.reserved_descriptor_blocks_count = 15;
+  auto const layout = fs::detail::geometry{block};
+
+  ASSERT_EQUAL(17u, layout.group_overhead_blocks_count(3));
+  ASSERT_EQUAL(0u, layout.group_overhead_blocks_count(2));
+  }
+
+void geometry_with_meta_block_groups_counts_scattered_descriptor_blocks_as_overhead()
+  {
+  auto block = large_superblock();
+  block.incompatible_features_bitmap |= static_cast<fs::detail::superblock::ift>(ift::meta_block_group);
+  block.read_only_compatible_features_bitmap |= static_cast<fs::detail::superblock::rft>(rft::sparse_superblock);
+  block.first_meta_block_group_id = 0;
+  block.blocks_count = 1u << 28;
+  auto const layout = fs::detail::geometry{block};
+
+  ASSERT_EQUAL(2u, layout.group_overhead_blocks_count(0));
+  ASSERT_EQUAL(0u, layout.group_overhead_blocks_count(2));
+  ASSERT_EQUAL(1u, layout.group_overhead_blocks_count(127));
+  ASSERT_EQUAL(1u, layout.group_overhead_blocks_count(128));
+  }
+
+void geometry_computes_the_size_of_inode_tables()
+  {
+  auto block = large_superblock();
+  block.revision_level = static_cast<fs::detail::superblock::rlv>(fs::detail::superblock::revision_level::dynamic);
+  block.inode_size = 256;
+  auto const layout = fs::detail::geometry{block};
+
+  ASSERT_EQUAL(512u, layout.inode_table_blocks_count());
+  }
+
+void geometry_maps_inodes_to_groups()
+  {
+  auto const layout = fs::detail::geometry{large_superblock()};
+  ASSERT_EQUAL(0u, layout.inode_group(1));
+  ASSERT_EQUAL(0u, layout.inode_index(1));
+  ASSERT_EQUAL(0u, layout.inode_group(8192));
+  ASSERT_EQUAL(8191u, layout.inode_index(8192));
+  ASSERT_EQUAL(1u, layout.inode_group(8193));
+  ASSERT_EQUAL(0u, layout.inode_index(8193));
+  }
+
+void geometry_with_flexible_block_groups_knows_their_size()
+  {
+  auto block = large_superblock();
+  ASSERT_EQUAL(1u, fs::detail::geometry{block}.flexible_group_size());
+
+  block.logical_flexible_group_size = 4;
+  ASSERT_EQUAL(1u, fs::detail::geometry{block}.flexible_group_size());
+
+  block.incompatible_features_bitmap |= static_cast<fs::detail::superblock::ift>(ift::flexible_block_groups);
+  ASSERT_EQUAL(16u, fs::detail::geometry{block}.flexible_group_size());
+  }
+
+void geometry_of_plausible_superblocks_is_valid()
+  {
+  ASSERT(fs::detail::valid_geometry(superblock_from_bytes(ext2_noopts)));
+  ASSERT(fs::detail::valid_geometry(large_superblock()));
+
+  auto block = large_superblock();
+  block.logical_block_size = 6;
+  ASSERT(fs::detail::valid_geometry(block));
+  }
+
+void geometry_of_implausible_superblocks_is_invalid()
+  {
+  auto block = large_superblock();
+  block.logical_block_size = 30;
+  ASSERT(!fs::detail::valid_geometry(block));
+
+  block = large_superblock();
+  block.inodes_per_group = 0;
+  ASSERT(!fs::detail::valid_geometry(block));
+
+  block = large_superblock();
+  block.blocks_per_group = 0;
+  ASSERT(!fs::detail::valid_geometry(block));
+
+  block = large_superblock();
+  block.incompatible_features_bitmap |= static_cast<fs::detail::superblock::ift>(ift::large_file_system);
+  block.group_descriptor_size = 48;
+  ASSERT(!fs::detail::valid_geometry(block));
+  block.group_descriptor_size = 8192;
+  ASSERT(!fs::detail::valid_geometry(block));
+  block.group_descriptor_size = 4096;
+  ASSERT(fs::detail::valid_geometry(block));
+  }
+
+void superblock_groups_match_groups_with_superblocks()
+  {
+  auto block = large_superblock();
+  for(auto const sparse : {false, true})
+    {
+    if(sparse)
+      {
+      block.read_only_compatible_features_bitmap |= static_cast<fs::detail::superblock::rft>(rft::sparse_superblock);
+      }
+    auto const layout = fs::detail::geometry{block};
+
+    auto expected = std::vector<fs::detail::u32>{};
+    for(auto group = 0u; group < layout.groups_count(); ++group)
+      {
+      if(layout.has_superblock(group))
+        {
+        expected.push_back(group);
+        }
+      }
+
+    ASSERT_EQUAL(expected, layout.superblock_groups());
+    }
+  }
+
+void superblock_groups_of_sparse_superblock_v2_are_the_backup_groups()
+  {
+  auto block = large_superblock();
+  block.compatible_features_bitmap |= static_cast<fs::detail::superblock::cft>(cft::sparse_superblock_v2);
+  block.backup_group_ids = {{31, 0}};
+  auto const layout = fs::detail::geometry{block};
+  ASSERT_EQUAL((std::vector<fs::detail::u32>{0, 31}), layout.superblock_groups());
+  }
+
+void superblock_copies_start_their_group()
+  {
+  auto const layout = fs::detail::geometry{large_superblock()};
+  ASSERT_EQUAL(1024u, layout.superblock_offset(0));
+  ASSERT_EQUAL(3ull * (1u << 15) * 4096, layout.superblock_offset(3));
+  }
+
+void geometry_of_backup_superblock_locates_backup_descriptors()
+  {
+  auto block = large_superblock();
+  block.superblock_group_id = 3;
+  auto const layout = fs::detail::geometry{block};
+  ASSERT_EQUAL(3u, layout.superblock_group());
+  ASSERT_EQUAL(3ull * (1u << 15) + 1, layout.descriptor_block_id(0));
+  }
+
+int main(int argc, char * argv[])
+  {
+  auto tests = cute::suite{
+    CUTE(noopts_geometry_has_1024_byte_blocks),
+    CUTE(noopts_geometry_has_single_group),
+    CUTE(noopts_geometry_places_descriptors_after_superblock),
+    CUTE(geometry_without_sparse_superblock_has_superblock_in_every_group),
+    CUTE(geometry_with_sparse_superblock_has_superblock_in_powers_of_3_5_and_7),
+    CUTE(geometry_with_sparse_superblock_v2_has_superblock_in_backup_groups),
+    CUTE(geometry_of_64bit_file_system_uses_descriptor_size_from_superblock),
+    CUTE(geometry_with_meta_block_groups_scatters_descriptor_blocks),
+    CUTE(geometry_counts_superblock_and_descriptor_copies_as_overhead),
+    CUTE(geometry_with_sparse_superblock_has_no_overhead_outside_backup_groups),
+    CUTE(geometry_with_meta_block_groups_counts_scattered_descriptor_blocks_as_overhead),
+    CUTE(geometry_computes_the_size_of_inode_tables),
+    CUTE(geometry_maps_inodes_to_groups),
+    CUTE(geometry_with_flexible_block_groups_knows_their_size),
+    CUTE(geometry_of_plausible_superblocks_is_valid),
+    CUTE(geometry_of_implausible_superblocks_is_invalid),
+    CUTE(superblock_groups_match_groups_with_superblocks),
+    CUTE(superblock_groups_of_sparse_superblock_v2_are_the_backup_groups),
+    CUTE(superblock_copies_start_their_group),
+    CUTE(geometry_of_backup_superblock_locates_backup_descriptors),
+  };
+
+  cute::xml_file_opener resultFile{argc, argv};
+  cute::xml_listener<cute::ostream_listener<>> listener{resultFile.out};
+  return !cute::makeRunner(listener, argc, argv)(tests, "fs::detail::geometry");
+  }
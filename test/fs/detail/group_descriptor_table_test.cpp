@@ -0,0 +1,116 @@
+#include "fs/detail/group_descriptor_table.hpp"
+#include "test/disk_fixture.hpp"
+
+#include <cute/cute.h>
+#include <cute/cute_runner.h>
+#include <cute/ostream_listener.h>
+#include <cute/xml_listener.h>
+
+auto constexpr kGroupsDiskImage = "../test/extfs_data/groups.img";
+auto constexpr kMetaGroupsDiskImage = "../test/extfs_data/metagroups.img";
+
+using fixture = disk_fixture;
+
+void new_table_has_no_loaded_blocks()
+  {
+  auto const disk = fixture{kGroupsDiskImage};
+  ASSERT_EQUAL(0u, disk.table->loaded_blocks_count());
+  }
+
+void accessing_a_group_loads_a_single_descriptor_block()
+  {
+  auto const disk = fixture{kGroupsDiskImage};
+  ASSERT((*disk.table)[disk.layout.groups_count() - 1]);
+  ASSERT_EQUAL(1u, disk.table->loaded_blocks_count());
+  ASSERT((*disk.table)[disk.layout.groups_count() - 2]);
+  ASSERT_EQUAL(1u, disk.table->loaded_blocks_count());
+  }
+
+void accessing_an_inexistent_group_returns_nothing()
+  {
+  auto const disk = fixture{kGroupsDiskImage};
+  ASSERT(!(*disk.table)[disk.layout.groups_count()]);
+  }
+
+void group_metadata_lies_within_group()
+  {
+  auto const disk = fixture{kGroupsDiskImage};
+  for(auto id = 0u; id < disk.layout.groups_count(); ++id)
+    {
+    auto const group = (*disk.table)[id];
+    auto const first = disk.layout.group_first_block_id(id);
+    auto const last = first + disk.layout.group_blocks_count(id);
+    ASSERT(group);
+    ASSERT_EQUAL(id, group->id);
+    ASSERT(group->block_bitmap_block_id >= first && group->block_bitmap_block_id < last);
+    ASSERT(group->inode_bitmap_block_id >= first && group->inode_bitmap_block_id < last);
+    ASSERT(group->inode_table_block_id >= first && group->inode_table_block_id < last);
+    }
+  }
+
+void free_counts_of_all_groups_sum_up_to_superblock_counts()
+  {
+  for(auto && path : {kGroupsDiskImage, kMetaGroupsDiskImage})
+    {
+    auto const disk = fixture{path};
+    auto freeBlocks = fs::detail::u64{};
+    auto freeInodes = fs::detail::u64{};
+    for(auto id = 0u; id < disk.layout.groups_count(); ++id)
+      {
+      auto const group = (*disk.table)[id];
+      ASSERT(group);
+      freeBlocks += group->free_blocks_count;
+      freeInodes += group->free_inodes_count;
+      }
+
+    ASSERT_EQUAL(disk.superblock->free_blocks_count, freeBlocks);
+    ASSERT_EQUAL(disk.superblock->free_inodes_count, freeInodes);
+    ASSERT_EQUAL(disk.layout.descriptor_blocks_count(), disk.table->loaded_blocks_count());
+    }
+  }
+
+void meta_block_group_table_uses_64_byte_descriptors()
+  {
+  auto const disk = fixture{kMetaGroupsDiskImage};
+  ASSERT_EQUAL(64u, disk.layout.descriptor_size());
+  ASSERT_EQUAL(disk.layout.group_first_block_id(16), disk.layout.descriptor_block_id(1));
+  }
+
+void verified_table_accepts_all_valid_descriptors()
+  {
+  auto const disk = fixture{kMetaGroupsDiskImage, true};
+  for(auto id = 0u; id < disk.layout.groups_count(); ++id)
+    {
+    ASSERT((*disk.table)[id]);
+    }
+  ASSERT_EQUAL(0u, disk.checksums->failures_count());
+  }
+
+void verified_table_rejects_descriptors_with_a_different_seed()
+  {
+  auto superblock = *fixture{kMetaGroupsDiskImage}.superblock;
+  superblock.uuid[0] ^= 1;
+  auto const checksums = fs::detail::metadata_checksums{superblock};
+  auto const disk = fixture{kMetaGroupsDiskImage};
+  auto const table = fs::detail::group_descriptor_table{*disk.device, disk.layout, &checksums};
+  ASSERT(!table[0]);
+  ASSERT(checksums.failures_count() > 0);
+  }
+
+int main(int argc, char * argv[])
+  {
+  auto tests = cute::suite{
+    CUTE(new_table_has_no_loaded_blocks),
+    CUTE(accessing_a_group_loads_a_single_descriptor_block),
+    CUTE(accessing_an_inexistent_group_returns_nothing),
+    CUTE(group_metadata_lies_within_group),
+    CUTE(free_counts_of_all_groups_sum_up_to_superblock_counts),
+    CUTE(meta_block_group_table_uses_64_byte_descriptors),
+    CUTE(verified_table_accepts_all_valid_descriptors),
+    CUTE(verified_table_rejects_descriptors_with_a_different_seed),
+  };
+
+  cute::xml_file_opener resultFile{argc, argv};
+  cute::xml_listener<cute::ostream_listener<>> listener{resultFile.out};
+  return !cute::makeRunner(listener, argc, argv)(tests, "fs::detail::group_descriptor_table");
+  }
@@ -0,0 +1,149 @@
+#include "fs/detail/buffer_cache.hpp"
+#include "fs/detail/group_prefetch.hpp"
+#include "test/disk_fixture.hpp"
+
+#include <cute/cute.h>
+#include <cute/cute_runner.h>
+#include <cute/ostream_listener.h>
+#include <cute/xml_listener.h>
+
+#include <limits>
+#include <memory>
+#include <vector>
+
+auto constexpr kGroupsDiskImage = "../test/extfs_data/groups.img";
+auto constexpr kExtentsDiskImage = "../test/extfs_data/extents.img";
+
+struct fixture : disk_fixture
+  {
+  using disk_fixture::disk_fixture;
+
+  std::vector<fs::detail::block_extent> extents(fs::detail::u32 const firstGroup, fs::detail::u32 const endGroup,
+                                                fs::detail::u32 const gap = fs::detail::kMaximumMetadataGapBlocks) const
+    {
+    return fs::detail::group_metadata_extents(layout, *table, firstGroup, endGroup, gap);
+    }
+  };
+
+bool covered(std::vector<fs::detail::block_extent> const & extents, fs::detail::u64 const blockId)
+  {
+  for(auto const & extent : extents)
+    {
+    if(blockId >= extent.first_block_id && blockId < extent.end_block_id())
+      {
+      return true;
+      }
+    }
+  return false;
+  }
+
+void metadata_of_flexible_group_is_joined()
+  {
+  auto const disk = fixture{kExtentsDiskImage};
+  ASSERT_EQUAL(16u, disk.layout.flexible_group_size());
+
+  auto const extents = disk.extents(0, disk.layout.groups_count());
+  ASSERT_EQUAL(1u, extents.size());
+
+  auto const group = (*disk.table)[0];
+  ASSERT(group);
+  ASSERT(covered(extents, group->block_bitmap_block_id));
+  ASSERT(covered(extents, group->inode_bitmap_block_id));
+  ASSERT(covered(extents, group->inode_table_block_id));
+  }
+
+void uninitialized_metadata_is_left_out()
+  {
+  auto const disk = fixture{kExtentsDiskImage};
+  auto const group = (*disk.table)[1];
+  ASSERT(group);
+  ASSERT(group->has(fs::detail::group_descriptor::flag::block_bitmap_uninitialized));
+  ASSERT(group->has(fs::detail::group_descriptor::flag::inodes_uninitialized));
+  ASSERT(disk.extents(1, 2).empty());
+
+  auto const used = disk.extents(0, 1);
+  ASSERT(!covered(used, (*disk.table)[0]->inode_table_block_id + disk.layout.inode_table_blocks_count() - 1));
+  }
+
+void metadata_without_flexible_groups_is_read_per_group()
+  {
+  auto const disk = fixture{kGroupsDiskImage};
+  ASSERT_EQUAL(1u, disk.layout.flexible_group_size());
+
+  auto const extents = disk.extents(0, 4);
+  ASSERT_EQUAL(4u, extents.size());
+  for(auto id = 0u; id < 4; ++id)
+    {
+    auto const group = (*disk.table)[id];
+    ASSERT(group);
+    ASSERT_EQUAL(group->block_bitmap_block_id, extents[id].first_block_id);
+    ASSERT_EQUAL(group->inode_table_block_id + disk.layout.inode_table_blocks_count(), extents[id].end_block_id());
+    }
+  }
+
+void gaps_are_bridged_up_to_the_limit()
+  {
+  auto const disk = fixture{kGroupsDiskImage};
+  ASSERT_EQUAL(1u, disk.extents(0, 4, std::numeric_limits<fs::detail::u32>::max()).size());
+  ASSERT_EQUAL(disk.layout.groups_count(), disk.extents(0, disk.layout.groups_count() + 1, 0).size());
+  }
+
+void touching_a_group_prefetches_its_flexible_group_once()
+  {
+  auto const disk = fixture{kExtentsDiskImage};
+  auto const prefetcher = fs::detail::group_prefetcher{*disk.device, nullptr, disk.layout, *disk.table};
+  prefetcher.touch(2);
+  prefetcher.touch(0);
+
+  auto const statistics = prefetcher.statistics();
+  ASSERT_EQUAL(fs::detail::u64{disk.layout.groups_count()}, statistics.prefetched_groups_count);
+  ASSERT_EQUAL(1u, statistics.reads_count);
+  ASSERT_EQUAL(disk.extents(0, disk.layout.groups_count()).front().blocks_count, statistics.blocks_count);
+  }
+
+void touching_a_group_without_flexible_groups_does_nothing()
+  {
+  auto const disk = fixture{kGroupsDiskImage};
+  auto const prefetcher = fs::detail::group_prefetcher{*disk.device, nullptr, disk.layout, *disk.table};
+  prefetcher.touch(3);
+  ASSERT_EQUAL(0u, prefetcher.statistics().reads_count);
+
+  prefetcher.prefetch(0, 4);
+  ASSERT_EQUAL(4u, prefetcher.statistics().prefetched_groups_count);
+  ASSERT_EQUAL(4u, prefetcher.statistics().reads_count);
+  }
+
+void prefetched_metadata_is_served_from_the_buffer_cache()
+  {
+  auto const disk = fixture{kExtentsDiskImage};
+  auto const blockSize = disk.layout.block_size();
+  auto const cache = fs::detail::buffer_cache{fs::detail::open_block_device(kExtentsDiskImage, false, false), blockSize,
+                                              std::size_t{1} << 20};
+  auto const prefetcher = fs::detail::group_prefetcher{cache, &cache, disk.layout, *disk.table};
+  prefetcher.touch(0);
+
+  auto const group = (*disk.table)[0];
+  ASSERT(group);
+  ASSERT(cache.block(group->block_bitmap_block_id));
+  ASSERT(cache.block(group->inode_bitmap_block_id));
+  ASSERT(cache.block(group->inode_table_block_id));
+  ASSERT_EQUAL(0u, cache.statistics().misses);
+  ASSERT_EQUAL(3u, cache.statistics().hits);
+  }
+
+int main(int argc, char * argv[])
+  {
+  auto tests = cute::suite{
+    CUTE(metadata_of_flexible_group_is_joined),
+    CUTE(uninitialized_metadata_is_left_out),
+    CUTE(metadata_without_flexible_groups_is_read_per_group),
+    CUTE(gaps_are_bridged_up_to_the_limit),
+    CUTE(touching_a_group_prefetches_its_flexible_group_once),
+    CUTE(touching_a_group_without_flexible_groups_does_nothing),
+    CUTE(prefetched_metadata_is_served_from_the_buffer_cache),
+  };
+
+  cute::xml_file_opener resultFile{argc, argv};
+  cute::xml_listener<cute::ostream_listener<>> listener{resultFile.out};
+  return !cute::makeRunner(listener, argc, argv)(tests, "fs::detail::group_prefetch");
+  }
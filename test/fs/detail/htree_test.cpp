@@ -0,0 +1,213 @@
+#include "fs/detail/directory.hpp"
+#include "fs/detail/htree.hpp"
+#include "fs/detail/name_hash.hpp"
+
+#include <cute/cute.h>
+#include <cute/cute_runner.h>
+#include <cute/ostream_listener.h>
+#include <cute/xml_listener.h>
+
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+auto constexpr kBlockSize = 1024u;
+auto constexpr kSeed = fs::detail::u32_arr<4>{{1, 2, 3, 4}};
+
+struct directory
+  {
+  explicit directory(std::size_t const blocksCount) : blocks(blocksCount, std::vector<fs::detail::u08>(kBlockSize)) { }
+
+  template<typename Type>
+  void put(std::size_t const block, std::size_t const offset, Type const & value)
+    {
+    std::memcpy(blocks[block].data() + offset, &value, sizeof(value));
+    }
+
+  void entries(std::size_t const block, std::size_t const offset, std::initializer_list<fs::detail::dx_entry> list)
+    {
+    put(block, offset, fs::detail::dx_count_limit{static_cast<fs::detail::u16>((kBlockSize - offset) / 8),
+                                                  static_cast<fs::detail::u16>(list.size())});
+    auto index = 0u;
+    for(auto const & entry : list)
+      {
+      if(index)
+        {
+        put(block, offset + index * sizeof(entry), entry);
+        }
+      else
+        {
+        put(block, offset + sizeof(fs::detail::dx_count_limit), entry.block);
+        }
+      ++index;
+      }
+    }
+
+  void root(fs::detail::u08 const indirectLevels, std::initializer_list<fs::detail::dx_entry> list)
+    {
+    put(0, 0, fs::detail::directory_entry{2, 12, 1, 2});
+    put(0, 8, '.');
+    put(0, 12, fs::detail::directory_entry{1, kBlockSize - 12, 2, 2});
+    put(0, 20, '.');
+    put(0, 21, '.');
+    put(0, 24, fs::detail::dx_root_info{0, 1, 8, indirectLevels, 0});
+    entries(0, 32, list);
+    }
+
+  void node(std::size_t const block, std::initializer_list<fs::detail::dx_entry> list)
+    {
+    put(block, 0, fs::detail::directory_entry{0, kBlockSize, 0, 0});
+    entries(block, 8, list);
+    }
+
+  void leaf(std::size_t const block, std::initializer_list<std::pair<std::string, fs::detail::u32>> list)
+    {
+    auto offset = std::size_t{};
+    auto remaining = list.size();
+    for(auto const & [name, id] : list)
+      {
+      auto const length = static_cast<fs::detail::u16>(--remaining ? (8 + name.size() + 3) / 4 * 4 : kBlockSize - offset);
+      put(block, offset, fs::detail::directory_entry{id, length, static_cast<fs::detail::u08>(name.size()), 1});
+      std::memcpy(blocks[block].data() + offset + 8, name.data(), name.size());
+      offset += length;
+      }
+    }
+
+  fs::detail::htree tree(bool const largeDirectories)
+    {
+    return fs::detail::htree{[this](auto const logicalBlock){
+      ++reads;
+      if(logicalBlock >= blocks.size())
+        {
+        return fs::detail::bytes{};
+        }
+      auto copy = std::shared_ptr<fs::detail::u08>{new fs::detail::u08[kBlockSize], std::default_delete<fs::detail::u08[]>{}};
+      std::memcpy(copy.get(), blocks[logicalBlock].data(), kBlockSize);
+      return fs::detail::bytes{copy};
+    }, kBlockSize, kSeed, false, largeDirectories};
+    }
+
+  std::vector<std::vector<fs::detail::u08>> blocks;
+  std::size_t reads{};
+  };
+
+fs::detail::u32 hash_of(std::string const & name)
+  {
+  return fs::detail::hash_name(name, fs::detail::hash_algorithm::half_md4, kSeed).major;
+  }
+
+auto ordered_names()
+  {
+  auto first = std::string{"alpha"};
+  auto second = std::string{"omega"};
+  if(hash_of(first) > hash_of(second))
+    {
+    std::swap(first, second);
+    }
+  return std::make_pair(first, second);
+  }
+
+void single_level_tree_finds_entries()
+  {
+  auto [low, high] = ordered_names();
+  auto disk = directory{3};
+  disk.root(0, {{0, 1}, {hash_of(high), 2}});
+  disk.leaf(1, {{low, 11}});
+  disk.leaf(2, {{high, 12}});
+
+  auto const tree = disk.tree(false);
+  ASSERT_EQUAL(11u, tree.find(low).value_or(0));
+  ASSERT_EQUAL(12u, tree.find(high).value_or(0));
+  }
+
+void missing_names_are_not_found()
+  {
+  auto [low, high] = ordered_names();
+  auto disk = directory{3};
+  disk.root(0, {{0, 1}, {hash_of(high), 2}});
+  disk.leaf(1, {{low, 11}});
+  disk.leaf(2, {{high, 12}});
+
+  auto const found = disk.tree(false).find("missing");
+  ASSERT(found);
+  ASSERT_EQUAL(0u, *found);
+  }
+
+void three_level_tree_reads_one_block_per_level()
+  {
+  auto [low, high] = ordered_names();
+  auto disk = directory{5};
+  disk.root(2, {{0, 1}});
+  disk.node(1, {{0, 2}});
+  disk.node(2, {{0, 3}, {hash_of(high), 4}});
+  disk.leaf(3, {{low, 11}});
+  disk.leaf(4, {{high, 12}});
+
+  auto const tree = disk.tree(true);
+  ASSERT_EQUAL(12u, tree.find(high).value_or(0));
+  ASSERT_EQUAL(4u, disk.reads);
+  }
+
+void three_level_tree_requires_large_directories()
+  {
+  auto [low, high] = ordered_names();
+  auto disk = directory{5};
+  disk.root(2, {{0, 1}});
+  disk.node(1, {{0, 2}});
+  disk.node(2, {{0, 3}, {hash_of(high), 4}});
+  disk.leaf(3, {{low, 11}});
+  disk.leaf(4, {{high, 12}});
+
+  ASSERT(!disk.tree(false).find(high));
+  }
+
+void colliding_hashes_continue_in_the_next_leaf()
+  {
+  auto disk = directory{3};
+  disk.root(0, {{0, 1}, {hash_of("target") | 1, 2}});
+  disk.leaf(1, {{"other", 11}});
+  disk.leaf(2, {{"target", 12}});
+
+  ASSERT_EQUAL(12u, disk.tree(false).find("target").value_or(0));
+  }
+
+void different_hashes_do_not_continue()
+  {
+  auto disk = directory{3};
+  disk.root(0, {{0, 1}, {hash_of("target") + 2, 2}});
+  disk.leaf(1, {{"other", 11}});
+  disk.leaf(2, {{"target", 12}});
+
+  ASSERT_EQUAL(0u, disk.tree(false).find("target").value_or(42));
+  ASSERT_EQUAL(2u, disk.reads);
+  }
+
+void corrupted_root_is_rejected()
+  {
+  auto disk = directory{2};
+  disk.root(0, {{0, 1}});
+  disk.put(0, 24, fs::detail::dx_root_info{0, 7, 8, 0, 0});
+  disk.leaf(1, {{"name", 11}});
+
+  ASSERT(!disk.tree(false).find("name"));
+  }
+
+int main(int argc, char * argv[])
+  {
+  auto tests = cute::suite{
+    CUTE(single_level_tree_finds_entries),
+    CUTE(missing_names_are_not_found),
+    CUTE(three_level_tree_reads_one_block_per_level),
+    CUTE(three_level_tree_requires_large_directories),
+    CUTE(colliding_hashes_continue_in_the_next_leaf),
+    CUTE(different_hashes_do_not_continue),
+    CUTE(corrupted_root_is_rejected),
+  };
+
+  cute::xml_file_opener resultFile{argc, argv};
+  cute::xml_listener<cute::ostream_listener<>> listener{resultFile.out};
+  return !cute::makeRunner(listener, argc, argv)(tests, "fs::detail::htree");
+  }
@@ -0,0 +1,192 @@
+#include "fs/detail/block_device.hpp"
+#include "fs/detail/indirect_map.hpp"
+#include "fs/detail/inode.hpp"
+#include "fs/extfs.hpp"
+
+#include <cute/cute.h>
+#include <cute/cute_runner.h>
+#include <cute/ostream_listener.h>
+#include <cute/xml_listener.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+auto constexpr kIndirectDiskImage = "../test/extfs_data/indirect.img";
+auto constexpr kLargeFile = "../test/extfs_data/tree/large";
+auto constexpr kLargeFileSize = 1288895u;
+auto constexpr kLargeFileBlocksCount = (kLargeFileSize + 1023u) / 1024u;
+auto constexpr kSparseFile = "../test/extfs_data/tree/sparse";
+auto constexpr kSparseFileSize = 1198u * 1024u;
+auto constexpr kBlockSize = 1024u;
+
+struct fixture
+  {
+  explicit fixture(fs::detail::u64 const size) :
+    disk{kIndirectDiskImage},
+    device{fs::detail::open_block_device(kIndirectDiskImage, false)}
+    {
+    for(auto id = 12u; id < 64; ++id)
+      {
+      auto const node = disk.inode(id);
+      if(node && node->size() == size)
+        {
+        map = std::make_unique<fs::detail::indirect_map>(*device, kBlockSize, node->block);
+        return;
+        }
+      }
+
+    throw std::runtime_error{"Failed to find test file!"};
+    }
+
+  fs::extfs disk;
+  std::unique_ptr<fs::detail::block_device> device;
+  std::unique_ptr<fs::detail::indirect_map> map;
+  };
+
+std::vector<char> content_of(std::string const & path)
+  {
+  auto file = std::ifstream{path, std::ios::binary};
+  return {std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+  }
+
+void new_indirect_map_has_no_loaded_blocks()
+  {
+  auto const test = fixture{kLargeFileSize};
+  ASSERT_EQUAL(0u, test.map->loaded_blocks_count());
+  ASSERT_EQUAL(0u, test.map->read_requests_count());
+  }
+
+void resolving_direct_blocks_loads_no_blocks()
+  {
+  auto const test = fixture{kLargeFileSize};
+  auto const runs = test.map->resolve(0, 12);
+  ASSERT(runs);
+  ASSERT_EQUAL(0u, test.map->loaded_blocks_count());
+  }
+
+void resolving_a_complete_file_loads_every_indirect_block_once()
+  {
+  auto const test = fixture{kLargeFileSize};
+  ASSERT(test.map->resolve(0, kLargeFileBlocksCount));
+
+  auto const doubleIndirectBlocksCount = (kLargeFileBlocksCount - 12 - 256 + 255) / 256;
+  ASSERT_EQUAL(1u + 1u + doubleIndirectBlocksCount, test.map->loaded_blocks_count());
+  ASSERT(test.map->read_requests_count() <= test.map->loaded_blocks_count());
+  }
+
+void resolving_sequential_chunks_loads_every_indirect_block_once()
+  {
+  auto const whole = fixture{kLargeFileSize};
+  auto const expected = whole.map->resolve(0, kLargeFileBlocksCount);
+  ASSERT(expected);
+
+  auto const test = fixture{kLargeFileSize};
+  auto blocks = std::vector<fs::detail::u64>{};
+  for(auto first = fs::detail::u64{}; first < kLargeFileBlocksCount; first += 32)
+    {
+    auto const runs = test.map->resolve(first, std::min<fs::detail::u64>(32, kLargeFileBlocksCount - first));
+    ASSERT(runs);
+    for(auto const & run : *runs)
+      {
+      for(auto block = fs::detail::u64{}; block < run.blocks_count; ++block)
+        {
+        blocks.push_back(run.physical_block_id + block);
+        }
+      }
+    }
+
+  auto expectedBlocks = std::vector<fs::detail::u64>{};
+  for(auto const & run : *expected)
+    {
+    for(auto block = fs::detail::u64{}; block < run.blocks_count; ++block)
+      {
+      expectedBlocks.push_back(run.physical_block_id + block);
+      }
+    }
+
+  ASSERT(expectedBlocks == blocks);
+  ASSERT_EQUAL(whole.map->loaded_blocks_count(), test.map->loaded_blocks_count());
+  }
+
+void resolving_a_cached_range_loads_no_blocks()
+  {
+  auto const test = fixture{kLargeFileSize};
+  test.map->resolve(0, kLargeFileBlocksCount);
+  auto const loaded = test.map->loaded_blocks_count();
+  test.map->resolve(0, kLargeFileBlocksCount);
+  test.map->resolve(700, 10);
+  ASSERT_EQUAL(loaded, test.map->loaded_blocks_count());
+  }
+
+void sparse_file_alternates_between_data_and_holes()
+  {
+  auto const test = fixture{kSparseFileSize};
+  auto const runs = test.map->resolve(0, 1198);
+  ASSERT(runs);
+  ASSERT_EQUAL(799u, runs->size());
+  for(auto index = 0u; index < runs->size(); ++index)
+    {
+    auto const & run = (*runs)[index];
+    ASSERT_EQUAL(index % 2 ? 2u : 1u, run.blocks_count);
+    ASSERT_EQUAL(index % 2 == 1, run.sparse());
+    }
+  }
+
+void runs_beyond_the_end_of_the_file_are_holes()
+  {
+  auto const test = fixture{kLargeFileSize};
+  auto const runs = test.map->resolve(kLargeFileBlocksCount, 100000);
+  ASSERT(runs);
+  ASSERT_EQUAL(1u, runs->size());
+  ASSERT(runs->front().sparse());
+  ASSERT_EQUAL(100000u, runs->front().blocks_count);
+  }
+
+void resolved_blocks_contain_file_content()
+  {
+  for(auto const & [path, size] : {std::make_pair(kLargeFile, kLargeFileSize), std::make_pair(kSparseFile, kSparseFileSize)})
+    {
+    auto const test = fixture{size};
+    auto const content = content_of(path);
+    ASSERT_EQUAL(size, content.size());
+
+    auto const runs = test.map->resolve(0, (size + kBlockSize - 1) / kBlockSize);
+    ASSERT(runs);
+    for(auto const & run : *runs)
+      {
+      if(run.sparse())
+        {
+        continue;
+        }
+
+      auto const offset = run.logical_block_id * kBlockSize;
+      auto const length = std::min<std::size_t>(kBlockSize * run.blocks_count, content.size() - offset);
+      auto block = std::vector<char>(length);
+      ASSERT(test.device->read(run.physical_block_id * kBlockSize, block.data(), block.size()));
+      ASSERT(std::equal(block.begin(), block.end(), content.begin() + offset));
+      }
+    }
+  }
+
+int main(int argc, char * argv[])
+  {
+  auto tests = cute::suite{
+    CUTE(new_indirect_map_has_no_loaded_blocks),
+    CUTE(resolving_direct_blocks_loads_no_blocks),
+    CUTE(resolving_a_complete_file_loads_every_indirect_block_once),
+    CUTE(resolving_sequential_chunks_loads_every_indirect_block_once),
+    CUTE(resolving_a_cached_range_loads_no_blocks),
+    CUTE(sparse_file_alternates_between_data_and_holes),
+    CUTE(runs_beyond_the_end_of_the_file_are_holes),
+    CUTE(resolved_blocks_contain_file_content),
+  };
+
+  cute::xml_file_opener resultFile{argc, argv};
+  cute::xml_listener<cute::ostream_listener<>> listener{resultFile.out};
+  return !cute::makeRunner(listener, argc, argv)(tests, "fs::detail::indirect_map");
+  }
@@ -0,0 +1,150 @@
+#include "fs/detail/extended_attributes.hpp"
+#include "fs/detail/inline_data.hpp"
+#include "fs/detail/inode.hpp"
+
+#include <cute/cute.h>
+#include <cute/cute_runner.h>
+#include <cute/ostream_listener.h>
+#include <cute/xml_listener.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+auto constexpr kInodeSize = 256u;
+auto constexpr kExtraSize = 32u;
+auto constexpr kAttributesOffset = 128u + kExtraSize + sizeof(fs::detail::u32);
+
+using raw_inode = std::array<fs::detail::u08, kInodeSize>;
+
+raw_inode make_inode(std::string const & content, bool const withAttribute = true)
+  {
+  auto node = fs::detail::inode{};
+  node.flags = static_cast<fs::detail::inode::flg>(fs::detail::inode::flag::inline_data);
+  node.size_lo = static_cast<fs::detail::u32>(content.size());
+  node.extra_size = kExtraSize;
+  std::memcpy(node.block.data(), content.data(), std::min(content.size(), sizeof(node.block)));
+
+  auto raw = raw_inode{};
+  std::memcpy(raw.data(), &node, sizeof(node));
+  if(!withAttribute)
+    {
+    return raw;
+    }
+
+  auto const tail = content.size() > sizeof(node.block) ? content.substr(sizeof(node.block)) : std::string{};
+  auto const magic = fs::detail::kExtendedAttributeMagic;
+  std::memcpy(raw.data() + kAttributesOffset - sizeof(magic), &magic, sizeof(magic));
+
+  auto entry = fs::detail::extended_attribute_entry{};
+  entry.name_length = 4;
+  entry.name_index = static_cast<fs::detail::u08>(fs::detail::attribute_namespace::system);
+  entry.value_offset = 64;
+  entry.value_size = static_cast<fs::detail::u32>((tail.size() + 3) / 4 * 4);
+  std::memcpy(raw.data() + kAttributesOffset, &entry, sizeof(entry));
+  std::memcpy(raw.data() + kAttributesOffset + sizeof(entry), "data", 4);
+  std::memcpy(raw.data() + kAttributesOffset + entry.value_offset, tail.data(), tail.size());
+  return raw;
+  }
+
+std::string content_of(fs::detail::inline_data const & data, fs::detail::u64 const offset, std::size_t const length)
+  {
+  auto content = std::string(length, '\0');
+  content.resize(data.copy(offset, content.data(), content.size()));
+  return content;
+  }
+
+void content_within_block_map_needs_no_attribute()
+  {
+  auto const raw = make_inode("nested file\n", false);
+  auto const data = fs::detail::inline_data_of(raw.data(), kInodeSize);
+  ASSERT(data);
+  ASSERT_EQUAL(12u, data->size());
+  ASSERT(!data->tail);
+  ASSERT_EQUAL(std::string{"nested file\n"}, content_of(*data, 0, 100));
+  }
+
+void content_overflows_into_system_data_attribute()
+  {
+  auto const content = std::string(60, 'h') + "tail of the content";
+  auto const raw = make_inode(content);
+  auto const data = fs::detail::inline_data_of(raw.data(), kInodeSize);
+  ASSERT(data);
+  ASSERT_EQUAL(60u, data->head_size);
+  ASSERT_EQUAL(19u, data->tail_size);
+  ASSERT_EQUAL(content, content_of(*data, 0, content.size()));
+  ASSERT_EQUAL(std::string{"hhtail"}, content_of(*data, 58, 6));
+  ASSERT_EQUAL(std::string{"content"}, content_of(*data, 72, 100));
+  ASSERT_EQUAL(std::string{}, content_of(*data, 79, 10));
+  }
+
+void inodes_without_inline_data_have_no_inline_content()
+  {
+  auto raw = make_inode("content");
+  auto node = fs::detail::inode{};
+  std::memcpy(raw.data() + offsetof(fs::detail::inode, flags), &node.flags, sizeof(node.flags));
+  ASSERT(!fs::detail::inline_data_of(raw.data(), kInodeSize));
+  }
+
+void overflow_without_attribute_is_rejected()
+  {
+  auto const raw = make_inode(std::string(70, 'x'), false);
+  ASSERT(!fs::detail::inline_data_of(raw.data(), kInodeSize));
+  ASSERT(!fs::detail::inline_data_of(make_inode(std::string(70, 'x')).data(), 128));
+  }
+
+void size_beyond_attribute_is_rejected()
+  {
+  auto raw = make_inode(std::string(70, 'x'));
+  auto const size = fs::detail::u32{100};
+  std::memcpy(raw.data() + offsetof(fs::detail::inode, size_lo), &size, sizeof(size));
+  ASSERT(!fs::detail::inline_data_of(raw.data(), kInodeSize));
+  }
+
+void attributes_are_visited_in_order()
+  {
+  auto const raw = make_inode(std::string(70, 'x'));
+  auto const region = fs::detail::in_inode_attributes(raw.data(), kInodeSize);
+  ASSERT_EQUAL(static_cast<void const *>(raw.data() + kAttributesOffset), static_cast<void const *>(region.entries));
+  ASSERT_EQUAL(kInodeSize - kAttributesOffset, region.length);
+
+  auto names = std::string{};
+  ASSERT(fs::detail::visit_attributes(region.entries, region.length, region.entries, region.length,
+                                      [&](auto const & entry, auto const name, auto const value){
+    names += std::string(name) + ":" + std::to_string(entry.value_size);
+    return value != nullptr;
+  }));
+  ASSERT_EQUAL(std::string{"data:12"}, names);
+  }
+
+void corrupted_attributes_are_detected()
+  {
+  auto raw = make_inode(std::string(70, 'x'));
+  auto const size = fs::detail::u32{4096};
+  std::memcpy(raw.data() + kAttributesOffset + offsetof(fs::detail::extended_attribute_entry, value_size), &size,
+              sizeof(size));
+  auto const region = fs::detail::in_inode_attributes(raw.data(), kInodeSize);
+  ASSERT(!fs::detail::visit_attributes(region.entries, region.length, region.entries, region.length,
+                                       [](auto const &, auto, auto){ return true; }));
+  ASSERT(!fs::detail::inline_data_of(raw.data(), kInodeSize));
+  }
+
+int main(int argc, char * argv[])
+  {
+  auto tests = cute::suite{
+    CUTE(content_within_block_map_needs_no_attribute),
+    CUTE(content_overflows_into_system_data_attribute),
+    CUTE(inodes_without_inline_data_have_no_inline_content),
+    CUTE(overflow_without_attribute_is_rejected),
+    CUTE(size_beyond_attribute_is_rejected),
+    CUTE(attributes_are_visited_in_order),
+    CUTE(corrupted_attributes_are_detected),
+  };
+
+  cute::xml_file_opener resultFile{argc, argv};
+  cute::xml_listener<cute::ostream_listener<>> listener{resultFile.out};
+  return !cute::makeRunner(listener, argc, argv)(tests, "fs::detail::inline_data");
+  }
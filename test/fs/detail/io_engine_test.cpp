@@ -0,0 +1,218 @@
+#include "fs/detail/block_device.hpp"
+#include "fs/detail/io_engine.hpp"
+
+#include <cute/cute.h>
+#include <cute/cute_runner.h>
+#include <cute/ostream_listener.h>
+#include <cute/xml_listener.h>
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+auto constexpr kGroupsDiskImage = "../test/extfs_data/groups.img";
+auto constexpr kBlockSize = 1024u;
+auto constexpr kBlocksCount = 256u;
+
+struct descriptor
+  {
+  descriptor() : value{::open(kGroupsDiskImage, O_RDONLY | O_CLOEXEC)} { }
+  ~descriptor() { ::close(value); }
+  int const value;
+  };
+
+auto content_of(fs::detail::u64 const offset, std::size_t const length)
+  {
+  auto device = fs::detail::open_block_device(kGroupsDiskImage, false);
+  auto content = std::vector<fs::detail::u08>(length);
+  device->read(offset, content.data(), content.size());
+  return content;
+  }
+
+void reads_every_block(fs::detail::io_engine & engine)
+  {
+  auto buffers = std::vector<std::vector<fs::detail::u08>>(kBlocksCount, std::vector<fs::detail::u08>(kBlockSize));
+  auto results = std::vector<std::promise<bool>>(kBlocksCount);
+  auto requests = std::vector<fs::detail::io_request>{};
+  for(auto block = 0u; block < kBlocksCount; ++block)
+    {
+    requests.push_back(fs::detail::io_request{block * kBlockSize, {{buffers[block].data(), kBlockSize}},
+                                              [&, block](bool const success){ results[block].set_value(success); }});
+    }
+
+  engine.submit(std::move(requests));
+
+  for(auto block = 0u; block < kBlocksCount; ++block)
+    {
+    ASSERT(results[block].get_future().get());
+    ASSERT(content_of(block * kBlockSize, kBlockSize) == buffers[block]);
+    }
+  }
+
+void reads_into_scattered_buffers(fs::detail::io_engine & engine)
+  {
+  auto head = std::vector<fs::detail::u08>(100);
+  auto tail = std::vector<fs::detail::u08>(3 * kBlockSize - head.size());
+  auto result = std::promise<bool>{};
+  engine.submit({fs::detail::io_request{kBlockSize, {{head.data(), head.size()}, {tail.data(), tail.size()}},
+                                        [&](bool const success){ result.set_value(success); }}});
+
+  ASSERT(result.get_future().get());
+  head.insert(head.end(), tail.begin(), tail.end());
+  ASSERT(content_of(kBlockSize, 3 * kBlockSize) == head);
+  }
+
+void reports_reads_past_the_end(fs::detail::io_engine & engine)
+  {
+  auto const size = static_cast<fs::detail::u64>(::lseek(descriptor{}.value, 0, SEEK_END));
+  auto buffer = std::vector<fs::detail::u08>(kBlockSize);
+  auto result = std::promise<bool>{};
+  engine.submit({fs::detail::io_request{size - kBlockSize / 2, {{buffer.data(), buffer.size()}},
+                                        [&](bool const success){ result.set_value(success); }}});
+
+  ASSERT(!result.get_future().get());
+  }
+
+void pool_engine_reads_every_block()
+  {
+  auto const file = descriptor{};
+  auto engine = fs::detail::pool_engine{file.value, 4};
+  reads_every_block(engine);
+  }
+
+void pool_engine_reads_into_scattered_buffers()
+  {
+  auto const file = descriptor{};
+  auto engine = fs::detail::pool_engine{file.value, 4};
+  reads_into_scattered_buffers(engine);
+  }
+
+void pool_engine_reports_reads_past_the_end()
+  {
+  auto const file = descriptor{};
+  auto engine = fs::detail::pool_engine{file.value, 4};
+  reports_reads_past_the_end(engine);
+  }
+
+void pool_engine_limits_its_workers()
+  {
+  auto const file = descriptor{};
+  auto engine = fs::detail::pool_engine{file.value, 1024};
+  ASSERT_EQUAL(1024u, engine.queue_depth());
+  reads_every_block(engine);
+  }
+
+void uring_engine_reads_every_block()
+  {
+  auto const file = descriptor{};
+  auto engine = fs::detail::uring_engine{file.value, 8};
+  if(engine.ready())
+    {
+    reads_every_block(engine);
+    }
+  }
+
+void uring_engine_reads_into_scattered_buffers()
+  {
+  auto const file = descriptor{};
+  auto engine = fs::detail::uring_engine{file.value, 8};
+  if(engine.ready())
+    {
+    reads_into_scattered_buffers(engine);
+    }
+  }
+
+void uring_engine_reports_reads_past_the_end()
+  {
+  auto const file = descriptor{};
+  auto engine = fs::detail::uring_engine{file.value, 8};
+  if(engine.ready())
+    {
+    reports_reads_past_the_end(engine);
+    }
+  }
+
+void engines_complete_all_requests_before_destruction()
+  {
+  auto const file = descriptor{};
+  auto completed = std::atomic<unsigned>{};
+  auto buffers = std::vector<std::vector<fs::detail::u08>>(kBlocksCount, std::vector<fs::detail::u08>(kBlockSize));
+
+    {
+    auto engine = fs::detail::make_io_engine(file.value, 16);
+    auto requests = std::vector<fs::detail::io_request>{};
+    for(auto block = 0u; block < kBlocksCount; ++block)
+      {
+      requests.push_back(fs::detail::io_request{block * kBlockSize, {{buffers[block].data(), kBlockSize}},
+                                                [&](bool const success){ completed += success; }});
+      }
+    engine->submit(std::move(requests));
+    }
+
+  ASSERT_EQUAL(kBlocksCount, completed.load());
+  }
+
+void positional_device_executes_batches()
+  {
+  auto device = fs::detail::open_block_device(kGroupsDiskImage, false, false, 4);
+  auto buffers = std::vector<std::vector<fs::detail::u08>>(16, std::vector<fs::detail::u08>(kBlockSize));
+  auto requests = std::vector<fs::detail::io_request>{};
+  for(auto index = 0u; index < buffers.size(); ++index)
+    {
+    requests.push_back(fs::detail::io_request{(2 * index + 1) * kBlockSize, {{buffers[index].data(), kBlockSize}}});
+    }
+
+  ASSERT(device->read_batch(std::move(requests)));
+  for(auto index = 0u; index < buffers.size(); ++index)
+    {
+    ASSERT(content_of((2 * index + 1) * kBlockSize, kBlockSize) == buffers[index]);
+    }
+  }
+
+void positional_device_rejects_batches_past_the_end()
+  {
+  auto device = fs::detail::open_block_device(kGroupsDiskImage, false, false);
+  auto buffer = std::vector<fs::detail::u08>(kBlockSize);
+  auto requests = std::vector<fs::detail::io_request>{};
+  requests.push_back(fs::detail::io_request{0, {{buffer.data(), buffer.size()}}});
+  requests.push_back(fs::detail::io_request{device->size(), {{buffer.data(), buffer.size()}}});
+  ASSERT(!device->read_batch(std::move(requests)));
+  }
+
+void mapped_device_executes_batches_synchronously()
+  {
+  auto device = fs::detail::open_block_device(kGroupsDiskImage, false);
+  auto buffer = std::vector<fs::detail::u08>(kBlockSize);
+  auto completed = false;
+  auto requests = std::vector<fs::detail::io_request>{};
+  requests.push_back(fs::detail::io_request{kBlockSize, {{buffer.data(), buffer.size()}},
+                                            [&](bool const success){ completed = success; }});
+  device->submit(std::move(requests));
+  ASSERT(completed);
+  ASSERT(content_of(kBlockSize, kBlockSize) == buffer);
+  }
+
+int main(int argc, char * argv[])
+  {
+  auto tests = cute::suite{
+    CUTE(pool_engine_reads_every_block),
+    CUTE(pool_engine_reads_into_scattered_buffers),
+    CUTE(pool_engine_reports_reads_past_the_end),
+    CUTE(pool_engine_limits_its_workers),
+    CUTE(uring_engine_reads_every_block),
+    CUTE(uring_engine_reads_into_scattered_buffers),
+    CUTE(uring_engine_reports_reads_past_the_end),
+    CUTE(engines_complete_all_requests_before_destruction),
+    CUTE(positional_device_executes_batches),
+    CUTE(positional_device_rejects_batches_past_the_end),
+    CUTE(mapped_device_executes_batches_synchronously),
+  };
+
+  cute::xml_file_opener resultFile{argc, argv};
+  cute::xml_listener<cute::ostream_listener<>> listener{resultFile.out};
+  return !cute::makeRunner(listener, argc, argv)(tests, "fs::detail::io_engine");
+  }
@@ -0,0 +1,176 @@
+#include "fs/detail/block_device.hpp"
+#include "fs/detail/journal.hpp"
+#include "fs/extfs.hpp"
+
+#include <cute/cute.h>
+#include <cute/cute_runner.h>
+#include <cute/ostream_listener.h>
+#include <cute/xml_listener.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+auto constexpr kJournalDiskImage = "../test/extfs_data/journal.img";
+auto constexpr kExtentsDiskImage = "../test/extfs_data/extents.img";
+auto constexpr kBlockSize = 1024u;
+auto constexpr kJournalInodeId = 8u;
+
+struct fixture
+  {
+  explicit fixture(char const * const path) :
+    disk{path, fs::extfs::mode::read_only, unrecovered()},
+    device{fs::detail::open_block_device(path, false)}
+    {
+    }
+
+  std::vector<fs::detail::block_run> runs_of(fs::detail::u32 const inodeId) const
+    {
+    auto const node = disk.inode(inodeId);
+    return disk.resolve(inodeId, 0, (node->size() + kBlockSize - 1) / kBlockSize).value_or(std::vector<fs::detail::block_run>{});
+    }
+
+  fs::detail::u64 small_block(fs::detail::u64 const logicalBlock) const
+    {
+    auto const runs = disk.resolve(disk.lookup("/small").value_or(0), logicalBlock, 1);
+    return runs && runs->size() == 1 ? runs->front().physical_block_id : 0;
+    }
+
+  std::unique_ptr<fs::detail::journal_overlay> overlay() const
+    {
+    auto index = fs::detail::scan_journal(*device, kBlockSize, runs_of(kJournalInodeId));
+    return std::make_unique<fs::detail::journal_overlay>(fs::detail::open_block_device(kJournalDiskImage, false), kBlockSize,
+                                                         index.value_or(fs::detail::journal_index{}).blocks);
+    }
+
+  static fs::extfs::settings unrecovered()
+    {
+    auto settings = fs::extfs::settings{};
+    settings.overlay_journal = false;
+    return settings;
+    }
+
+  fs::extfs disk;
+  std::unique_ptr<fs::detail::block_device> device;
+  };
+
+std::string repeated(std::string const & line, std::size_t const length)
+  {
+  auto content = std::string{};
+  while(content.size() < length)
+    {
+    content += line;
+    }
+  return content.substr(0, length);
+  }
+
+void scan_indexes_latest_committed_copies()
+  {
+  auto const disk = fixture{kJournalDiskImage};
+  auto const index = fs::detail::scan_journal(*disk.device, kBlockSize, disk.runs_of(kJournalInodeId));
+  ASSERT(index);
+  ASSERT_EQUAL(2u, index->blocks.size());
+
+  auto const first = index->blocks.find(disk.small_block(0));
+  ASSERT(first != index->blocks.end());
+  ASSERT_EQUAL(1u, first->second.sequence);
+  ASSERT(!first->second.escaped);
+
+  auto const escaped = index->blocks.find(disk.small_block(3));
+  ASSERT(escaped != index->blocks.end());
+  ASSERT_EQUAL(3u, escaped->second.sequence);
+  ASSERT(escaped->second.escaped);
+
+  ASSERT(index->blocks.find(disk.small_block(1)) == index->blocks.end());
+  ASSERT(index->blocks.find(disk.small_block(2)) == index->blocks.end());
+  }
+
+void scan_of_clean_journal_is_empty()
+  {
+  auto const disk = fixture{kExtentsDiskImage};
+  auto const index = fs::detail::scan_journal(*disk.device, kBlockSize, disk.runs_of(kJournalInodeId));
+  ASSERT(index);
+  ASSERT(index->blocks.empty());
+  ASSERT_EQUAL(0u, index->statistics.transactions_count);
+  ASSERT(!index->statistics.incomplete);
+  }
+
+void scan_of_non_journal_fails()
+  {
+  auto const disk = fixture{kJournalDiskImage};
+  ASSERT(!fs::detail::scan_journal(*disk.device, kBlockSize, disk.runs_of(disk.disk.lookup("/large").value_or(0))));
+  ASSERT(!fs::detail::scan_journal(*disk.device, 4096, disk.runs_of(kJournalInodeId)));
+  }
+
+void overlay_restores_escaped_blocks()
+  {
+  auto const disk = fixture{kJournalDiskImage};
+  auto const overlay = disk.overlay();
+  auto content = std::string(6, '\0');
+  ASSERT(overlay->read(disk.small_block(3) * kBlockSize + 2, content.data(), content.size()));
+  ASSERT_EQUAL(std::string("\x39\x98" "esca"), content);
+  }
+
+void overlay_patches_vectored_reads()
+  {
+  auto const disk = fixture{kJournalDiskImage};
+  auto const overlay = disk.overlay();
+  auto const offset = disk.small_block(1) * kBlockSize - 10;
+  auto head = std::string(4, '\0');
+  auto tail = std::string(16, '\0');
+  ASSERT(overlay->read(offset, {{head.data(), head.size()}, {tail.data(), tail.size()}}));
+
+  auto expected = std::string(20, '\0');
+  ASSERT(disk.device->read(offset, expected.data(), expected.size()));
+  expected.replace(0, 10, repeated("journaled\n", kBlockSize).substr(kBlockSize - 10));
+  ASSERT_EQUAL(expected, head + tail);
+  }
+
+void overlay_patches_fetches_and_batches()
+  {
+  auto const disk = fixture{kJournalDiskImage};
+  auto const overlay = disk.overlay();
+  auto const journaled = repeated("journaled\n", kBlockSize);
+  auto const fetched = overlay->fetch(disk.small_block(0) * kBlockSize, kBlockSize);
+  ASSERT(fetched);
+  ASSERT_EQUAL(journaled, std::string(fetched.get(), fetched.get() + kBlockSize));
+
+  auto patched = std::string(kBlockSize, '\0');
+  auto untouched = std::string(kBlockSize, '\0');
+  ASSERT(overlay->read_batch({
+    {disk.small_block(0) * kBlockSize, {{patched.data(), patched.size()}}},
+    {disk.small_block(2) * kBlockSize, {{untouched.data(), untouched.size()}}},
+  }));
+  ASSERT_EQUAL(journaled, patched);
+
+  auto original = std::string(kBlockSize, '\0');
+  ASSERT(disk.device->read(disk.small_block(2) * kBlockSize, original.data(), original.size()));
+  ASSERT_EQUAL(original, untouched);
+  }
+
+void overlay_is_not_writeable()
+  {
+  auto const disk = fixture{kJournalDiskImage};
+  auto const overlay = disk.overlay();
+  auto const byte = fs::detail::u08{};
+  ASSERT(!overlay->writeable());
+  ASSERT(!overlay->write(0, &byte, 1));
+  }
+
+int main(int argc, char * argv[])
+  {
+  auto tests = cute::suite{
+    CUTE(scan_indexes_latest_committed_copies),
+    CUTE(scan_of_clean_journal_is_empty),
+    CUTE(scan_of_non_journal_fails),
+    CUTE(overlay_restores_escaped_blocks),
+    CUTE(overlay_patches_vectored_reads),
+    CUTE(overlay_patches_fetches_and_batches),
+    CUTE(overlay_is_not_writeable),
+  };
+
+  cute::xml_file_opener resultFile{argc, argv};
+  cute::xml_listener<cute::ostream_listener<>> listener{resultFile.out};
+  return !cute::makeRunner(listener, argc, argv)(tests, "fs::detail::journal");
+  }
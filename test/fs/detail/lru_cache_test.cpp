@@ -0,0 +1,135 @@
+#include "fs/detail/lru_cache.hpp"
+
+#include <cute/cute.h>
+#include <cute/cute_runner.h>
+#include <cute/ostream_listener.h>
+#include <cute/xml_listener.h>
+
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
+
+using cache = fs::detail::lru_cache<int, std::string>;
+
+void empty_cache_misses()
+  {
+  auto const values = cache{1024};
+  ASSERT(!values.find(42));
+  ASSERT_EQUAL(1u, values.statistics().misses);
+  }
+
+void inserted_value_can_be_found()
+  {
+  auto values = cache{1024};
+  values.insert(42, "answer", 8);
+  ASSERT_EQUAL(std::string{"answer"}, *values.find(42));
+  ASSERT_EQUAL(1u, values.statistics().hits);
+  }
+
+void inserting_an_existing_key_replaces_the_value()
+  {
+  auto values = cache{1024};
+  values.insert(42, "answer", 8);
+  values.insert(42, "question", 16);
+  ASSERT_EQUAL(std::string{"question"}, *values.find(42));
+  ASSERT_EQUAL(1u, values.statistics().entries);
+  ASSERT_EQUAL(16u, values.statistics().size);
+  }
+
+void erased_value_can_not_be_found()
+  {
+  auto values = cache{1024};
+  values.insert(42, "answer", 8);
+  values.erase(42);
+  ASSERT(!values.find(42));
+  ASSERT_EQUAL(0u, values.statistics().size);
+  }
+
+void least_recently_used_entry_is_evicted_first()
+  {
+  auto values = cache{3, 1};
+  values.insert(1, "one", 1);
+  values.insert(2, "two", 1);
+  values.insert(3, "three", 1);
+  values.find(1);
+  values.insert(4, "four", 1);
+
+  ASSERT(values.find(1));
+  ASSERT(!values.find(2));
+  ASSERT(values.find(3));
+  ASSERT(values.find(4));
+  ASSERT_EQUAL(1u, values.statistics().evictions);
+  }
+
+void cache_never_exceeds_its_capacity()
+  {
+  auto values = cache{256};
+  for(auto key = 0; key < 1000; ++key)
+    {
+    values.insert(key, std::to_string(key), 8);
+    ASSERT(values.statistics().size <= 256);
+    }
+  }
+
+void shrinking_the_cache_evicts_entries()
+  {
+  auto values = cache{1024, 1};
+  for(auto key = 0; key < 100; ++key)
+    {
+    values.insert(key, std::to_string(key), 8);
+    }
+
+  values.resize(80);
+  ASSERT_EQUAL(10u, values.statistics().entries);
+  ASSERT(values.find(99));
+  ASSERT(!values.find(0));
+  }
+
+void cleared_cache_is_empty()
+  {
+  auto values = cache{1024};
+  values.insert(1, "one", 1);
+  values.clear();
+  ASSERT_EQUAL(0u, values.statistics().entries);
+  ASSERT(!values.find(1));
+  }
+
+void cache_supports_concurrent_access()
+  {
+  auto values = cache{1 << 16};
+  auto workers = std::vector<std::thread>{};
+  for(auto worker = 0; worker < 8; ++worker)
+    {
+    workers.emplace_back([&, worker]{
+      for(auto key = 0; key < 1000; ++key)
+        {
+        values.insert(key * 8 + worker, std::to_string(key), 8);
+        values.find(key * 8 + (worker + 1) % 8);
+        }
+    });
+    }
+
+  std::for_each(workers.begin(), workers.end(), [](auto & worker){ worker.join(); });
+  ASSERT_EQUAL(8000u, values.statistics().entries);
+  ASSERT_EQUAL(8000u, values.statistics().hits + values.statistics().misses);
+  }
+
+int main(int argc, char * argv[])
+  {
+  auto tests = cute::suite{
+    CUTE(empty_cache_misses),
+    CUTE(inserted_value_can_be_found),
+    CUTE(inserting_an_existing_key_replaces_the_value),
+    CUTE(erased_value_can_not_be_found),
+    CUTE(least_recently_used_entry_is_evicted_first),
+    CUTE(cache_never_exceeds_its_capacity),
+    CUTE(shrinking_the_cache_evicts_entries),
+    CUTE(cleared_cache_is_empty),
+    CUTE(cache_supports_concurrent_access),
+  };
+
+  cute::xml_file_opener resultFile{argc, argv};
+  cute::xml_listener<cute::ostream_listener<>> listener{resultFile.out};
+  return !cute::makeRunner(listener, argc, argv)(tests, "fs::detail::lru_cache");
+  }
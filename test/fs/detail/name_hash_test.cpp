@@ -0,0 +1,89 @@
+#include "fs/detail/name_hash.hpp"
+
+#include <cute/cute.h>
+#include <cute/cute_runner.h>
+#include <cute/ostream_listener.h>
+#include <cute/xml_listener.h>
+
+#include <string>
+
+using fs::detail::hash_algorithm;
+
+auto constexpr kSeed = fs::detail::u32_arr<4>{{0x67452301, 0xefcdab89, 0x67452301, 0xefcdab89}};
+auto constexpr kZeroSeed = fs::detail::u32_arr<4>{};
+auto constexpr kLongName = "a_rather_long_file_name_that_spans_more_than_thirty_two_bytes";
+auto constexpr kUmlauts = "\xc3\xa4\xc3\xb6\xc3\xbc";
+
+void legacy_hash_matches_reference()
+  {
+  ASSERT_EQUAL(0xe74b53e2u, fs::detail::hash_name("a", hash_algorithm::legacy, kSeed).major);
+  ASSERT_EQUAL(0x32252546u, fs::detail::hash_name("hello", hash_algorithm::legacy, kSeed).major);
+  ASSERT_EQUAL(0xb5075554u, fs::detail::hash_name(kLongName, hash_algorithm::legacy, kSeed).major);
+  ASSERT_EQUAL(0u, fs::detail::hash_name("hello", hash_algorithm::legacy, kSeed).minor);
+  }
+
+void half_md4_hash_matches_reference()
+  {
+  auto const hash = fs::detail::hash_name("hello", hash_algorithm::half_md4, kSeed);
+  ASSERT_EQUAL(0xa26e4a80u, hash.major);
+  ASSERT_EQUAL(0x97e5b7f7u, hash.minor);
+
+  auto const longHash = fs::detail::hash_name(kLongName, hash_algorithm::half_md4, kSeed);
+  ASSERT_EQUAL(0xd6e25c30u, longHash.major);
+  ASSERT_EQUAL(0x362421b9u, longHash.minor);
+  }
+
+void tea_hash_matches_reference()
+  {
+  auto const hash = fs::detail::hash_name("a", hash_algorithm::tea, kSeed);
+  ASSERT_EQUAL(0x6d0ea4c0u, hash.major);
+  ASSERT_EQUAL(0xc18922dfu, hash.minor);
+
+  auto const longHash = fs::detail::hash_name(kLongName, hash_algorithm::tea, kSeed);
+  ASSERT_EQUAL(0x927d018eu, longHash.major);
+  ASSERT_EQUAL(0xb3ac2daau, longHash.minor);
+  }
+
+void zero_seed_selects_default_seed()
+  {
+  auto const hash = fs::detail::hash_name("hello", hash_algorithm::half_md4, kZeroSeed);
+  ASSERT_EQUAL(0x1746da32u, hash.major);
+  ASSERT_EQUAL(0x420013b5u, hash.minor);
+  }
+
+void signedness_affects_non_ascii_names()
+  {
+  ASSERT_EQUAL(0xe32d0194u, fs::detail::hash_name(kUmlauts, hash_algorithm::legacy, kSeed).major);
+  ASSERT_EQUAL(0xd21e5596u, fs::detail::hash_name(kUmlauts, hash_algorithm::legacy_unsigned, kSeed).major);
+  ASSERT_EQUAL(0x86de7e36u, fs::detail::hash_name(kUmlauts, hash_algorithm::half_md4, kSeed).major);
+  ASSERT_EQUAL(0xc26909ecu, fs::detail::hash_name(kUmlauts, hash_algorithm::half_md4_unsigned, kSeed).major);
+  ASSERT_EQUAL(0x18ed4406u, fs::detail::hash_name(kUmlauts, hash_algorithm::tea, kSeed).major);
+  ASSERT_EQUAL(0xd1dbd0d4u, fs::detail::hash_name(kUmlauts, hash_algorithm::tea_unsigned, kSeed).major);
+  }
+
+void major_hash_is_always_even()
+  {
+  for(auto index = 0; index < 256; ++index)
+    {
+    auto const name = "name-" + std::to_string(index);
+    ASSERT_EQUAL(0u, fs::detail::hash_name(name, hash_algorithm::legacy, kSeed).major & 1);
+    ASSERT_EQUAL(0u, fs::detail::hash_name(name, hash_algorithm::half_md4, kSeed).major & 1);
+    ASSERT_EQUAL(0u, fs::detail::hash_name(name, hash_algorithm::tea, kSeed).major & 1);
+    }
+  }
+
+int main(int argc, char * argv[])
+  {
+  auto tests = cute::suite{
+    CUTE(legacy_hash_matches_reference),
+    CUTE(half_md4_hash_matches_reference),
+    CUTE(tea_hash_matches_reference),
+    CUTE(zero_seed_selects_default_seed),
+    CUTE(signedness_affects_non_ascii_names),
+    CUTE(major_hash_is_always_even),
+  };
+
+  cute::xml_file_opener resultFile{argc, argv};
+  cute::xml_listener<cute::ostream_listener<>> listener{resultFile.out};
+  return !cute::makeRunner(listener, argc, argv)(tests, "fs::detail::name_hash");
+  }
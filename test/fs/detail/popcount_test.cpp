@@ -0,0 +1,102 @@
+#include "fs/detail/popcount.hpp"
+
+#include <cute/cute.h>
+#include <cute/cute_runner.h>
+#include <cute/ostream_listener.h>
+#include <cute/xml_listener.h>
+
+#include <random>
+#include <vector>
+
+auto random_bytes(std::size_t const length)
+  {
+  auto engine = std::mt19937{static_cast<std::mt19937::result_type>(length)};
+  auto distribution = std::uniform_int_distribution<unsigned>{0, 255};
+  auto bytes = std::vector<fs::detail::u08>(length);
+  for(auto & byte : bytes)
+    {
+    byte = static_cast<fs::detail::u08>(distribution(engine));
+    }
+  return bytes;
+  }
+
+fs::detail::u64 reference_count(fs::detail::u08 const * const data, std::size_t const bits)
+  {
+  auto count = fs::detail::u64{};
+  for(auto bit = std::size_t{}; bit < bits; ++bit)
+    {
+    count += (data[bit / 8] >> (bit % 8)) & 1;
+    }
+  return count;
+  }
+
+void kernel_counts_match_reference(fs::detail::popcount_kernel const kernel)
+  {
+  if(!fs::detail::supported(kernel))
+    {
+    return;
+    }
+
+  for(auto const length : {0u, 1u, 7u, 8u, 31u, 32u, 33u, 63u, 64u, 65u, 1000u, 4096u, 4099u})
+    {
+    auto const bytes = random_bytes(length);
+    ASSERT_EQUAL(reference_count(bytes.data(), length * 8), fs::detail::popcount(bytes.data(), length, kernel));
+    }
+  }
+
+void scalar_kernel_is_always_supported()
+  {
+  ASSERT(fs::detail::supported(fs::detail::popcount_kernel::scalar));
+  }
+
+void best_kernel_is_supported()
+  {
+  ASSERT(fs::detail::supported(fs::detail::best_popcount_kernel()));
+  }
+
+void scalar_kernel_counts_set_bits()
+  {
+  kernel_counts_match_reference(fs::detail::popcount_kernel::scalar);
+  }
+
+void avx2_kernel_counts_set_bits()
+  {
+  kernel_counts_match_reference(fs::detail::popcount_kernel::avx2);
+  }
+
+void avx512_kernel_counts_set_bits()
+  {
+  kernel_counts_match_reference(fs::detail::popcount_kernel::avx512);
+  }
+
+void full_bitmap_has_all_bits_set()
+  {
+  auto const bytes = std::vector<fs::detail::u08>(1024, 0xff);
+  ASSERT_EQUAL(8192u, fs::detail::popcount(bytes.data(), bytes.size()));
+  }
+
+void counting_bitmap_bits_ignores_trailing_bits()
+  {
+  auto const bytes = random_bytes(1024);
+  for(auto const bits : {0u, 1u, 5u, 8u, 2000u, 2003u, 8191u})
+    {
+    ASSERT_EQUAL(reference_count(bytes.data(), bits), fs::detail::count_set_bits(bytes.data(), bits));
+    }
+  }
+
+int main(int argc, char * argv[])
+  {
+  auto tests = cute::suite{
+    CUTE(scalar_kernel_is_always_supported),
+    CUTE(best_kernel_is_supported),
+    CUTE(scalar_kernel_counts_set_bits),
+    CUTE(avx2_kernel_counts_set_bits),
+    CUTE(avx512_kernel_counts_set_bits),
+    CUTE(full_bitmap_has_all_bits_set),
+    CUTE(counting_bitmap_bits_ignores_trailing_bits),
+  };
+
+  cute::xml_file_opener resultFile{argc, argv};
+  cute::xml_listener<cute::ostream_listener<>> listener{resultFile.out};
+  return !cute::makeRunner(listener, argc, argv)(tests, "fs::detail::popcount");
+  }
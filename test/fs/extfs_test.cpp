@@ -15,13 +15,49 @@ namespace stdfs = std::filesystem;
 #error The standard library has no support for the Filesystem TS
 #endif
 
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
 #include <initializer_list>
+#include <iterator>
+#include <map>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
 
 auto constexpr kNonExistantImage = "THIS_DISK_DOES_NOT_EXIST";
 auto constexpr kLabeledDiskImage = "../test/extfs_data/labeled.img";
 auto constexpr kUnlabeledDiskImage = "../test/extfs_data/unlabeled.img";
+auto constexpr kGroupsDiskImage = "../test/extfs_data/groups.img";
+auto constexpr kMetaGroupsDiskImage = "../test/extfs_data/metagroups.img";
+auto constexpr kMetaGroupsBlocksPerGroup = 256u;
+auto constexpr kExtentsDiskImage = "../test/extfs_data/extents.img";
+auto constexpr kIndirectDiskImage = "../test/extfs_data/indirect.img";
+auto constexpr kDirectoriesDiskImage = "../test/extfs_data/directories.img";
+auto constexpr kJournalDiskImage = "../test/extfs_data/journal.img";
+auto constexpr kInlineDiskImage = "../test/extfs_data/inline.img";
+auto constexpr kAttributesDiskImage = "../test/extfs_data/attributes.img";
+auto constexpr kRootDirectoryId = 2u;
+auto constexpr kMaximumTestInodesCount = 8192u;
+auto constexpr kSparseFileSize = 1198u * 1024u;
+auto constexpr kLargeFileSize = 1288895u;
+
+auto constexpr kLargeFile = "../test/extfs_data/tree/large";
+auto constexpr kSparseFile = "../test/extfs_data/tree/sparse";
+auto constexpr kTree = "../test/extfs_data/tree";
+auto constexpr kSmallFile = "../test/extfs_data/tree/small";
+
+std::vector<char> content_of(std::string const & path)
+  {
+  auto file = std::ifstream{path, std::ios::binary};
+  return {std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+  }
 
 bool disk_exists(stdfs::path const & imagePath)
   {
@@ -59,6 +95,20 @@ auto guard_disk_image_none(std::initializer_list<char const *> imageList)
   return fs::extfs{*imageList.begin()};
   }
 
+fs::detail::u32 find_inode_by_size(fs::extfs const & disk, fs::detail::u64 const size)
+  {
+  for(auto id = 12u; id < 64; ++id)
+    {
+    auto const node = disk.inode(id);
+    if(node && node->type() == fs::detail::inode::file_type::regular_file && node->size() == size)
+      {
+      return id;
+      }
+    }
+
+  throw std::runtime_error{"Failed to find the expected inode!"};
+  }
+
 void construction_with_inexistent_file_creates_extfs_that_is_not_open()
   {
   auto && disk = guard_disk_image_none({kNonExistantImage});
@@ -107,6 +157,1448 @@ void construction_with_unlabeled_image_creates_extfs_that_has_empty_string_for_l
   ASSERT_EQUAL("", disk.label());
   }
 
+void non_open_file_system_has_no_groups()
+  {
+  auto && disk = guard_disk_image_none({kNonExistantImage});
+  ASSERT_EQUAL(0u, disk.groups_count());
+  ASSERT(!disk.group(0));
+  }
+
+void construction_with_multi_group_image_creates_extfs_with_groups()
+  {
+  auto && disk = guard_disk_image_any({kGroupsDiskImage});
+  ASSERT_EQUAL(64u, disk.groups_count());
+  }
+
+void groups_of_open_file_system_are_accessible()
+  {
+  auto && disk = guard_disk_image_any({kGroupsDiskImage});
+  for(auto id = 0u; id < disk.groups_count(); ++id)
+    {
+    auto const group = disk.group(id);
+    ASSERT(group);
+    ASSERT_EQUAL(id, group->id);
+    }
+  ASSERT(!disk.group(disk.groups_count()));
+  }
+
+void non_open_file_system_has_no_inodes()
+  {
+  auto && disk = guard_disk_image_none({kNonExistantImage});
+  ASSERT(!disk.inode(2));
+  }
+
+void inode_zero_does_not_exist()
+  {
+  auto && disk = guard_disk_image_any({kLabeledDiskImage});
+  ASSERT(!disk.inode(0));
+  }
+
+void inode_beyond_inode_count_does_not_exist()
+  {
+  auto && disk = guard_disk_image_any({kGroupsDiskImage});
+  ASSERT(!disk.inode(1u << 30));
+  }
+
+void root_inode_is_a_directory()
+  {
+  auto && disk = guard_disk_image_any({kLabeledDiskImage, kGroupsDiskImage});
+  auto const root = disk.inode(2);
+  ASSERT(root);
+  ASSERT(root->type() == fs::detail::inode::file_type::directory);
+  ASSERT_EQUAL(3u, root->links_count);
+  }
+
+void repeated_inode_lookup_hits_the_cache()
+  {
+  auto && disk = guard_disk_image_any({kLabeledDiskImage});
+  auto const first = disk.inode(2);
+  auto const second = disk.inode(2);
+  ASSERT_EQUAL(first.get(), second.get());
+  ASSERT_EQUAL(1u, disk.inode_cache_statistics().hits);
+  ASSERT_EQUAL(1u, disk.inode_cache_statistics().misses);
+  }
+
+void inode_cache_respects_its_budget()
+  {
+  auto settings = fs::extfs::settings{};
+  settings.inode_cache_size = 0;
+  auto const disk = fs::extfs{kLabeledDiskImage, fs::extfs::mode::read_only, settings};
+  ASSERT(disk.inode(2));
+  ASSERT(disk.inode(2));
+  ASSERT_EQUAL(0u, disk.inode_cache_statistics().entries);
+  ASSERT_EQUAL(0u, disk.inode_cache_statistics().hits);
+  }
+
+void inodes_can_be_looked_up_concurrently()
+  {
+  auto && disk = guard_disk_image_any({kGroupsDiskImage});
+  auto failures = std::atomic<int>{};
+  auto workers = std::vector<std::thread>{};
+  for(auto worker = 0; worker < 8; ++worker)
+    {
+    workers.emplace_back([&]{
+      for(auto round = 0; round < 100; ++round)
+        {
+        auto const root = disk.inode(2);
+        auto const lostAndFound = disk.inode(11);
+        if(!root || !lostAndFound || root->type() != fs::detail::inode::file_type::directory ||
+           lostAndFound->type() != fs::detail::inode::file_type::directory)
+          {
+          ++failures;
+          }
+        }
+    });
+    }
+
+  std::for_each(workers.begin(), workers.end(), [](auto & worker){ worker.join(); });
+  ASSERT_EQUAL(0, failures.load());
+  }
+
+void non_open_file_system_resolves_nothing()
+  {
+  auto && disk = guard_disk_image_none({kNonExistantImage});
+  ASSERT(!disk.resolve(12, 0, 1));
+  }
+
+void resolving_extents_maps_requested_range()
+  {
+  auto && disk = guard_disk_image_any({kExtentsDiskImage});
+  auto const runs = disk.resolve(find_inode_by_size(disk, kSparseFileSize), 3, 4);
+  ASSERT(runs);
+  ASSERT_EQUAL(3u, runs->size());
+  ASSERT_EQUAL(3u, (*runs)[0].logical_block_id);
+  ASSERT(!(*runs)[0].sparse());
+  ASSERT((*runs)[1].sparse());
+  ASSERT_EQUAL(2u, (*runs)[1].blocks_count);
+  ASSERT(!(*runs)[2].sparse());
+  }
+
+void resolving_extents_populates_block_map_cache()
+  {
+  auto && disk = guard_disk_image_any({kExtentsDiskImage});
+  auto const id = find_inode_by_size(disk, kSparseFileSize);
+  ASSERT(disk.resolve(id, 0, 10));
+  ASSERT(disk.resolve(id, 10, 10));
+  ASSERT_EQUAL(1u, disk.block_map_cache_statistics().entries);
+  ASSERT_EQUAL(1u, disk.block_map_cache_statistics().hits);
+  }
+
+void resolving_indirect_blocks_maps_complete_file()
+  {
+  auto && disk = guard_disk_image_any({kIndirectDiskImage});
+  auto const id = find_inode_by_size(disk, kLargeFileSize);
+  auto const blocksCount = (kLargeFileSize + 1023) / 1024;
+  auto const runs = disk.resolve(id, 0, blocksCount);
+  ASSERT(runs);
+  ASSERT(std::none_of(runs->begin(), runs->end(), [](auto const & run){ return run.sparse(); }));
+
+  auto mapped = 0u;
+  std::for_each(runs->begin(), runs->end(), [&](auto const & run){ mapped += run.blocks_count; });
+  ASSERT_EQUAL(blocksCount, mapped);
+  }
+
+void resolving_indirect_blocks_populates_block_map_cache()
+  {
+  auto && disk = guard_disk_image_any({kIndirectDiskImage});
+  auto const id = find_inode_by_size(disk, kSparseFileSize);
+  ASSERT(disk.resolve(id, 0, 300));
+  ASSERT(disk.resolve(id, 0, 300));
+  ASSERT_EQUAL(1u, disk.block_map_cache_statistics().entries);
+  ASSERT_EQUAL(1u, disk.block_map_cache_statistics().hits);
+  }
+
+void finding_in_non_directory_fails()
+  {
+  auto && disk = guard_disk_image_any({kDirectoriesDiskImage});
+  auto const small = disk.find(kRootDirectoryId, "small");
+  ASSERT(small && *small);
+  ASSERT(!disk.find(*small, "anything"));
+  }
+
+void finding_in_linear_directory_finds_entries()
+  {
+  auto && disk = guard_disk_image_any({kIndirectDiskImage});
+  auto const directory = disk.find(kRootDirectoryId, "directory");
+  ASSERT(directory && *directory);
+  auto const nested = disk.find(*directory, "nested");
+  ASSERT(nested && *nested);
+  auto const file = disk.find(*nested, "file");
+  ASSERT(file && *file);
+  ASSERT(disk.inode(*file)->type() == fs::detail::inode::file_type::regular_file);
+  }
+
+void finding_missing_entry_returns_zero()
+  {
+  auto && disk = guard_disk_image_any({kIndirectDiskImage, kDirectoriesDiskImage});
+  auto const missing = disk.find(kRootDirectoryId, "missing");
+  ASSERT(missing);
+  ASSERT_EQUAL(0u, *missing);
+  }
+
+void finding_in_indexed_directory_finds_entries()
+  {
+  auto && disk = guard_disk_image_any({kDirectoriesDiskImage});
+  auto const indexed = disk.find(kRootDirectoryId, "indexed");
+  ASSERT(indexed && *indexed);
+  ASSERT(disk.inode(*indexed)->has(fs::detail::inode::flag::hash_indexed));
+
+  auto const first = disk.find(*indexed, "entry-00000");
+  ASSERT(first && *first);
+  for(auto const name : {"entry-00001", "entry-04711", "entry-07999"})
+    {
+    auto const found = disk.find(*indexed, name);
+    ASSERT(found);
+    ASSERT_EQUAL(*first, *found);
+    }
+
+  auto const unicode = disk.find(*indexed, "ünïcödé");
+  ASSERT(unicode && *unicode);
+  ASSERT(*first != *unicode);
+  ASSERT_EQUAL(0u, disk.find(*indexed, "entry-08000").value_or(42));
+  }
+
+void indexed_and_linear_directories_agree()
+  {
+  auto && indexedDisk = guard_disk_image_any({kDirectoriesDiskImage});
+  auto && linearDisk = guard_disk_image_any({kIndirectDiskImage});
+  auto const indexed = indexedDisk.find(kRootDirectoryId, "indexed").value_or(0);
+  auto const linear = linearDisk.find(kRootDirectoryId, "indexed").value_or(0);
+  ASSERT(indexed && linear);
+
+  for(auto entry = 0; entry < 8000; entry += 97)
+    {
+    auto name = std::string{"entry-00000"};
+    auto const digits = std::to_string(entry);
+    name.replace(name.size() - digits.size(), digits.size(), digits);
+    ASSERT(indexedDisk.find(indexed, name).value_or(0));
+    ASSERT(linearDisk.find(linear, name).value_or(0));
+    }
+  }
+
+void relative_paths_can_not_be_looked_up()
+  {
+  auto && disk = guard_disk_image_any({kDirectoriesDiskImage});
+  ASSERT(!disk.lookup(""));
+  ASSERT(!disk.lookup("directory/nested"));
+  }
+
+void root_path_resolves_to_root_directory()
+  {
+  auto && disk = guard_disk_image_any({kDirectoriesDiskImage});
+  ASSERT_EQUAL(kRootDirectoryId, disk.lookup("/").value_or(0));
+  ASSERT_EQUAL(kRootDirectoryId, disk.lookup("//./").value_or(0));
+  }
+
+void nested_paths_resolve_component_by_component()
+  {
+  auto && disk = guard_disk_image_any({kDirectoriesDiskImage});
+  auto const directory = disk.find(kRootDirectoryId, "directory").value_or(0);
+  auto const nested = disk.find(directory, "nested").value_or(0);
+  auto const file = disk.find(nested, "file").value_or(0);
+  ASSERT(file);
+  ASSERT_EQUAL(file, disk.lookup("/directory/nested/file").value_or(0));
+  ASSERT_EQUAL(file, disk.lookup("/directory//./nested/file").value_or(0));
+  ASSERT_EQUAL(directory, disk.lookup("/directory/nested/..").value_or(0));
+  }
+
+void missing_components_resolve_to_zero()
+  {
+  auto && disk = guard_disk_image_any({kDirectoriesDiskImage});
+  ASSERT_EQUAL(0u, disk.lookup("/missing").value_or(42));
+  ASSERT_EQUAL(0u, disk.lookup("/directory/missing/file").value_or(42));
+  }
+
+void paths_through_files_can_not_be_looked_up()
+  {
+  auto && disk = guard_disk_image_any({kDirectoriesDiskImage});
+  ASSERT(!disk.lookup("/small/file"));
+  }
+
+void repeated_prefixes_resolve_from_dentry_cache()
+  {
+  auto && disk = guard_disk_image_any({kDirectoriesDiskImage});
+  ASSERT(disk.lookup("/directory/nested/file").value_or(0));
+  auto const misses = disk.dentry_cache_statistics().misses;
+  ASSERT(disk.lookup("/directory/nested").value_or(0));
+  ASSERT(disk.lookup("/directory/nested/file").value_or(0));
+  ASSERT_EQUAL(misses, disk.dentry_cache_statistics().misses);
+  ASSERT_EQUAL(5u, disk.dentry_cache_statistics().hits);
+  }
+
+void missing_names_are_cached_as_negative_entries()
+  {
+  auto && disk = guard_disk_image_any({kDirectoriesDiskImage});
+  ASSERT_EQUAL(0u, disk.lookup("/indexed/missing").value_or(42));
+  ASSERT_EQUAL(0u, disk.lookup("/indexed/missing").value_or(42));
+  ASSERT_EQUAL(2u, disk.dentry_cache_statistics().entries);
+  ASSERT_EQUAL(2u, disk.dentry_cache_statistics().hits);
+  }
+
+void dentry_cache_respects_its_budget()
+  {
+  auto settings = fs::extfs::settings{};
+  settings.dentry_cache_size = 16 * 1024;
+  auto const disk = fs::extfs{kDirectoriesDiskImage, fs::extfs::mode::read_only, settings};
+  for(auto entry = 0; entry < 1000; ++entry)
+    {
+    auto name = std::string{"/indexed/entry-00000"};
+    auto const digits = std::to_string(entry);
+    name.replace(name.size() - digits.size(), digits.size(), digits);
+    ASSERT(disk.lookup(name).value_or(0));
+    }
+
+  auto const statistics = disk.dentry_cache_statistics();
+  ASSERT_EQUAL(16u * 1024u, statistics.capacity);
+  ASSERT(statistics.size <= statistics.capacity);
+  ASSERT(statistics.size > 0);
+  ASSERT(statistics.evictions > 0);
+  }
+
+void mapped_file_system_bypasses_buffer_cache()
+  {
+  auto && disk = guard_disk_image_any({kDirectoriesDiskImage});
+  ASSERT(disk.lookup("/directory/nested/file").value_or(0));
+  ASSERT_EQUAL(0u, disk.buffer_cache_statistics().misses);
+  ASSERT_EQUAL(0u, disk.buffer_cache_statistics().capacity);
+  }
+
+void unmapped_file_system_reads_metadata_through_buffer_cache()
+  {
+  auto settings = fs::extfs::settings{};
+  settings.memory_map = false;
+  auto const unmapped = fs::extfs{kDirectoriesDiskImage, fs::extfs::mode::read_only, settings};
+  auto && mapped = guard_disk_image_any({kDirectoriesDiskImage});
+
+  for(auto const path : {"/directory/nested/file", "/indexed/entry-00001", "/indexed/entry-07999", "/large"})
+    {
+    auto const id = unmapped.lookup(path).value_or(0);
+    ASSERT(id);
+    ASSERT_EQUAL(mapped.lookup(path).value_or(0), id);
+    }
+
+  auto const statistics = unmapped.buffer_cache_statistics();
+  ASSERT(statistics.misses > 0);
+  ASSERT(statistics.hits > 0);
+  ASSERT_EQUAL(settings.buffer_cache_size, statistics.capacity);
+  }
+
+void loading_an_inode_prefetches_its_flexible_group()
+  {
+  auto settings = fs::extfs::settings{};
+  settings.memory_map = false;
+  auto const disk = fs::extfs{kExtentsDiskImage, fs::extfs::mode::read_only, settings};
+  ASSERT(disk.inode(2));
+
+  auto const prefetches = disk.group_prefetch_statistics();
+  ASSERT_EQUAL(fs::detail::u64{disk.groups_count()}, prefetches.prefetched_groups_count);
+  ASSERT_EQUAL(1u, prefetches.reads_count);
+
+  auto const misses = disk.buffer_cache_statistics().misses;
+  for(auto const id : {11u, 12u, 13u})
+    {
+    ASSERT(disk.inode(id));
+    }
+  ASSERT_EQUAL(misses, disk.buffer_cache_statistics().misses);
+  ASSERT_EQUAL(1u, disk.group_prefetch_statistics().reads_count);
+  }
+
+void flexible_group_prefetch_can_be_disabled()
+  {
+  auto settings = fs::extfs::settings{};
+  settings.memory_map = false;
+  settings.prefetch_flexible_groups = false;
+  auto const disk = fs::extfs{kExtentsDiskImage, fs::extfs::mode::read_only, settings};
+  ASSERT(disk.inode(2));
+  ASSERT_EQUAL(0u, disk.group_prefetch_statistics().reads_count);
+  }
+
+void group_metadata_can_be_prefetched_explicitly()
+  {
+  auto && disk = guard_disk_image_any({kGroupsDiskImage});
+  disk.prefetch_group_metadata(0, disk.groups_count());
+  auto const prefetches = disk.group_prefetch_statistics();
+  ASSERT_EQUAL(fs::detail::u64{disk.groups_count()}, prefetches.prefetched_groups_count);
+  ASSERT_EQUAL(fs::detail::u64{disk.groups_count()}, prefetches.reads_count);
+  }
+
+void reading_non_existent_inode_fails()
+  {
+  auto && disk = guard_disk_image_any({kExtentsDiskImage});
+  auto buffer = std::vector<char>(16);
+  ASSERT(!disk.read(0, 0, buffer.data(), buffer.size()));
+  }
+
+void reading_complete_files_returns_their_content()
+  {
+  for(auto const image : {kExtentsDiskImage, kIndirectDiskImage})
+    {
+    auto const disk = fs::extfs{image};
+    for(auto const path : {"/large", "/sparse", "/small", "/directory/nested/file"})
+      {
+      auto const expected = content_of(std::string{"../test/extfs_data/tree"} + path);
+      auto buffer = std::vector<char>(expected.size() + 100);
+      auto const count = disk.read(disk.lookup(path).value_or(0), 0, buffer.data(), buffer.size());
+      ASSERT(count);
+      ASSERT_EQUAL(expected.size(), *count);
+      ASSERT(std::equal(expected.begin(), expected.end(), buffer.begin()));
+      }
+    }
+  }
+
+void reading_unaligned_ranges_returns_their_content()
+  {
+  auto && disk = guard_disk_image_any({kExtentsDiskImage});
+  auto const expected = content_of(kSparseFile);
+  auto const id = disk.lookup("/sparse").value_or(0);
+  for(auto offset = std::size_t{1}; offset < expected.size(); offset += 7919)
+    {
+    auto buffer = std::vector<char>(4099);
+    auto const count = disk.read(id, offset, buffer.data(), buffer.size());
+    ASSERT(count);
+    ASSERT_EQUAL(std::min(buffer.size(), expected.size() - offset), *count);
+    ASSERT(std::equal(buffer.begin(), buffer.begin() + *count, expected.begin() + offset));
+    }
+  }
+
+void reading_beyond_the_end_returns_nothing()
+  {
+  auto && disk = guard_disk_image_any({kExtentsDiskImage});
+  auto buffer = std::vector<char>(16);
+  ASSERT_EQUAL(0u, disk.read(disk.lookup("/small").value_or(0), 1u << 20, buffer.data(), buffer.size()).value_or(42));
+  }
+
+void reader_streams_complete_file()
+  {
+  auto settings = fs::extfs::settings{};
+  settings.memory_map = false;
+  auto const disk = fs::extfs{kIndirectDiskImage, fs::extfs::mode::read_only, settings};
+  auto const expected = content_of(kLargeFile);
+  auto reader = disk.reader(disk.lookup("/large").value_or(0));
+  ASSERT_EQUAL(expected.size(), reader.size());
+
+  auto content = std::vector<char>{};
+  auto buffer = std::vector<char>(4000);
+  while(auto const count = reader.read(buffer.data(), buffer.size()).value_or(0))
+    {
+    content.insert(content.end(), buffer.begin(), buffer.begin() + count);
+    }
+
+  ASSERT_EQUAL(expected.size(), reader.position());
+  ASSERT(expected == content);
+  }
+
+void sequential_reads_grow_the_readahead_window()
+  {
+  auto && disk = guard_disk_image_any({kExtentsDiskImage});
+  auto reader = disk.reader(disk.lookup("/large").value_or(0));
+  auto buffer = std::vector<char>(64 * 1024);
+  for(auto round = 0; round < 8; ++round)
+    {
+    reader.read(buffer.data(), buffer.size());
+    }
+  ASSERT(reader.readahead_size() > fs::file_reader::kInitialReadaheadSize);
+
+  reader.seek(0);
+  ASSERT_EQUAL(fs::file_reader::kInitialReadaheadSize, reader.readahead_size());
+  ASSERT_EQUAL(buffer.size(), reader.read(buffer.data(), buffer.size()).value_or(0));
+  auto const expected = content_of(kLargeFile);
+  ASSERT(std::equal(buffer.begin(), buffer.end(), expected.begin()));
+  }
+
+void free_space_of_clean_file_systems_matches_summary_counts()
+  {
+  for(auto const path : {kLabeledDiskImage, kGroupsDiskImage, kMetaGroupsDiskImage, kExtentsDiskImage, kIndirectDiskImage})
+    {
+    auto && disk = guard_disk_image_any({path});
+    auto const usage = disk.scan_free_space();
+    ASSERT(usage);
+    ASSERT_EQUAL(std::size_t{disk.groups_count()}, usage->groups.size());
+    ASSERT(usage->inconsistent_groups().empty());
+    ASSERT(usage->consistent());
+    }
+  }
+
+void free_space_does_not_depend_on_the_number_of_threads()
+  {
+  auto && disk = guard_disk_image_any({kMetaGroupsDiskImage});
+  auto const single = disk.scan_free_space(1);
+  auto const multiple = disk.scan_free_space(4);
+  ASSERT(single && multiple);
+  ASSERT_EQUAL(single->free_blocks_count, multiple->free_blocks_count);
+  ASSERT_EQUAL(single->free_inodes_count, multiple->free_inodes_count);
+  }
+
+void free_space_of_unmapped_file_system_matches_mapped_file_system()
+  {
+  auto settings = fs::extfs::settings{};
+  settings.memory_map = false;
+  auto const unmapped = fs::extfs{kExtentsDiskImage, fs::extfs::mode::read_only, settings};
+  auto && mapped = guard_disk_image_any({kExtentsDiskImage});
+  ASSERT_EQUAL(mapped.scan_free_space()->free_blocks_count, unmapped.scan_free_space()->free_blocks_count);
+  ASSERT_EQUAL(mapped.scan_free_space()->free_inodes_count, unmapped.scan_free_space()->free_inodes_count);
+  }
+
+void free_space_reports_stale_summary_counts()
+  {
+  auto const copy = stdfs::temp_directory_path() / "extfs_stale_counts.img";
+  stdfs::copy_file(kGroupsDiskImage, copy, stdfs::copy_options::overwrite_existing);
+
+    {
+    auto image = std::fstream{copy.string(), std::ios::binary | std::ios::in | std::ios::out};
+    auto const staleCount = fs::detail::u32{42};
+    image.seekp(1024 + offsetof(fs::detail::superblock, free_blocks_count));
+    image.write(reinterpret_cast<char const *>(&staleCount), sizeof(staleCount));
+    }
+
+  auto const usage = fs::extfs{copy.string()}.scan_free_space();
+  stdfs::remove(copy);
+  ASSERT(usage);
+  ASSERT_EQUAL(42u, usage->recorded_free_blocks_count);
+  ASSERT(usage->free_blocks_count != 42u);
+  ASSERT(!usage->consistent());
+  ASSERT(usage->inconsistent_groups().empty());
+  }
+
+void free_extents_account_for_all_free_blocks()
+  {
+  for(auto const path : {kGroupsDiskImage, kMetaGroupsDiskImage, kExtentsDiskImage, kIndirectDiskImage})
+    {
+    auto && disk = guard_disk_image_any({path});
+    auto const usage = disk.scan_free_space();
+    auto const report = disk.scan_free_extents();
+    ASSERT(usage && report);
+    ASSERT_EQUAL(usage->free_blocks_count, report->total.free_blocks_count);
+    ASSERT_EQUAL(usage->groups.size(), report->groups.size());
+
+    auto groupExtents = std::uint64_t{};
+    for(auto group = std::size_t{}; group < report->groups.size(); ++group)
+      {
+      ASSERT_EQUAL(usage->groups[group].free_blocks_count, report->groups[group].free_blocks_count);
+      groupExtents += report->groups[group].free_extents_count;
+      }
+    ASSERT(report->total.free_extents_count <= groupExtents);
+    }
+  }
+
+void free_extents_span_group_boundaries()
+  {
+  auto && disk = guard_disk_image_any({kMetaGroupsDiskImage});
+  auto const report = disk.scan_free_extents();
+  ASSERT(report);
+  ASSERT(report->total.largest_extent > kMetaGroupsBlocksPerGroup);
+  }
+
+void free_extents_do_not_depend_on_the_number_of_threads()
+  {
+  auto && disk = guard_disk_image_any({kMetaGroupsDiskImage});
+  auto const single = disk.scan_free_extents(1);
+  auto const multiple = disk.scan_free_extents(4);
+  ASSERT(single && multiple);
+  ASSERT(single->total.extents_count == multiple->total.extents_count);
+  ASSERT(single->total.blocks_count == multiple->total.blocks_count);
+  }
+
+stdfs::path corrupted_copy(char const * const path, std::string const & name, fs::detail::u64 const offset)
+  {
+  auto const copy = stdfs::temp_directory_path() / name;
+  stdfs::copy_file(path, copy, stdfs::copy_options::overwrite_existing);
+
+  auto image = std::fstream{copy.string(), std::ios::binary | std::ios::in | std::ios::out};
+  auto byte = char{};
+  image.seekg(static_cast<std::streamoff>(offset));
+  image.get(byte);
+  image.seekp(static_cast<std::streamoff>(offset));
+  image.put(static_cast<char>(byte ^ 0x5a));
+  return copy;
+  }
+
+template<typename Value>
+stdfs::path patched_copy(char const * const path, std::string const & name, fs::detail::u64 const offset, Value const value)
+  {
+  auto const copy = stdfs::temp_directory_path() / name;
+  stdfs::copy_file(path, copy, stdfs::copy_options::overwrite_existing);
+
+  auto image = std::fstream{copy.string(), std::ios::binary | std::ios::in | std::ios::out};
+  image.seekp(static_cast<std::streamoff>(offset));
+  image.write(reinterpret_cast<char const *>(&value), sizeof(value));
+  return copy;
+  }
+
+void implausible_geometry_fails_to_open()
+  {
+  auto constexpr superblockOffset = fs::detail::u64{1024};
+  auto const copies = std::vector<stdfs::path>{
+    patched_copy(kGroupsDiskImage, "extfs_huge_blocks.img",
+                 superblockOffset + offsetof(fs::detail::superblock, logical_block_size), fs::detail::u32{30}),
+    patched_copy(kGroupsDiskImage, "extfs_no_inodes_per_group.img",
+                 superblockOffset + offsetof(fs::detail::superblock, inodes_per_group), fs::detail::u32{0}),
+    patched_copy(kGroupsDiskImage, "extfs_no_blocks_per_group.img",
+                 superblockOffset + offsetof(fs::detail::superblock, blocks_per_group), fs::detail::u32{0}),
+    patched_copy(kExtentsDiskImage, "extfs_huge_descriptors.img",
+                 superblockOffset + offsetof(fs::detail::superblock, group_descriptor_size), fs::detail::u16{2048}),
+  };
+
+  auto configuration = fs::extfs::settings{};
+  configuration.verify_checksums = false;
+  auto opened = std::vector<bool>{};
+  for(auto const & copy : copies)
+    {
+    auto const disk = fs::extfs{copy.string(), fs::extfs::mode::read_only, configuration};
+    opened.push_back(disk.open());
+    ASSERT(!disk.inode(2));
+    stdfs::remove(copy);
+    }
+
+  ASSERT_EQUAL(std::vector<bool>(copies.size(), false), opened);
+  }
+
+void free_space_ignores_uninitialized_flags_without_lazy_initialization()
+  {
+  // groups.img uses 1024 byte blocks, so its group descriptor table starts in block 2.
+  auto constexpr descriptorTableOffset = fs::detail::u64{2 * 1024};
+  auto const flags = static_cast<fs::detail::group_descriptor::flg>(
+    static_cast<fs::detail::group_descriptor::flg>(fs::detail::group_descriptor::flag::inodes_uninitialized) |
+    static_cast<fs::detail::group_descriptor::flg>(fs::detail::group_descriptor::flag::block_bitmap_uninitialized));
+  auto const copy = patched_copy(kGroupsDiskImage, "extfs_stray_group_flags.img",
+                                 descriptorTableOffset + offsetof(fs::detail::group_descriptor, flags), flags);
+
+  auto const expected = fs::extfs{kGroupsDiskImage}.scan_free_space();
+  auto const usage = fs::extfs{copy.string()}.scan_free_space();
+  auto const report = fs::extfs{copy.string()}.scan_free_extents();
+  stdfs::remove(copy);
+  ASSERT(expected && usage && report);
+  ASSERT_EQUAL(expected->groups[0].free_blocks_count, usage->groups[0].free_blocks_count);
+  ASSERT_EQUAL(expected->groups[0].free_inodes_count, usage->groups[0].free_inodes_count);
+  ASSERT_EQUAL(expected->free_blocks_count, report->total.free_blocks_count);
+  ASSERT(usage->consistent());
+  }
+
+void file_systems_without_metadata_checksums_are_not_verified()
+  {
+  auto && disk = guard_disk_image_any({kGroupsDiskImage});
+  ASSERT(!disk.verifies_checksums());
+  ASSERT_EQUAL(0u, disk.checksum_failures_count());
+  }
+
+void verification_can_be_disabled()
+  {
+  auto configuration = fs::extfs::settings{};
+  configuration.verify_checksums = false;
+  auto const disk = fs::extfs{kExtentsDiskImage, fs::extfs::mode::read_only, configuration};
+  ASSERT(disk.open());
+  ASSERT(!disk.verifies_checksums());
+  }
+
+void intact_metadata_passes_verification()
+  {
+  for(auto const path : {kExtentsDiskImage, kDirectoriesDiskImage, kMetaGroupsDiskImage})
+    {
+    auto && disk = guard_disk_image_any({path});
+    ASSERT(disk.verifies_checksums());
+    ASSERT(disk.scan_free_space());
+    for(auto id = 1u; id < 64; ++id)
+      {
+      disk.inode(id);
+      }
+    ASSERT_EQUAL(0u, disk.checksum_failures_count());
+    }
+
+  auto && disk = guard_disk_image_any({kDirectoriesDiskImage});
+  auto const indexed = disk.find(kRootDirectoryId, "indexed");
+  ASSERT(indexed && *indexed);
+  ASSERT(disk.find(*indexed, "entry-04711").value_or(0));
+  ASSERT(disk.lookup("/small"));
+
+  auto && extents = guard_disk_image_any({kExtentsDiskImage});
+  auto const large = find_inode_by_size(extents, kLargeFileSize);
+  auto content = std::vector<char>(kLargeFileSize);
+  ASSERT_EQUAL(std::size_t{kLargeFileSize}, extents.read(large, 0, content.data(), content.size()).value_or(0));
+
+  ASSERT_EQUAL(0u, disk.checksum_failures_count());
+  ASSERT_EQUAL(0u, extents.checksum_failures_count());
+  }
+
+void corrupted_superblock_fails_to_open()
+  {
+  auto const copy = corrupted_copy(kExtentsDiskImage, "extfs_corrupted_superblock.img",
+                                   1024 + offsetof(fs::detail::superblock, label));
+  auto configuration = fs::extfs::settings{};
+  auto const verified = fs::extfs{copy.string(), fs::extfs::mode::read_only, configuration}.open();
+  configuration.verify_checksums = false;
+  auto const unverified = fs::extfs{copy.string(), fs::extfs::mode::read_only, configuration}.open();
+  stdfs::remove(copy);
+  ASSERT(!verified);
+  ASSERT(unverified);
+  }
+
+void corrupted_inode_can_not_be_read()
+  {
+  auto && pristine = guard_disk_image_any({kDirectoriesDiskImage});
+  auto const group = pristine.group(0);
+  ASSERT(group);
+
+  auto superblock = fs::detail::superblock{};
+  std::ifstream{kDirectoriesDiskImage, std::ios::binary}.seekg(1024).read(reinterpret_cast<char *>(&superblock),
+                                                                           sizeof(superblock));
+  auto const blockSize = fs::detail::u64{1024} << superblock.logical_block_size;
+  auto const rootOffset = group->inode_table_block_id * blockSize + (kRootDirectoryId - 1) * superblock.inode_size;
+  auto const copy = corrupted_copy(kDirectoriesDiskImage, "extfs_corrupted_inode.img",
+                                   rootOffset + offsetof(fs::detail::inode, access_timestamp));
+
+  auto const disk = fs::extfs{copy.string()};
+  auto const root = disk.inode(kRootDirectoryId);
+  auto const failures = disk.checksum_failures_count();
+  stdfs::remove(copy);
+  ASSERT(disk.open());
+  ASSERT(!root);
+  ASSERT_EQUAL(1u, failures);
+  }
+
+void superblock_copies_of_clean_file_systems_are_consistent()
+  {
+  for(auto const path : {kGroupsDiskImage, kMetaGroupsDiskImage, kExtentsDiskImage, kIndirectDiskImage})
+    {
+    auto && disk = guard_disk_image_any({path});
+    auto const copies = disk.superblock_copies();
+    ASSERT(!copies.empty());
+    ASSERT(copies.front().group > 0);
+    for(auto const & copy : copies)
+      {
+      ASSERT(copy.consistent());
+      }
+    }
+  }
+
+void sparse_file_system_has_superblock_copies_in_powers_of_3_5_and_7()
+  {
+  auto && disk = guard_disk_image_any({kGroupsDiskImage});
+  auto groups = std::vector<fs::detail::u32>{};
+  for(auto const & copy : disk.superblock_copies())
+    {
+    groups.push_back(copy.group);
+    }
+  ASSERT_EQUAL((std::vector<fs::detail::u32>{1, 3, 5, 7, 9, 25, 27, 49}), groups);
+  }
+
+void corrupted_superblock_copy_is_reported()
+  {
+  auto && pristine = guard_disk_image_any({kMetaGroupsDiskImage});
+  auto const target = pristine.superblock_copies().at(2);
+  auto const copy = corrupted_copy(kMetaGroupsDiskImage, "extfs_corrupted_backup.img",
+                                   target.offset + offsetof(fs::detail::superblock, inodes_count));
+
+  auto configuration = fs::extfs::settings{};
+  configuration.verify_checksums = false;
+  auto const copies = fs::extfs{copy.string(), fs::extfs::mode::read_only, configuration}.superblock_copies();
+  stdfs::remove(copy);
+  ASSERT_EQUAL(pristine.superblock_copies().size(), copies.size());
+  for(auto const & candidate : copies)
+    {
+    ASSERT_EQUAL(candidate.group != target.group, candidate.consistent());
+    }
+  }
+
+void file_system_can_be_opened_from_a_backup_superblock()
+  {
+  auto && pristine = guard_disk_image_any({kExtentsDiskImage});
+  auto const backup = pristine.superblock_copies().front();
+  auto const copy = corrupted_copy(kExtentsDiskImage, "extfs_corrupted_primary.img",
+                                   1024 + offsetof(fs::detail::superblock, magic_number));
+
+  auto configuration = fs::extfs::settings{};
+  auto const primary = fs::extfs{copy.string(), fs::extfs::mode::read_only, configuration}.open();
+  configuration.superblock_offset = backup.offset;
+  auto const disk = fs::extfs{copy.string(), fs::extfs::mode::read_only, configuration};
+  auto const large = disk.open() ? find_inode_by_size(disk, kLargeFileSize) : 0;
+  auto const copies = disk.superblock_copies();
+  stdfs::remove(copy);
+
+  ASSERT(!primary);
+  ASSERT(disk.open());
+  ASSERT(large);
+  ASSERT_EQUAL(0u, disk.checksum_failures_count());
+  ASSERT_EQUAL(0u, copies.front().group);
+  ASSERT(!copies.front().valid);
+  }
+
+void backup_superblock_can_be_found_without_primary_superblock()
+  {
+  auto && pristine = guard_disk_image_any({kIndirectDiskImage});
+  auto const backup = pristine.superblock_copies().front();
+  auto const copy = corrupted_copy(kIndirectDiskImage, "extfs_probed_primary.img",
+                                   1024 + offsetof(fs::detail::superblock, magic_number));
+
+  auto const device = fs::detail::open_block_device(copy.string(), false);
+  auto const found = device ? fs::detail::probe_superblock_copies(*device) : std::vector<fs::detail::superblock_copy>{};
+  stdfs::remove(copy);
+
+  ASSERT_EQUAL(1u, found.size());
+  ASSERT_EQUAL(backup.offset, found.front().offset);
+  ASSERT(found.front().valid);
+  }
+
+std::vector<fs::detail::u32> used_inodes_of(fs::extfs const & disk)
+  {
+  auto used = std::vector<fs::detail::u32>{};
+  for(auto id = 1u; id <= kMaximumTestInodesCount; ++id)
+    {
+    auto const node = disk.inode(id);
+    if(node && node->mode)
+      {
+      used.push_back(id);
+      }
+    }
+  return used;
+  }
+
+void inode_scan_finds_all_used_inodes()
+  {
+  for(auto const path : {kGroupsDiskImage, kMetaGroupsDiskImage, kExtentsDiskImage, kIndirectDiskImage})
+    {
+    auto && disk = guard_disk_image_any({path});
+    auto scan = disk.inode_scanner();
+    ASSERT(scan);
+
+    auto used = std::vector<fs::detail::u32>{};
+    auto scannedCount = fs::detail::u32{};
+    while(auto const id = scan->next())
+      {
+      ++scannedCount;
+      if(scan->current().mode)
+        {
+        used.push_back(*id);
+        }
+      }
+
+    ASSERT(!scan->failed());
+    ASSERT(scannedCount >= used.size());
+    ASSERT_EQUAL(used_inodes_of(disk), used);
+    }
+  }
+
+void inode_scan_skips_uninitialized_inode_tables()
+  {
+  auto && lazy = guard_disk_image_any({kExtentsDiskImage});
+  auto && eager = guard_disk_image_any({kIndirectDiskImage});
+  auto lazyScan = lazy.inode_scanner();
+  auto eagerScan = eager.inode_scanner();
+
+  auto lazyCount = 0u;
+  while(lazyScan->next())
+    {
+    ++lazyCount;
+    }
+  auto eagerCount = 0u;
+  while(eagerScan->next())
+    {
+    ++eagerCount;
+    }
+
+  ASSERT(lazyCount < kMaximumTestInodesCount);
+  ASSERT_EQUAL(kMaximumTestInodesCount, eagerCount);
+  ASSERT(lazyScan->chunks_count() < lazy.groups_count());
+  }
+
+void inode_scan_reads_tables_in_chunks()
+  {
+  auto && disk = guard_disk_image_any({kIndirectDiskImage});
+  auto scan = disk.inode_scanner(0, 1);
+  auto count = 0u;
+  while(scan->next())
+    {
+    ++count;
+    }
+
+  ASSERT_EQUAL(2048u, count);
+  ASSERT_EQUAL(1u, scan->chunks_count());
+  }
+
+void parallel_inode_scan_matches_sequential_scan()
+  {
+  auto && disk = guard_disk_image_any({kMetaGroupsDiskImage});
+  auto sequential = std::vector<fs::detail::u32>{};
+  auto scan = disk.inode_scanner();
+  while(auto const id = scan->next())
+    {
+    sequential.push_back(*id);
+    }
+
+  auto mutex = std::mutex{};
+  auto parallel = std::vector<fs::detail::u32>{};
+  ASSERT(disk.scan_inodes([&](auto const id, auto const &){
+    auto lock = std::lock_guard<std::mutex>{mutex};
+    parallel.push_back(id);
+  }, 4));
+
+  std::sort(parallel.begin(), parallel.end());
+  ASSERT_EQUAL(sequential, parallel);
+  }
+
+void listing_non_directory_fails()
+  {
+  auto && disk = guard_disk_image_any({kDirectoriesDiskImage});
+  auto const small = disk.find(kRootDirectoryId, "small").value_or(0);
+  ASSERT(!disk.list(small, [](auto, auto, auto){ return true; }));
+  }
+
+void listing_directory_reports_all_entries()
+  {
+  for(auto const path : {kIndirectDiskImage, kDirectoriesDiskImage})
+    {
+    auto && disk = guard_disk_image_any({path});
+    auto const indexed = disk.find(kRootDirectoryId, "indexed").value_or(0);
+    auto names = std::vector<std::string>{};
+    ASSERT(disk.list(indexed, [&](auto const inodeId, auto const name, auto const type){
+      if(name != "." && name != "..")
+        {
+        ASSERT_EQUAL(disk.find(indexed, name).value_or(0), inodeId);
+        }
+      ASSERT(type != fs::detail::directory_entry::file_type::unknown);
+      names.emplace_back(name);
+      return true;
+    }));
+
+    ASSERT_EQUAL(8003u, names.size());
+    ASSERT_EQUAL(1, std::count(names.begin(), names.end(), "."));
+    ASSERT_EQUAL(1, std::count(names.begin(), names.end(), ".."));
+    ASSERT_EQUAL(1, std::count(names.begin(), names.end(), "entry-07999"));
+    }
+  }
+
+void listing_stops_when_the_visitor_does()
+  {
+  auto && disk = guard_disk_image_any({kDirectoriesDiskImage});
+  auto const indexed = disk.find(kRootDirectoryId, "indexed").value_or(0);
+  auto count = 0u;
+  ASSERT(disk.list(indexed, [&](auto, auto, auto){ return ++count < 10; }));
+  ASSERT_EQUAL(10u, count);
+  }
+
+std::vector<std::string> walked_paths_of(fs::extfs const & disk, unsigned const threads)
+  {
+  auto mutex = std::mutex{};
+  auto paths = std::vector<std::string>{};
+  auto const statistics = disk.walk(kRootDirectoryId, [&](auto const & entry){
+    auto lock = std::lock_guard<std::mutex>{mutex};
+    paths.emplace_back(entry.path);
+    return fs::walk_action::descend;
+  }, threads);
+
+  ASSERT(statistics);
+  ASSERT_EQUAL(paths.size(), statistics->entries_count);
+  ASSERT_EQUAL(0u, statistics->failures_count);
+  ASSERT(!statistics->stopped);
+  std::sort(paths.begin(), paths.end());
+  return paths;
+  }
+
+void walk_visits_the_complete_tree()
+  {
+  auto expected = std::vector<std::string>{"lost+found"};
+  for(auto const & entry : stdfs::recursive_directory_iterator{kTree})
+    {
+    expected.push_back(entry.path().string().substr(std::string{kTree}.size() + 1));
+    }
+  std::sort(expected.begin(), expected.end());
+
+  for(auto const path : {kIndirectDiskImage, kDirectoriesDiskImage})
+    {
+    auto && disk = guard_disk_image_any({path});
+    ASSERT_EQUAL(expected, walked_paths_of(disk, 4));
+    }
+  }
+
+void walk_does_not_depend_on_the_number_of_threads()
+  {
+  auto && disk = guard_disk_image_any({kDirectoriesDiskImage});
+  ASSERT_EQUAL(walked_paths_of(disk, 1), walked_paths_of(disk, 8));
+  }
+
+void walk_does_not_descend_into_pruned_directories()
+  {
+  auto && disk = guard_disk_image_any({kDirectoriesDiskImage});
+  auto tooDeep = std::atomic<bool>{};
+  auto const statistics = disk.walk(kRootDirectoryId, [&](auto const & entry){
+    tooDeep = tooDeep || entry.depth > 2;
+    return entry.name == "indexed" || entry.name == "nested" ? fs::walk_action::prune : fs::walk_action::descend;
+  }, 4);
+
+  ASSERT(statistics);
+  ASSERT(!tooDeep);
+  ASSERT_EQUAL(3u, statistics->directories_count);
+  ASSERT_EQUAL(7u, statistics->entries_count);
+  }
+
+void stopped_walk_visits_no_further_entries()
+  {
+  auto && disk = guard_disk_image_any({kDirectoriesDiskImage});
+  auto const statistics = disk.walk(kRootDirectoryId, [](auto const &){ return fs::walk_action::stop; }, 1);
+
+  ASSERT(statistics);
+  ASSERT(statistics->stopped);
+  ASSERT_EQUAL(1u, statistics->entries_count);
+  }
+
+void walking_a_file_fails()
+  {
+  auto && disk = guard_disk_image_any({kDirectoriesDiskImage});
+  auto const small = disk.find(kRootDirectoryId, "small").value_or(0);
+  ASSERT(!disk.walk(small, [](auto const &){ return fs::walk_action::descend; }));
+  }
+
+void listing_with_attributes_reports_the_inodes_of_all_entries()
+  {
+  for(auto const path : {kIndirectDiskImage, kDirectoriesDiskImage})
+    {
+    auto && disk = guard_disk_image_any({path});
+    auto names = std::vector<std::string>{};
+    ASSERT(disk.list(kRootDirectoryId, [&](auto, auto const name, auto){
+      names.emplace_back(name);
+      return true;
+    }));
+
+    auto listed = std::vector<std::string>{};
+    ASSERT(disk.list_with_attributes(kRootDirectoryId, [&](auto const & batch){
+      for(auto const & entry : batch)
+        {
+        auto const node = disk.inode(entry.inode_id);
+        ASSERT(entry.attributes);
+        ASSERT_EQUAL(node->mode, entry.attributes->mode);
+        ASSERT_EQUAL(node->size(), entry.attributes->size());
+        ASSERT(entry.type == fs::detail::entry_type_of(node->type()));
+        listed.push_back(entry.name);
+        }
+      return true;
+    }));
+
+    std::sort(names.begin(), names.end());
+    std::sort(listed.begin(), listed.end());
+    ASSERT_EQUAL(names, listed);
+    }
+  }
+
+void listing_with_attributes_orders_batches_by_inode()
+  {
+  auto && disk = guard_disk_image_any({kDirectoriesDiskImage});
+  ASSERT(disk.list_with_attributes(kRootDirectoryId, [&](auto const & batch){
+    ASSERT(std::is_sorted(batch.begin(), batch.end(), [](auto const & lhs, auto const & rhs){
+      return lhs.inode_id < rhs.inode_id;
+    }));
+    return true;
+  }));
+  }
+
+void listing_with_attributes_respects_the_batch_size()
+  {
+  auto && disk = guard_disk_image_any({kDirectoriesDiskImage});
+  auto const indexed = disk.find(kRootDirectoryId, "indexed").value_or(0);
+  auto batches = 0u;
+  auto entries = std::size_t{};
+  ASSERT(disk.list_with_attributes(indexed, [&](auto const & batch){
+    ASSERT(batch.size() <= 1000u);
+    ++batches;
+    entries += batch.size();
+    return true;
+  }, 1000));
+
+  ASSERT_EQUAL(9u, batches);
+  ASSERT_EQUAL(8003u, entries);
+  }
+
+void listing_with_attributes_stops_when_the_visitor_does()
+  {
+  auto && disk = guard_disk_image_any({kDirectoriesDiskImage});
+  auto const indexed = disk.find(kRootDirectoryId, "indexed").value_or(0);
+  auto batches = 0u;
+  ASSERT(disk.list_with_attributes(indexed, [&](auto const &){ return ++batches < 2; }, 1000));
+  ASSERT_EQUAL(2u, batches);
+  }
+
+void listed_inodes_are_cached()
+  {
+  auto && disk = guard_disk_image_any({kIndirectDiskImage});
+  auto ids = std::vector<fs::detail::u32>{};
+  ASSERT(disk.list_with_attributes(kRootDirectoryId, [&](auto const & batch){
+    for(auto const & entry : batch)
+      {
+      ids.push_back(entry.inode_id);
+      }
+    return true;
+  }));
+
+  auto const before = disk.inode_cache_statistics();
+  for(auto const id : ids)
+    {
+    disk.inode(id);
+    }
+  auto const after = disk.inode_cache_statistics();
+
+  ASSERT_EQUAL(before.misses, after.misses);
+  ASSERT_EQUAL(before.hits + ids.size(), after.hits);
+  }
+
+std::vector<fs::detail::u32> files_of(fs::extfs const & disk)
+  {
+  auto mutex = std::mutex{};
+  auto files = std::vector<fs::detail::u32>{};
+  disk.walk(kRootDirectoryId, [&](auto const & entry){
+    if(entry.type == fs::detail::directory_entry::file_type::regular_file)
+      {
+      auto lock = std::lock_guard<std::mutex>{mutex};
+      files.push_back(entry.inode_id);
+      }
+    return fs::walk_action::descend;
+  });
+  return files;
+  }
+
+void bulk_read_delivers_the_content_of_all_files()
+  {
+  for(auto const path : {kExtentsDiskImage, kIndirectDiskImage})
+    {
+    auto && disk = guard_disk_image_any({path});
+    auto const files = files_of(disk);
+    auto contents = std::map<fs::detail::u32, std::vector<char>>{};
+    for(auto const id : files)
+      {
+      contents[id].resize(disk.inode(id)->size());
+      }
+
+    auto completed = std::vector<fs::detail::u32>{};
+    auto const statistics = disk.read_bulk(files, [&](auto const & piece){
+      auto & content = contents[piece.inode_id];
+      ASSERT(piece.offset + piece.length <= content.size());
+      std::copy(piece.data, piece.data + piece.length, content.begin() + piece.offset);
+      return true;
+    }, [&](auto const id, auto const success){
+      ASSERT(success);
+      completed.push_back(id);
+    });
+
+    ASSERT(statistics);
+    ASSERT_EQUAL(files.size(), statistics->files_count);
+    ASSERT_EQUAL(0u, statistics->failures_count);
+    ASSERT_EQUAL(files.size(), completed.size());
+    ASSERT_EQUAL(content_of(kLargeFile), contents[disk.lookup("/large").value_or(0)]);
+    ASSERT_EQUAL(content_of(kSparseFile), contents[disk.lookup("/sparse").value_or(0)]);
+    ASSERT_EQUAL(content_of("../test/extfs_data/tree/small"), contents[disk.lookup("/small").value_or(0)]);
+    }
+  }
+
+void bulk_read_of_unmapped_file_system_matches_mapped_file_system()
+  {
+  auto settings = fs::extfs::settings{};
+  settings.memory_map = false;
+  auto const unmapped = fs::extfs{kExtentsDiskImage, fs::extfs::mode::read_only, settings};
+  auto && mapped = guard_disk_image_any({kExtentsDiskImage});
+  auto const files = files_of(mapped);
+
+  auto const collect = [&](fs::extfs const & disk){
+    auto pieces = std::vector<std::pair<fs::detail::u32, std::vector<char>>>{};
+    disk.read_bulk(files, [&](auto const & piece){
+      pieces.emplace_back(piece.inode_id, std::vector<char>{piece.data, piece.data + piece.length});
+      return true;
+    });
+    return pieces;
+  };
+
+  ASSERT(collect(mapped) == collect(unmapped));
+  }
+
+void bulk_read_reports_unreadable_inodes()
+  {
+  auto && disk = guard_disk_image_any({kExtentsDiskImage});
+  auto const large = disk.lookup("/large").value_or(0);
+  auto failures = std::vector<fs::detail::u32>{};
+  auto const statistics = disk.read_bulk({0, large}, [](auto const &){ return true; }, [&](auto const id, auto const success){
+    if(!success)
+      {
+      failures.push_back(id);
+      }
+  });
+
+  ASSERT(statistics);
+  ASSERT_EQUAL(std::vector<fs::detail::u32>{0}, failures);
+  ASSERT_EQUAL(1u, statistics->files_count);
+  ASSERT_EQUAL(kLargeFileSize, statistics->bytes_count);
+  }
+
+std::string sequence(int const last)
+  {
+  auto content = std::string{};
+  for(auto number = 1; number <= last; ++number)
+    {
+    content += std::to_string(number) + "\n";
+    }
+  return content;
+  }
+
+void inline_files_are_read_from_the_inode()
+  {
+  auto settings = fs::extfs::settings{};
+  settings.memory_map = false;
+  auto const disk = fs::extfs{kInlineDiskImage, fs::extfs::mode::read_only, settings};
+  auto const nested = disk.lookup("/directory/nested/file").value_or(0);
+  auto const overflowing = disk.lookup("/overflowing").value_or(0);
+  ASSERT(disk.inode(nested)->has(fs::detail::inode::flag::inline_data));
+  ASSERT(disk.inode(overflowing)->has(fs::detail::inode::flag::inline_data));
+  ASSERT(!disk.resolve(overflowing, 0, 1));
+
+  auto const misses = disk.buffer_cache_statistics().misses;
+  auto buffer = std::string(128, '\0');
+  buffer.resize(disk.read(nested, 0, buffer.data(), buffer.size()).value_or(0));
+  ASSERT_EQUAL(std::string{"nested file\n"}, buffer);
+
+  auto const expected = sequence(30);
+  buffer.assign(128, '\0');
+  buffer.resize(disk.read(overflowing, 0, buffer.data(), buffer.size()).value_or(0));
+  ASSERT_EQUAL(expected, buffer);
+
+  buffer.assign(10, '\0');
+  buffer.resize(disk.read(overflowing, 55, buffer.data(), buffer.size()).value_or(0));
+  ASSERT_EQUAL(expected.substr(55, 10), buffer);
+  ASSERT_EQUAL(misses, disk.buffer_cache_statistics().misses);
+  }
+
+void inline_directories_are_listed_and_searched()
+  {
+  auto && disk = guard_disk_image_any({kInlineDiskImage});
+  auto const directory = disk.lookup("/directory").value_or(0);
+  auto const nested = disk.lookup("/directory/nested").value_or(0);
+  ASSERT(disk.inode(directory)->has(fs::detail::inode::flag::inline_data));
+  ASSERT_EQUAL(directory, disk.lookup("/directory/nested/..").value_or(0));
+  ASSERT_EQUAL(nested, disk.lookup("/directory/nested/.").value_or(0));
+  ASSERT_EQUAL(0u, disk.lookup("/directory/missing").value_or(42));
+
+  auto names = std::vector<std::string>{};
+  ASSERT(disk.list(directory, [&](auto const id, auto const name, auto const type){
+    names.emplace_back(name);
+    ASSERT(id);
+    ASSERT(type == fs::detail::directory_entry::file_type::directory);
+    return true;
+  }));
+  ASSERT_EQUAL((std::vector<std::string>{".", "..", "nested"}), names);
+  }
+
+void bulk_read_delivers_inline_content()
+  {
+  auto && disk = guard_disk_image_any({kInlineDiskImage});
+  auto const overflowing = disk.lookup("/overflowing").value_or(0);
+  auto const small = disk.lookup("/small").value_or(0);
+  auto contents = std::map<fs::detail::u32, std::string>{};
+  contents[overflowing].resize(disk.inode(overflowing)->size());
+  contents[small].resize(disk.inode(small)->size());
+
+  auto const statistics = disk.read_bulk({overflowing, small}, [&](auto const & piece){
+    contents[piece.inode_id].replace(piece.offset, piece.length, reinterpret_cast<char const *>(piece.data), piece.length);
+    return true;
+  }, [](auto, auto const success){ ASSERT(success); });
+
+  ASSERT(statistics);
+  ASSERT_EQUAL(2u, statistics->files_count);
+  ASSERT_EQUAL(sequence(30), contents[overflowing]);
+  ASSERT_EQUAL(sequence(2000), contents[small]);
+  }
+
+std::string attribute_of(fs::extfs const & disk, fs::detail::u32 const inodeId, std::string_view const name)
+  {
+  auto const value = disk.extended_attribute(inodeId, name).value_or(std::vector<fs::detail::u08>{});
+  return std::string{value.begin(), value.end()};
+  }
+
+void extended_attributes_are_listed_from_inode_and_block()
+  {
+  auto && disk = guard_disk_image_any({kAttributesDiskImage});
+  auto const small = disk.lookup("/small").value_or(0);
+  ASSERT(disk.inode(small)->extended_attributes_block_id());
+
+  auto attributes = std::map<std::string, std::string>{};
+  ASSERT(disk.list_extended_attributes(small, [&](auto const name, auto const value, auto const size){
+    attributes.emplace(name, std::string{reinterpret_cast<char const *>(value), size});
+    return true;
+  }));
+
+  auto spilled = std::string{};
+  for(auto number = 1; number <= 60; ++number)
+    {
+    spilled += (number > 1 ? "," : "") + std::to_string(number);
+    }
+  spilled += "\n";
+
+  auto const expected = std::map<std::string, std::string>{{"trusted.spilled", spilled}, {"user.comment", "small"}};
+  ASSERT_EQUAL(expected, attributes);
+  ASSERT_EQUAL(spilled, attribute_of(disk, small, "trusted.spilled"));
+  ASSERT_EQUAL(std::string{"small"}, attribute_of(disk, small, "user.comment"));
+  ASSERT(!disk.extended_attribute(small, "user.missing"));
+  ASSERT(!disk.extended_attribute(small, "comment"));
+  ASSERT(disk.verifies_checksums());
+  ASSERT_EQUAL(0u, disk.checksum_failures_count());
+  }
+
+void in_inode_attributes_are_read_without_attribute_blocks()
+  {
+  auto && disk = guard_disk_image_any({kAttributesDiskImage});
+  auto const directory = disk.lookup("/directory").value_or(0);
+  auto const nested = disk.lookup("/directory/nested").value_or(0);
+  ASSERT_EQUAL(std::string{"system_u:object_r:etc_t:s0"}, attribute_of(disk, directory, "security.selinux"));
+  ASSERT(!disk.extended_attribute(directory, "system.posix_acl_access"));
+
+  auto count = 0;
+  ASSERT(disk.list_extended_attributes(nested, [&](auto, auto, auto){ return ++count; }));
+  ASSERT_EQUAL(0, count);
+  ASSERT(!disk.list_extended_attributes(0, [](auto, auto, auto){ return true; }));
+  ASSERT_EQUAL(0u, disk.attribute_block_cache_statistics().misses);
+  }
+
+void shared_attribute_blocks_are_read_once()
+  {
+  auto settings = fs::extfs::settings{};
+  settings.memory_map = false;
+  auto const disk = fs::extfs{kAttributesDiskImage, fs::extfs::mode::read_only, settings};
+  auto const small = disk.lookup("/small").value_or(0);
+  auto const large = disk.lookup("/large").value_or(0);
+  ASSERT_EQUAL(disk.inode(small)->extended_attributes_block_id(), disk.inode(large)->extended_attributes_block_id());
+
+  auto const value = attribute_of(disk, small, "trusted.spilled");
+  ASSERT(!value.empty());
+  auto const misses = disk.buffer_cache_statistics().misses;
+  ASSERT_EQUAL(value, attribute_of(disk, large, "trusted.spilled"));
+  ASSERT_EQUAL(value, attribute_of(disk, small, "trusted.spilled"));
+  ASSERT_EQUAL(misses, disk.buffer_cache_statistics().misses);
+
+  auto const statistics = disk.attribute_block_cache_statistics();
+  ASSERT_EQUAL(1u, statistics.misses);
+  ASSERT_EQUAL(2u, statistics.hits);
+  ASSERT_EQUAL(1u, statistics.entries);
+  }
+
+void read_only_file_system_can_not_be_synced()
+  {
+  auto && disk = guard_disk_image_any({kExtentsDiskImage});
+  ASSERT(!disk.sync());
+  ASSERT_EQUAL(0u, disk.buffer_cache_write_statistics().flushes_count);
+  }
+
+void allocating_blocks_requires_writeable_file_system()
+  {
+  auto && disk = guard_disk_image_any({kExtentsDiskImage});
+  ASSERT(disk.allocate_blocks(kRootDirectoryId, 1).empty());
+  ASSERT(!disk.release_blocks(fs::detail::block_extent{100, 1}));
+  }
+
+void allocated_blocks_follow_the_content_of_the_inode()
+  {
+  auto const copy = std::string{"../test/extfs_data/extents_allocation.img"};
+  stdfs::copy_file(kExtentsDiskImage, copy, stdfs::copy_options::overwrite_existing);
+  {
+  auto disk = fs::extfs{copy, fs::extfs::mode::writeable};
+  auto const large = disk.lookup("/large").value_or(0);
+  auto const runs = disk.resolve(large, 0, kLargeFileSize / 1024);
+  ASSERT(runs && !runs->empty());
+
+  auto const extents = disk.allocate_blocks(large, 4);
+  ASSERT_EQUAL(1u, extents.size());
+  ASSERT_EQUAL(4u, extents[0].blocks_count);
+  for(auto const & run : *runs)
+    {
+    ASSERT(run.sparse() || extents[0].end_block_id() <= run.physical_block_id ||
+           extents[0].first_block_id >= run.physical_block_id + run.blocks_count);
+    }
+
+  auto const next = disk.allocate_blocks(large, 4, extents[0].end_block_id());
+  ASSERT_EQUAL(1u, next.size());
+  ASSERT_EQUAL(extents[0].end_block_id(), next[0].first_block_id);
+  ASSERT(disk.release_blocks(extents[0]));
+  ASSERT(disk.release_blocks(next[0]));
+  ASSERT_EQUAL(8u, disk.block_allocator_statistics().released_blocks_count);
+  }
+  stdfs::remove(copy);
+  }
+
+std::vector<char> repeated(std::string const & line, std::size_t const length)
+  {
+  auto content = std::vector<char>{};
+  while(content.size() < length)
+    {
+    content.insert(content.end(), line.begin(), line.end());
+    }
+  content.resize(length);
+  return content;
+  }
+
+std::vector<char> recovered_small_file()
+  {
+  auto content = content_of(kSmallFile);
+  auto const journaled = repeated("journaled\n", 1024);
+  auto const escaped = repeated("escaped\n", 1020);
+  std::copy(journaled.begin(), journaled.end(), content.begin());
+  std::copy(std::begin("\xc0\x3b\x39\x98"), std::begin("\xc0\x3b\x39\x98") + 4, content.begin() + 3 * 1024);
+  std::copy(escaped.begin(), escaped.end(), content.begin() + 3 * 1024 + 4);
+  return content;
+  }
+
+std::vector<char> read_small_file(fs::extfs const & disk)
+  {
+  auto const id = disk.lookup("/small").value_or(0);
+  auto content = std::vector<char>(content_of(kSmallFile).size());
+  ASSERT_EQUAL(content.size(), disk.read(id, 0, content.data(), content.size()).value_or(0));
+  return content;
+  }
+
+void journal_of_unclean_file_system_is_scanned()
+  {
+  auto && disk = guard_disk_image_any({kJournalDiskImage});
+  ASSERT(disk.needs_recovery());
+
+  auto const statistics = disk.journal_statistics();
+  ASSERT(statistics);
+  ASSERT_EQUAL(3u, statistics->transactions_count);
+  ASSERT_EQUAL(3u, statistics->logged_blocks_count);
+  ASSERT_EQUAL(1u, statistics->revoked_blocks_count);
+  ASSERT_EQUAL(2u, statistics->blocks_count);
+  ASSERT(statistics->incomplete);
+  }
+
+void journal_of_clean_file_system_is_not_scanned()
+  {
+  auto && disk = guard_disk_image_any({kExtentsDiskImage});
+  ASSERT(!disk.needs_recovery());
+  ASSERT(!disk.journal_statistics());
+  }
+
+void committed_blocks_are_read_from_the_journal()
+  {
+  auto && disk = guard_disk_image_any({kJournalDiskImage});
+  ASSERT_EQUAL(recovered_small_file(), read_small_file(disk));
+  }
+
+void committed_blocks_are_read_from_the_journal_of_unmapped_file_system()
+  {
+  auto settings = fs::extfs::settings{};
+  settings.memory_map = false;
+  auto const disk = fs::extfs{kJournalDiskImage, fs::extfs::mode::read_only, settings};
+  ASSERT_EQUAL(recovered_small_file(), read_small_file(disk));
+
+  auto contents = std::vector<char>(content_of(kSmallFile).size());
+  auto const statistics = disk.read_bulk({disk.lookup("/small").value_or(0)}, [&](auto const & piece){
+    std::copy(piece.data, piece.data + piece.length, contents.begin() + static_cast<std::ptrdiff_t>(piece.offset));
+    return true;
+  });
+  ASSERT(statistics);
+  ASSERT_EQUAL(recovered_small_file(), contents);
+  }
+
+void journal_is_ignored_if_overlay_is_disabled()
+  {
+  auto settings = fs::extfs::settings{};
+  settings.overlay_journal = false;
+  auto const disk = fs::extfs{kJournalDiskImage, fs::extfs::mode::read_only, settings};
+  ASSERT(disk.needs_recovery());
+  ASSERT(!disk.journal_statistics());
+  ASSERT_EQUAL(content_of(kSmallFile), read_small_file(disk));
+  }
+
 int main(int argc, char * argv[])
   {
   auto tests = cute::suite{
@@ -118,6 +1610,98 @@ int main(int argc, char * argv[])
     CUTE(construction_with_unlabeled_image_creates_extfs_that_has_no_label),
     CUTE(construction_with_labeled_image_creates_extfs_that_has_label_labeleddisk),
     CUTE(construction_with_unlabeled_image_creates_extfs_that_has_empty_string_for_label),
+    CUTE(non_open_file_system_has_no_groups),
+    CUTE(construction_with_multi_group_image_creates_extfs_with_groups),
+    CUTE(groups_of_open_file_system_are_accessible),
+    CUTE(non_open_file_system_has_no_inodes),
+    CUTE(inode_zero_does_not_exist),
+    CUTE(inode_beyond_inode_count_does_not_exist),
+    CUTE(root_inode_is_a_directory),
+    CUTE(repeated_inode_lookup_hits_the_cache),
+    CUTE(inode_cache_respects_its_budget),
+    CUTE(inodes_can_be_looked_up_concurrently),
+    CUTE(non_open_file_system_resolves_nothing),
+    CUTE(resolving_extents_maps_requested_range),
+    CUTE(resolving_extents_populates_block_map_cache),
+    CUTE(resolving_indirect_blocks_maps_complete_file),
+    CUTE(resolving_indirect_blocks_populates_block_map_cache),
+    CUTE(finding_in_non_directory_fails),
+    CUTE(finding_in_linear_directory_finds_entries),
+    CUTE(finding_missing_entry_returns_zero),
+    CUTE(finding_in_indexed_directory_finds_entries),
+    CUTE(indexed_and_linear_directories_agree),
+    CUTE(relative_paths_can_not_be_looked_up),
+    CUTE(root_path_resolves_to_root_directory),
+    CUTE(nested_paths_resolve_component_by_component),
+    CUTE(missing_components_resolve_to_zero),
+    CUTE(paths_through_files_can_not_be_looked_up),
+    CUTE(repeated_prefixes_resolve_from_dentry_cache),
+    CUTE(missing_names_are_cached_as_negative_entries),
+    CUTE(dentry_cache_respects_its_budget),
+    CUTE(mapped_file_system_bypasses_buffer_cache),
+    CUTE(unmapped_file_system_reads_metadata_through_buffer_cache),
+    CUTE(loading_an_inode_prefetches_its_flexible_group),
+    CUTE(flexible_group_prefetch_can_be_disabled),
+    CUTE(group_metadata_can_be_prefetched_explicitly),
+    CUTE(reading_non_existent_inode_fails),
+    CUTE(reading_complete_files_returns_their_content),
+    CUTE(reading_unaligned_ranges_returns_their_content),
+    CUTE(reading_beyond_the_end_returns_nothing),
+    CUTE(reader_streams_complete_file),
+    CUTE(sequential_reads_grow_the_readahead_window),
+    CUTE(free_space_of_clean_file_systems_matches_summary_counts),
+    CUTE(free_space_does_not_depend_on_the_number_of_threads),
+    CUTE(free_space_of_unmapped_file_system_matches_mapped_file_system),
+    CUTE(free_space_reports_stale_summary_counts),
+    CUTE(free_space_ignores_uninitialized_flags_without_lazy_initialization),
+    CUTE(free_extents_account_for_all_free_blocks),
+    CUTE(free_extents_span_group_boundaries),
+    CUTE(free_extents_do_not_depend_on_the_number_of_threads),
+    CUTE(file_systems_without_metadata_checksums_are_not_verified),
+    CUTE(verification_can_be_disabled),
+    CUTE(intact_metadata_passes_verification),
+    CUTE(corrupted_superblock_fails_to_open),
+    CUTE(implausible_geometry_fails_to_open),
+    CUTE(corrupted_inode_can_not_be_read),
+    CUTE(superblock_copies_of_clean_file_systems_are_consistent),
+    CUTE(sparse_file_system_has_superblock_copies_in_powers_of_3_5_and_7),
+    CUTE(corrupted_superblock_copy_is_reported),
+    CUTE(file_system_can_be_opened_from_a_backup_superblock),
+    CUTE(backup_superblock_can_be_found_without_primary_superblock),
+    CUTE(inode_scan_finds_all_used_inodes),
+    CUTE(inode_scan_skips_uninitialized_inode_tables),
+    CUTE(inode_scan_reads_tables_in_chunks),
+    CUTE(parallel_inode_scan_matches_sequential_scan),
+    CUTE(listing_non_directory_fails),
+    CUTE(listing_directory_reports_all_entries),
+    CUTE(listing_stops_when_the_visitor_does),
+    CUTE(walk_visits_the_complete_tree),
+    CUTE(walk_does_not_depend_on_the_number_of_threads),
+    CUTE(walk_does_not_descend_into_pruned_directories),
+    CUTE(stopped_walk_visits_no_further_entries),
+    CUTE(walking_a_file_fails),
+    CUTE(listing_with_attributes_reports_the_inodes_of_all_entries),
+    CUTE(listing_with_attributes_orders_batches_by_inode),
+    CUTE(listing_with_attributes_respects_the_batch_size),
+    CUTE(listing_with_attributes_stops_when_the_visitor_does),
+    CUTE(listed_inodes_are_cached),
+    CUTE(bulk_read_delivers_the_content_of_all_files),
+    CUTE(bulk_read_of_unmapped_file_system_matches_mapped_file_system),
+    CUTE(bulk_read_reports_unreadable_inodes),
+    CUTE(inline_files_are_read_from_the_inode),
+    CUTE(inline_directories_are_listed_and_searched),
+    CUTE(bulk_read_delivers_inline_content),
+    CUTE(extended_attributes_are_listed_from_inode_and_block),
+    CUTE(in_inode_attributes_are_read_without_attribute_blocks),
+    CUTE(shared_attribute_blocks_are_read_once),
+    CUTE(read_only_file_system_can_not_be_synced),
+    CUTE(allocating_blocks_requires_writeable_file_system),
+    CUTE(allocated_blocks_follow_the_content_of_the_inode),
+    CUTE(journal_of_unclean_file_system_is_scanned),
+    CUTE(journal_of_clean_file_system_is_not_scanned),
+    CUTE(committed_blocks_are_read_from_the_journal),
+    CUTE(committed_blocks_are_read_from_the_journal_of_unmapped_file_system),
+    CUTE(journal_is_ignored_if_overlay_is_disabled),
   };
 
   cute::xml_file_opener resultFile{argc, argv};
@@ -0,0 +1,14 @@
+#!/bin/sh
+
+# This script adds a file to a test disk image with inline data, whose content is too large for the block map area of its
+# inode and thus overflows into the system.data extended attribute.
+
+set -e
+
+IMAGE="$1"
+WORK="$(mktemp -d)"
+trap 'rm -rf "${WORK}"' EXIT
+
+seq 1 30 > "${WORK}/overflowing"
+
+debugfs -w -R "write ${WORK}/overflowing overflowing" "${IMAGE}"
@@ -0,0 +1,36 @@
+#!/bin/sh
+
+# This script logs checksummed transactions in the journal of a test disk image without replaying them, so that the file
+# system needs recovery. The first transaction logs the first two blocks of /small, the second one revokes the second
+# block, the third one logs the fourth block with content that needs to be escaped, and the last one logs the third block
+# but is never committed.
+
+set -e
+
+IMAGE="$1"
+WORK="$(mktemp -d)"
+trap 'rm -rf "${WORK}"' EXIT
+
+block_of() {
+  debugfs -R "bmap /small $1" "${IMAGE}" 2>/dev/null
+}
+
+yes journaled | head -c 2048 > "${WORK}/journaled"
+printf '\300\073\071\230' > "${WORK}/escaped"
+yes escaped | head -c 1020 >> "${WORK}/escaped"
+yes pending | head -c 1024 > "${WORK}/pending"
+
+debugfs -w -f - "${IMAGE}" <<EOF
+jo -c
+jw -b $(block_of 0),$(block_of 1) ${WORK}/journaled
+jc
+jo -c
+jw -r $(block_of 1)
+jc
+jo -c
+jw -b $(block_of 3) ${WORK}/escaped
+jc
+jo -c
+jw -b $(block_of 2) -c ${WORK}/pending
+jc
+EOF
@@ -0,0 +1,28 @@
+#!/bin/sh
+
+# This script creates the directory tree used to populate the test disk images
+
+set -e
+
+TREE="$1"
+
+rm -rf "${TREE}"
+mkdir -p "${TREE}/directory/nested"
+
+seq 1 2000 > "${TREE}/small"
+seq 1 200000 > "${TREE}/large"
+echo "nested file" > "${TREE}/directory/nested/file"
+
+seq 1 2000 > "${TREE}/chunk"
+: > "${TREE}/sparse"
+for CHUNK in $(seq 0 399); do
+  dd if="${TREE}/chunk" of="${TREE}/sparse" bs=1024 count=1 skip=$((CHUNK % 4)) seek=$((CHUNK * 3)) conv=notrunc 2>/dev/null
+done
+rm "${TREE}/chunk"
+
+mkdir -p "${TREE}/indexed"
+: > "${TREE}/indexed/entry-00000"
+: > "${TREE}/indexed/ünïcödé"
+for ENTRY in $(seq 1 7999); do
+  ln "${TREE}/indexed/entry-00000" "${TREE}/indexed/$(printf 'entry-%05d' "${ENTRY}")"
+done